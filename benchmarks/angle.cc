@@ -0,0 +1,311 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// Planar rotations: composing SE(2) poses with Angle, which calls
+// std::cos and std::sin at each use, against UnitComplex, which keeps
+// them.
+//
+// Angle wrapping: the former loop-based wrap against Angle and the
+// batched wrapAngles, and element-wise operations on Angle against
+// AngleArray.
+//
+// Sines, cosines and tangents of wrapped angles: the standard library
+// against the batched kernels, at each precision.
+//
+// Binary angles: accumulating Angle against BinaryAngle32, and adding
+// arrays of angles as counts.
+//
+// Signals: unwrapping with Angle::distance sample by sample against
+// AngleUnwrapper, and the circular mean and variance over a window of
+// 64 samples recomputed at each sample against CircularStatistics.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <jrl/mathtools/angle.hh>
+#include <jrl/mathtools/anglearray.hh>
+#include <jrl/mathtools/binaryangle.hh>
+#include <jrl/mathtools/circularstatistics.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000;
+static const std::size_t count = 4096;
+
+static double loopWrap (double angle)
+{
+  while (angle < -M_PI)
+    angle += 2. * M_PI;
+  while (angle > M_PI)
+    angle -= 2. * M_PI;
+  return angle;
+}
+
+int main ()
+{
+  std::vector<Angle> angles (count);
+  std::vector<UnitComplex> rotations (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      angles[i] = Angle (0.001 * static_cast<double> (i));
+      rotations[i] = UnitComplex (angles[i]);
+    }
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("Angle, pose composition",
+     benchmark::measure ([&] {
+	 benchmark::escape (angles);
+	 Angle theta;
+	 double x = 0.;
+	 double y = 0.;
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     x += cos (theta) * 0.1 - sin (theta) * 0.01;
+	     y += sin (theta) * 0.1 + cos (theta) * 0.01;
+	     theta += angles[i];
+	   }
+	 benchmark::escape (x);
+	 benchmark::escape (y);
+       }, iterations) / n);
+  benchmark::report
+    ("UnitComplex, pose composition",
+     benchmark::measure ([&] {
+	 benchmark::escape (rotations);
+	 UnitComplex theta;
+	 double x = 0.;
+	 double y = 0.;
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     double dx = 0.1;
+	     double dy = 0.01;
+	     theta.rotate (dx, dy);
+	     x += dx;
+	     y += dy;
+	     theta *= rotations[i];
+	   }
+	 benchmark::escape (x);
+	 benchmark::escape (y);
+       }, iterations) / n);
+
+  // Odometry-like values, up to a few hundred turns.
+  std::vector<double> raw (count), wrapped (count);
+  for (std::size_t i = 0; i < count; ++i)
+    raw[i] = std::sin (static_cast<double> (i)) * static_cast<double> (i);
+  benchmark::report
+    ("wrap, loops",
+     benchmark::measure ([&] {
+	 benchmark::escape (raw);
+	 for (std::size_t i = 0; i < count; ++i)
+	   wrapped[i] = loopWrap (raw[i]);
+	 benchmark::escape (wrapped);
+       }, iterations) / n);
+  benchmark::report
+    ("wrap, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (raw);
+	 for (std::size_t i = 0; i < count; ++i)
+	   wrapped[i] = Angle (raw[i]).value ();
+	 benchmark::escape (wrapped);
+       }, iterations) / n);
+  benchmark::report
+    ("wrap, wrapAngles",
+     benchmark::measure ([&] {
+	 benchmark::escape (raw);
+	 wrapAngles (&raw[0], &wrapped[0], count);
+	 benchmark::escape (wrapped);
+       }, iterations) / n);
+
+  AngleArray a (&raw[0], count);
+  const AngleArray b (&wrapped[0], count);
+  std::vector<Angle> c (a.data (), a.data () + count);
+  const std::vector<Angle> d (b.data (), b.data () + count);
+  benchmark::report
+    ("add, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (c);
+	 for (std::size_t i = 0; i < count; ++i)
+	   c[i] += d[i];
+	 benchmark::escape (c);
+       }, iterations) / n);
+  benchmark::report
+    ("add, AngleArray",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 a += b;
+	 benchmark::escape (a);
+       }, iterations) / n);
+  benchmark::report
+    ("interpolate, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (c);
+	 for (std::size_t i = 0; i < count; ++i)
+	   c[i] = c[i].interpolate (0.3, d[i]);
+	 benchmark::escape (c);
+       }, iterations) / n);
+  benchmark::report
+    ("interpolate, AngleArray",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 a = a.interpolate (0.3, b);
+	 benchmark::escape (a);
+       }, iterations) / n);
+
+  std::vector<double> sines (count), cosines (count);
+  benchmark::report
+    ("sincos, libm",
+     benchmark::measure ([&] {
+	 benchmark::escape (wrapped);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     sines[i] = std::sin (wrapped[i]);
+	     cosines[i] = std::cos (wrapped[i]);
+	   }
+	 benchmark::escape (sines);
+	 benchmark::escape (cosines);
+       }, iterations) / n);
+  static const char* sinCosNames[] =
+    {"sincos, full precision", "sincos, medium precision",
+     "sincos, low precision"};
+  static const char* tanNames[] =
+    {"tan, full precision", "tan, medium precision", "tan, low precision"};
+  static const TrigonometryPrecision precisions[] =
+    {FULL_PRECISION, MEDIUM_PRECISION, LOW_PRECISION};
+  for (unsigned p = 0; p < 3; ++p)
+    benchmark::report
+      (sinCosNames[p],
+       benchmark::measure ([&] {
+	   benchmark::escape (wrapped);
+	   sinCosAngles (&wrapped[0], &sines[0], &cosines[0],
+			 wrapped.size (), precisions[p]);
+	   benchmark::escape (sines);
+	   benchmark::escape (cosines);
+	 }, iterations) / n);
+  benchmark::report
+    ("tan, libm",
+     benchmark::measure ([&] {
+	 benchmark::escape (wrapped);
+	 for (std::size_t i = 0; i < count; ++i)
+	   sines[i] = std::tan (wrapped[i]);
+	 benchmark::escape (sines);
+       }, iterations) / n);
+  for (unsigned p = 0; p < 3; ++p)
+    benchmark::report
+      (tanNames[p],
+       benchmark::measure ([&] {
+	   benchmark::escape (wrapped);
+	   tanAngles (&wrapped[0], &sines[0], wrapped.size (),
+		      precisions[p]);
+	   benchmark::escape (sines);
+	 }, iterations) / n);
+
+  std::vector<BinaryAngle32> binaries (count);
+  std::vector<std::uint32_t> counts (count), otherCounts (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      binaries[i] = BinaryAngle32 (angles[i]);
+      counts[i] = BinaryAngle32 (Angle (raw[i])).count ();
+      otherCounts[i] = BinaryAngle32 (Angle (wrapped[i])).count ();
+    }
+  benchmark::report
+    ("accumulate, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (angles);
+	 Angle sum;
+	 for (std::size_t i = 0; i < count; ++i)
+	   sum += angles[i];
+	 benchmark::escape (sum);
+       }, iterations) / n);
+  benchmark::report
+    ("accumulate, BinaryAngle32",
+     benchmark::measure ([&] {
+	 benchmark::escape (binaries);
+	 BinaryAngle32 sum;
+	 for (std::size_t i = 0; i < count; ++i)
+	   sum += binaries[i];
+	 benchmark::escape (sum);
+       }, iterations) / n);
+  benchmark::report
+    ("add, BinaryAngle32 counts",
+     benchmark::measure ([&] {
+	 benchmark::escape (counts);
+	 for (std::size_t i = 0; i < count; ++i)
+	   counts[i] += otherCounts[i];
+	 benchmark::escape (counts);
+       }, iterations) / n);
+
+  std::vector<double> signal (count), unwrapped (count);
+  for (std::size_t i = 0; i < count; ++i)
+    signal[i] = Angle (0.01 * static_cast<double> (i)).value ();
+  benchmark::report
+    ("unwrap, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (signal);
+	 unwrapped[0] = signal[0];
+	 for (std::size_t i = 1; i < count; ++i)
+	   {
+	     const Angle step = Angle (signal[i]) - Angle (signal[i - 1]);
+	     unwrapped[i] = unwrapped[i - 1] + step.value ();
+	   }
+	 benchmark::escape (unwrapped);
+       }, iterations) / n);
+  benchmark::report
+    ("unwrap, AngleUnwrapper",
+     benchmark::measure ([&] {
+	 benchmark::escape (signal);
+	 AngleUnwrapper unwrapper;
+	 unwrapper.unwrap (&signal[0], &unwrapped[0], signal.size ());
+	 benchmark::escape (unwrapped);
+       }, iterations) / n);
+
+  const std::size_t window = 64;
+  std::vector<double> means (count), variances (count);
+  benchmark::report
+    ("window statistics, direct",
+     benchmark::measure ([&] {
+	 benchmark::escape (signal);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const std::size_t begin = i + 1 > window ? i + 1 - window : 0;
+	     double x = 0.;
+	     double y = 0.;
+	     for (std::size_t j = begin; j <= i; ++j)
+	       {
+		 x += std::cos (signal[j]);
+		 y += std::sin (signal[j]);
+	       }
+	     means[i] = std::atan2 (y, x);
+	     variances[i] = 1. - std::sqrt (x * x + y * y)
+	       / static_cast<double> (i + 1 - begin);
+	   }
+	 benchmark::escape (means);
+	 benchmark::escape (variances);
+       }, iterations / 10) / n);
+  CircularStatistics statistics (window);
+  benchmark::report
+    ("window statistics, CircularStatistics",
+     benchmark::measure ([&] {
+	 benchmark::escape (signal);
+	 statistics.clear ();
+	 statistics.push (&signal[0], signal.size (), &means[0],
+			  &variances[0]);
+	 benchmark::escape (means);
+	 benchmark::escape (variances);
+       }, iterations) / n);
+  return 0;
+}
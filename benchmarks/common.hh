@@ -0,0 +1,101 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_BENCHMARKS_COMMON_HH
+# define JRL_MATHTOOLS_BENCHMARKS_COMMON_HH
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+
+namespace benchmark
+{
+  /// \brief Make the compiler assume that value is read and written.
+  ///
+  /// This prevents benchmarked computations from being hoisted out of
+  /// the timing loop or optimized away.
+  template <typename T>
+  inline void escape (T& value)
+  {
+# if defined __GNUC__
+    asm volatile ("" : : "r" (&value) : "memory");
+# else
+    static T* volatile sink;
+    sink = &value;
+# endif
+  }
+
+  /// \brief Average time of a call to f, in nanoseconds.
+  template <typename F>
+  double measure (const F& f, unsigned iterations)
+  {
+    // Warm up caches and branch predictors.
+    for (unsigned i = 0; i < iterations / 10 + 1; ++i)
+      f ();
+
+    typedef std::chrono::steady_clock clock_t;
+    const clock_t::time_point start = clock_t::now ();
+    for (unsigned i = 0; i < iterations; ++i)
+      f ();
+    const clock_t::time_point end = clock_t::now ();
+    return std::chrono::duration<double, std::nano> (end - start).count ()
+      / iterations;
+  }
+
+  /// \brief Write a JSON string, dropping control characters.
+  inline void writeJsonString (std::FILE* file, const char* s)
+  {
+    std::fputc ('"', file);
+    for (; *s; ++s)
+      {
+	if (*s == '"' || *s == '\\')
+	  std::fputc ('\\', file);
+	if (static_cast<unsigned char> (*s) >= 0x20)
+	  std::fputc (*s, file);
+      }
+    std::fputc ('"', file);
+  }
+
+  /// \brief Append a timing to the JSON results, if any.
+  ///
+  /// When the JRL_MATHTOOLS_BENCHMARK_JSON environment variable names
+  /// a file, one JSON object per line is appended to it, with the
+  /// benchmark program taken from JRL_MATHTOOLS_BENCHMARK. The
+  /// benchmark target gathers these records into a single document.
+  inline void record (const char* name, double ns)
+  {
+    const char* path = std::getenv ("JRL_MATHTOOLS_BENCHMARK_JSON");
+    if (! path || ! *path)
+      return;
+    std::FILE* file = std::fopen (path, "a");
+    if (! file)
+      return;
+    const char* program = std::getenv ("JRL_MATHTOOLS_BENCHMARK");
+    std::fputs ("{\"benchmark\": ", file);
+    writeJsonString (file, program ? program : "");
+    std::fputs (", \"name\": ", file);
+    writeJsonString (file, name);
+    std::fprintf (file, ", \"ns\": %.4f}\n", ns);
+    std::fclose (file);
+  }
+
+  /// \brief Print a timing.
+  inline void report (const char* name, double ns)
+  {
+    std::printf ("%-48s %12.2f ns\n", name, ns);
+    record (name, ns);
+  }
+} // end of namespace benchmark.
+
+#endif //! JRL_MATHTOOLS_BENCHMARKS_COMMON_HH
@@ -0,0 +1,157 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// 3x3 decompositions against their LAPACK counterparts on heap
+// buffers: symmetric eigen-decomposition against dsyev, singular value
+// decomposition against the pseudo-inverse of matrixNxP, one at a time
+// and batched.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/decompositions3x3.hh>
+#include <jrl/mathtools/matrixnxp.hh>
+
+#include "common.hh"
+
+extern "C"
+{
+  void dsyev_ (const char* jobz, const char* uplo, const int* n, double* a,
+	       const int* lda, double* w, double* work, const int* lwork,
+	       int* info);
+}
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 100;
+static const std::size_t count = 4096;
+
+int main ()
+{
+  std::vector<Matrix3x3<double> > A (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      const double k = static_cast<double> (i);
+      const double a = std::cos (0.9 * k), b = std::sin (1.7 * k);
+      const double d = std::cos (2.3 * k), e = std::sin (0.4 * k);
+      A[i] = Matrix3x3<double> (a + 2., d, e,
+				d, b + 2., 0.5,
+				e, 0.5, 3.);
+    }
+  std::vector<double> a (6 * count), values (3 * count), vectors (9 * count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      a[i] = A[i].m[0];
+      a[count + i] = A[i].m[4];
+      a[2 * count + i] = A[i].m[8];
+      a[3 * count + i] = A[i].m[3];
+      a[4 * count + i] = A[i].m[6];
+      a[5 * count + i] = A[i].m[7];
+    }
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("LAPACK dsyev",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const int three = 3;
+	     const int lwork = 102;
+	     int info;
+	     std::vector<double> m (A[i].m, A[i].m + 9);
+	     std::vector<double> w (3);
+	     std::vector<double> work (lwork);
+	     dsyev_ ("V", "U", &three, &m[0], &three, &w[0], &work[0], &lwork,
+		     &info);
+	     values[i] = w[0];
+	   }
+	 benchmark::escape (values);
+       }, iterations) / n);
+  benchmark::report
+    ("SymmetricEigenDecomposition",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const SymmetricEigenDecomposition<double> e (A[i]);
+	     values[i] = e.eigenvalues ()[0];
+	     vectors[i] = e.eigenvectors ().m[0];
+	   }
+	 benchmark::escape (values);
+	 benchmark::escape (vectors);
+       }, iterations) / n);
+  benchmark::report
+    ("symmetricEigenDecomposition, batched",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 symmetricEigenDecomposition (&a[0], &values[0], &vectors[0], count);
+	 benchmark::escape (values);
+	 benchmark::escape (vectors);
+       }, iterations) / n);
+
+  // General matrices.
+  std::vector<Matrix3x3<double> > B (count);
+  std::vector<double> b (9 * count), u (9 * count), sigma (3 * count);
+  for (std::size_t i = 0; i < count; ++i)
+    for (unsigned k = 0; k < 9; ++k)
+      {
+	B[i].m[k] = std::cos (0.37 * static_cast<double> (9 * i + k) + 0.1 * k);
+	b[k * count + i] = B[i].m[k];
+      }
+  matrixNxP Bnxp (3, 3);
+  matrixNxP Binv (3, 3);
+  benchmark::report
+    ("matrixNxP pseudoInverse",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     for (unsigned r = 0; r < 3; ++r)
+	       for (unsigned c = 0; c < 3; ++c)
+		 Bnxp (r, c) = B[i].m[3 * r + c];
+	     pseudoInverse (Bnxp, Binv);
+	     benchmark::escape (Binv);
+	   }
+       }, iterations / 10) / n);
+  benchmark::report
+    ("SingularValueDecomposition",
+     benchmark::measure ([&] {
+	 benchmark::escape (B);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const SingularValueDecomposition<double> svd (B[i]);
+	     sigma[i] = svd.singularValues ()[2];
+	     u[i] = svd.matrixU ().m[0];
+	   }
+	 benchmark::escape (sigma);
+	 benchmark::escape (u);
+       }, iterations) / n);
+  benchmark::report
+    ("singularValueDecomposition, batched",
+     benchmark::measure ([&] {
+	 benchmark::escape (b);
+	 singularValueDecomposition (&b[0], &u[0], &sigma[0], &vectors[0],
+				     count);
+	 benchmark::escape (u);
+       }, iterations) / n);
+  benchmark::report
+    ("nearestRotation, batched",
+     benchmark::measure ([&] {
+	 benchmark::escape (b);
+	 nearestRotation (&b[0], &u[0], count);
+	 benchmark::escape (u);
+       }, iterations) / n);
+  return 0;
+}
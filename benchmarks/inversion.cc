@@ -0,0 +1,108 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Compare the 4x4 inversion with the cofactor expansion it replaced.
+// Build with -mavx2 (or -march=native) to measure the vectorized
+// double precision path.
+
+#include <string>
+
+#include <jrl/mathtools/matrix4x4.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 10000000;
+
+// Previous implementation: full cofactor expansion, separate
+// determinant and scaling through operator*.
+template <typename T>
+static void cofactorInversion (const Matrix4x4<T>& M, Matrix4x4<T>& A)
+{
+  const T* m = M.m;
+  T det = 1. / M.determinant ();
+
+  A.m[0]=m[6]*m[11]*m[13] - m[7]*m[10]*m[13] + m[7]*m[9]*m[14] - m[5]*m[11]*m[14] - m[6]*m[9]*m[15] +m[5]*m[10]*m[15];
+  A.m[1]=m[3]*m[10]*m[13] - m[2]*m[11]*m[13] - m[3]*m[9]*m[14] + m[1]*m[11]*m[14] + m[2]*m[9]*m[15] -m[1]*m[10]*m[15];
+  A.m[2]=m[2]*m[7]*m[13] - m[3]*m[6]*m[13] + m[3]*m[5]*m[14] - m[1]*m[7]*m[14] - m[2]*m[5]*m[15] + m[1]*m[6]*m[15];
+  A.m[3]=m[3]*m[6]*m[9] - m[2]*m[7]*m[9] - m[3]*m[5]*m[10] + m[1]*m[7]*m[10] + m[2]*m[5]*m[11] - m[1]*m[6]*m[11];
+
+  A.m[4]=m[7]*m[10]*m[12] -m[6]*m[11]*m[12] -m[7]*m[8]*m[14] + m[4]*m[11]*m[14] + m[6]*m[8]*m[15] - m[4]*m[10]*m[15];
+  A.m[5]=m[2]*m[11]*m[12] -m[3]*m[10]*m[12] +m[3]*m[8]*m[14] - m[0]*m[11]*m[14] - m[2]*m[8]*m[15] + m[0]*m[10]*m[15];
+  A.m[6]=m[3]*m[6]*m[12] - m[2]*m[7]*m[12] - m[3]*m[4]*m[14] + m[0]*m[7]*m[14] + m[2]*m[4]*m[15] - m[0]*m[6]*m[15];
+  A.m[7]=m[2]*m[7]*m[8] - m[3]*m[6]*m[8] + m[3]*m[4]*m[10] - m[0]*m[7]*m[10] - m[2]*m[4]*m[11] + m[0]*m[6]*m[11];
+
+  A.m[8]=m[5]*m[11]*m[12] - m[7]*m[9]*m[12] + m[7]*m[8]*m[13] - m[4]*m[11]*m[13] - m[5]*m[8]*m[15] + m[4]*m[9]*m[15];
+  A.m[9]=m[0]*m[11]*m[13] + m[1]*m[8]*m[15] + m[3]*m[9]*m[12] - m[0]*m[9]*m[15] - m[1]*m[11]*m[12] - m[3]*m[8]*m[13];
+  A.m[10]=m[1]*m[7]*m[12] - m[3]*m[5]*m[12] + m[3]*m[4]*m[13] - m[0]*m[7]*m[13] - m[1]*m[4]*m[15] + m[0]*m[5]*m[15];
+  A.m[11]=m[3]*m[5]*m[8] - m[1]*m[7]*m[8] - m[3]*m[4]*m[9] + m[0]*m[7]*m[9] + m[1]*m[4]*m[11] - m[0]*m[5]*m[11];
+
+  A.m[12]=m[6]*m[9]*m[12] - m[5]*m[10]*m[12] - m[6]*m[8]*m[13] + m[4]*m[10]*m[13] + m[5]*m[8]*m[14] - m[4]*m[9]*m[14];
+  A.m[13]=m[1]*m[10]*m[12] - m[2]*m[9]*m[12] + m[2]*m[8]*m[13] - m[0]*m[10]*m[13] - m[1]*m[8]*m[14] + m[0]*m[9]*m[14];
+  A.m[14]=m[2]*m[5]*m[12] - m[1]*m[6]*m[12] - m[2]*m[4]*m[13] + m[0]*m[6]*m[13] + m[1]*m[4]*m[14] - m[0]*m[5]*m[14];
+  A.m[15]=m[1]*m[6]*m[8] - m[2]*m[5]*m[8] + m[2]*m[4]*m[9] - m[0]*m[6]*m[9] - m[1]*m[4]*m[10] + m[0]*m[5]*m[10];
+
+  A = A * det;
+}
+
+template <typename T>
+static void run (const char* type)
+{
+  const std::string prefix = std::string ("Matrix4x4<") + type + "> ";
+  Matrix4x4<T> A (5, 1, 2, 0.5,
+		  1, 6, 3, 1,
+		  2, 3, 7, 2,
+		  0.5, 1, 2, 8);
+  Matrix4x4<T> X;
+  T det;
+
+  benchmark::report
+    ((prefix + "cofactor expansion").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 cofactorInversion (A, X);
+	 benchmark::escape (X);
+       }, iterations));
+  benchmark::report
+    ((prefix + "Inversion").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.Inversion (X);
+	 benchmark::escape (X);
+       }, iterations));
+  benchmark::report
+    ((prefix + "Inversion (checked)").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.Inversion (X, det, T (1e-12));
+	 benchmark::escape (X);
+       }, iterations));
+  benchmark::report
+    ((prefix + "Inversion (in place)").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (X);
+	 X.Inversion (X);
+	 benchmark::escape (X);
+       }, iterations));
+}
+
+int main ()
+{
+  run<float> ("float");
+  run<double> ("double");
+  return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+// Logging of Matrix4x4 poses: text output element by element with
+// std::endl, as display () used to, with operator<< and with
+// formatText; parsing with operator>> and with parseText; binary
+// files with BinaryWriter and MappedArray.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/mathtools/io.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const std::size_t count = 100000;
+
+int main ()
+{
+  const char* text = "io-benchmark.txt";
+  const char* binary = "io-benchmark.bin";
+  std::vector<Matrix4x4<double> > poses (count);
+  for (std::size_t i = 0; i < count; ++i)
+    for (unsigned int e = 0; e < 16; ++e)
+      poses[i].m[e] = std::sin (static_cast<double> (16 * i + e));
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("write, element-wise with std::endl",
+     benchmark::measure ([&] {
+	 std::ofstream file (text);
+	 for (std::size_t i = 0; i < count; ++i)
+	   for (unsigned int r = 0; r < 4; ++r)
+	     {
+	       for (unsigned int c = 0; c < 4; ++c)
+		 file << poses[i].m[4 * r + c] << " ";
+	       file << std::endl;
+	     }
+       }, 1) / n);
+  benchmark::report
+    ("write, operator<<",
+     benchmark::measure ([&] {
+	 std::ofstream file (text);
+	 for (std::size_t i = 0; i < count; ++i)
+	   file << poses[i];
+       }, 1) / n);
+  benchmark::report
+    ("write, formatText (round trip)",
+     benchmark::measure ([&] {
+	 std::ofstream file (text);
+	 for (std::size_t i = 0; i < count; ++i)
+	   formatText (file, poses[i]);
+       }, 1) / n);
+  benchmark::report
+    ("write, formatText (17 digits)",
+     benchmark::measure ([&] {
+	 std::ofstream file (text);
+	 for (std::size_t i = 0; i < count; ++i)
+	   formatText (file, poses[i], 17);
+       }, 1) / n);
+  benchmark::report
+    ("write, BinaryWriter",
+     benchmark::measure ([&] {
+	 BinaryWriter<Matrix4x4<double> > writer (binary);
+	 for (std::size_t i = 0; i < count; ++i)
+	   writer.write (poses[i]);
+       }, 10) / n);
+
+  std::vector<double> elements (16 * count);
+  benchmark::report
+    ("read, operator>>",
+     benchmark::measure ([&] {
+	 std::ifstream file (text);
+	 for (std::size_t i = 0; i < elements.size (); ++i)
+	   file >> elements[i];
+	 benchmark::escape (elements);
+       }, 1) / n);
+  std::string contents;
+  {
+    std::ifstream file (text);
+    std::ostringstream buffer;
+    buffer << file.rdbuf ();
+    contents = buffer.str ();
+  }
+  benchmark::report
+    ("read, parseText",
+     benchmark::measure ([&] {
+	 const char* first = contents.c_str ();
+	 const char* last = first + contents.size ();
+	 Matrix4x4<double> pose;
+	 for (std::size_t i = 0; i < count && first; ++i)
+	   first = parseText (first, last, pose);
+	 benchmark::escape (pose);
+       }, 1) / n);
+  benchmark::report
+    ("read, MappedArray",
+     benchmark::measure ([&] {
+	 MappedArray<Matrix4x4<double> > mapped (binary);
+	 double sum = 0.;
+	 for (std::size_t i = 0; i < mapped.size (); ++i)
+	   sum += mapped[i].m[3];
+	 benchmark::escape (sum);
+       }, 10) / n);
+
+  std::remove (text);
+  std::remove (binary);
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Forward kinematics of a 30-link chain: full recomputation with
+// Matrix4x4 products against the incremental KinematicChain.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/kinematicchain.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000000;
+static const std::size_t links = 30;
+
+static Matrix4x4<double> joint (double q)
+{
+  const double c = std::cos (q);
+  const double s = std::sin (q);
+  return Matrix4x4<double> (c, -s, 0., 0.5,
+			    s, c, 0., 0.,
+			    0., 0., 1., 0.1,
+			    0., 0., 0., 1.);
+}
+
+int main ()
+{
+  std::vector<Matrix4x4<double> > local (links, joint (0.1));
+  std::vector<Matrix4x4<double> > world (links);
+  KinematicChain<double> chain;
+  for (std::size_t i = 0; i < links; ++i)
+    chain.addLink (local[i]);
+  const Matrix4x4<double> moved = joint (0.2);
+
+  benchmark::report
+    ("full recomputation",
+     benchmark::measure ([&] {
+	 benchmark::escape (local);
+	 world[0] = local[0];
+	 for (std::size_t i = 1; i < links; ++i)
+	   world[i] = world[i - 1] * local[i];
+	 benchmark::escape (world);
+       }, iterations));
+  benchmark::report
+    ("KinematicChain, every joint moved",
+     benchmark::measure ([&] {
+	 chain.setLocal (0, moved);
+	 benchmark::escape (chain);
+	 chain.update ();
+       }, iterations));
+  benchmark::report
+    ("KinematicChain, last 5 joints moved",
+     benchmark::measure ([&] {
+	 for (std::size_t i = links - 5; i < links; ++i)
+	   chain.setLocal (i, moved);
+	 benchmark::escape (chain);
+	 chain.update ();
+       }, iterations));
+  benchmark::report
+    ("KinematicChain, last joint moved",
+     benchmark::measure ([&] {
+	 chain.setLocal (links - 1, moved);
+	 benchmark::escape (chain);
+	 chain.update ();
+       }, iterations));
+  return 0;
+}
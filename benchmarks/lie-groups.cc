@@ -0,0 +1,114 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// SO(3) and SE(3) exponentials: Rodrigues' formula with the standard
+// library trigonometric functions against expSO3 / expSE3, one at a
+// time and batched.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/liegroups.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000;
+static const std::size_t count = 4096;
+
+static Matrix3x3<double> rodrigues (const Vector3D<double>& w)
+{
+  const double theta = w.norm ();
+  const double x = w.m_x / theta;
+  const double y = w.m_y / theta;
+  const double z = w.m_z / theta;
+  const double c = std::cos (theta);
+  const double s = std::sin (theta);
+  const double k = 1 - c;
+  return Matrix3x3<double>
+    (c + k * x * x, k * x * y - s * z, k * x * z + s * y,
+     k * x * y + s * z, c + k * y * y, k * y * z - s * x,
+     k * x * z - s * y, k * y * z + s * x, c + k * z * z);
+}
+
+int main ()
+{
+  std::vector<Vector3D<double> > w (count), v (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      const double k = static_cast<double> (i);
+      w[i] = Vector3D<double> (std::sin (k), 0.5 * std::cos (k), 0.3)
+	* (0.0007 * k);
+      v[i] = Vector3D<double> (1., k, -0.5);
+    }
+  std::vector<Matrix3x3<double> > R (count);
+  std::vector<Matrix4x4<double> > M (count);
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("SO(3), Rodrigues with sin/cos",
+     benchmark::measure ([&] {
+	 benchmark::escape (w);
+	 for (std::size_t i = 0; i < count; ++i)
+	   R[i] = rodrigues (w[i]);
+	 benchmark::escape (R);
+       }, iterations) / n);
+  benchmark::report
+    ("SO(3), expSO3",
+     benchmark::measure ([&] {
+	 benchmark::escape (w);
+	 for (std::size_t i = 0; i < count; ++i)
+	   R[i] = expSO3 (w[i]);
+	 benchmark::escape (R);
+       }, iterations) / n);
+  benchmark::report
+    ("SO(3), batched expSO3",
+     benchmark::measure ([&] {
+	 benchmark::escape (w);
+	 expSO3 (&w[0], &R[0], count);
+	 benchmark::escape (R);
+       }, iterations) / n);
+  benchmark::report
+    ("SO(3), logSO3",
+     benchmark::measure ([&] {
+	 benchmark::escape (R);
+	 logSO3 (&R[0], &w[0], count);
+	 benchmark::escape (w);
+       }, iterations) / n);
+  benchmark::report
+    ("SE(3), expSE3",
+     benchmark::measure ([&] {
+	 benchmark::escape (w);
+	 for (std::size_t i = 0; i < count; ++i)
+	   M[i] = expSE3 (v[i], w[i]);
+	 benchmark::escape (M);
+       }, iterations) / n);
+  benchmark::report
+    ("SE(3), batched expSE3",
+     benchmark::measure ([&] {
+	 benchmark::escape (w);
+	 expSE3 (&v[0], &w[0], &M[0], count);
+	 benchmark::escape (M);
+       }, iterations) / n);
+  benchmark::report
+    ("SE(3), logSE3",
+     benchmark::measure ([&] {
+	 benchmark::escape (M);
+	 logSE3 (&M[0], &v[0], &w[0], count);
+	 benchmark::escape (w);
+       }, iterations) / n);
+  return 0;
+}
@@ -0,0 +1,173 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+// Nearest neighbours among SE(2) configurations: one-to-many distances
+// written with Angle::distance against the batched kernel, and
+// nearest neighbour queries by brute force against KdTree. Also
+// one-to-many SE(3) distances with acos against the batched kernel.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/angle.hh>
+#include <jrl/mathtools/distances.hh>
+#include <jrl/mathtools/nearestneighbors.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 100;
+static const std::size_t count = 20000;
+static const std::size_t queries = 256;
+
+// Scattered samples in [-1, 1], as a sampling-based planner draws them.
+static double sample (double k)
+{
+  const double x = std::sin (12.9898 * k) * 43758.5453;
+  return 2. * (x - std::floor (x)) - 1.;
+}
+
+int main ()
+{
+  // Configurations, coordinate-wise for the kernel and point-wise for
+  // the tree.
+  std::vector<double> poses (3 * count), points (3 * count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      const double k = static_cast<double> (i);
+      points[3 * i] = poses[i] = 5. * sample (k);
+      points[3 * i + 1] = poses[count + i] = 5. * sample (k + 0.25);
+      points[3 * i + 2] = poses[2 * count + i] = M_PI * sample (k + 0.5);
+    }
+  const double query[] = {0.3, -0.2, 3.};
+  std::vector<double> out (count);
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("SE(2) distances, Angle",
+     benchmark::measure ([&] {
+	 benchmark::escape (poses);
+	 const Angle theta (query[2]);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const double dx = poses[i] - query[0];
+	     const double dy = poses[count + i] - query[1];
+	     const double dt = theta.distance (Angle (poses[2 * count + i]));
+	     out[i] = std::sqrt (dx * dx + dy * dy + dt * dt);
+	   }
+	 benchmark::escape (out);
+       }, iterations) / n);
+  benchmark::report
+    ("SE(2) distances, se2Distances",
+     benchmark::measure ([&] {
+	 benchmark::escape (poses);
+	 se2Distances (query, &poses[0], &out[0], poses.size () / 3);
+	 benchmark::escape (out);
+       }, iterations) / n);
+
+  static const bool circular[] = {false, false, true};
+  KdTree<3> tree (circular);
+  benchmark::report
+    ("KdTree, insertion one by one",
+     benchmark::measure ([&] {
+	 tree.clear ();
+	 for (std::size_t i = 0; i < count; ++i)
+	   tree.insert (&points[3 * i]);
+	 benchmark::escape (tree);
+       }, 1) / n);
+  benchmark::report
+    ("KdTree, batch insertion",
+     benchmark::measure ([&] {
+	 tree.clear ();
+	 tree.insert (&points[0], count);
+	 benchmark::escape (tree);
+       }, 10) / n);
+
+  std::vector<double> targets (3 * queries);
+  for (std::size_t q = 0; q < queries; ++q)
+    {
+      const double k = static_cast<double> (q) + 0.125;
+      targets[3 * q] = 5. * sample (k);
+      targets[3 * q + 1] = 5. * sample (k + 0.25);
+      targets[3 * q + 2] = M_PI * sample (k + 0.5);
+    }
+  std::size_t ids[10];
+  double distances[10];
+  benchmark::report
+    ("nearest, brute force",
+     benchmark::measure ([&] {
+	 for (std::size_t q = 0; q < queries; ++q)
+	   {
+	     se2Distances (&targets[3 * q], &poses[0], &out[0],
+			   poses.size () / 3);
+	     ids[0] = std::min_element (out.begin (), out.end ())
+	       - out.begin ();
+	     benchmark::escape (ids);
+	   }
+       }, 1) / static_cast<double> (queries));
+  benchmark::report
+    ("nearest, KdTree",
+     benchmark::measure ([&] {
+	 for (std::size_t q = 0; q < queries; ++q)
+	   {
+	     tree.nearest (&targets[3 * q], 1, ids, distances);
+	     benchmark::escape (ids);
+	   }
+       }, iterations) / static_cast<double> (queries));
+  benchmark::report
+    ("10 nearest, KdTree",
+     benchmark::measure ([&] {
+	 for (std::size_t q = 0; q < queries; ++q)
+	   {
+	     tree.nearest (&targets[3 * q], 10, ids, distances);
+	     benchmark::escape (ids);
+	   }
+       }, iterations) / static_cast<double> (queries));
+
+  std::vector<Vector3D<double> > translations (count);
+  std::vector<Quaternion<double> > rotations (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      const double k = static_cast<double> (i);
+      translations[i] = Vector3D<double> (poses[i], poses[count + i], 0.);
+      rotations[i] = Quaternion<double> (std::sin (k), std::cos (k), 0.5,
+					 std::sin (0.3 * k));
+      rotations[i].normalize ();
+    }
+  const Vector3D<double> t (0.1, 0.2, 0.3);
+  const Quaternion<double> r = rotations[7];
+  benchmark::report
+    ("SE(3) distances, acos",
+     benchmark::measure ([&] {
+	 benchmark::escape (rotations);
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const double c = std::min (std::abs (r.dot (rotations[i])), 1.);
+	     const double angle = 2. * std::acos (c);
+	     out[i] = std::sqrt ((translations[i] - t).normsquared ()
+				 + angle * angle);
+	   }
+	 benchmark::escape (out);
+       }, iterations) / n);
+  benchmark::report
+    ("SE(3) distances, se3Distances",
+     benchmark::measure ([&] {
+	 benchmark::escape (rotations);
+	 se3Distances (t, r, &translations[0], &rotations[0], &out[0],
+		       rotations.size ());
+	 benchmark::escape (out);
+       }, iterations) / n);
+  return 0;
+}
@@ -0,0 +1,731 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// One benchmark per operation of the fixed-size types: Vector3D,
+// Vector4D, Matrix3x3 and Matrix4x4 at both precisions, Angle and
+// UnitComplex. The operands are hidden from the optimizer at each
+// call, so that the timings are those of a single call in a loop, not
+// of a computation folded across iterations.
+//
+// Matrix4x4::operator+= (const Matrix3x3&) is left out as it reads
+// past the end of its argument, and so are the Angle operators *=, /=
+// and -= with a scalar, which do not compile.
+
+#include <string>
+
+#include <jrl/mathtools/angle.hh>
+#include <jrl/mathtools/matrix3x3.hh>
+#include <jrl/mathtools/matrix4x4.hh>
+#include <jrl/mathtools/vector3.hh>
+#include <jrl/mathtools/vector4.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000000;
+
+template <typename F>
+static void time (const std::string& name, const F& f)
+{
+  benchmark::report (name.c_str (), benchmark::measure (f, iterations));
+}
+
+template <typename T>
+static void vector3 (const std::string& prefix)
+{
+  Vector3D<T> a (T (0.3), T (-1.2), T (2.5));
+  Vector3D<T> b (T (1.1), T (0.4), T (-0.7));
+  Vector3D<T> c;
+  T s = T (1);
+  T r = T ();
+  bool flag = false;
+
+  time (prefix + "unary operator-", [&] {
+      benchmark::escape (a);
+      c = -a;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a + b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a - b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+=", [&] {
+      benchmark::escape (b);
+      c += b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-=", [&] {
+      benchmark::escape (b);
+      c -= b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator* (scalar)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (s);
+      c = a * s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/ (scalar)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (s);
+      c = a / s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator*=", [&] {
+      benchmark::escape (s);
+      c *= s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/=", [&] {
+      benchmark::escape (s);
+      c /= s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator* (dot product)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      r = a * b;
+      benchmark::escape (r);
+    });
+  time (prefix + "operator^ (cross product)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a ^ b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator==", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      flag = a == b;
+      benchmark::escape (flag);
+    });
+  time (prefix + "norm", [&] {
+      benchmark::escape (a);
+      r = a.norm ();
+      benchmark::escape (r);
+    });
+  time (prefix + "normsquared", [&] {
+      benchmark::escape (a);
+      r = a.normsquared ();
+      benchmark::escape (r);
+    });
+  time (prefix + "normalize", [&] {
+      benchmark::escape (a);
+      a.normalize ();
+      benchmark::escape (a);
+    });
+  time (prefix + "IsZero", [&] {
+      benchmark::escape (a);
+      flag = a.IsZero ();
+      benchmark::escape (flag);
+    });
+}
+
+template <typename T>
+static void vector4 (const std::string& prefix)
+{
+  Vector4D<T> a (T (0.3), T (-1.2), T (2.5), T (1));
+  Vector4D<T> b (T (1.1), T (0.4), T (-0.7), T (0.5));
+  Vector4D<T> c;
+  const Vector3D<T> v (T (1.1), T (0.4), T (-0.7));
+  T s = T (1);
+  T r = T ();
+  bool flag = false;
+
+  time (prefix + "unary operator-", [&] {
+      benchmark::escape (a);
+      c = -a;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a + b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a - b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+=", [&] {
+      benchmark::escape (b);
+      c += b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-=", [&] {
+      benchmark::escape (b);
+      c -= b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator* (scalar)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (s);
+      c = a * s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/ (scalar)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (s);
+      c = a / s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator*=", [&] {
+      benchmark::escape (s);
+      c *= s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/=", [&] {
+      benchmark::escape (s);
+      c /= s;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator= (Vector3D)", [&] {
+      benchmark::escape (v);
+      c = v;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator==", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      flag = a == b;
+      benchmark::escape (flag);
+    });
+  time (prefix + "norm", [&] {
+      benchmark::escape (a);
+      r = a.norm ();
+      benchmark::escape (r);
+    });
+  time (prefix + "normsquared", [&] {
+      benchmark::escape (a);
+      r = a.normsquared ();
+      benchmark::escape (r);
+    });
+  time (prefix + "normalize", [&] {
+      benchmark::escape (a);
+      a.normalize ();
+      benchmark::escape (a);
+    });
+}
+
+template <typename T>
+static void matrix3x3 (const std::string& prefix)
+{
+  // Symmetric positive definite, so that every solver applies.
+  Matrix3x3<T> A (T (4), T (1), T (0.5),
+		  T (1), T (3), T (0.25),
+		  T (0.5), T (0.25), T (2));
+  Matrix3x3<T> B (T (0.36), T (0.48), T (-0.8),
+		  T (-0.8), T (0.6), T (0),
+		  T (0.48), T (0.64), T (0.6));
+  Matrix3x3<T> C;
+  Matrix3x3<T> X;
+  Vector3D<T> b (T (1), T (2), T (3));
+  Vector3D<T> x;
+  T s = T (1);
+  T r = T ();
+  bool flag = false;
+
+  time (prefix + "setZero", [&] {
+      C.setZero ();
+      benchmark::escape (C);
+    });
+  time (prefix + "setIdentity", [&] {
+      C.setIdentity ();
+      benchmark::escape (C);
+    });
+  time (prefix + "Fill", [&] {
+      benchmark::escape (s);
+      C.Fill (s);
+      benchmark::escape (C);
+    });
+  time (prefix + "operator+", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A + B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator-", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A - B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator* (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A * B;
+      benchmark::escape (C);
+    });
+  time (prefix + "CeqthismulB (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      A.CeqthismulB (B, C);
+      benchmark::escape (C);
+    });
+  time (prefix + "operator* (scalar)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (s);
+      C = A * s;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator+=", [&] {
+      benchmark::escape (B);
+      C += B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator-=", [&] {
+      benchmark::escape (B);
+      C -= B;
+      benchmark::escape (C);
+    });
+  C = B;
+  time (prefix + "operator*= (matrix)", [&] {
+      benchmark::escape (B);
+      C *= B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator*= (scalar)", [&] {
+      benchmark::escape (s);
+      C *= s;
+      benchmark::escape (C);
+    });
+  time (prefix + "Transpose", [&] {
+      benchmark::escape (A);
+      C = A.Transpose ();
+      benchmark::escape (C);
+    });
+  time (prefix + "Transpose (output argument)", [&] {
+      benchmark::escape (A);
+      A.Transpose (C);
+      benchmark::escape (C);
+    });
+  time (prefix + "Inversion", [&] {
+      benchmark::escape (A);
+      A.Inversion (C);
+      benchmark::escape (C);
+    });
+  time (prefix + "determinant", [&] {
+      benchmark::escape (A);
+      r = A.determinant ();
+      benchmark::escape (r);
+    });
+  time (prefix + "IsIdentity", [&] {
+      benchmark::escape (A);
+      flag = A.IsIdentity ();
+      benchmark::escape (flag);
+    });
+  time (prefix + "luSolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.luSolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "luSolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.luSolve (B, X);
+      benchmark::escape (X);
+    });
+  time (prefix + "choleskySolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.choleskySolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "choleskySolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.choleskySolve (B, X);
+      benchmark::escape (X);
+    });
+  time (prefix + "ldltSolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.ldltSolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "ldltSolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.ldltSolve (B, X);
+      benchmark::escape (X);
+    });
+  benchmark::escape (flag);
+}
+
+template <typename T>
+static void matrix4x4 (const std::string& prefix)
+{
+  // Symmetric positive definite, so that every solver applies.
+  Matrix4x4<T> A (T (5), T (1), T (2), T (0.5),
+		  T (1), T (6), T (3), T (1),
+		  T (2), T (3), T (7), T (2),
+		  T (0.5), T (1), T (2), T (8));
+  // Rigid transformation.
+  Matrix4x4<T> B (T (0.36), T (0.48), T (-0.8), T (1.5),
+		  T (-0.8), T (0.6), T (0), T (-2),
+		  T (0.48), T (0.64), T (0.6), T (0.25),
+		  T (0), T (0), T (0), T (1));
+  Matrix4x4<T> C;
+  Matrix4x4<T> X;
+  Vector3D<T> p (T (1), T (2), T (3));
+  Vector3D<T> q;
+  Vector4D<T> b (T (1), T (2), T (3), T (1));
+  Vector4D<T> x;
+  T s = T (1);
+  T r = T ();
+  bool flag = false;
+
+  time (prefix + "setZero", [&] {
+      C.setZero ();
+      benchmark::escape (C);
+    });
+  time (prefix + "setIdentity", [&] {
+      C.setIdentity ();
+      benchmark::escape (C);
+    });
+  time (prefix + "operator+", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A + B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator-", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A - B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator* (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      C = A * B;
+      benchmark::escape (C);
+    });
+  time (prefix + "CeqthismulB (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      A.CeqthismulB (B, C);
+      benchmark::escape (C);
+    });
+  time (prefix + "CeqthismulBAffine", [&] {
+      benchmark::escape (B);
+      B.CeqthismulBAffine (B, C);
+      benchmark::escape (C);
+    });
+  time (prefix + "operator* (Vector3D)", [&] {
+      benchmark::escape (B);
+      benchmark::escape (p);
+      q = B * p;
+      benchmark::escape (q);
+    });
+  time (prefix + "operator* (Vector4D)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      x = A * b;
+      benchmark::escape (x);
+    });
+  time (prefix + "CeqthismulB (Vector4D)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      A.CeqthismulB (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "operator* (scalar)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (s);
+      C = A * s;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator-=", [&] {
+      benchmark::escape (B);
+      C -= B;
+      benchmark::escape (C);
+    });
+  C = B;
+  time (prefix + "operator*= (matrix)", [&] {
+      benchmark::escape (B);
+      C *= B;
+      benchmark::escape (C);
+    });
+  time (prefix + "operator*= (scalar)", [&] {
+      benchmark::escape (s);
+      C *= s;
+      benchmark::escape (C);
+    });
+  time (prefix + "Transpose", [&] {
+      benchmark::escape (A);
+      C = A.Transpose ();
+      benchmark::escape (C);
+    });
+  time (prefix + "Inversion", [&] {
+      benchmark::escape (A);
+      C = A.Inversion ();
+      benchmark::escape (C);
+    });
+  time (prefix + "Inversion (output argument)", [&] {
+      benchmark::escape (A);
+      A.Inversion (C);
+      benchmark::escape (C);
+    });
+  time (prefix + "Inversion (checked)", [&] {
+      benchmark::escape (A);
+      flag = A.Inversion (C, r, T (1e-6));
+      benchmark::escape (C);
+    });
+  time (prefix + "determinant", [&] {
+      benchmark::escape (A);
+      r = A.determinant ();
+      benchmark::escape (r);
+    });
+  time (prefix + "trace", [&] {
+      benchmark::escape (A);
+      r = A.trace ();
+      benchmark::escape (r);
+    });
+  time (prefix + "luSolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.luSolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "luSolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.luSolve (B, X);
+      benchmark::escape (X);
+    });
+  time (prefix + "choleskySolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.choleskySolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "choleskySolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.choleskySolve (B, X);
+      benchmark::escape (X);
+    });
+  time (prefix + "ldltSolve (vector)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (b);
+      flag = A.ldltSolve (b, x);
+      benchmark::escape (x);
+    });
+  time (prefix + "ldltSolve (matrix)", [&] {
+      benchmark::escape (A);
+      benchmark::escape (B);
+      flag = A.ldltSolve (B, X);
+      benchmark::escape (X);
+    });
+  benchmark::escape (flag);
+}
+
+static void angle ()
+{
+  const std::string prefix = "Angle ";
+  Angle a (2.5);
+  Angle b (-1.3);
+  Angle c;
+  double v = 7.1;
+  double r = 0.;
+
+  time (prefix + "constructor (wrapping)", [&] {
+      benchmark::escape (v);
+      c = Angle (v);
+      benchmark::escape (c);
+    });
+  time (prefix + "degree (named constructor)", [&] {
+      benchmark::escape (v);
+      c = Angle::degree (v);
+      benchmark::escape (c);
+    });
+  time (prefix + "degree", [&] {
+      benchmark::escape (a);
+      r = a.degree ();
+      benchmark::escape (r);
+    });
+  time (prefix + "operator+", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a + b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a - b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+=", [&] {
+      benchmark::escape (b);
+      c += b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator-=", [&] {
+      benchmark::escape (b);
+      c -= b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+ (double)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (v);
+      c = a + v;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator- (double)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (v);
+      c = a - v;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator+= (double)", [&] {
+      benchmark::escape (v);
+      c += v;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator* (double)", [&] {
+      benchmark::escape (a);
+      benchmark::escape (v);
+      c = a * v;
+      benchmark::escape (c);
+    });
+  time (prefix + "interpolate", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a.interpolate (0.3, b);
+      benchmark::escape (c);
+    });
+  time (prefix + "distance", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      r = a.distance (b);
+      benchmark::escape (r);
+    });
+  time (prefix + "cos", [&] {
+      benchmark::escape (a);
+      r = cos (a);
+      benchmark::escape (r);
+    });
+  time (prefix + "sin", [&] {
+      benchmark::escape (a);
+      r = sin (a);
+      benchmark::escape (r);
+    });
+  time (prefix + "tan", [&] {
+      benchmark::escape (a);
+      r = tan (a);
+      benchmark::escape (r);
+    });
+}
+
+static void unitComplex ()
+{
+  const std::string prefix = "UnitComplex ";
+  Angle angle (2.5);
+  UnitComplex a (angle);
+  UnitComplex b (Angle (-1.3));
+  UnitComplex c;
+  double x = 1.;
+  double y = 2.;
+  double r = 0.;
+
+  time (prefix + "constructor (Angle)", [&] {
+      benchmark::escape (angle);
+      c = UnitComplex (angle);
+      benchmark::escape (c);
+    });
+  time (prefix + "angle", [&] {
+      benchmark::escape (a);
+      angle = a.angle ();
+      benchmark::escape (angle);
+    });
+  time (prefix + "tan", [&] {
+      benchmark::escape (a);
+      r = a.tan ();
+      benchmark::escape (r);
+    });
+  time (prefix + "operator*", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a * b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      c = a / b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator*=", [&] {
+      benchmark::escape (b);
+      c *= b;
+      benchmark::escape (c);
+    });
+  time (prefix + "operator/=", [&] {
+      benchmark::escape (b);
+      c /= b;
+      benchmark::escape (c);
+    });
+  time (prefix + "inverse", [&] {
+      benchmark::escape (a);
+      c = a.inverse ();
+      benchmark::escape (c);
+    });
+  time (prefix + "rotate", [&] {
+      benchmark::escape (a);
+      a.rotate (x, y);
+      benchmark::escape (x);
+      benchmark::escape (y);
+    });
+  time (prefix + "normalize", [&] {
+      benchmark::escape (c);
+      c.normalize ();
+      benchmark::escape (c);
+    });
+  time (prefix + "distance", [&] {
+      benchmark::escape (a);
+      benchmark::escape (b);
+      r = a.distance (b);
+      benchmark::escape (r);
+    });
+}
+
+int main ()
+{
+  vector3<float> ("Vector3D<float> ");
+  vector3<double> ("Vector3D<double> ");
+  vector4<float> ("Vector4D<float> ");
+  vector4<double> ("Vector4D<double> ");
+  matrix3x3<float> ("Matrix3x3<float> ");
+  matrix3x3<double> ("Matrix3x3<double> ");
+  matrix4x4<float> ("Matrix4x4<float> ");
+  matrix4x4<double> ("Matrix4x4<double> ");
+  angle ();
+  unitComplex ();
+  return 0;
+}
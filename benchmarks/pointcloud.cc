@@ -0,0 +1,101 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// Throughput of the bulk point transformation, compared with a loop
+// over Matrix4x4::operator*. Build with -mavx2 (or -march=native) to
+// measure the vectorized kernels.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <jrl/mathtools/pointcloud.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const std::size_t points = 1000000;
+static const unsigned iterations = 100;
+
+// Time per point, and memory throughput counting the bytes read and
+// written for every point.
+template <typename T>
+static void report (const std::string& name, double ns)
+{
+  std::printf ("%-48s %12.2f ns %8.2f GB/s\n", name.c_str (),
+	       ns / points, 6. * sizeof (T) * points / ns);
+  benchmark::record (name.c_str (), ns / points);
+}
+
+template <typename T>
+static void run (const char* type)
+{
+  const std::string prefix = std::string (type) + " ";
+  const unsigned hardware = std::max (std::thread::hardware_concurrency (), 1u);
+
+  const Matrix4x4<T> M (T (0.36), T (0.48), T (-0.8), T (1.5),
+			T (-0.8), T (0.6), T (0), T (-2),
+			T (0.48), T (0.64), T (0.6), T (0.25),
+			T (0), T (0), T (0), T (1));
+  std::vector<Vector3D<T> > in (points), out (points);
+  for (std::size_t i = 0; i < points; ++i)
+    in[i] = Vector3D<T> (T (i % 17), T (i % 13), T (i % 7));
+  std::vector<T> x (points), y (points), z (points);
+  std::vector<T> xo (points), yo (points), zo (points);
+
+  report<T>
+    (prefix + "operator* loop",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < points; ++i)
+	   out[i] = M * in[i];
+	 benchmark::escape (out);
+       }, iterations));
+  for (unsigned threads = 1; threads <= hardware; threads *= 2)
+    {
+      const std::string suffix =
+	" (" + std::to_string (threads) + " thread(s))";
+      report<T>
+	(prefix + "AoS" + suffix,
+	 benchmark::measure ([&] {
+	     transformPoints (M, in.data (), out.data (), points, threads);
+	     benchmark::escape (out);
+	   }, iterations));
+      report<T>
+	(prefix + "AoS in place" + suffix,
+	 benchmark::measure ([&] {
+	     transformPoints (M, out.data (), points, threads);
+	     benchmark::escape (out);
+	   }, iterations));
+      report<T>
+	(prefix + "SoA" + suffix,
+	 benchmark::measure ([&] {
+	     transformPoints (M, x.data (), y.data (), z.data (),
+			      xo.data (), yo.data (), zo.data (),
+			      points, threads);
+	     benchmark::escape (xo);
+	   }, iterations));
+    }
+}
+
+int main ()
+{
+  run<float> ("float");
+  run<double> ("double");
+  return 0;
+}
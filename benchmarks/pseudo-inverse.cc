@@ -0,0 +1,98 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// pseudoInverse and dampedInverse of matrixNxP across the shapes met
+// in whole-body control: square, wide Jacobians of a few tasks over
+// many joints, and their tall transposes. Each is timed allocating its
+// buffers at each call and reusing those of a PseudoInverseWorkspace.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <jrl/mathtools/matrixnxp.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+// Work per shape, in multiply-adds, so that the large shapes run for
+// about the same time. Small ones are dominated by the allocations and
+// the LAPACK calls, and are capped.
+static const double work = 5e7;
+static const double maxIterations = 20000;
+
+static void run (unsigned rows, unsigned cols)
+{
+  matrixNxP A (rows, cols);
+  for (unsigned i = 0; i < rows; ++i)
+    for (unsigned j = 0; j < cols; ++j)
+      A (i, j) = std::sin (static_cast<double> (i * cols + j + 1));
+  matrixNxP Ainv (cols, rows);
+
+  const double m = std::max (rows, cols);
+  const double n = std::min (rows, cols);
+  const unsigned iterations =
+    static_cast<unsigned> (std::min (work / (m * m * n), maxIterations));
+
+  char name[64];
+  std::snprintf (name, sizeof (name), "pseudoInverse %ux%u", rows, cols);
+  benchmark::report
+    (name,
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 pseudoInverse (A, Ainv);
+	 benchmark::escape (Ainv);
+       }, iterations));
+  std::snprintf (name, sizeof (name), "dampedInverse %ux%u", rows, cols);
+  benchmark::report
+    (name,
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 dampedInverse (A, Ainv, 1e-3);
+	 benchmark::escape (Ainv);
+       }, iterations));
+
+  PseudoInverseWorkspace workspace (rows, cols);
+  std::snprintf (name, sizeof (name), "pseudoInverse %ux%u, workspace",
+		 rows, cols);
+  benchmark::report
+    (name,
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 pseudoInverse (A, Ainv, workspace);
+	 benchmark::escape (Ainv);
+       }, iterations));
+  std::snprintf (name, sizeof (name), "dampedInverse %ux%u, workspace",
+		 rows, cols);
+  benchmark::report
+    (name,
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 dampedInverse (A, Ainv, workspace, 1e-3);
+	 benchmark::escape (Ainv);
+       }, iterations));
+}
+
+int main ()
+{
+  static const unsigned shapes[][2] =
+    {{3, 3}, {6, 6}, {12, 12}, {30, 30}, {50, 50},
+     {6, 7}, {6, 12}, {6, 30}, {12, 30}, {6, 100},
+     {7, 6}, {30, 6}, {100, 6}};
+  for (unsigned i = 0; i < sizeof (shapes) / sizeof (shapes[0]); ++i)
+    run (shapes[i][0], shapes[i][1]);
+  return 0;
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+// Quantized storage: encoding and decoding of poses and positions, and
+// a scan of the translations of a pose set, as a nearest neighbour
+// search does, on Matrix4x4 against QuantizedPose.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/quantization.hh>
+#include <jrl/mathtools/random.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 20;
+static const std::size_t count = 200000;
+
+int main ()
+{
+  const Vector3Quantizer quantizer (Vector3D<double> (-10., -10., -10.),
+				    Vector3D<double> (10., 10., 10.));
+  std::vector<Matrix4x4<double> > poses (count);
+  std::vector<Vector3D<double> > positions (count);
+  {
+    std::vector<Matrix3x3<double> > rotations (count);
+    RandomStream random (3);
+    randomRotations (random, &rotations[0], rotations.size ());
+    for (std::size_t i = 0; i < count; ++i)
+      {
+	const double k = static_cast<double> (i);
+	positions[i] = Vector3D<double> (10. * std::sin (k),
+					 10. * std::cos (1.3 * k),
+					 10. * std::sin (0.7 * k));
+	for (unsigned int row = 0; row < 3; ++row)
+	  for (unsigned int col = 0; col < 3; ++col)
+	    poses[i].m[4 * row + col] = rotations[i].m[3 * row + col];
+	poses[i].m[3] = positions[i].m_x;
+	poses[i].m[7] = positions[i].m_y;
+	poses[i].m[11] = positions[i].m_z;
+      }
+  }
+
+  const double n = static_cast<double> (count);
+  std::vector<QuantizedPose> quantized (count);
+  std::vector<QuantizedVector3D> quantizedPositions (count);
+  benchmark::report
+    ("encodePoses",
+     benchmark::measure ([&] {
+	 encodePoses (quantizer, &poses[0], &quantized[0], quantized.size ());
+	 benchmark::escape (quantized);
+       }, iterations) / n);
+  std::vector<Matrix4x4<double> > decoded (count);
+  benchmark::report
+    ("decodePoses",
+     benchmark::measure ([&] {
+	 decodePoses (quantizer, &quantized[0], &decoded[0], decoded.size ());
+	 benchmark::escape (decoded);
+       }, iterations) / n);
+  benchmark::report
+    ("encodeVectors",
+     benchmark::measure ([&] {
+	 encodeVectors (quantizer, &positions[0], &quantizedPositions[0],
+			quantizedPositions.size ());
+	 benchmark::escape (quantizedPositions);
+       }, iterations) / n);
+  std::vector<Vector3D<double> > decodedPositions (count);
+  benchmark::report
+    ("decodeVectors",
+     benchmark::measure ([&] {
+	 decodeVectors (quantizer, &quantizedPositions[0],
+			&decodedPositions[0], decodedPositions.size ());
+	 benchmark::escape (decodedPositions);
+       }, iterations) / n);
+
+  // Nearest translation to a query.
+  const Vector3D<double> query (1., 2., 3.);
+  benchmark::report
+    ("translation scan, Matrix4x4",
+     benchmark::measure ([&] {
+	 double best = 1e300;
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const double dx = poses[i].m[3] - query.m_x;
+	     const double dy = poses[i].m[7] - query.m_y;
+	     const double dz = poses[i].m[11] - query.m_z;
+	     best = std::min (best, dx * dx + dy * dy + dz * dz);
+	   }
+	 benchmark::escape (best);
+       }, iterations) / n);
+  benchmark::report
+    ("translation scan, QuantizedPose",
+     benchmark::measure ([&] {
+	 const Vector3D<double>& min = quantizer.min ();
+	 const Vector3D<double>& step = quantizer.step ();
+	 double best = 1e300;
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const QuantizedVector3D& t = quantized[i].m_translation;
+	     const double dx = min.m_x + t.m_x * step.m_x - query.m_x;
+	     const double dy = min.m_y + t.m_y * step.m_y - query.m_y;
+	     const double dz = min.m_z + t.m_z * step.m_z - query.m_z;
+	     best = std::min (best, dx * dx + dy * dy + dz * dz);
+	   }
+	 benchmark::escape (best);
+       }, iterations) / n);
+  return 0;
+}
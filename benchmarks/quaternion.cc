@@ -0,0 +1,90 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// Quaternion interpolation: batched slerp and nlerp against a scalar
+// slerp written with the standard library trigonometric functions.
+
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/quaternion.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000;
+static const std::size_t count = 4096;
+
+static Quaternion<double> libmSlerp (const Quaternion<double>& a,
+				     Quaternion<double> b, double t)
+{
+  double c = a.dot (b);
+  if (c < 0)
+    {
+      b = -b;
+      c = -c;
+    }
+  if (c > 1 - 1e-12)
+    return nlerp (a, b, t);
+  const double theta = std::acos (c);
+  const double s = 1 / std::sin (theta);
+  const double wa = std::sin ((1 - t) * theta) * s;
+  const double wb = std::sin (t * theta) * s;
+  return Quaternion<double> (wa * a.m_x + wb * b.m_x, wa * a.m_y + wb * b.m_y,
+			     wa * a.m_z + wb * b.m_z, wa * a.m_w + wb * b.m_w);
+}
+
+int main ()
+{
+  std::vector<Quaternion<double> > a (count), b (count), out (count);
+  std::vector<double> t (count);
+  for (std::size_t i = 0; i < count; ++i)
+    {
+      const double k = static_cast<double> (i);
+      Vector3D<double> u (1., std::sin (k), 0.5);
+      Vector3D<double> v (std::cos (k), 1., 0.2);
+      u.normalize ();
+      v.normalize ();
+      a[i] = Quaternion<double>::fromAxisAngle (u, 0.001 * k);
+      b[i] = Quaternion<double>::fromAxisAngle (v, 1. + 0.0005 * k);
+      t[i] = std::fmod (0.37 * k, 1.);
+    }
+
+  const double n = static_cast<double> (count);
+  benchmark::report
+    ("slerp, acos/sin per quaternion",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 for (std::size_t i = 0; i < count; ++i)
+	   out[i] = libmSlerp (a[i], b[i], t[i]);
+	 benchmark::escape (out);
+       }, iterations) / n);
+  benchmark::report
+    ("slerp, batched",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 slerp (&a[0], &b[0], &t[0], &out[0], count);
+	 benchmark::escape (out);
+       }, iterations) / n);
+  benchmark::report
+    ("nlerp, batched",
+     benchmark::measure ([&] {
+	 benchmark::escape (a);
+	 nlerp (&a[0], &b[0], &t[0], &out[0], count);
+	 benchmark::escape (out);
+       }, iterations) / n);
+  return 0;
+}
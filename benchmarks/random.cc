@@ -0,0 +1,116 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+// Bulk sampling of uniform angles and rotations: std::mt19937 with
+// std::uniform_real_distribution, std::cos, std::sin and
+// Quaternion::toRotationMatrix one sample at a time, against the
+// batched RandomStream samplers.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <jrl/mathtools/random.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 100;
+static const std::size_t count = 10000;
+
+int main ()
+{
+  const double n = static_cast<double> (count);
+  std::mt19937 engine (42);
+  std::uniform_real_distribution<double> uniform (0., 1.);
+  RandomStream random (42);
+
+  std::vector<double> angles (count);
+  benchmark::report
+    ("angles, mt19937",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < count; ++i)
+	   angles[i] = M_PI * (2. * uniform (engine) - 1.);
+	 benchmark::escape (angles);
+       }, iterations) / n);
+  benchmark::report
+    ("angles, randomAngles",
+     benchmark::measure ([&] {
+	 randomAngles (random, &angles[0], angles.size ());
+	 benchmark::escape (angles);
+       }, iterations) / n);
+
+  std::vector<Quaternion<double> > quaternions (count);
+  std::vector<Matrix3x3<double> > matrices (count);
+  std::vector<double> soa (9 * count);
+  benchmark::report
+    ("quaternions, mt19937",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const double u = uniform (engine);
+	     const double t1 = 2. * M_PI * uniform (engine);
+	     const double t2 = 2. * M_PI * uniform (engine);
+	     const double r1 = std::sqrt (1. - u);
+	     const double r2 = std::sqrt (u);
+	     quaternions[i] = Quaternion<double>
+	       (r1 * std::sin (t1), r1 * std::cos (t1),
+		r2 * std::sin (t2), r2 * std::cos (t2));
+	   }
+	 benchmark::escape (quaternions);
+       }, iterations) / n);
+  benchmark::report
+    ("quaternions, randomQuaternions",
+     benchmark::measure ([&] {
+	 randomQuaternions (random, &soa[0], soa.size () / 9);
+	 benchmark::escape (soa);
+       }, iterations) / n);
+  benchmark::report
+    ("quaternions, randomQuaternions (Quaternion)",
+     benchmark::measure ([&] {
+	 randomQuaternions (random, &quaternions[0], quaternions.size ());
+	 benchmark::escape (quaternions);
+       }, iterations) / n);
+
+  benchmark::report
+    ("rotations, mt19937",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < count; ++i)
+	   {
+	     const double u = uniform (engine);
+	     const double t1 = 2. * M_PI * uniform (engine);
+	     const double t2 = 2. * M_PI * uniform (engine);
+	     const double r1 = std::sqrt (1. - u);
+	     const double r2 = std::sqrt (u);
+	     matrices[i] = Quaternion<double>
+	       (r1 * std::sin (t1), r1 * std::cos (t1),
+		r2 * std::sin (t2), r2 * std::cos (t2)).toRotationMatrix ();
+	   }
+	 benchmark::escape (matrices);
+       }, iterations) / n);
+  benchmark::report
+    ("rotations, randomRotations",
+     benchmark::measure ([&] {
+	 randomRotations (random, &soa[0], soa.size () / 9);
+	 benchmark::escape (soa);
+       }, iterations) / n);
+  benchmark::report
+    ("rotations, randomRotations (Matrix3x3)",
+     benchmark::measure ([&] {
+	 randomRotations (random, &matrices[0], matrices.size ());
+	 benchmark::escape (matrices);
+       }, iterations) / n);
+  return 0;
+}
@@ -0,0 +1,70 @@
+# Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+#
+# This file is part of jrl-mathtools.
+# jrl-mathtools is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# jrl-mathtools is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Lesser Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+# Run the benchmarks and write their timings to a JSON document.
+#
+# This script is run by the `benchmark' target with the following
+# variables:
+#
+# - BENCHMARKS: names of the benchmarks,
+# - DIRECTORY: directory of the `NAME-benchmark' binaries,
+# - OUTPUT: JSON file to write,
+# - VERSION, COMPILER, FLAGS, SYSTEM and HOST: description of the
+#   build and of the machine, copied to the document.
+#
+# Each benchmark appends one JSON object per timing to a temporary
+# file named by the JRL_MATHTOOLS_BENCHMARK_JSON environment variable
+# (see common.hh), which is then wrapped into the document.
+
+SET(RECORDS "${OUTPUT}.records")
+FILE(REMOVE "${RECORDS}")
+SET(ENV{JRL_MATHTOOLS_BENCHMARK_JSON} "${RECORDS}")
+
+FOREACH(NAME ${BENCHMARKS})
+  MESSAGE(STATUS "Running ${NAME}-benchmark")
+  SET(ENV{JRL_MATHTOOLS_BENCHMARK} "${NAME}")
+  EXECUTE_PROCESS(COMMAND "${DIRECTORY}/${NAME}-benchmark"
+    RESULT_VARIABLE RESULT)
+  IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "${NAME}-benchmark failed: ${RESULT}")
+  ENDIF(NOT RESULT EQUAL 0)
+ENDFOREACH(NAME)
+
+# One record per line: separate them with commas.
+FILE(READ "${RECORDS}" RESULTS)
+STRING(STRIP "${RESULTS}" RESULTS)
+STRING(REPLACE "\n" ",\n    " RESULTS "${RESULTS}")
+
+# Escape the description.
+FOREACH(VARIABLE VERSION COMPILER FLAGS SYSTEM HOST)
+  STRING(REPLACE "\\" "\\\\" ${VARIABLE} "${${VARIABLE}}")
+  STRING(REPLACE "\"" "\\\"" ${VARIABLE} "${${VARIABLE}}")
+  STRING(STRIP "${${VARIABLE}}" ${VARIABLE})
+ENDFOREACH(VARIABLE)
+
+FILE(WRITE "${OUTPUT}" "{
+  \"library\": \"jrl-mathtools\",
+  \"version\": \"${VERSION}\",
+  \"compiler\": \"${COMPILER}\",
+  \"flags\": \"${FLAGS}\",
+  \"system\": \"${SYSTEM}\",
+  \"host\": \"${HOST}\",
+  \"results\": [
+    ${RESULTS}
+  ]
+}
+")
+FILE(REMOVE "${RECORDS}")
+MESSAGE(STATUS "Benchmark results written to ${OUTPUT}")
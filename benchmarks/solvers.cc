@@ -0,0 +1,228 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// Compare the fixed-size factorizations with the cofactor inversion
+// of Matrix3x3 and Matrix4x4, and with the LAPACK-based pseudo-inverse
+// of matrixNxP for larger systems.
+
+#include <string>
+
+#include <jrl/mathtools/matrix3x3.hh>
+#include <jrl/mathtools/matrix4x4.hh>
+#include <jrl/mathtools/matrixnxp.hh>
+#include <jrl/mathtools/decompositions.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const unsigned iterations = 1000000;
+
+static void matrix3x3 ()
+{
+  Matrix3x3<double> A (4., 1., 2.,
+		       1., 5., 3.,
+		       2., 3., 6.);
+  Vector3D<double> b (1., 2., 3.);
+  Vector3D<double> x;
+  Matrix3x3<double> X;
+
+  benchmark::report
+    ("Matrix3x3 Inversion + product",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 Matrix3x3<double> Ainv;
+	 A.Inversion (Ainv);
+	 x.m_x = Ainv.m[0] * b.m_x + Ainv.m[1] * b.m_y + Ainv.m[2] * b.m_z;
+	 x.m_y = Ainv.m[3] * b.m_x + Ainv.m[4] * b.m_y + Ainv.m[5] * b.m_z;
+	 x.m_z = Ainv.m[6] * b.m_x + Ainv.m[7] * b.m_y + Ainv.m[8] * b.m_z;
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix3x3 luSolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.luSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix3x3 choleskySolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.choleskySolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix3x3 ldltSolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.ldltSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+
+  Matrix3x3<double> I;
+  I.setIdentity ();
+  benchmark::report
+    ("Matrix3x3 Inversion",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.Inversion (X);
+	 benchmark::escape (X);
+       }, iterations));
+  benchmark::report
+    ("Matrix3x3 luSolve (inverse)",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.luSolve (I, X);
+	 benchmark::escape (X);
+       }, iterations));
+}
+
+static void matrix4x4 ()
+{
+  Matrix4x4<double> A (5., 1., 2., 0.5,
+		       1., 6., 3., 1.,
+		       2., 3., 7., 2.,
+		       0.5, 1., 2., 8.);
+  Vector4D<double> b (1., 2., 3., 4.);
+  Vector4D<double> x;
+  Matrix4x4<double> X;
+
+  benchmark::report
+    ("Matrix4x4 Inversion + product",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 Matrix4x4<double> Ainv;
+	 A.Inversion (Ainv);
+	 Ainv.CeqthismulB (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix4x4 luSolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.luSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix4x4 choleskySolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.choleskySolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+  benchmark::report
+    ("Matrix4x4 ldltSolve",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.ldltSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations));
+
+  Matrix4x4<double> I;
+  I.setIdentity ();
+  benchmark::report
+    ("Matrix4x4 Inversion",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.Inversion (X);
+	 benchmark::escape (X);
+       }, iterations));
+  benchmark::report
+    ("Matrix4x4 luSolve (inverse)",
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.luSolve (I, X);
+	 benchmark::escape (X);
+       }, iterations));
+}
+
+template <unsigned N>
+static void matrixNxN ()
+{
+  const std::string prefix =
+    "MatrixRxC " + std::to_string (N) + "x" + std::to_string (N) + " ";
+
+  MatrixRxC<double, N, N> A;
+  for (unsigned i = 0; i < N; ++i)
+    for (unsigned j = 0; j < N; ++j)
+      A (i, j) = 1. / (1. + i + j) + (i == j ? N : 0.);
+  MatrixRxC<double, N, 1> b (1.);
+  MatrixRxC<double, N, 1> x;
+
+  benchmark::report
+    ((prefix + "Inversion + product").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 MatrixRxC<double, N, N> Ainv;
+	 A.Inversion (Ainv);
+	 Ainv.CeqthismulB (b, x);
+	 benchmark::escape (x);
+       }, iterations / N));
+  benchmark::report
+    ((prefix + "luSolve").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.luSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations / N));
+  benchmark::report
+    ((prefix + "choleskySolve").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.choleskySolve (b, x);
+	 benchmark::escape (x);
+       }, iterations / N));
+  benchmark::report
+    ((prefix + "ldltSolve").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (A);
+	 A.ldltSolve (b, x);
+	 benchmark::escape (x);
+       }, iterations / N));
+
+  // Factorize once, solve many times.
+  const LDLTDecomposition<double, N> ldlt (A);
+  benchmark::report
+    ((prefix + "LDLTDecomposition::solveInPlace").c_str (),
+     benchmark::measure ([&] {
+	 x = b;
+	 ldlt.solveInPlace (x);
+	 benchmark::escape (x);
+       }, iterations / N));
+
+  // Heap-allocated LAPACK path.
+  matrixNxP Anxp (N, N);
+  matrixNxP Ainv (N, N);
+  for (unsigned i = 0; i < N; ++i)
+    for (unsigned j = 0; j < N; ++j)
+      Anxp (i, j) = A (i, j);
+  benchmark::report
+    ((prefix + "matrixNxP pseudoInverse").c_str (),
+     benchmark::measure ([&] {
+	 benchmark::escape (Anxp);
+	 pseudoInverse (Anxp, Ainv);
+	 benchmark::escape (Ainv);
+       }, iterations / (100 * N)));
+}
+
+int main ()
+{
+  matrix3x3 ();
+  matrix4x4 ();
+  matrixNxN<6> ();
+  matrixNxN<12> ();
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+// Trajectory logging: cost of a commit from the real-time loop, and
+// scan of the z translation of a pose through the columns of a
+// TrajectoryLog against loading whole poses, and against a binary
+// file of Matrix4x4 records.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <jrl/mathtools/trajectorylog.hh>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static const std::size_t count = 200000;
+
+int main ()
+{
+  const char* path = "trajectory-log-benchmark.bin";
+  const char* records = "trajectory-log-benchmark.records";
+  TrajectoryLayout layout;
+  const std::size_t base = layout.addPose ("base");
+  for (int j = 0; j < 6; ++j)
+    layout.addAngle ("joint" + std::to_string (j));
+
+  Matrix4x4<double> pose;
+  for (unsigned int e = 0; e < 16; ++e)
+    pose.m[e] = std::sin (static_cast<double> (e));
+
+  const double n = static_cast<double> (count);
+  std::size_t dropped = 0;
+  {
+    TrajectoryLogWriter writer (path, layout, 1024, 1 << 18);
+    std::size_t i = 0;
+    benchmark::report
+      ("set and commit",
+       benchmark::measure ([&] {
+	   pose.m[11] = static_cast<double> (i);
+	   writer.set (base, pose);
+	   for (std::size_t j = 0; j < 6; ++j)
+	     writer.set (base + 1 + j, Angle (0.1 * static_cast<double> (j)));
+	   writer.commit (static_cast<double> (i++));
+	 }, count));
+    writer.close ();
+    dropped = writer.dropped ();
+  }
+  {
+    BinaryWriter<Matrix4x4<double> > writer (records);
+    for (std::size_t i = 0; i < count; ++i)
+      {
+	pose.m[11] = static_cast<double> (i);
+	writer.write (pose);
+      }
+  }
+
+  TrajectoryLog log (path);
+  const std::size_t z = layout.column (base) + 11;
+  double sum = 0.;
+  benchmark::report
+    ("z scan, TrajectoryLog::column",
+     benchmark::measure ([&] {
+	 for (std::size_t k = 0; k < log.chunks (); ++k)
+	   {
+	     const double* column = log.column (k, z);
+	     const std::size_t size =
+	       std::min (log.chunkSize (), log.size () - k * log.chunkSize ());
+	     for (std::size_t i = 0; i < size; ++i)
+	       sum += column[i];
+	   }
+	 benchmark::escape (sum);
+       }, 10) / static_cast<double> (log.size ()));
+  benchmark::report
+    ("z scan, TrajectoryLog::pose",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < log.size (); ++i)
+	   sum += log.pose (base, i).m[11];
+	 benchmark::escape (sum);
+       }, 10) / static_cast<double> (log.size ()));
+  MappedArray<Matrix4x4<double> > mapped (records);
+  benchmark::report
+    ("z scan, MappedArray<Matrix4x4>",
+     benchmark::measure ([&] {
+	 for (std::size_t i = 0; i < mapped.size (); ++i)
+	   sum += mapped[i].m[11];
+	 benchmark::escape (sum);
+       }, 10) / n);
+  benchmark::report
+    ("find by time",
+     benchmark::measure ([&] {
+	 std::size_t found = 0;
+	 for (std::size_t i = 0; i < 1000; ++i)
+	   found += log.find (static_cast<double> (i * 197 % count) + 0.5);
+	 benchmark::escape (found);
+       }, 100) / 1000.);
+  std::printf ("%lu samples dropped\n", static_cast<unsigned long> (dropped));
+
+  std::remove (path);
+  std::remove (records);
+  return 0;
+}
@@ -23,12 +23,25 @@
 
 # include <jrl/mathtools/vector3.hh>
 # include <jrl/mathtools/vector4.hh>
+# include <jrl/mathtools/quaternion.hh>
 # include <jrl/mathtools/vectorn.hh>
 
 # include <jrl/mathtools/matrix3x3.hh>
 # include <jrl/mathtools/matrix4x4.hh>
+# include <jrl/mathtools/matrixrxc.hh>
 # include <jrl/mathtools/matrixnxp.hh>
+# include <jrl/mathtools/decompositions.hh>
+# include <jrl/mathtools/decompositions3x3.hh>
+# include <jrl/mathtools/pointcloud.hh>
+# include <jrl/mathtools/kinematicchain.hh>
+# include <jrl/mathtools/frametree.hh>
+# include <jrl/mathtools/liegroups.hh>
+# include <jrl/mathtools/distances.hh>
+# include <jrl/mathtools/nearestneighbors.hh>
+# include <jrl/mathtools/random.hh>
+# include <jrl/mathtools/quantization.hh>
 
+# include <jrl/mathtools/format.hh>
 # include <jrl/mathtools/io.hh>
 
 #endif //! JRL_MATHTOOLS_HH
@@ -22,6 +22,7 @@
 
 # include <jrl/mathtools/constants.hh>
 # include <jrl/mathtools/deprecated.hh>
+# include <jrl/mathtools/trigonometry.hh>
 
 namespace jrlMathTools
 {
@@ -203,13 +204,11 @@ namespace jrlMathTools
     /// @}
   protected:
 
-    /// \brief Set angle between -PI and PI.
+    /// \brief Set angle between -PI and PI, in constant time.
     void setBetweenMinusAndPlusPI ()
     {
-      while (angle_ < -M_PI)
-	angle_ += 2. * M_PI;
-      while (angle_ > M_PI)
-	angle_ -= 2. * M_PI;
+      angle_ = detail::Trigonometry<double, detail::ScalarOps<double> >::wrap
+	(angle_);
     }
 
     /// \brief Update angle value.
@@ -223,6 +222,133 @@ namespace jrlMathTools
     double angle_;
   };
 
+  /// \brief Planar rotation stored as the unit complex number
+  /// cos (angle) + i sin (angle).
+  ///
+  /// The cosine and sine are computed together once, when converting
+  /// from an Angle, and kept. Rotations are composed by complex
+  /// multiplication, without any trigonometric function, which makes
+  /// this class the representation of choice for angles used over and
+  /// over, e.g. the orientations of SE(2) configurations.
+  class UnitComplex
+  {
+  public:
+    /// \brief Default constructor: the null rotation.
+    UnitComplex ()
+      : cos_ (1.),
+	sin_ (0.)
+    {}
+
+    /// \brief Constructor from an angle.
+    explicit UnitComplex (const Angle& angle)
+      : cos_ (std::cos (angle.value ())),
+	sin_ (std::sin (angle.value ()))
+    {}
+
+    /// \brief Constructor from the cosine and the sine, which are
+    /// expected to be those of the same angle.
+    UnitComplex (const double& cos, const double& sin)
+      : cos_ (cos),
+	sin_ (sin)
+    {}
+
+    /// \brief Cosine of the angle.
+    const double& cos () const
+    {
+      return cos_;
+    }
+
+    /// \brief Sine of the angle.
+    const double& sin () const
+    {
+      return sin_;
+    }
+
+    /// \brief Tangent of the angle.
+    double tan () const
+    {
+      return sin_ / cos_;
+    }
+
+    /// \brief Angle, in [-PI, PI].
+    Angle angle () const
+    {
+      return Angle (std::atan2 (sin_, cos_));
+    }
+
+    /// \brief Composition: the sum of the angles.
+    UnitComplex operator* (const UnitComplex& rhs) const
+    {
+      return UnitComplex (cos_ * rhs.cos_ - sin_ * rhs.sin_,
+			  sin_ * rhs.cos_ + cos_ * rhs.sin_);
+    }
+
+    UnitComplex& operator*= (const UnitComplex& rhs)
+    {
+      *this = *this * rhs;
+      return *this;
+    }
+
+    /// \brief Difference of the angles.
+    UnitComplex operator/ (const UnitComplex& rhs) const
+    {
+      return *this * rhs.inverse ();
+    }
+
+    UnitComplex& operator/= (const UnitComplex& rhs)
+    {
+      *this = *this / rhs;
+      return *this;
+    }
+
+    /// \brief Opposite angle.
+    UnitComplex inverse () const
+    {
+      return UnitComplex (cos_, -sin_);
+    }
+
+    /// \brief Rotate the point (x, y).
+    void rotate (double& x, double& y) const
+    {
+      const double rx = cos_ * x - sin_ * y;
+      y = sin_ * x + cos_ * y;
+      x = rx;
+    }
+
+    /// \brief Scale back to unit modulus, to remove the rounding
+    /// errors accumulated by long sequences of compositions.
+    void normalize ()
+    {
+      const double n = std::sqrt (cos_ * cos_ + sin_ * sin_);
+      cos_ /= n;
+      sin_ /= n;
+    }
+
+    /// \brief Distance on unit circle, as Angle::distance.
+    double distance (const UnitComplex& other) const
+    {
+      const UnitComplex diff = *this / other;
+      return std::fabs (std::atan2 (diff.sin_, diff.cos_));
+    }
+
+    /// \brief output to a stream.
+    std::ostream& display (std::ostream& os) const
+    {
+      os << "(" << cos_ << ", " << sin_ << ")";
+      return os;
+    }
+
+  private:
+    double cos_;
+    double sin_;
+  };
+
+  inline std::ostream& operator<< (std::ostream& os,
+				   const UnitComplex& rotation)
+  {
+    return rotation.display (os);
+  }
+
   template <typename T>
   Angle operator* (const T& coef, const Angle& angle)
   {
@@ -244,6 +370,21 @@ namespace jrlMathTools
     return std::tan (angle.value ());
   }
 
+  inline double cos (const UnitComplex& rotation)
+  {
+    return rotation.cos ();
+  }
+
+  inline double sin (const UnitComplex& rotation)
+  {
+    return rotation.sin ();
+  }
+
+  inline double tan (const UnitComplex& rotation)
+  {
+    return rotation.tan ();
+  }
+
   inline std::ostream& display (std::ostream& os, const Angle& angle)
   {
     return angle.display (os);
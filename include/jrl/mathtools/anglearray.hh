@@ -0,0 +1,355 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_ANGLEARRAY_HH
+# define JRL_MATHTOOLS_ANGLEARRAY_HH
+# include <cstddef>
+# include <stdexcept>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/angle.hh>
+
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Element-wise operations on angles, written once against
+    /// the ScalarOps / Simd4 interface. They all follow the shortest
+    /// arc, as Angle does.
+    struct AngleSum
+    {
+      template <typename V>
+      typename V::type apply (typename V::type a, typename V::type b) const
+      {
+	return Trigonometry<double, V>::wrap (V::add (a, b));
+      }
+    };
+
+    struct AngleDifference
+    {
+      template <typename V>
+      typename V::type apply (typename V::type a, typename V::type b) const
+      {
+	return Trigonometry<double, V>::wrap (V::sub (a, b));
+      }
+    };
+
+    struct AngleDistance
+    {
+      template <typename V>
+      typename V::type apply (typename V::type a, typename V::type b) const
+      {
+	const typename V::type d =
+	  Trigonometry<double, V>::wrap (V::sub (a, b));
+	return V::select (V::lt (d, V::set1 (0.)), V::neg (d), d);
+      }
+    };
+
+    struct AngleInterpolation
+    {
+      explicit AngleInterpolation (const double& alpha)
+	: alpha_ (alpha)
+      {}
+
+      template <typename V>
+      typename V::type apply (typename V::type a, typename V::type b) const
+      {
+	typedef Trigonometry<double, V> trigonometry_t;
+	const typename V::type d = trigonometry_t::wrap (V::sub (b, a));
+	return trigonometry_t::wrap (V::fma (V::set1 (alpha_), d, a));
+      }
+
+    private:
+      double alpha_;
+    };
+
+    /// \brief out[i] = f (a[i], b[i]), four angles at a time when
+    /// Simd4 is available. out may be a or b.
+    template <typename F>
+    void transformAngles (const double* a, const double* b, double* out,
+			  std::size_t n, const F& f)
+    {
+      std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+      typedef Simd4<double> V;
+      for (; i + 4 <= n; i += 4)
+	V::store (out + i,
+		  f.template apply<V> (V::load (a + i), V::load (b + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	out[i] = f.template apply<ScalarOps<double> > (a[i], b[i]);
+    }
+
+    /// \brief s[i] = sin (x[i]) and c[i] = cos (x[i]) for x[i] in
+    /// [-PI, PI], four angles at a time when Simd4 is available.
+    template <TrigonometryPrecision P>
+    void sinCosWrapped (const double* x, double* s, double* c,
+			std::size_t n)
+    {
+      std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+      typedef Simd4<double> V;
+      for (; i + 4 <= n; i += 4)
+	{
+	  V::type si, ci;
+	  WrappedSinCos<double, V, P>::run (V::load (x + i), si, ci);
+	  V::store (s + i, si);
+	  V::store (c + i, ci);
+	}
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	WrappedSinCos<double, ScalarOps<double>, P>::run (x[i], s[i], c[i]);
+    }
+
+    /// \brief t[i] = tan (x[i]) for x[i] in [-PI, PI].
+    template <TrigonometryPrecision P>
+    void tanWrapped (const double* x, double* t, std::size_t n)
+    {
+      std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+      typedef Simd4<double> V;
+      for (; i + 4 <= n; i += 4)
+	{
+	  V::type si, ci;
+	  WrappedSinCos<double, V, P>::run (V::load (x + i), si, ci);
+	  V::store (t + i, V::div (si, ci));
+	}
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	{
+	  double si, ci;
+	  WrappedSinCos<double, ScalarOps<double>, P>::run (x[i], si, ci);
+	  t[i] = si / ci;
+	}
+    }
+  } // end of namespace detail.
+
+  /// \brief Sines and cosines of n angles in [-PI, PI], such as the
+  /// values of Angle or AngleArray.
+  ///
+  /// The angles are not reduced, so that the kernels are a handful of
+  /// polynomial evaluations. Values outside [-PI, PI] give wrong
+  /// results: wrap them first with wrapAngles.
+  inline void
+  sinCosAngles (const double* angles, double* s, double* c, std::size_t n,
+		TrigonometryPrecision precision = FULL_PRECISION)
+  {
+    switch (precision)
+      {
+      case MEDIUM_PRECISION:
+	detail::sinCosWrapped<MEDIUM_PRECISION> (angles, s, c, n);
+	break;
+      case LOW_PRECISION:
+	detail::sinCosWrapped<LOW_PRECISION> (angles, s, c, n);
+	break;
+      default:
+	detail::sinCosWrapped<FULL_PRECISION> (angles, s, c, n);
+      }
+  }
+
+  /// \brief Tangents of n angles in [-PI, PI], see sinCosAngles.
+  ///
+  /// The precision is relative to the cosine, so that it degrades
+  /// close to +/- PI / 2.
+  inline void
+  tanAngles (const double* angles, double* t, std::size_t n,
+	     TrigonometryPrecision precision = FULL_PRECISION)
+  {
+    switch (precision)
+      {
+      case MEDIUM_PRECISION:
+	detail::tanWrapped<MEDIUM_PRECISION> (angles, t, n);
+	break;
+      case LOW_PRECISION:
+	detail::tanWrapped<LOW_PRECISION> (angles, t, n);
+	break;
+      default:
+	detail::tanWrapped<FULL_PRECISION> (angles, t, n);
+      }
+  }
+
+  /// \brief Wrap n angles into [-PI, PI], as Angle does. out may be
+  /// in.
+  inline void wrapAngles (const double* in, double* out, std::size_t n)
+  {
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    for (; i + 4 <= n; i += 4)
+      V::store (out + i, detail::Trigonometry<double, V>::wrap
+		(V::load (in + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      out[i] = detail::Trigonometry<double, detail::ScalarOps<double> >::wrap
+	(in[i]);
+  }
+
+  /// \brief Array of angles, e.g. the joint angles of a robot.
+  ///
+  /// Values are kept in [-PI, PI] and the operations follow the same
+  /// rules as Angle, but apply to the whole array at once with
+  /// vector instructions.
+  class AngleArray
+  {
+  public:
+    AngleArray ()
+      : values_ ()
+    {}
+
+    /// \brief Array of n null angles.
+    explicit AngleArray (std::size_t n)
+      : values_ (n, 0.)
+    {}
+
+    /// \brief Constructor from n values, which are wrapped.
+    AngleArray (const double* values, std::size_t n)
+      : values_ (n)
+    {
+      assign (values, n);
+    }
+
+    /// \brief Replace the content by n values, which are wrapped.
+    void assign (const double* values, std::size_t n)
+    {
+      values_.resize (n);
+      if (n)
+	wrapAngles (values, &values_[0], n);
+    }
+
+    std::size_t size () const
+    {
+      return values_.size ();
+    }
+
+    /// \brief Wrapped values.
+    const double* data () const
+    {
+      return values_.empty () ? 0 : &values_[0];
+    }
+
+    /// \brief i-th angle.
+    Angle operator[] (std::size_t i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return Angle (values_[i]);
+    }
+
+    /// \brief Set the i-th angle.
+    void set (std::size_t i, const Angle& angle)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      values_[i] = angle.value ();
+    }
+
+    /// Arithmetic operators overload, on arrays of the same size.
+    /// They throw std::invalid_argument if the sizes differ.
+    /// \{
+    AngleArray& operator+= (const AngleArray& rhs)
+    {
+      return apply (rhs, detail::AngleSum ());
+    }
+
+    AngleArray& operator-= (const AngleArray& rhs)
+    {
+      return apply (rhs, detail::AngleDifference ());
+    }
+
+    AngleArray operator+ (const AngleArray& rhs) const
+    {
+      AngleArray result (*this);
+      return result += rhs;
+    }
+
+    AngleArray operator- (const AngleArray& rhs) const
+    {
+      AngleArray result (*this);
+      return result -= rhs;
+    }
+    /// \}
+
+    /// \brief Interpolation along the shortest arcs, as
+    /// Angle::interpolate.
+    ///
+    /// \throw std::invalid_argument if the sizes differ.
+    AngleArray interpolate (const double& alpha,
+			    const AngleArray& other) const
+    {
+      AngleArray result (*this);
+      return result.apply (other, detail::AngleInterpolation (alpha));
+    }
+
+    /// \brief Distances on unit circle, as Angle::distance, stored in
+    /// out which must hold size () values.
+    ///
+    /// \throw std::invalid_argument if the sizes differ.
+    void distance (const AngleArray& other, double* out) const
+    {
+      checkSize (other);
+      if (! values_.empty ())
+	detail::transformAngles (&values_[0], &other.values_[0], out,
+				 size (), detail::AngleDistance ());
+    }
+
+    /// \brief Sines and cosines, stored in s and c which must hold
+    /// size () values. See sinCosAngles.
+    void sinCos (double* s, double* c,
+		 TrigonometryPrecision precision = FULL_PRECISION) const
+    {
+      if (! values_.empty ())
+	sinCosAngles (&values_[0], s, c, size (), precision);
+    }
+
+    /// \brief Tangents, stored in t which must hold size () values.
+    /// See tanAngles.
+    void tan (double* t,
+	      TrigonometryPrecision precision = FULL_PRECISION) const
+    {
+      if (! values_.empty ())
+	tanAngles (&values_[0], t, size (), precision);
+    }
+
+  private:
+    /// \brief Throw unless other has as many angles.
+    ///
+    /// Unlike index checks, this is kept in release builds: a size
+    /// mismatch would read past the end of the shorter array.
+    void checkSize (const AngleArray& other) const
+    {
+      if (other.size () != size ())
+	throw std::invalid_argument ("angle array size mismatch");
+    }
+
+    template <typename F>
+    AngleArray& apply (const AngleArray& rhs, const F& f)
+    {
+      checkSize (rhs);
+      if (! values_.empty ())
+	detail::transformAngles (&values_[0], &rhs.values_[0], &values_[0],
+				 size (), f);
+      return *this;
+    }
+
+    std::vector<double> values_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_ANGLEARRAY_HH
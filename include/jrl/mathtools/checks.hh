@@ -0,0 +1,58 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_CHECKS_HH
+# define JRL_MATHTOOLS_CHECKS_HH
+# include <stdexcept>
+
+// Index checking policy of the fixed-size types.
+//
+// By default, element accessors check their index and throw a
+// std::logic_error when it is out of range, unless NDEBUG is defined.
+// Unchecked accessors are noexcept and branch-free, which is what
+// real-time and vectorized code needs.
+//
+// The default can be overridden by defining either
+// JRL_MATHTOOLS_ENABLE_BOUNDS_CHECK or JRL_MATHTOOLS_DISABLE_BOUNDS_CHECK
+// before including any jrl-mathtools header. The chosen policy must be
+// the same in every translation unit of a program.
+# if defined JRL_MATHTOOLS_ENABLE_BOUNDS_CHECK \
+  && defined JRL_MATHTOOLS_DISABLE_BOUNDS_CHECK
+#  error "bounds checking cannot be both enabled and disabled"
+# endif
+
+# ifndef JRL_MATHTOOLS_BOUNDS_CHECK
+#  if defined JRL_MATHTOOLS_ENABLE_BOUNDS_CHECK
+#   define JRL_MATHTOOLS_BOUNDS_CHECK 1
+#  elif defined JRL_MATHTOOLS_DISABLE_BOUNDS_CHECK || defined NDEBUG
+#   define JRL_MATHTOOLS_BOUNDS_CHECK 0
+#  else
+#   define JRL_MATHTOOLS_BOUNDS_CHECK 1
+#  endif
+# endif //! JRL_MATHTOOLS_BOUNDS_CHECK
+
+# if JRL_MATHTOOLS_BOUNDS_CHECK
+#  define JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+#  define JRL_MATHTOOLS_CHECK_INDEX(COND)			\
+  do {								\
+    if (!(COND))						\
+      throw std::logic_error ("bad index");			\
+  } while (0)
+# else
+#  define JRL_MATHTOOLS_ACCESSOR_NOEXCEPT noexcept
+#  define JRL_MATHTOOLS_CHECK_INDEX(COND) do {} while (0)
+# endif //! JRL_MATHTOOLS_BOUNDS_CHECK
+
+#endif //! JRL_MATHTOOLS_CHECKS_HH
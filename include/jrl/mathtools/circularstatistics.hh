@@ -0,0 +1,288 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef JRL_MATHTOOLS_CIRCULARSTATISTICS_HH
+# define JRL_MATHTOOLS_CIRCULARSTATISTICS_HH
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+# include <stdexcept>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+
+# include <jrl/mathtools/angle.hh>
+# include <jrl/mathtools/anglearray.hh>
+
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Number of turns to add to current to get the closest
+    /// to previous, i.e. round ((previous - current) / 2 pi).
+    template <typename V>
+    typename V::type turnJump (typename V::type previous,
+			       typename V::type current)
+    {
+      return V::floor (V::fma (V::sub (previous, current),
+			       V::set1 (1. / (2. * M_PI)), V::set1 (.5)));
+    }
+  } // end of namespace detail.
+
+  /// \brief Streaming unwrapping of angle signals.
+  ///
+  /// Successive chunks of angles, e.g. logged joint positions or
+  /// headings in [-PI, PI], are mapped to a continuous signal by
+  /// adding multiples of 2 PI, so that consecutive samples never
+  /// differ by more than PI. The state carried between chunks is the
+  /// last sample and the number of turns, which is an integer: unlike
+  /// a running sum of the differences, the output does not drift.
+  class AngleUnwrapper
+  {
+  public:
+    AngleUnwrapper ()
+      : last_ (0.),
+	turns_ (0.),
+	started_ (false)
+    {}
+
+    /// \brief Start a new signal.
+    void reset ()
+    {
+      last_ = 0.;
+      turns_ = 0.;
+      started_ = false;
+    }
+
+    /// \brief Number of turns added to the last sample.
+    double turns () const
+    {
+      return turns_;
+    }
+
+    /// \brief Unwrap the next n samples of the signal into out, which
+    /// must not overlap angles.
+    ///
+    /// The jumps between samples and the final values are computed
+    /// four at a time when Simd4 is available, only the running count
+    /// of turns is sequential.
+    void unwrap (const double* angles, double* out, std::size_t n)
+    {
+      if (! n)
+	return;
+      if (! started_)
+	{
+	  last_ = angles[0];
+	  started_ = true;
+	}
+
+      typedef detail::ScalarOps<double> S;
+      out[0] = detail::turnJump<S> (last_, angles[0]);
+      std::size_t i = 1;
+# if JRL_MATHTOOLS_HAS_AVX2
+      typedef detail::Simd4<double> V;
+      for (; i + 4 <= n; i += 4)
+	V::store (out + i, detail::turnJump<V> (V::load (angles + i - 1),
+						V::load (angles + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	out[i] = detail::turnJump<S> (angles[i - 1], angles[i]);
+
+      for (i = 0; i < n; ++i)
+	{
+	  turns_ += out[i];
+	  out[i] = turns_;
+	}
+      last_ = angles[n - 1];
+
+      const double twoPi = 2. * M_PI;
+      i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+      for (; i + 4 <= n; i += 4)
+	V::store (out + i, V::fma (V::load (out + i), V::set1 (twoPi),
+				   V::load (angles + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	out[i] = S::fma (out[i], twoPi, angles[i]);
+    }
+
+  private:
+    double last_;
+    double turns_;
+    bool started_;
+  };
+
+  /// \brief Circular statistics over a sliding window of angles.
+  ///
+  /// The accumulator keeps the cosines and sines of the last window ()
+  /// samples in a ring buffer, together with their sums. Each sample
+  /// costs O(1): its cosine and sine, computed for whole chunks by
+  /// sinCosAngles, are added to the sums and those of the sample
+  /// leaving the window are subtracted. The sums are recomputed from
+  /// the buffer once per window to get rid of the rounding errors, which
+  /// keeps the amortized cost constant. No memory is allocated after
+  /// construction.
+  class CircularStatistics
+  {
+  public:
+    /// \brief Accumulator over the last window samples.
+    explicit CircularStatistics (std::size_t window)
+      : cos_ (window),
+	sin_ (window),
+	newCos_ (window),
+	newSin_ (window),
+	head_ (0),
+	size_ (0),
+	updates_ (0),
+	sumCos_ (0.),
+	sumSin_ (0.)
+    {
+      if (! window)
+	throw std::invalid_argument ("empty window");
+    }
+
+    /// \brief Maximum number of samples.
+    std::size_t window () const
+    {
+      return cos_.size ();
+    }
+
+    /// \brief Number of samples in the window.
+    std::size_t size () const
+    {
+      return size_;
+    }
+
+    /// \brief Remove all samples.
+    void clear ()
+    {
+      head_ = 0;
+      size_ = 0;
+      updates_ = 0;
+      sumCos_ = 0.;
+      sumSin_ = 0.;
+    }
+
+    /// \brief Add one sample.
+    void push (const Angle& angle)
+    {
+      push (&angle.value (), 1);
+    }
+
+    /// \brief Add n samples in [-PI, PI].
+    ///
+    /// If means and variances are not null, they receive the mean and
+    /// the circular variance of the window after each sample.
+    void push (const double* angles, std::size_t n, double* means = 0,
+	       double* variances = 0)
+    {
+      while (n)
+	{
+	  const std::size_t m = std::min (n, window () - head_);
+	  sinCosAngles (angles, &newSin_[0], &newCos_[0], m);
+	  for (std::size_t j = 0; j < m; ++j)
+	    {
+	      double& c = cos_[head_ + j];
+	      double& s = sin_[head_ + j];
+	      if (size_ == window ())
+		{
+		  sumCos_ -= c;
+		  sumSin_ -= s;
+		}
+	      else
+		++size_;
+	      c = newCos_[j];
+	      s = newSin_[j];
+	      sumCos_ += c;
+	      sumSin_ += s;
+	      if (means)
+		means[j] = mean ().value ();
+	      if (variances)
+		variances[j] = variance ();
+	    }
+
+	  head_ = (head_ + m) % window ();
+	  updates_ += m;
+	  if (updates_ >= window ())
+	    refresh ();
+	  angles += m;
+	  means = means ? means + m : 0;
+	  variances = variances ? variances + m : 0;
+	  n -= m;
+	}
+    }
+
+    /// \brief Circular mean, null for an empty window.
+    Angle mean () const
+    {
+      return Angle (std::atan2 (sumSin_, sumCos_));
+    }
+
+    /// \brief Mean resultant length, in [0, 1]: 1 when all the
+    /// samples are equal, close to 0 when they are spread uniformly.
+    double resultantLength () const
+    {
+      if (! size_)
+	return 0.;
+      const double r = std::sqrt (sumCos_ * sumCos_ + sumSin_ * sumSin_)
+	/ static_cast<double> (size_);
+      return r < 1. ? r : 1.;
+    }
+
+    /// \brief Circular variance, 1 - resultantLength (), in [0, 1].
+    double variance () const
+    {
+      return 1. - resultantLength ();
+    }
+
+    /// \brief Circular standard deviation, sqrt (-2 log R), in
+    /// radian. It matches the usual one for concentrated samples and
+    /// is infinite when R is null.
+    double standardDeviation () const
+    {
+      return std::sqrt (-2. * std::log (resultantLength ()));
+    }
+
+  private:
+    /// \brief Recompute the sums from the buffer, whose first size_
+    /// elements are the samples.
+    void refresh ()
+    {
+      sumCos_ = 0.;
+      sumSin_ = 0.;
+      for (std::size_t i = 0; i < size_; ++i)
+	{
+	  sumCos_ += cos_[i];
+	  sumSin_ += sin_[i];
+	}
+      updates_ = 0;
+    }
+
+    std::vector<double> cos_;
+    std::vector<double> sin_;
+    std::vector<double> newCos_;
+    std::vector<double> newSin_;
+    std::size_t head_;
+    std::size_t size_;
+    std::size_t updates_;
+    double sumCos_;
+    double sumSin_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_CIRCULARSTATISTICS_HH
@@ -0,0 +1,213 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_DECOMPOSITIONS_HH
+# define JRL_MATHTOOLS_DECOMPOSITIONS_HH
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/matrixrxc.hh>
+# include <jrl/mathtools/solvers.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Reusable LU decomposition of a NxN matrix.
+  template <typename T, unsigned int N>
+  class LUDecomposition
+  {
+  public:
+    LUDecomposition ()
+      : lu_ (), p_ (), ok_ (false)
+    {}
+
+    explicit LUDecomposition (const MatrixRxC<T, N, N>& A)
+      : lu_ (), p_ (), ok_ (false)
+    {
+      compute (A);
+    }
+
+    /// \brief Factorize A, return false if it is singular.
+    bool compute (const MatrixRxC<T, N, N>& A)
+    {
+      lu_ = A;
+      ok_ = luFactorize<N> (lu_.m, p_);
+      return ok_;
+    }
+
+    /// \brief Whether the last factorization succeeded.
+    bool ok () const
+    {
+      return ok_;
+    }
+
+    /// \brief Packed L and U factors.
+    const MatrixRxC<T, N, N>& matrixLU () const
+    {
+      return lu_;
+    }
+
+    /// \brief Replace B by the solution of A X = B.
+    ///
+    /// The last factorization must have succeeded, see ok ().
+    template <unsigned int K>
+    void solveInPlace (MatrixRxC<T, N, K>& B) const
+    {
+      luSolveInPlace<N, K> (lu_.m, p_, B.m);
+    }
+
+    /// \brief Solution of A X = B, if ok ().
+    template <unsigned int K>
+    MatrixRxC<T, N, K> solve (const MatrixRxC<T, N, K>& B) const
+    {
+      MatrixRxC<T, N, K> X (B);
+      solveInPlace (X);
+      return X;
+    }
+
+    /// \brief Determinant of A, zero if it is singular.
+    T determinant () const
+    {
+      // A singular factorization stops early, leaving the last pivots
+      // unwritten.
+      if (!ok_)
+	return T ();
+      T det = 1;
+      for (unsigned int i = 0; i < N; ++i)
+	det *= (p_[i] == i) ? lu_.m[N * i + i] : -lu_.m[N * i + i];
+      return det;
+    }
+
+  private:
+    MatrixRxC<T, N, N> lu_;
+    unsigned int p_[N];
+    bool ok_;
+  };
+
+  /// \brief Reusable Cholesky decomposition of a symmetric positive
+  /// definite NxN matrix.
+  template <typename T, unsigned int N>
+  class CholeskyDecomposition
+  {
+  public:
+    CholeskyDecomposition ()
+      : l_ (), ok_ (false)
+    {}
+
+    explicit CholeskyDecomposition (const MatrixRxC<T, N, N>& A)
+      : l_ (), ok_ (false)
+    {
+      compute (A);
+    }
+
+    /// \brief Factorize A, return false if it is not positive definite.
+    bool compute (const MatrixRxC<T, N, N>& A)
+    {
+      l_ = A;
+      ok_ = choleskyFactorize<N> (l_.m);
+      return ok_;
+    }
+
+    /// \brief Whether the last factorization succeeded.
+    bool ok () const
+    {
+      return ok_;
+    }
+
+    /// \brief Replace B by the solution of A X = B.
+    ///
+    /// The last factorization must have succeeded, see ok ().
+    template <unsigned int K>
+    void solveInPlace (MatrixRxC<T, N, K>& B) const
+    {
+      choleskySolveInPlace<N, K> (l_.m, B.m);
+    }
+
+    /// \brief Solution of A X = B, if ok ().
+    template <unsigned int K>
+    MatrixRxC<T, N, K> solve (const MatrixRxC<T, N, K>& B) const
+    {
+      MatrixRxC<T, N, K> X (B);
+      solveInPlace (X);
+      return X;
+    }
+
+  private:
+    MatrixRxC<T, N, N> l_;
+    bool ok_;
+  };
+
+  /// \brief Reusable LDL^T decomposition of a symmetric NxN matrix.
+  template <typename T, unsigned int N>
+  class LDLTDecomposition
+  {
+  public:
+    LDLTDecomposition ()
+      : ld_ (), ok_ (false)
+    {}
+
+    explicit LDLTDecomposition (const MatrixRxC<T, N, N>& A)
+      : ld_ (), ok_ (false)
+    {
+      compute (A);
+    }
+
+    /// \brief Factorize A, return false if a pivot vanishes.
+    bool compute (const MatrixRxC<T, N, N>& A)
+    {
+      ld_ = A;
+      ok_ = ldltFactorize<N> (ld_.m);
+      return ok_;
+    }
+
+    /// \brief Whether the last factorization succeeded.
+    bool ok () const
+    {
+      return ok_;
+    }
+
+    /// \brief Replace B by the solution of A X = B.
+    ///
+    /// The last factorization must have succeeded, see ok ().
+    template <unsigned int K>
+    void solveInPlace (MatrixRxC<T, N, K>& B) const
+    {
+      ldltSolveInPlace<N, K> (ld_.m, B.m);
+    }
+
+    /// \brief Solution of A X = B, if ok ().
+    template <unsigned int K>
+    MatrixRxC<T, N, K> solve (const MatrixRxC<T, N, K>& B) const
+    {
+      MatrixRxC<T, N, K> X (B);
+      solveInPlace (X);
+      return X;
+    }
+
+    /// \brief Determinant of A.
+    T determinant () const
+    {
+      T det = 1;
+      for (unsigned int i = 0; i < N; ++i)
+	det *= ld_.m[N * i + i];
+      return det;
+    }
+
+  private:
+    MatrixRxC<T, N, N> ld_;
+    bool ok_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_DECOMPOSITIONS_HH
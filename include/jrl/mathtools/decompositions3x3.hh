@@ -0,0 +1,644 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_DECOMPOSITIONS3X3_HH
+# define JRL_MATHTOOLS_DECOMPOSITIONS3X3_HH
+# include <cmath>
+# include <cstddef>
+# include <limits>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/matrix3x3.hh>
+
+// Allocation-free decompositions specialized for 3x3 matrices.
+//
+// The symmetric eigen-decomposition uses the cyclic Jacobi method:
+// each rotation cancels one off-diagonal coefficient, and the product
+// of the rotations is accumulated as a quaternion, which is cheaper
+// than a matrix and stays orthonormal. The kernels are written once
+// against the ScalarOps / Simd4 interface, so that batches stored as
+// coefficient arrays are decomposed four matrices at a time.
+//
+// The singular value decomposition follows McAdams et al., "Computing
+// the Singular Value Decomposition of 3x3 matrices with minimal
+// branching and elementary floating point operations" (2011): V
+// diagonalizes A^T A, the columns of A V are sorted by decreasing
+// norm, and a QR decomposition by Givens rotations, accumulated as a
+// quaternion too, gives U.
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief q = q * (sh e_r, ch), where (sh e_r, ch) is the
+    /// quaternion of a rotation about the axis r, all quaternions being
+    /// stored as (x, y, z, w).
+    template <typename T, typename V, unsigned int r>
+    void composeAxisRotation (typename V::type* q, typename V::type sh,
+			      typename V::type ch)
+    {
+      typedef typename V::type v_t;
+      const unsigned int p = (r + 1) % 3;
+      const unsigned int k = (r + 2) % 3;
+      const v_t qr = q[r];
+      const v_t qp = q[p];
+      const v_t qk = q[k];
+      const v_t qw = q[3];
+      q[r] = V::fma (qw, sh, V::mul (qr, ch));
+      q[p] = V::fma (qk, sh, V::mul (qp, ch));
+      q[k] = V::sub (V::mul (qk, ch), V::mul (qp, sh));
+      q[3] = V::sub (V::mul (qw, ch), V::mul (qr, sh));
+    }
+
+    /// \brief Jacobi eigen-decomposition kernels.
+    template <typename T, typename V>
+    struct SymmetricEigen3x3
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+
+      /// \brief Upper bound on the number of sweeps, convergence is
+      /// quadratic and usually reached after four or five.
+      static const unsigned int maxSweeps = 8;
+
+      /// \brief Cancel the coefficient (p, k), r being the third
+      /// index, with (r, p, k) a cyclic permutation of (0, 1, 2).
+      ///
+      /// d holds the diagonal and o the off-diagonal coefficients,
+      /// o[k] being the one whose row and column differ from k. The
+      /// rotation, about axis r, is accumulated into the quaternion
+      /// q stored as (x, y, z, w).
+      template <unsigned int r>
+      static void rotate (v_t* d, v_t* o, v_t* q)
+      {
+	const unsigned int p = (r + 1) % 3;
+	const unsigned int k = (r + 2) % 3;
+	const v_t zero = V::set1 (T ());
+	const v_t one = V::set1 (T (1));
+
+	// t = tan (theta) is the smallest root of
+	// t^2 + t (d[k] - d[p]) / o[r] - 1 = 0.
+	const v_t diff = V::sub (d[k], d[p]);
+	const m_t negative = V::lt (diff, zero);
+	const v_t absDiff = V::select (negative, V::neg (diff), diff);
+	const v_t twice = V::add (o[r], o[r]);
+	const v_t den =
+	  V::add (absDiff, V::sqrt (V::fma (diff, diff,
+					    V::mul (twice, twice))));
+	const v_t num = V::select (negative, V::neg (twice), twice);
+	const v_t t =
+	  V::select (V::lt (zero, den), V::div (num, den), zero);
+
+	const v_t root = V::sqrt (V::fma (t, t, one));
+	const v_t c = V::div (one, root);
+	const v_t s = V::mul (t, c);
+	const v_t th = V::div (t, V::add (one, root));
+	const v_t ch = V::div (one, V::sqrt (V::fma (th, th, one)));
+	const v_t sh = V::mul (th, ch);
+
+	const v_t tpq = V::mul (t, o[r]);
+	d[p] = V::sub (d[p], tpq);
+	d[k] = V::add (d[k], tpq);
+	o[r] = zero;
+	const v_t orp = o[k];
+	const v_t ork = o[p];
+	o[k] = V::sub (V::mul (c, orp), V::mul (s, ork));
+	o[p] = V::fma (s, orp, V::mul (c, ork));
+
+	composeAxisRotation<T, V, r> (q, V::neg (sh), ch);
+      }
+
+      /// \brief Diagonalize the symmetric matrix (d, o).
+      ///
+      /// On output, d holds the eigenvalues and q the rotation whose
+      /// matrix has the eigenvectors as columns.
+      static void diagonalize (v_t* d, v_t* o, v_t* q)
+      {
+	const v_t eps2 = V::set1 (std::numeric_limits<T>::epsilon ()
+				  * std::numeric_limits<T>::epsilon ());
+	const v_t tiny = V::set1 (std::numeric_limits<T>::min ());
+	q[0] = q[1] = q[2] = V::set1 (T ());
+	q[3] = V::set1 (T (1));
+	for (unsigned int sweep = 0; sweep < maxSweeps; ++sweep)
+	  {
+	    const v_t off =
+	      V::fma (o[0], o[0], V::fma (o[1], o[1], V::mul (o[2], o[2])));
+	    const v_t diag =
+	      V::fma (d[0], d[0], V::fma (d[1], d[1], V::mul (d[2], d[2])));
+	    if (V::all (V::lt (off, V::fma (eps2, diag, tiny))))
+	      break;
+	    rotate<2> (d, o, q);
+	    rotate<0> (d, o, q);
+	    rotate<1> (d, o, q);
+	  }
+      }
+
+      /// \brief Row-major rotation matrix of the quaternion q, which
+      /// is normalized first.
+      static void rotation (const v_t* q, v_t* m)
+      {
+	const v_t one = V::set1 (T (1));
+	const v_t n = V::fma (q[0], q[0],
+			      V::fma (q[1], q[1],
+				      V::fma (q[2], q[2],
+					      V::mul (q[3], q[3]))));
+	const v_t s = V::div (V::set1 (T (2)), n);
+	const v_t xs = V::mul (q[0], s);
+	const v_t ys = V::mul (q[1], s);
+	const v_t zs = V::mul (q[2], s);
+	const v_t xx = V::mul (q[0], xs);
+	const v_t yy = V::mul (q[1], ys);
+	const v_t zz = V::mul (q[2], zs);
+	const v_t xy = V::mul (q[0], ys);
+	const v_t xz = V::mul (q[0], zs);
+	const v_t yz = V::mul (q[1], zs);
+	const v_t wx = V::mul (q[3], xs);
+	const v_t wy = V::mul (q[3], ys);
+	const v_t wz = V::mul (q[3], zs);
+	m[0] = V::sub (one, V::add (yy, zz));
+	m[1] = V::sub (xy, wz);
+	m[2] = V::add (xz, wy);
+	m[3] = V::add (xy, wz);
+	m[4] = V::sub (one, V::add (xx, zz));
+	m[5] = V::sub (yz, wx);
+	m[6] = V::sub (xz, wy);
+	m[7] = V::add (yz, wx);
+	m[8] = V::sub (one, V::add (xx, yy));
+      }
+
+      /// \brief Order d[i] <= d[j], i < j, swapping the columns of the
+      /// row-major matrix m accordingly. One of them changes sign so
+      /// that m stays a rotation.
+      template <unsigned int i, unsigned int j>
+      static void order (v_t* d, v_t* m)
+      {
+	const m_t swap = V::lt (d[j], d[i]);
+	const v_t di = d[i];
+	d[i] = V::select (swap, d[j], di);
+	d[j] = V::select (swap, di, d[j]);
+	for (unsigned int row = 0; row < 3; ++row)
+	  {
+	    const v_t mi = m[3 * row + i];
+	    const v_t mj = m[3 * row + j];
+	    m[3 * row + i] = V::select (swap, mj, mi);
+	    m[3 * row + j] = V::select (swap, V::neg (mi), mj);
+	  }
+      }
+
+      /// \brief Eigenvalues, in ascending order, and eigenvectors of
+      /// the symmetric matrix (d, o). d is overwritten by the
+      /// eigenvalues, and m receives the eigenvectors as the columns
+      /// of a row-major rotation matrix.
+      static void run (v_t* d, v_t* o, v_t* m)
+      {
+	v_t q[4];
+	diagonalize (d, o, q);
+	rotation (q, m);
+	order<0, 1> (d, m);
+	order<1, 2> (d, m);
+	order<0, 1> (d, m);
+      }
+    };
+
+    /// \brief Decompose the first matrices of a batch, four at a
+    /// time, return how many were processed.
+    template <typename T, bool Vectorized = HasSimd4<T>::value>
+    struct SymmetricEigen3x3Simd4
+    {
+      static std::size_t run (const T*, T*, T*, std::size_t)
+      {
+	return 0;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <typename T>
+    struct SymmetricEigen3x3Simd4<T, true>
+    {
+      static std::size_t run (const T* a, T* values, T* vectors,
+			      std::size_t n)
+      {
+	typedef Simd4<T> V;
+	typedef typename V::type v_t;
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t d[3], o[3], m[9];
+	    for (unsigned int k = 0; k < 3; ++k)
+	      d[k] = V::load (a + k * n + i);
+	    o[2] = V::load (a + 3 * n + i);
+	    o[1] = V::load (a + 4 * n + i);
+	    o[0] = V::load (a + 5 * n + i);
+	    SymmetricEigen3x3<T, V>::run (d, o, m);
+	    for (unsigned int k = 0; k < 3; ++k)
+	      V::store (values + k * n + i, d[k]);
+	    for (unsigned int k = 0; k < 9; ++k)
+	      V::store (vectors + k * n + i, m[k]);
+	  }
+	return i;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Singular value decomposition kernels.
+    template <typename T, typename V>
+    struct Svd3x3
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+      typedef SymmetricEigen3x3<T, V> eigen_t;
+
+      /// \brief Swap the columns i and j of the row-major matrices b
+      /// and v if the norm of the column i of b is smaller. One of the
+      /// columns changes sign so that v stays a rotation.
+      template <unsigned int i, unsigned int j>
+      static void order (v_t* b, v_t* v)
+      {
+	const v_t ni = V::fma (b[i], b[i],
+			       V::fma (b[3 + i], b[3 + i],
+				       V::mul (b[6 + i], b[6 + i])));
+	const v_t nj = V::fma (b[j], b[j],
+			       V::fma (b[3 + j], b[3 + j],
+				       V::mul (b[6 + j], b[6 + j])));
+	const m_t swap = V::lt (ni, nj);
+	for (unsigned int row = 0; row < 3; ++row)
+	  {
+	    const v_t bi = b[3 * row + i];
+	    const v_t bj = b[3 * row + j];
+	    b[3 * row + i] = V::select (swap, bj, bi);
+	    b[3 * row + j] = V::select (swap, V::neg (bi), bj);
+	    const v_t vi = v[3 * row + i];
+	    const v_t vj = v[3 * row + j];
+	    v[3 * row + i] = V::select (swap, vj, vi);
+	    v[3 * row + j] = V::select (swap, V::neg (vi), vj);
+	  }
+      }
+
+      /// \brief Givens rotation cancelling b (j, col) with b (i, col),
+      /// i < j, applied to the rows of b and accumulated into q.
+      ///
+      /// The rotation is computed from its half angle, and by an angle
+      /// larger than pi / 2 when b (i, col) is negative to avoid a
+      /// cancellation, so that b (i, col) ends up non-negative.
+      template <unsigned int i, unsigned int j, unsigned int col>
+      static void givens (v_t* b, v_t* q)
+      {
+	// Columns shorter than tiny are left as is, tiny^2 being still a
+	// normal number.
+	const v_t zero = V::set1 (T ());
+	const v_t tiny = V::set1 (std::sqrt (std::numeric_limits<T>::min ()));
+	const v_t a1 = b[3 * i + col];
+	const v_t a2 = b[3 * j + col];
+	const v_t rho = V::sqrt (V::fma (a1, a1, V::mul (a2, a2)));
+	const m_t nonZero = V::lt (tiny, rho);
+	const m_t negative = V::lt (a1, zero);
+	const v_t absA1 = V::select (negative, V::neg (a1), a1);
+	const v_t chUnscaled = V::add (absA1, V::select (nonZero, rho, tiny));
+	const v_t shUnscaled = V::select (nonZero, a2, zero);
+	v_t ch = V::select (negative, shUnscaled, chUnscaled);
+	v_t sh = V::select (negative, chUnscaled, shUnscaled);
+	const v_t w =
+	  V::div (V::set1 (T (1)), V::sqrt (V::fma (ch, ch, V::mul (sh, sh))));
+	ch = V::mul (ch, w);
+	sh = V::mul (sh, w);
+
+	const v_t c = V::sub (V::mul (ch, ch), V::mul (sh, sh));
+	const v_t s = V::mul (V::set1 (T (2)), V::mul (ch, sh));
+	for (unsigned int k = 0; k < 3; ++k)
+	  {
+	    const v_t bi = b[3 * i + k];
+	    const v_t bj = b[3 * j + k];
+	    b[3 * i + k] = V::fma (c, bi, V::mul (s, bj));
+	    b[3 * j + k] = V::sub (V::mul (c, bj), V::mul (s, bi));
+	  }
+
+	// The rotation of the (i, j) plane by the angle theta is a
+	// rotation by theta about the third axis, or by -theta for the
+	// (0, 2) plane.
+	if (i == 0 && j == 2)
+	  composeAxisRotation<T, V, 1> (q, V::neg (sh), ch);
+	else
+	  composeAxisRotation<T, V, 3 - i - j> (q, sh, ch);
+      }
+
+      /// \brief A = U diag (sigma) V^T, with U and V rotations and
+      /// |sigma[0]| >= |sigma[1]| >= |sigma[2]|. sigma[2] has the sign
+      /// of the determinant of A, the others are non-negative.
+      ///
+      /// All matrices are row-major.
+      static void run (const v_t* a, v_t* u, v_t* sigma, v_t* v)
+      {
+	// V diagonalizes A^T A.
+	v_t d[3], o[3], q[4];
+	for (unsigned int k = 0; k < 3; ++k)
+	  d[k] = V::fma (a[k], a[k],
+			 V::fma (a[3 + k], a[3 + k],
+				 V::mul (a[6 + k], a[6 + k])));
+	o[0] = V::fma (a[1], a[2], V::fma (a[4], a[5], V::mul (a[7], a[8])));
+	o[1] = V::fma (a[2], a[0], V::fma (a[5], a[3], V::mul (a[8], a[6])));
+	o[2] = V::fma (a[0], a[1], V::fma (a[3], a[4], V::mul (a[6], a[7])));
+	eigen_t::diagonalize (d, o, q);
+	eigen_t::rotation (q, v);
+
+	// B = A V, whose columns are orthogonal.
+	v_t b[9];
+	for (unsigned int row = 0; row < 3; ++row)
+	  for (unsigned int col = 0; col < 3; ++col)
+	    b[3 * row + col] =
+	      V::fma (a[3 * row], v[col],
+		      V::fma (a[3 * row + 1], v[3 + col],
+			      V::mul (a[3 * row + 2], v[6 + col])));
+	order<0, 1> (b, v);
+	order<0, 2> (b, v);
+	order<1, 2> (b, v);
+
+	// B = U R, R being diagonal up to rounding errors.
+	q[0] = q[1] = q[2] = V::set1 (T ());
+	q[3] = V::set1 (T (1));
+	givens<0, 1, 0> (b, q);
+	givens<0, 2, 0> (b, q);
+	givens<1, 2, 1> (b, q);
+	eigen_t::rotation (q, u);
+	sigma[0] = b[0];
+	sigma[1] = b[4];
+	sigma[2] = b[8];
+      }
+
+      /// \brief r = U V^T, the rotation closest to A.
+      static void nearestRotation (const v_t* a, v_t* r)
+      {
+	v_t u[9], sigma[3], v[9];
+	run (a, u, sigma, v);
+	for (unsigned int row = 0; row < 3; ++row)
+	  for (unsigned int col = 0; col < 3; ++col)
+	    r[3 * row + col] =
+	      V::fma (u[3 * row], v[3 * col],
+		      V::fma (u[3 * row + 1], v[3 * col + 1],
+			      V::mul (u[3 * row + 2], v[3 * col + 2])));
+      }
+    };
+
+    /// \brief Decompose the first matrices of a batch, four at a
+    /// time, return how many were processed.
+    template <typename T, bool Vectorized = HasSimd4<T>::value>
+    struct Svd3x3Simd4
+    {
+      static std::size_t run (const T*, T*, T*, T*, std::size_t)
+      {
+	return 0;
+      }
+
+      static std::size_t nearestRotation (const T*, T*, std::size_t)
+      {
+	return 0;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <typename T>
+    struct Svd3x3Simd4<T, true>
+    {
+      typedef Simd4<T> V;
+      typedef typename V::type v_t;
+
+      static std::size_t run (const T* a, T* u, T* sigma, T* v,
+			      std::size_t n)
+      {
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t av[9], uv[9], sv[3], vv[9];
+	    for (unsigned int k = 0; k < 9; ++k)
+	      av[k] = V::load (a + k * n + i);
+	    Svd3x3<T, V>::run (av, uv, sv, vv);
+	    for (unsigned int k = 0; k < 9; ++k)
+	      {
+		V::store (u + k * n + i, uv[k]);
+		V::store (v + k * n + i, vv[k]);
+	      }
+	    for (unsigned int k = 0; k < 3; ++k)
+	      V::store (sigma + k * n + i, sv[k]);
+	  }
+	return i;
+      }
+
+      static std::size_t nearestRotation (const T* a, T* r, std::size_t n)
+      {
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t av[9], rv[9];
+	    for (unsigned int k = 0; k < 9; ++k)
+	      av[k] = V::load (a + k * n + i);
+	    Svd3x3<T, V>::nearestRotation (av, rv);
+	    for (unsigned int k = 0; k < 9; ++k)
+	      V::store (r + k * n + i, rv[k]);
+	  }
+	return i;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+  } // end of namespace detail.
+
+  /// \brief Eigen-decomposition of a symmetric 3x3 matrix.
+  ///
+  /// Only the lower triangular part of the matrix is read.
+  /// Eigenvalues are sorted in ascending order, and the eigenvectors
+  /// are the columns of a rotation matrix.
+  template <typename T>
+  class SymmetricEigenDecomposition
+  {
+  public:
+    SymmetricEigenDecomposition ()
+      : values_ (), vectors_ ()
+    {}
+
+    explicit SymmetricEigenDecomposition (const Matrix3x3<T>& A)
+    {
+      compute (A);
+    }
+
+    /// \brief Decompose A.
+    void compute (const Matrix3x3<T>& A)
+    {
+      T d[3] = {A.m[0], A.m[4], A.m[8]};
+      T o[3] = {A.m[7], A.m[6], A.m[3]};
+      detail::SymmetricEigen3x3<T, detail::ScalarOps<T> >::run
+	(d, o, vectors_.m);
+      values_ = Vector3D<T> (d[0], d[1], d[2]);
+    }
+
+    /// \brief Eigenvalues, in ascending order.
+    const Vector3D<T>& eigenvalues () const
+    {
+      return values_;
+    }
+
+    /// \brief Eigenvectors, as the columns of a rotation matrix.
+    const Matrix3x3<T>& eigenvectors () const
+    {
+      return vectors_;
+    }
+
+  private:
+    Vector3D<T> values_;
+    Matrix3x3<T> vectors_;
+  };
+
+  /// \brief Eigen-decomposition of a batch of n symmetric 3x3
+  /// matrices stored as coefficient arrays.
+  ///
+  /// Coefficient k of matrix i is stored at index k * n + i:
+  ///   - in a, for the coefficients (0, 0), (1, 1), (2, 2), (1, 0),
+  ///     (2, 0) and (2, 1),
+  ///   - in values, for the eigenvalues in ascending order,
+  ///   - in vectors, for the row-major coefficients of the rotation
+  ///     matrix whose columns are the eigenvectors.
+  template <typename T>
+  void symmetricEigenDecomposition (const T* a, T* values, T* vectors,
+				    std::size_t n)
+  {
+    typedef detail::SymmetricEigen3x3<T, detail::ScalarOps<T> > scalar_t;
+    std::size_t i =
+      detail::SymmetricEigen3x3Simd4<T>::run (a, values, vectors, n);
+    for (; i < n; ++i)
+      {
+	T d[3] = {a[i], a[n + i], a[2 * n + i]};
+	T o[3] = {a[5 * n + i], a[4 * n + i], a[3 * n + i]};
+	T m[9];
+	scalar_t::run (d, o, m);
+	for (unsigned int k = 0; k < 3; ++k)
+	  values[k * n + i] = d[k];
+	for (unsigned int k = 0; k < 9; ++k)
+	  vectors[k * n + i] = m[k];
+      }
+  }
+
+  /// \brief Singular value decomposition of a 3x3 matrix.
+  ///
+  /// A = U diag (sigma) V^T, where U and V are rotations and the
+  /// singular values are sorted by decreasing absolute value. To keep
+  /// U and V proper rotations, the last singular value has the sign
+  /// of the determinant of A.
+  template <typename T>
+  class SingularValueDecomposition
+  {
+  public:
+    SingularValueDecomposition ()
+      : u_ (), sigma_ (), v_ ()
+    {}
+
+    explicit SingularValueDecomposition (const Matrix3x3<T>& A)
+    {
+      compute (A);
+    }
+
+    /// \brief Decompose A.
+    void compute (const Matrix3x3<T>& A)
+    {
+      T sigma[3];
+      detail::Svd3x3<T, detail::ScalarOps<T> >::run (A.m, u_.m, sigma, v_.m);
+      sigma_ = Vector3D<T> (sigma[0], sigma[1], sigma[2]);
+    }
+
+    /// \brief Left singular vectors, as the columns of a rotation.
+    const Matrix3x3<T>& matrixU () const
+    {
+      return u_;
+    }
+
+    /// \brief Singular values, the last one being signed.
+    const Vector3D<T>& singularValues () const
+    {
+      return sigma_;
+    }
+
+    /// \brief Right singular vectors, as the columns of a rotation.
+    const Matrix3x3<T>& matrixV () const
+    {
+      return v_;
+    }
+
+  private:
+    Matrix3x3<T> u_;
+    Vector3D<T> sigma_;
+    Matrix3x3<T> v_;
+  };
+
+  /// \brief Rotation closest to A in the Frobenius norm.
+  ///
+  /// This is the rotation factor of the polar decomposition of A when
+  /// its determinant is positive. A rotation matrix which drifted
+  /// from orthonormality is projected back this way.
+  template <typename T>
+  Matrix3x3<T> nearestRotation (const Matrix3x3<T>& A)
+  {
+    Matrix3x3<T> R;
+    detail::Svd3x3<T, detail::ScalarOps<T> >::nearestRotation (A.m, R.m);
+    return R;
+  }
+
+  /// \brief Singular value decomposition of a batch of n 3x3 matrices
+  /// stored as coefficient arrays.
+  ///
+  /// Coefficient k of matrix i is stored at index k * n + i, k being
+  /// the row-major index for a, u and v, and the rank of the singular
+  /// value for sigma.
+  template <typename T>
+  void singularValueDecomposition (const T* a, T* u, T* sigma, T* v,
+				   std::size_t n)
+  {
+    typedef detail::Svd3x3<T, detail::ScalarOps<T> > scalar_t;
+    std::size_t i = detail::Svd3x3Simd4<T>::run (a, u, sigma, v, n);
+    for (; i < n; ++i)
+      {
+	T ai[9], ui[9], si[3], vi[9];
+	for (unsigned int k = 0; k < 9; ++k)
+	  ai[k] = a[k * n + i];
+	scalar_t::run (ai, ui, si, vi);
+	for (unsigned int k = 0; k < 9; ++k)
+	  {
+	    u[k * n + i] = ui[k];
+	    v[k * n + i] = vi[k];
+	  }
+	for (unsigned int k = 0; k < 3; ++k)
+	  sigma[k * n + i] = si[k];
+      }
+  }
+
+  /// \brief Nearest rotations of a batch of n 3x3 matrices stored as
+  /// coefficient arrays, as in singularValueDecomposition. r may be a.
+  template <typename T>
+  void nearestRotation (const T* a, T* r, std::size_t n)
+  {
+    typedef detail::Svd3x3<T, detail::ScalarOps<T> > scalar_t;
+    std::size_t i = detail::Svd3x3Simd4<T>::nearestRotation (a, r, n);
+    for (; i < n; ++i)
+      {
+	T ai[9], ri[9];
+	for (unsigned int k = 0; k < 9; ++k)
+	  ai[k] = a[k * n + i];
+	scalar_t::nearestRotation (ai, ri);
+	for (unsigned int k = 0; k < 9; ++k)
+	  r[k * n + i] = ri[k];
+      }
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_DECOMPOSITIONS3X3_HH
@@ -0,0 +1,299 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef JRL_MATHTOOLS_DISTANCES_HH
+# define JRL_MATHTOOLS_DISTANCES_HH
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/angle.hh>
+# include <jrl/mathtools/quaternion.hh>
+# include <jrl/mathtools/vector3.hh>
+
+// One-to-many distances between configurations, the inner loop of
+// nearest neighbour searches.
+//
+// Each kernel computes the distances from one query to n
+// configurations, four at a time when Simd4 is available. Rotations
+// follow the same rules as Angle::distance: angles are compared along
+// the shortest arc and quaternions q and -q are the same rotation.
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief |a - b| along the shortest arc, for a and b in [-pi, pi].
+    template <typename V>
+    typename V::type circularDifference (typename V::type a,
+					 typename V::type b)
+    {
+      const typename V::type d = V::sub (a, b);
+      const typename V::type absD =
+	V::select (V::lt (d, V::set1 (0.)), V::neg (d), d);
+      const typename V::type other = V::sub (V::set1 (2. * M_PI), absD);
+      return V::select (V::lt (other, absD), other, absD);
+    }
+
+    /// \brief out[i] += w2 (p[i] - q)^2, p holding one coordinate of
+    /// n points, compared along the shortest arc if Circular.
+    template <bool Circular>
+    void accumulateSquaredDifferences (const double& q, const double* p,
+				       const double& w2, double* out,
+				       std::size_t n)
+    {
+      typedef ScalarOps<double> S;
+      std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+      typedef Simd4<double> V;
+      const V::type qv = V::set1 (q);
+      const V::type w2v = V::set1 (w2);
+      for (; i + 4 <= n; i += 4)
+	{
+	  const V::type d = Circular
+	    ? circularDifference<V> (V::load (p + i), qv)
+	    : V::sub (V::load (p + i), qv);
+	  V::store (out + i, V::fma (V::mul (d, d), w2v, V::load (out + i)));
+	}
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+      for (; i < n; ++i)
+	{
+	  const double d =
+	    Circular ? circularDifference<S> (p[i], q) : p[i] - q;
+	  out[i] = S::fma (d * d, w2, out[i]);
+	}
+    }
+
+    /// \brief Squared weighted distances from query to n points.
+    ///
+    /// Coordinate k of point i is points[k * stride + i]. Coordinate k
+    /// is an angle in [-pi, pi] if circular[k] and is scaled by
+    /// weights[k]. Both may be null: no angle, unit weights.
+    inline void
+    squaredDistances (const double* query, const double* points,
+		      std::size_t stride, std::size_t n,
+		      std::size_t dimension, const bool* circular,
+		      const double* weights, double* out)
+    {
+      std::fill (out, out + n, 0.);
+      for (std::size_t k = 0; k < dimension; ++k)
+	{
+	  const double w = weights ? weights[k] : 1.;
+	  if (circular && circular[k])
+	    accumulateSquaredDifferences<true>
+	      (query[k], points + k * stride, w * w, out, n);
+	  else
+	    accumulateSquaredDifferences<false>
+	      (query[k], points + k * stride, w * w, out, n);
+	}
+    }
+
+    /// \brief Distance kernels on rotations and poses, written once
+    /// against the ScalarOps / Simd4 interface. Quaternions and
+    /// vectors are passed coefficient-wise.
+    template <typename T, typename V>
+    struct PoseDistance
+    {
+      typedef typename V::type v_t;
+
+      /// \brief Angle of the rotation from a to b, twice the angle
+      /// between the quaternions. The latter is 2 atan (|b - a| /
+      /// |b + a|) once b is in the half-space of a, which is accurate
+      /// even for nearby rotations, unlike acos (a.b).
+      static v_t rotation (const v_t* a, const v_t* bIn)
+      {
+	v_t b[4] = {bIn[0], bIn[1], bIn[2], bIn[3]};
+	Interpolation<T, V>::shortestPath (a, b);
+	v_t diff = V::set1 (T ());
+	v_t sum = V::set1 (T ());
+	for (unsigned int k = 0; k < 4; ++k)
+	  {
+	    const v_t dk = V::sub (b[k], a[k]);
+	    const v_t sk = V::add (b[k], a[k]);
+	    diff = V::fma (dk, dk, diff);
+	    sum = V::fma (sk, sk, sum);
+	  }
+	return V::mul (V::set1 (T (4)),
+		       Trigonometry<T, V>::atan (V::sqrt (V::div (diff, sum))));
+      }
+
+      /// \brief sqrt (|ta - tb|^2 + w2 angle^2).
+      static v_t pose (const v_t* ta, const v_t* qa, const v_t* tb,
+		       const v_t* qb, v_t w2)
+      {
+	const v_t angle = rotation (qa, qb);
+	v_t d2 = V::mul (w2, V::mul (angle, angle));
+	for (unsigned int k = 0; k < 3; ++k)
+	  {
+	    const v_t dk = V::sub (tb[k], ta[k]);
+	    d2 = V::fma (dk, dk, d2);
+	  }
+	return V::sqrt (d2);
+      }
+    };
+
+    /// \brief Distances from a pose to the first poses of arrays, four
+    /// at a time, return how many were processed. Translations are
+    /// ignored if Translation is false.
+    template <typename T, bool Translation,
+	      bool Vectorized = HasSimd4<T>::value>
+    struct PoseDistancesSimd4
+    {
+      static std::size_t run (const T*, const T*, const T*, const T*, T*,
+			      std::size_t, T)
+      {
+	return 0;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <typename T, bool Translation>
+    struct PoseDistancesSimd4<T, Translation, true>
+    {
+      static std::size_t run (const T* t, const T* q, const T* ts,
+			      const T* qs, T* out, std::size_t n, T w2)
+      {
+	typedef Simd4<T> V;
+	typedef typename V::type v_t;
+
+	v_t ta[3], qa[4];
+	for (unsigned int k = 0; k < 3; ++k)
+	  ta[k] = V::set1 (Translation ? t[k] : T ());
+	for (unsigned int k = 0; k < 4; ++k)
+	  qa[k] = V::set1 (q[k]);
+	const v_t w2v = V::set1 (w2);
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t qb[4];
+	    for (unsigned int k = 0; k < 4; ++k)
+	      qb[k] = V::load (qs + 4 * (i + k));
+	    V::transpose (qb[0], qb[1], qb[2], qb[3]);
+	    if (Translation)
+	      {
+		const T* p = ts + 3 * i;
+		v_t tb[3];
+		for (unsigned int k = 0; k < 3; ++k)
+		  tb[k] = V::set (p[k], p[3 + k], p[6 + k], p[9 + k]);
+		V::store (out + i,
+			  PoseDistance<T, V>::pose (ta, qa, tb, qb, w2v));
+	      }
+	    else
+	      V::store (out + i, PoseDistance<T, V>::rotation (qa, qb));
+	  }
+	return i;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Apply the pose distance kernels to arrays of poses.
+    template <typename T, bool Translation>
+    struct PoseDistances
+    {
+      typedef PoseDistance<T, ScalarOps<T> > scalar_t;
+
+      static void run (const T* t, const T* q, const T* ts, const T* qs,
+		       T* out, std::size_t n, T w2)
+      {
+	std::size_t i = PoseDistancesSimd4<T, Translation>::run
+	  (t, q, ts, qs, out, n, w2);
+	for (; i < n; ++i)
+	  out[i] = Translation
+	    ? scalar_t::pose (t, q, ts + 3 * i, qs + 4 * i, w2)
+	    : scalar_t::rotation (q, qs + 4 * i);
+      }
+    };
+  } // end of namespace detail.
+
+  /// \brief Distances on unit circle from query to n angles in
+  /// [-PI, PI], as Angle::distance.
+  inline void angleDistances (const Angle& query, const double* angles,
+			      double* out, std::size_t n)
+  {
+    typedef detail::ScalarOps<double> S;
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    const V::type q = V::set1 (query.value ());
+    for (; i + 4 <= n; i += 4)
+      V::store (out + i, detail::circularDifference<V> (V::load (angles + i),
+							 q));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      out[i] = detail::circularDifference<S> (angles[i], query.value ());
+  }
+
+  /// \brief Distances from an SE(2) configuration to n others.
+  ///
+  /// Configurations are (x, y, theta), theta in [-PI, PI], and their
+  /// distance is sqrt (dx^2 + dy^2 + (rotationWeight dtheta)^2), dtheta
+  /// following the shortest arc. The batch is stored coordinate-wise:
+  /// x, y and theta of configuration i are poses[i], poses[n + i] and
+  /// poses[2 n + i].
+  inline void se2Distances (const double* query, const double* poses,
+			    double* out, std::size_t n,
+			    double rotationWeight = 1.)
+  {
+    static const bool circular[] = {false, false, true};
+    const double weights[] = {1., 1., rotationWeight};
+    detail::squaredDistances (query, poses, n, n, 3, circular, weights, out);
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    for (; i + 4 <= n; i += 4)
+      V::store (out + i, V::sqrt (V::load (out + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      out[i] = std::sqrt (out[i]);
+  }
+
+  /// \brief Angles of the rotations from query to n unit quaternions,
+  /// in [0, PI].
+  template <typename T>
+  void rotationDistances (const Quaternion<T>& query,
+			  const Quaternion<T>* rotations, T* out,
+			  std::size_t n)
+  {
+    detail::PoseDistances<T, false>::run
+      (0, query.data (), 0, reinterpret_cast<const T*> (rotations), out,
+       n, T ());
+  }
+
+  /// \brief Distances from an SE(3) pose to n others.
+  ///
+  /// The distance is sqrt (|dt|^2 + (rotationWeight angle)^2), angle
+  /// being that of the relative rotation, see rotationDistances.
+  template <typename T>
+  void se3Distances (const Vector3D<T>& translation,
+		     const Quaternion<T>& rotation,
+		     const Vector3D<T>* translations,
+		     const Quaternion<T>* rotations, T* out, std::size_t n,
+		     T rotationWeight = T (1))
+  {
+    detail::PoseDistances<T, true>::run
+      (translation.data (), rotation.data (),
+       reinterpret_cast<const T*> (translations),
+       reinterpret_cast<const T*> (rotations), out, n,
+       rotationWeight * rotationWeight);
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_DISTANCES_HH
@@ -0,0 +1,304 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_FORMAT_HH
+# define JRL_MATHTOOLS_FORMAT_HH
+# include <algorithm>
+# include <clocale>
+# include <cmath>
+# include <cstddef>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <ios>
+# include <limits>
+# include <locale>
+# include <ostream>
+# include <type_traits>
+
+// Text formatting and parsing of numbers without iostreams.
+//
+// Numbers are formatted with snprintf into a caller-provided buffer
+// and parsed with strtod, so that a text matrix costs a single stream
+// write and no stream extraction at all. Both follow the LC_NUMERIC
+// category of the C locale: its decimal point is translated to and
+// from '.', so that the text does not depend on the locale.
+//
+// The display () methods of the matrices go through formatRows, which
+// writes exactly what element-wise operator<< would, without the
+// flushes of std::endl. Scalar types other than float and double are
+// still written element by element.
+namespace jrlMathTools
+{
+  /// \brief Precision of formatNumber giving the shortest text that
+  /// parses back to the same value.
+  static const int ROUND_TRIP_PRECISION = -1;
+
+  /// \brief Size of a buffer large enough for any formatted number.
+  static const std::size_t NUMBER_BUFFER_SIZE = 32;
+
+  namespace detail
+  {
+    /// \brief Scalar types formatted and parsed with snprintf and
+    /// strtod. Only the specialisations are available.
+    template <typename T>
+    struct NumberFormat
+    {
+      static const bool available = false;
+    };
+
+    template <>
+    struct NumberFormat<float>
+    {
+      static const bool available = true;
+      static const int digits10 = 6;
+      static const int maxDigits10 = 9;
+
+      static float parse (const char* text, char** end)
+      {
+	return std::strtof (text, end);
+      }
+    };
+
+    template <>
+    struct NumberFormat<double>
+    {
+      static const bool available = true;
+      static const int digits10 = 15;
+      static const int maxDigits10 = 17;
+
+      static double parse (const char* text, char** end)
+      {
+	return std::strtod (text, end);
+      }
+    };
+
+    /// \brief Decimal point of the C locale, used by snprintf and
+    /// strtod.
+    inline const char* decimalPoint ()
+    {
+      const char* point = std::localeconv ()->decimal_point;
+      return point && *point ? point : ".";
+    }
+
+    /// \brief Replace the first occurrence of from by to in the
+    /// length characters of text, which can hold size characters.
+    ///
+    /// \return the new length, which is kept below size.
+    inline std::size_t replace (char* text, std::size_t length,
+				std::size_t size, const char* from,
+				const char* to)
+    {
+      text[length] = 0;
+      char* position = std::strstr (text, from);
+      if (! position)
+	return length;
+      const std::size_t fromLength = std::strlen (from);
+      const std::size_t toLength = std::strlen (to);
+      const std::size_t tail =
+	length - std::size_t (position - text) - fromLength;
+      if (length - fromLength + toLength + 1 > size)
+	return length;
+      std::memmove (position + toLength, position + fromLength, tail + 1);
+      std::memcpy (position, to, toLength);
+      return length - fromLength + toLength;
+    }
+
+    /// \brief Number of characters written by snprintf into a buffer
+    /// of NUMBER_BUFFER_SIZE characters.
+    inline std::size_t writtenLength (int length, std::size_t size)
+    {
+      return length < 0 ? 0 : std::min (std::size_t (length), size - 1);
+    }
+
+    inline bool isSpace (char c)
+    {
+      return c == ' ' || c == '\n' || c == '\t' || c == '\r'
+	|| c == '\f' || c == '\v';
+    }
+  } // end of namespace detail.
+
+  /// \brief Format value as printf's %g into out, which must hold
+  /// NUMBER_BUFFER_SIZE characters.
+  ///
+  /// \param precision number of significant digits, or
+  /// ROUND_TRIP_PRECISION for the shortest exact representation. It is
+  /// limited to std::numeric_limits<T>::max_digits10, as further digits
+  /// carry no information.
+  /// \return number of characters written, without terminating zero.
+  template <typename T>
+  std::size_t formatNumber (char* out, T value,
+			    int precision = ROUND_TRIP_PRECISION)
+  {
+    typedef detail::NumberFormat<T> format_t;
+    std::size_t length = 0;
+    if (precision >= 0)
+      length = detail::writtenLength
+	(std::snprintf (out, NUMBER_BUFFER_SIZE, "%.*g",
+			std::min (precision, int (format_t::maxDigits10)),
+			double (value)), NUMBER_BUFFER_SIZE);
+    else
+      {
+	// Rounding to n digits gives the shortest representation with
+	// at most n digits, when there is one: only the last digits
+	// need to be tried, but for subnormal numbers which are less
+	// precise.
+	const bool subnormal = value != T ()
+	  && std::abs (value) < std::numeric_limits<T>::min ();
+	for (int digits = subnormal ? 1 : format_t::digits10;
+	     digits <= format_t::maxDigits10; ++digits)
+	  {
+	    length = detail::writtenLength
+	      (std::snprintf (out, NUMBER_BUFFER_SIZE, "%.*g",
+			      digits, double (value)), NUMBER_BUFFER_SIZE);
+	    if (format_t::parse (out, 0) == value)
+	      break;
+	  }
+      }
+    const char* point = detail::decimalPoint ();
+    if (point[0] != '.' || point[1])
+      length = detail::replace (out, length, NUMBER_BUFFER_SIZE, point, ".");
+    return length;
+  }
+
+  /// \brief Parse a number, skipping leading white spaces.
+  ///
+  /// \return the end of the number, or 0 if [first, last) does not
+  /// start with a number.
+  template <typename T>
+  const char* parseNumber (const char* first, const char* last, T& value)
+  {
+    while (first != last && detail::isSpace (*first))
+      ++first;
+    char token[NUMBER_BUFFER_SIZE * 2];
+    std::size_t length = 0;
+    while (first + length != last && !detail::isSpace (first[length]))
+      {
+	if (length + 1 == sizeof (token))
+	  return 0;
+	token[length] = first[length];
+	++length;
+      }
+    if (length == 0)
+      return 0;
+    token[length] = 0;
+    std::size_t tokenLength = length;
+    const char* point = detail::decimalPoint ();
+    if (point[0] != '.' || point[1])
+      tokenLength = detail::replace (token, length, sizeof (token), ".",
+				     point);
+    char* end;
+    value = detail::NumberFormat<T>::parse (token, &end);
+    return end == token + tokenLength ? first + length : 0;
+  }
+
+  /// \brief Parse n numbers separated by white spaces.
+  ///
+  /// \return the end of the last number, or 0 on error.
+  template <typename T>
+  const char* parseNumbers (const char* first, const char* last,
+			    T* values, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n && first; ++i)
+      first = parseNumber (first, last, values[i]);
+    return first;
+  }
+
+  /// \brief Write a rows x cols row-major matrix to os with the given
+  /// precision, which may be ROUND_TRIP_PRECISION.
+  template <typename T>
+  std::ostream& formatRows (std::ostream& os, const T* m,
+			    unsigned int rows, unsigned int cols,
+			    int precision)
+  {
+    char buffer[16 * NUMBER_BUFFER_SIZE];
+    std::size_t size = 0;
+    for (unsigned int i = 0; i < rows; ++i)
+      {
+	for (unsigned int j = 0; j < cols; ++j)
+	  {
+	    if (size + NUMBER_BUFFER_SIZE + 2 > sizeof (buffer))
+	      {
+		os.write (buffer, std::streamsize (size));
+		size = 0;
+	      }
+	    size += formatNumber (buffer + size, m[i * cols + j], precision);
+	    buffer[size++] = ' ';
+	  }
+	buffer[size++] = '\n';
+      }
+    os.write (buffer, std::streamsize (size));
+    return os;
+  }
+
+  namespace detail
+  {
+    template <typename T>
+    std::ostream& formatElements (std::ostream& os, const T* m,
+				  unsigned int rows, unsigned int cols)
+    {
+      for (unsigned int i = 0; i < rows; ++i)
+	{
+	  for (unsigned int j = 0; j < cols; ++j)
+	    os << m[i * cols + j] << ' ';
+	  os << '\n';
+	}
+      return os;
+    }
+
+    template <typename T>
+    std::ostream& formatRows (std::ostream& os, const T* m,
+			      unsigned int rows, unsigned int cols,
+			      std::false_type)
+    {
+      return formatElements (os, m, rows, cols);
+    }
+
+    template <typename T>
+    std::ostream& formatRows (std::ostream& os, const T* m,
+			      unsigned int rows, unsigned int cols,
+			      std::true_type)
+    {
+      const std::ios::fmtflags flags = std::ios::floatfield
+	| std::ios::showpos | std::ios::showpoint | std::ios::uppercase;
+      if ((os.flags () & flags) || os.width () != 0
+	  || os.precision () > NumberFormat<T>::maxDigits10
+	  || os.getloc () != std::locale::classic ())
+	return formatElements (os, m, rows, cols);
+      return jrlMathTools::formatRows
+	(os, m, rows, cols, int (os.precision ()));
+    }
+  } // end of namespace detail.
+
+  /// \brief Write a rows x cols row-major matrix to os, each element
+  /// followed by a space and each row by a new line, as display ().
+  ///
+  /// Rows are formatted into a buffer, written to os when full. The
+  /// stream is not flushed. If precision is not given, the precision
+  /// of the stream is used; a stream with other formatting flags, a
+  /// width, a locale or a precision above max_digits10 is written to
+  /// element by element, as are scalars other than float and double.
+  template <typename T>
+  std::ostream& formatRows (std::ostream& os, const T* m,
+			    unsigned int rows, unsigned int cols)
+  {
+    return detail::formatRows
+      (os, m, rows, cols,
+       std::integral_constant<bool, detail::NumberFormat<T>::available> ());
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_FORMAT_HH
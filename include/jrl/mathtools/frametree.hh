@@ -0,0 +1,327 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_FRAMETREE_HH
+# define JRL_MATHTOOLS_FRAMETREE_HH
+# include <algorithm>
+# include <atomic>
+# include <cstddef>
+# include <deque>
+# include <map>
+# include <stdexcept>
+# include <string>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Tree of named frames with cached relative transformations.
+  ///
+  /// Each frame stores its transformation relative to its parent. The
+  /// tree caches, for every frame, its transformation relative to the
+  /// root and the inverse of it, so that the transformation between
+  /// any two frames costs two lookups and one product.
+  ///
+  /// Local transformations are changed with setLocal, which only flags
+  /// the frame. publish () then recomputes the cached transformations
+  /// of the flagged frames and their descendants, in a single pass,
+  /// and makes them visible to readers at once.
+  ///
+  /// Concurrency: the structure of the tree (addFrame) must be built
+  /// before it is shared. Afterwards, one writer thread may call
+  /// setLocal and publish while any number of threads call world and
+  /// transform. Readers never block, the published transformations are
+  /// guarded by a sequence lock: a reader retries if a publication
+  /// happened while it was copying, so it always sees a consistent
+  /// snapshot of the tree.
+  ///
+  /// Transformations are homogeneous rigid (or affine) matrices: their
+  /// last row is taken to be (0, 0, 0, 1).
+  template <typename T>
+  class FrameTree
+  {
+  public:
+    typedef Matrix4x4<T> matrix_t;
+
+    /// \brief Tree reduced to its root frame.
+    explicit FrameTree (const std::string& root = "world")
+      : firstChanged_ (0),
+	sequence_ (0)
+    {
+      matrix_t I;
+      I.setIdentity ();
+      insert (root, 0, I);
+      publish ();
+    }
+
+    /// \brief Number of frames, the root included.
+    std::size_t size () const
+    {
+      return names_.size ();
+    }
+
+    /// \brief Index of the root frame.
+    static std::size_t root ()
+    {
+      return 0;
+    }
+
+    /// \brief Add a frame, return its index.
+    ///
+    /// The cached transformations of the new frame are published
+    /// immediately.
+    ///
+    /// \param local transformation of the frame relative to its parent.
+    std::size_t addFrame (const std::string& name, std::size_t parent,
+			  const matrix_t& local)
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (parent < size ());
+      if (ids_.count (name))
+	throw std::invalid_argument ("duplicate frame name: " + name);
+      const std::size_t id = insert (name, parent, local);
+      publish ();
+      return id;
+    }
+
+    /// \brief Add a frame, return its index.
+    std::size_t addFrame (const std::string& name, const std::string& parent,
+			  const matrix_t& local)
+    {
+      return addFrame (name, id (parent), local);
+    }
+
+    /// \brief Index of a frame.
+    std::size_t id (const std::string& name) const
+    {
+      typename std::map<std::string, std::size_t>::const_iterator it =
+	ids_.find (name);
+      if (it == ids_.end ())
+	throw std::invalid_argument ("unknown frame: " + name);
+      return it->second;
+    }
+
+    /// \brief Name of a frame.
+    const std::string& name (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return names_[i];
+    }
+
+    /// \brief Parent of a frame, the root is its own parent.
+    std::size_t parent (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return parents_[i];
+    }
+
+    /// \brief Transformation of a frame relative to its parent, as last
+    /// set by the writer.
+    const matrix_t& local (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return local_[i];
+    }
+
+    /// \brief Change the transformation of a frame relative to its
+    /// parent.
+    ///
+    /// Readers keep seeing the previous transformation until the next
+    /// call to publish.
+    void setLocal (std::size_t i, const matrix_t& local)
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      local_[i] = local;
+      changed_[i] = true;
+      firstChanged_ = std::min (firstChanged_, i);
+    }
+
+    /// \brief Recompute and publish the transformations of the frames
+    /// changed since the last publication and of their descendants.
+    void publish ()
+    {
+      const std::size_t n = size ();
+      if (firstChanged_ >= n)
+	return;
+
+      // Parents always have a lower index than their children, so one
+      // pass propagates the changes down the tree. Frames before
+      // firstChanged_ are clean, their dirty_ flags were cleared by the
+      // previous publication.
+      for (std::size_t i = firstChanged_; i < n; ++i)
+	{
+	  dirty_[i] = changed_[i] || (i != 0 && dirty_[parents_[i]]);
+	  if (! dirty_[i])
+	    continue;
+	  if (i == 0)
+	    world_[0] = local_[0];
+	  else
+	    world_[parents_[i]].CeqthismulBAffine (local_[i], world_[i]);
+	  world_[i].Inversion (inverse_[i]);
+	  changed_[i] = false;
+	}
+
+      const unsigned int s = sequence_.load (std::memory_order_relaxed);
+      sequence_.store (s + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+      for (std::size_t i = firstChanged_; i < n; ++i)
+	if (dirty_[i])
+	  {
+	    published_[i].store (world_[i], inverse_[i]);
+	    dirty_[i] = false;
+	  }
+      sequence_.store (s + 2, std::memory_order_release);
+
+      firstChanged_ = n;
+    }
+
+    /// \brief Published transformation of a frame relative to the root.
+    matrix_t world (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      matrix_t M;
+      unsigned int s;
+      do
+	{
+	  s = beginRead ();
+	  published_[i].loadWorld (M);
+	}
+      while (! endRead (s));
+      return M;
+    }
+
+    /// \brief Published transformation of a frame relative to the root.
+    matrix_t world (const std::string& name) const
+    {
+      return world (id (name));
+    }
+
+    /// \brief Published transformation from frame `from' to frame `to'.
+    ///
+    /// The result maps coordinates expressed in `from' to coordinates
+    /// expressed in `to', i.e. world (to)^-1 * world (from).
+    matrix_t transform (std::size_t from, std::size_t to) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (from < size () && to < size ());
+      matrix_t A;
+      matrix_t B;
+      unsigned int s;
+      do
+	{
+	  s = beginRead ();
+	  published_[to].loadInverse (A);
+	  published_[from].loadWorld (B);
+	}
+      while (! endRead (s));
+      matrix_t M;
+      A.CeqthismulBAffine (B, M);
+      return M;
+    }
+
+    /// \brief Published transformation from frame `from' to frame `to'.
+    matrix_t transform (const std::string& from, const std::string& to) const
+    {
+      return transform (id (from), id (to));
+    }
+
+  private:
+    /// \brief Affine part of the transformations visible to readers.
+    ///
+    /// Coefficients are relaxed atomics so that a reader racing with
+    /// the writer is well defined, the sequence lock detects the race.
+    struct Published
+    {
+      std::atomic<T> world[12];
+      std::atomic<T> inverse[12];
+
+      void store (const matrix_t& W, const matrix_t& I)
+      {
+	for (unsigned int k = 0; k < 12; ++k)
+	  {
+	    world[k].store (W.m[k], std::memory_order_relaxed);
+	    inverse[k].store (I.m[k], std::memory_order_relaxed);
+	  }
+      }
+
+      static void load (const std::atomic<T>* a, matrix_t& M)
+      {
+	for (unsigned int k = 0; k < 12; ++k)
+	  M.m[k] = a[k].load (std::memory_order_relaxed);
+	M.m[12] = M.m[13] = M.m[14] = T ();
+	M.m[15] = T (1);
+      }
+
+      void loadWorld (matrix_t& M) const
+      {
+	load (world, M);
+      }
+
+      void loadInverse (matrix_t& M) const
+      {
+	load (inverse, M);
+      }
+    };
+
+    std::size_t insert (const std::string& name, std::size_t parent,
+			const matrix_t& local)
+    {
+      const std::size_t i = names_.size ();
+      names_.push_back (name);
+      ids_[name] = i;
+      parents_.push_back (parent);
+      local_.push_back (local);
+      world_.push_back (matrix_t ());
+      inverse_.push_back (matrix_t ());
+      changed_.push_back (true);
+      dirty_.push_back (false);
+      published_.emplace_back ();
+      firstChanged_ = std::min (firstChanged_, i);
+      return i;
+    }
+
+    /// \brief Wait for the writer to be outside of a publication.
+    unsigned int beginRead () const
+    {
+      unsigned int s;
+      while ((s = sequence_.load (std::memory_order_acquire)) & 1)
+	continue;
+      return s;
+    }
+
+    /// \brief Whether no publication happened since beginRead.
+    bool endRead (unsigned int s) const
+    {
+      std::atomic_thread_fence (std::memory_order_acquire);
+      return sequence_.load (std::memory_order_relaxed) == s;
+    }
+
+    std::vector<std::string> names_;
+    std::map<std::string, std::size_t> ids_;
+    std::vector<std::size_t> parents_;
+    std::vector<matrix_t> local_;
+    std::vector<matrix_t> world_;
+    std::vector<matrix_t> inverse_;
+    std::vector<bool> changed_;
+    std::vector<bool> dirty_;
+    std::size_t firstChanged_;
+    std::deque<Published> published_;
+    std::atomic<unsigned int> sequence_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_FRAMETREE_HH
@@ -16,9 +16,22 @@
 #ifndef JRL_MATHTOOLS_FWD_HH
 # define JRL_MATHTOOLS_FWD_HH
 
+// MSVC reports 199711L unless /Zc:__cplusplus is given.
+# if __cplusplus < 201103L && !defined _MSC_VER
+#  error "jrl-mathtools requires C++11 (e.g. -std=c++11)."
+# endif //! __cplusplus < 201103L
+
 namespace jrlMathTools
 {
   class Angle;
+  class UnitComplex;
+  class AngleArray;
+
+  template <typename U>
+  class BinaryAngle;
+
+  class AngleUnwrapper;
+  class CircularStatistics;
 
   template <typename T>
   struct Vector3D;
@@ -26,12 +39,62 @@ namespace jrlMathTools
   template <typename T>
   struct Vector4D;
 
+  template <typename T>
+  struct Quaternion;
+
   template <typename T>
   struct Matrix3x3;
 
   template <typename T>
   struct Matrix4x4;
 
+  template <typename T, unsigned int R, unsigned int C>
+  struct MatrixRxC;
+
+  template <typename T, unsigned int N>
+  class LUDecomposition;
+
+  template <typename T, unsigned int N>
+  class CholeskyDecomposition;
+
+  template <typename T, unsigned int N>
+  class LDLTDecomposition;
+
+  template <typename T>
+  class SymmetricEigenDecomposition;
+
+  template <typename T>
+  class SingularValueDecomposition;
+
+  template <typename T>
+  class KinematicChain;
+
+  template <typename T>
+  class FrameTree;
+
+  template <unsigned int D>
+  class KdTree;
+
+  class PseudoInverseWorkspace;
+
+  class RandomStream;
+
+  template <typename Type>
+  class BinaryWriter;
+
+  template <typename Type>
+  class MappedArray;
+
+  class BinaryMapping;
+
+  class TrajectoryLayout;
+  class TrajectoryLogWriter;
+  class TrajectoryLog;
+
+  struct QuantizedVector3D;
+  struct QuantizedPose;
+  class Vector3Quantizer;
+
 } // end of namespace jrlMathTools.
 
 #endif //! JRL_MATHTOOLS_FWD_HH
@@ -15,10 +15,710 @@
 
 #ifndef JRL_MATHTOOLS_IO_HH
 # define JRL_MATHTOOLS_IO_HH
+# include <algorithm>
+# include <cstddef>
+# include <cstdint>
+# include <cstdio>
+# include <cstring>
 # include <iostream>
+# include <stdexcept>
+# include <string>
+# include <vector>
 
-namespace jrlMathtools
+# if defined _WIN32
+#  include <io.h>
+# else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+# endif //! _WIN32
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/format.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/vector4.hh>
+# include <jrl/mathtools/quaternion.hh>
+# include <jrl/mathtools/matrix3x3.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+# include <jrl/mathtools/matrixrxc.hh>
+# include <jrl/mathtools/matrixnxp.hh>
+
+// Binary files of fixed-size records.
+//
+// A file is a 64-byte BinaryHeader followed, from byte offset
+// m_alignment on, by contiguous records of m_rows x m_cols row-major
+// scalars in the byte order of the machine. The records of a mapped
+// file are thus directly an array of Matrix4x4, Vector3D, ... or of
+// row-major matrixNxP elements: reading involves no parsing and no
+// copy.
+//
+// Records are only ever appended and the header does not hold their
+// count, which is deduced from the file size: a file can be read while
+// it is being written, and a truncated last record, e.g. after a crash,
+// is ignored.
+//
+// The text counterpart of a record is a line of its rows x cols
+// numbers, written by formatText and read back by parseText.
+//
+// Files are mapped with mmap on POSIX systems. On Windows, they are
+// read into memory instead: the interface is the same, but opening a
+// file costs a copy of it.
+namespace jrlMathTools
 {
+  /// \brief Scalar type of the records of a binary file.
+  enum BinaryScalarType
+  {
+    BINARY_FLOAT32 = 1,
+    BINARY_FLOAT64 = 2
+  };
+
+  /// \brief Header of a binary file.
+  struct BinaryHeader
+  {
+    /// \brief "jrlmtbin".
+    char m_magic[8];
+    /// \brief 0x01020304 as written by the machine.
+    std::uint32_t m_byteOrder;
+    std::uint32_t m_version;
+    /// \brief A BinaryScalarType.
+    std::uint32_t m_scalarType;
+    std::uint32_t m_rows;
+    std::uint32_t m_cols;
+    /// \brief Offset of the first record, a multiple of 64.
+    std::uint32_t m_alignment;
+    std::uint8_t m_reserved[32];
+
+    static const std::uint32_t byteOrder = 0x01020304;
+    static const std::uint32_t version = 1;
+    static const std::uint32_t alignment = 64;
+
+    /// \brief Header of a new file.
+    static BinaryHeader make (BinaryScalarType scalarType,
+			      std::uint32_t rows, std::uint32_t cols)
+    {
+      BinaryHeader header;
+      std::memset (&header, 0, sizeof (header));
+      std::memcpy (header.m_magic, "jrlmtbin", 8);
+      header.m_byteOrder = byteOrder;
+      header.m_version = version;
+      header.m_scalarType = scalarType;
+      header.m_rows = rows;
+      header.m_cols = cols;
+      header.m_alignment = alignment;
+      return header;
+    }
+
+    /// \brief Size of a scalar, 0 for an unknown scalar type.
+    std::size_t scalarSize () const
+    {
+      return m_scalarType == BINARY_FLOAT32 ? 4
+	: m_scalarType == BINARY_FLOAT64 ? 8 : 0;
+    }
+
+    /// \brief Size of a record, in bytes.
+    std::size_t recordSize () const
+    {
+      return std::size_t (m_rows) * m_cols * scalarSize ();
+    }
+
+    /// \brief Whether this header can be read on this machine.
+    bool valid () const
+    {
+      return std::memcmp (m_magic, "jrlmtbin", 8) == 0
+	&& m_byteOrder == byteOrder
+	&& m_version == version
+	&& recordSize () > 0
+	&& m_alignment >= sizeof (BinaryHeader)
+	&& m_alignment % alignment == 0;
+    }
+
+    /// \brief Whether the records of both headers are the same.
+    bool sameRecords (const BinaryHeader& other) const
+    {
+      return m_scalarType == other.m_scalarType
+	&& m_rows == other.m_rows
+	&& m_cols == other.m_cols;
+    }
+  };
+
+  static_assert (sizeof (BinaryHeader) == 64,
+		 "BinaryHeader must be 64 bytes long");
+
+  /// \brief Scalar type tag of T.
+  template <typename T>
+  struct BinaryScalar;
+
+  template <>
+  struct BinaryScalar<float>
+  {
+    static const BinaryScalarType value = BINARY_FLOAT32;
+  };
+
+  template <>
+  struct BinaryScalar<double>
+  {
+    static const BinaryScalarType value = BINARY_FLOAT64;
+  };
+
+  /// \brief Record layout of a fixed-size type: its scalar type and
+  /// its shape. Quaternions are stored as (x, y, z, w).
+  template <typename Type>
+  struct BinaryTraits;
+
+  template <typename T, unsigned int R, unsigned int C>
+  struct BinaryRecord
+  {
+    typedef T scalar_type;
+    static const unsigned int rows = R;
+    static const unsigned int cols = C;
+  };
+
+  template <>
+  struct BinaryTraits<float> : BinaryRecord<float, 1, 1> {};
+
+  template <>
+  struct BinaryTraits<double> : BinaryRecord<double, 1, 1> {};
+
+  template <typename T>
+  struct BinaryTraits<Vector3D<T> > : BinaryRecord<T, 3, 1> {};
+
+  template <typename T>
+  struct BinaryTraits<Vector4D<T> > : BinaryRecord<T, 4, 1> {};
+
+  template <typename T>
+  struct BinaryTraits<Quaternion<T> > : BinaryRecord<T, 4, 1> {};
+
+  template <typename T>
+  struct BinaryTraits<Matrix3x3<T> > : BinaryRecord<T, 3, 3> {};
+
+  template <typename T>
+  struct BinaryTraits<Matrix4x4<T> > : BinaryRecord<T, 4, 4> {};
+
+  template <typename T, unsigned int R, unsigned int C>
+  struct BinaryTraits<MatrixRxC<T, R, C> > : BinaryRecord<T, R, C> {};
+
+  namespace detail
+  {
+    /// \brief Record layout of Type, checking that Type is exactly its
+    /// record.
+    template <typename Type>
+    struct PackedRecord : BinaryTraits<Type>
+    {
+      typedef BinaryTraits<Type> traits_t;
+      static const unsigned int size = traits_t::rows * traits_t::cols;
+      static_assert (sizeof (Type)
+		     == size * sizeof (typename traits_t::scalar_type),
+		     "the type must be a packed array of scalars");
+    };
+
+    /// \brief Header of Type records.
+    template <typename Type>
+    BinaryHeader binaryHeader ()
+    {
+      typedef PackedRecord<Type> record_t;
+      return BinaryHeader::make
+	(BinaryScalar<typename record_t::scalar_type>::value,
+	 record_t::rows, record_t::cols);
+    }
+
+    /// \brief Truncate an open file to length bytes.
+    inline bool truncateFile (std::FILE* file, std::size_t length)
+    {
+# if defined _WIN32
+      return ::_chsize_s (::_fileno (file), static_cast<__int64> (length))
+	== 0;
+# else
+      return ::ftruncate (fileno (file), off_t (length)) == 0;
+# endif //! _WIN32
+    }
+
+    /// \brief Map a whole file read-only, or return 0 if it cannot be
+    /// opened.
+    ///
+    /// \param length size of the file, set on success.
+    /// \param minimum files shorter than this are not mapped and
+    /// throw.
+    inline const char* mapFile (const std::string& path,
+				std::size_t& length, std::size_t minimum)
+    {
+# if defined _WIN32
+      std::FILE* file = std::fopen (path.c_str (), "rb");
+      if (!file)
+	return 0;
+      std::fseek (file, 0, SEEK_END);
+      const long end = std::ftell (file);
+      if (end < long (minimum))
+	{
+	  std::fclose (file);
+	  throw std::runtime_error (path + " is not a binary file");
+	}
+      length = std::size_t (end);
+      // Align the copy on 64 bytes, as a mapping on pages, and keep
+      // the offset of the allocation in the byte before.
+      char* allocation = new char[length + 64];
+      const std::size_t offset =
+	64 - reinterpret_cast<std::size_t> (allocation) % 64;
+      char* address = allocation + offset;
+      address[-1] = char (offset);
+      std::rewind (file);
+      const bool read = std::fread (address, 1, length, file) == length;
+      std::fclose (file);
+      if (!read)
+	{
+	  delete[] allocation;
+	  throw std::runtime_error ("cannot read " + path);
+	}
+      return address;
+# else
+      const int fd = ::open (path.c_str (), O_RDONLY);
+      if (fd < 0)
+	return 0;
+      struct stat status;
+      if (::fstat (fd, &status) != 0 || status.st_size < off_t (minimum))
+	{
+	  ::close (fd);
+	  throw std::runtime_error (path + " is not a binary file");
+	}
+      length = std::size_t (status.st_size);
+      void* address = ::mmap (0, length, PROT_READ, MAP_SHARED, fd, 0);
+      ::close (fd);
+      if (address == MAP_FAILED)
+	throw std::runtime_error ("cannot map " + path);
+      return static_cast<const char*> (address);
+# endif //! _WIN32
+    }
+
+    /// \brief Release a file mapped by mapFile.
+    inline void unmapFile (const char* address, std::size_t length)
+    {
+# if defined _WIN32
+      (void) length;
+      delete[] (address - static_cast<unsigned char> (address[-1]));
+# else
+      ::munmap (const_cast<char*> (address), length);
+# endif //! _WIN32
+    }
+
+    /// \brief Buffered appending of raw records to a binary file.
+    class BinaryFileWriter
+    {
+    public:
+      /// \brief Constructor.
+      /// \param metadata bytes stored between the header and the
+      /// first record of a new file, within header.m_alignment.
+      BinaryFileWriter (const std::string& path, const BinaryHeader& header,
+			bool append, const std::string& metadata = "")
+	: file_ (0),
+	  recordSize_ (header.recordSize ()),
+	  size_ (0)
+      {
+	if (!header.valid ()
+	    || sizeof (header) + metadata.size () > header.m_alignment)
+	  throw std::invalid_argument ("invalid binary record layout");
+	file_ = std::fopen (path.c_str (), append ? "ab+" : "wb");
+	if (!file_)
+	  throw std::runtime_error ("cannot open " + path);
+	std::setvbuf (file_, 0, _IOFBF, 1 << 20);
+	std::fseek (file_, 0, SEEK_END);
+	const long end = std::ftell (file_);
+	if (end > 0)
+	  {
+	    // Append to the records of an existing file.
+	    BinaryHeader existing;
+	    std::rewind (file_);
+	    if (std::fread (&existing, sizeof (existing), 1, file_) != 1
+		|| !existing.valid () || !existing.sameRecords (header)
+		|| std::size_t (end) < existing.m_alignment)
+	      {
+		std::fclose (file_);
+		throw std::runtime_error (path + " holds other records");
+	      }
+	    size_ = (std::size_t (end) - existing.m_alignment) / recordSize_;
+	    // Drop a truncated last record, so that new ones are aligned.
+	    const std::size_t length =
+	      existing.m_alignment + size_ * recordSize_;
+	    if (length != std::size_t (end)
+		&& !truncateFile (file_, length))
+	      {
+		std::fclose (file_);
+		throw std::runtime_error ("cannot truncate " + path);
+	      }
+	    std::fseek (file_, 0, SEEK_END);
+	    return;
+	  }
+	std::vector<char> padding (header.m_alignment - sizeof (header));
+	std::copy (metadata.begin (), metadata.end (), padding.begin ());
+	// An empty padding may have no storage: fwrite must not be
+	// given its null pointer.
+	if (std::fwrite (&header, sizeof (header), 1, file_) != 1
+	    || (padding.size () != 0
+		&& std::fwrite (padding.data (), 1, padding.size (), file_)
+		!= padding.size ()))
+	  {
+	    std::fclose (file_);
+	    throw std::runtime_error ("cannot write " + path);
+	  }
+      }
+
+      ~BinaryFileWriter ()
+      {
+	if (file_)
+	  std::fclose (file_);
+      }
+
+      /// \brief Append n records.
+      void write (const void* records, std::size_t n)
+      {
+	if (!file_)
+	  throw std::logic_error ("binary file is closed");
+	if (std::fwrite (records, recordSize_, n, file_) != n)
+	  throw std::runtime_error ("cannot write binary records");
+	size_ += n;
+      }
+
+      void flush ()
+      {
+	if (file_ && std::fflush (file_) != 0)
+	  throw std::runtime_error ("cannot write binary records");
+      }
+
+      void close ()
+      {
+	if (!file_)
+	  return;
+	const int status = std::fclose (file_);
+	file_ = 0;
+	if (status != 0)
+	  throw std::runtime_error ("cannot write binary records");
+      }
+
+      /// \brief Number of records in the file.
+      std::size_t size () const
+      {
+	return size_;
+      }
+
+    private:
+      BinaryFileWriter (const BinaryFileWriter&);
+      BinaryFileWriter& operator= (const BinaryFileWriter&);
+
+      std::FILE* file_;
+      std::size_t recordSize_;
+      std::size_t size_;
+    };
+  } // end of namespace detail.
+
+  /// \brief Writer appending Type records to a binary file.
+  ///
+  /// Writes are buffered; records are in the file once flush or close
+  /// has been called, or when the writer is destroyed.
+  template <typename Type>
+  class BinaryWriter
+  {
+  public:
+    /// \brief Constructor.
+    /// \param append if the file exists, append to its records instead
+    /// of truncating it. They must have the same layout.
+    explicit BinaryWriter (const std::string& path, bool append = false)
+      : file_ (path, detail::binaryHeader<Type> (), append)
+    {}
+
+    void write (const Type& record)
+    {
+      file_.write (&record, 1);
+    }
+
+    void write (const Type* records, std::size_t n)
+    {
+      file_.write (records, n);
+    }
+
+    void flush ()
+    {
+      file_.flush ();
+    }
+
+    void close ()
+    {
+      file_.close ();
+    }
+
+    /// \brief Number of records in the file.
+    std::size_t size () const
+    {
+      return file_.size ();
+    }
+
+  private:
+    detail::BinaryFileWriter file_;
+  };
+
+  /// \brief Writer of matrixNxP records, all of the same shape.
+  template <>
+  class BinaryWriter<matrixNxP>
+  {
+  public:
+    BinaryWriter (const std::string& path,
+		  std::size_t rows, std::size_t cols, bool append = false)
+      : file_ (path, BinaryHeader::make (BINARY_FLOAT64,
+					 std::uint32_t (rows),
+					 std::uint32_t (cols)), append),
+	rows_ (rows),
+	cols_ (cols)
+    {}
+
+    /// \brief Append a matrix, of the shape of the file.
+    void write (const matrixNxP& record)
+    {
+      if (record.size1 () != rows_ || record.size2 () != cols_)
+	throw std::invalid_argument ("bad matrix size");
+      file_.write (&record.data ()[0], 1);
+    }
+
+    void flush ()
+    {
+      file_.flush ();
+    }
+
+    void close ()
+    {
+      file_.close ();
+    }
+
+    /// \brief Number of records in the file.
+    std::size_t size () const
+    {
+      return file_.size ();
+    }
+
+  private:
+    detail::BinaryFileWriter file_;
+    std::size_t rows_;
+    std::size_t cols_;
+  };
+
+  /// \brief Read-only memory mapping of a binary file, or copy of it
+  /// on Windows.
+  ///
+  /// The records found when the file is mapped are valid as long as
+  /// the mapping lives.
+  class BinaryMapping
+  {
+  public:
+    explicit BinaryMapping (const std::string& path)
+      : address_ (0),
+	length_ (0),
+	size_ (0)
+    {
+      address_ = detail::mapFile (path, length_, sizeof (BinaryHeader));
+      if (!address_)
+	throw std::runtime_error ("cannot open " + path);
+      const BinaryHeader& h = header ();
+      if (!h.valid () || h.m_alignment > length_)
+	{
+	  detail::unmapFile (address_, length_);
+	  throw std::runtime_error (path + " is not a binary file");
+	}
+      size_ = (length_ - h.m_alignment) / h.recordSize ();
+    }
+
+    ~BinaryMapping ()
+    {
+      detail::unmapFile (address_, length_);
+    }
+
+    const BinaryHeader& header () const
+    {
+      return *reinterpret_cast<const BinaryHeader*> (address_);
+    }
+
+    /// \brief Number of complete records.
+    std::size_t size () const
+    {
+      return size_;
+    }
+
+    /// \brief Bytes between the header and the first record.
+    const char* metadata () const
+    {
+      return address_ + sizeof (BinaryHeader);
+    }
+
+    std::size_t metadataSize () const
+    {
+      return header ().m_alignment - sizeof (BinaryHeader);
+    }
+
+    /// \brief First record.
+    const void* data () const
+    {
+      return address_ + header ().m_alignment;
+    }
+
+  private:
+    BinaryMapping (const BinaryMapping&);
+    BinaryMapping& operator= (const BinaryMapping&);
+
+    const char* address_;
+    std::size_t length_;
+    std::size_t size_;
+  };
+
+  /// \brief Zero-copy view of the Type records of a binary file.
+  template <typename Type>
+  class MappedArray
+  {
+  public:
+    typedef const Type* const_iterator;
+
+    /// \brief Map a file, which must hold Type records.
+    explicit MappedArray (const std::string& path)
+      : mapping_ (path)
+    {
+      if (!mapping_.header ().sameRecords (detail::binaryHeader<Type> ()))
+	throw std::runtime_error (path + " holds other records");
+    }
+
+    std::size_t size () const
+    {
+      return mapping_.size ();
+    }
+
+    bool empty () const
+    {
+      return size () == 0;
+    }
+
+    const Type* data () const
+    {
+      return static_cast<const Type*> (mapping_.data ());
+    }
+
+    const Type& operator[] (std::size_t i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return data ()[i];
+    }
+
+    const_iterator begin () const
+    {
+      return data ();
+    }
+
+    const_iterator end () const
+    {
+      return data () + size ();
+    }
+
+  private:
+    BinaryMapping mapping_;
+  };
+
+  /// \brief Zero-copy view of the matrixNxP records of a binary file:
+  /// each one is a row-major array of rows () x cols () doubles.
+  template <>
+  class MappedArray<matrixNxP>
+  {
+  public:
+    explicit MappedArray (const std::string& path)
+      : mapping_ (path)
+    {
+      if (mapping_.header ().m_scalarType != BINARY_FLOAT64)
+	throw std::runtime_error (path + " holds other records");
+    }
+
+    std::size_t size () const
+    {
+      return mapping_.size ();
+    }
+
+    bool empty () const
+    {
+      return size () == 0;
+    }
+
+    std::size_t rows () const
+    {
+      return mapping_.header ().m_rows;
+    }
+
+    std::size_t cols () const
+    {
+      return mapping_.header ().m_cols;
+    }
+
+    /// \brief Elements of record i, row-major.
+    const double* operator[] (std::size_t i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return static_cast<const double*> (mapping_.data ())
+	+ i * rows () * cols ();
+    }
+
+    /// \brief Copy of record i.
+    matrixNxP matrix (std::size_t i) const
+    {
+      const double* elements = (*this)[i];
+      matrixNxP result (rows (), cols ());
+      std::copy (elements, elements + rows () * cols (),
+		 result.data ().begin ());
+      return result;
+    }
+
+  private:
+    BinaryMapping mapping_;
+  };
+
+  /// \brief Write a record as a line of text: its rows x cols numbers
+  /// separated by spaces. The stream is not flushed.
+  /// \param precision number of significant digits, the shortest
+  /// representation that parses back exactly by default.
+  template <typename Type>
+  std::ostream& formatText (std::ostream& os, const Type& record,
+			    int precision = ROUND_TRIP_PRECISION)
+  {
+    typedef detail::PackedRecord<Type> record_t;
+    typedef typename record_t::scalar_type scalar_t;
+    return formatRows (os, reinterpret_cast<const scalar_t*> (&record),
+		       1, record_t::size, precision);
+  }
+
+  /// \brief Write a matrix as a line of text, row-major.
+  inline std::ostream& formatText (std::ostream& os, const matrixNxP& record,
+				   int precision = ROUND_TRIP_PRECISION)
+  {
+    return formatRows (os, record.data ().begin (), 1,
+		       (unsigned int) (record.size1 () * record.size2 ()),
+		       precision);
+  }
+
+  /// \brief Parse a record written by formatText, or any rows x cols
+  /// numbers separated by white spaces.
+  ///
+  /// \return the end of the record, or 0 on error.
+  template <typename Type>
+  const char* parseText (const char* first, const char* last, Type& record)
+  {
+    typedef detail::PackedRecord<Type> record_t;
+    typedef typename record_t::scalar_type scalar_t;
+    return parseNumbers (first, last, reinterpret_cast<scalar_t*> (&record),
+			 record_t::size);
+  }
+
+  /// \brief Parse a matrix written by formatText. The matrix must
+  /// already have its size.
+  inline const char* parseText (const char* first, const char* last,
+				matrixNxP& record)
+  {
+    return parseNumbers (first, last, record.data ().begin (),
+			 record.size1 () * record.size2 ());
+  }
+
 } // end of namespace jrlMathTools.
 
 #endif //! JRL_MATHTOOLS_IO_HH
@@ -0,0 +1,184 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_KINEMATICCHAIN_HH
+# define JRL_MATHTOOLS_KINEMATICCHAIN_HH
+# include <algorithm>
+# include <cstddef>
+# include <iterator>
+# include <stdexcept>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Serial chain of rigid links with incremental forward
+  /// kinematics.
+  ///
+  /// Link i stores its transformation relative to link i - 1 (or to
+  /// the base for the first link) and caches its transformation
+  /// relative to the world frame.
+  ///
+  /// Changing a local transformation only marks the world
+  /// transformations from that link onward as dirty. Since a link
+  /// depends on all its predecessors, the dirty flags of a chain
+  /// always form a suffix and are stored as the length of the clean
+  /// prefix. World transformations are recomputed lazily, up to the
+  /// requested link, so several joint updates between two queries
+  /// share a single pass starting at the first modified link.
+  ///
+  /// Transformations are homogeneous rigid (or affine) matrices: their
+  /// last row is taken to be (0, 0, 0, 1).
+  ///
+  /// Queries update the cache and are therefore not thread-safe, even
+  /// though they are const.
+  template <typename T>
+  class KinematicChain
+  {
+  public:
+    typedef Matrix4x4<T> matrix_t;
+
+    /// \brief Chain of n links with identity transformations.
+    explicit KinematicChain (std::size_t n = 0)
+      : base_ (identity ()),
+	local_ (n, identity ()),
+	world_ (n, identity ()),
+	clean_ (n)
+    {}
+
+    /// \brief Number of links.
+    std::size_t size () const
+    {
+      return local_.size ();
+    }
+
+    /// \brief Append a link, return its index.
+    std::size_t addLink (const matrix_t& local)
+    {
+      local_.push_back (local);
+      world_.push_back (matrix_t ());
+      return local_.size () - 1;
+    }
+
+    /// \brief Transformation of the chain base in the world frame.
+    const matrix_t& base () const
+    {
+      return base_;
+    }
+
+    /// \brief Move the base, every link becomes dirty.
+    void setBase (const matrix_t& base)
+    {
+      base_ = base;
+      clean_ = 0;
+    }
+
+    /// \brief Transformation of link i relative to its parent.
+    const matrix_t& local (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return local_[i];
+    }
+
+    /// \brief Change the transformation of link i relative to its
+    /// parent, links i and after become dirty.
+    void setLocal (std::size_t i, const matrix_t& local)
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      local_[i] = local;
+      clean_ = std::min (clean_, i);
+    }
+
+    /// \brief Change the local transformations of links
+    /// first, first + 1, ... from a range, with a single invalidation.
+    ///
+    /// The range is traversed twice, to check its length first.
+    ///
+    /// \throw std::invalid_argument if the range goes past the last
+    /// link; no transformation is changed then.
+    template <typename ForwardIterator>
+    void setLocals (std::size_t first,
+		    ForwardIterator begin, ForwardIterator end)
+    {
+      const std::size_t n =
+	static_cast<std::size_t> (std::distance (begin, end));
+      if (first > size () || n > size () - first)
+	throw std::invalid_argument ("range past the last link");
+      std::copy (begin, end, local_.begin () + first);
+      if (n > 0)
+	clean_ = std::min (clean_, first);
+    }
+
+    /// \brief Transformation of link i in the world frame.
+    ///
+    /// Only the dirty links up to i are recomputed.
+    const matrix_t& world (std::size_t i) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      if (clean_ <= i)
+	update (i + 1);
+      return world_[i];
+    }
+
+    /// \brief Transformation of the last link in the world frame.
+    const matrix_t& end () const
+    {
+      if (local_.empty ())
+	throw std::logic_error ("empty kinematic chain");
+      return world (size () - 1);
+    }
+
+    /// \brief Recompute every dirty world transformation.
+    void update () const
+    {
+      update (size ());
+    }
+
+    /// \brief Number of leading links whose world transformation is
+    /// up to date.
+    std::size_t upToDate () const
+    {
+      return clean_;
+    }
+
+  private:
+    static matrix_t identity ()
+    {
+      matrix_t I;
+      I.setIdentity ();
+      return I;
+    }
+
+    /// \brief Make the first n world transformations up to date.
+    void update (std::size_t n) const
+    {
+      for (std::size_t i = clean_; i < n; ++i)
+	(i == 0 ? base_ : world_[i - 1]).CeqthismulBAffine (local_[i],
+							    world_[i]);
+      clean_ = std::max (clean_, n);
+    }
+
+    matrix_t base_;
+    std::vector<matrix_t> local_;
+    mutable std::vector<matrix_t> world_;
+    mutable std::size_t clean_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_KINEMATICCHAIN_HH
@@ -0,0 +1,419 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_LIEGROUPS_HH
+# define JRL_MATHTOOLS_LIEGROUPS_HH
+# include <cmath>
+# include <cstddef>
+# include <limits>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/matrix3x3.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+# include <jrl/mathtools/quaternion.hh>
+
+// Exponential and logarithm maps of SO(3) and SE(3).
+//
+// A rotation is represented by its rotation vector w (axis times
+// angle), a rigid transformation by its twist (v, w), v being the
+// linear part. expSE3 (v, w) is the transformation reached after a
+// unit time at the constant body velocity (v, w).
+//
+// Below a small angle, the coefficients are evaluated with their
+// Taylor expansions, which avoids the trigonometric functions and the
+// divisions by the angle. The batched exponentials process four
+// twists at a time when Simd4 is available.
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Square of the angle below which Taylor expansions are
+    /// used: their truncation error is then below the epsilon.
+    template <typename T>
+    T smallAngleThreshold ()
+    {
+      static const T threshold =
+	std::cbrt (std::numeric_limits<T>::epsilon ());
+      return threshold;
+    }
+
+    /// \brief Exponential map kernels, written once against the
+    /// ScalarOps / Simd4 interface.
+    template <typename T, typename V>
+    struct ExponentialMap
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+
+      /// \brief Coefficients of the exponential of w, theta2 being
+      /// |w|^2:
+      ///   exp ([w]) = c I + a [w] + b w w^T
+      ///   V (w) = a I + b [w] + d w w^T
+      /// with c = cos (theta), a = sin (theta) / theta,
+      /// b = (1 - cos (theta)) / theta^2 and
+      /// d = (theta - sin (theta)) / theta^3.
+      static void coefficients (v_t theta2, v_t& c, v_t& a, v_t& b, v_t& d)
+      {
+	const v_t one = V::set1 (T (1));
+	c = V::fma (V::fma (theta2, V::set1 (T (1. / 24.)),
+			    V::set1 (T (-1. / 2.))), theta2, one);
+	a = V::fma (V::fma (theta2, V::set1 (T (1. / 120.)),
+			    V::set1 (T (-1. / 6.))), theta2, one);
+	b = V::fma (V::fma (theta2, V::set1 (T (1. / 720.)),
+			    V::set1 (T (-1. / 24.))), theta2,
+		    V::set1 (T (1. / 2.)));
+	d = V::fma (V::fma (theta2, V::set1 (T (1. / 5040.)),
+			    V::set1 (T (-1. / 120.))), theta2,
+		    V::set1 (T (1. / 6.)));
+	const m_t small =
+	  V::lt (theta2, V::set1 (smallAngleThreshold<T> ()));
+	if (V::all (small))
+	  return;
+
+	// Half-angle formulas: 1 - cos (theta) = 2 sin^2 (theta / 2)
+	// does not cancel for small angles.
+	const v_t theta = V::sqrt (V::select (small, one, theta2));
+	v_t sh, ch;
+	SinCos<T, V>::run (V::mul (theta, V::set1 (T (0.5))), sh, ch);
+	const v_t inv = V::div (one, theta);
+	const v_t sinTheta = V::mul (V::set1 (T (2)), V::mul (sh, ch));
+	const v_t oneMinusCos = V::mul (V::set1 (T (2)), V::mul (sh, sh));
+	c = V::select (small, c, V::sub (one, oneMinusCos));
+	a = V::select (small, a, V::mul (sinTheta, inv));
+	b = V::select (small, b, V::mul (oneMinusCos, V::mul (inv, inv)));
+	d = V::select (small, d,
+		       V::mul (V::sub (theta, sinTheta),
+			       V::mul (inv, V::mul (inv, inv))));
+      }
+
+      /// \brief r = exp ([w]) as a row-major 3x3 matrix.
+      static void rotation (const v_t* w, v_t c, v_t a, v_t b, v_t* r)
+      {
+	const v_t bx = V::mul (b, w[0]);
+	const v_t by = V::mul (b, w[1]);
+	const v_t bz = V::mul (b, w[2]);
+	const v_t ax = V::mul (a, w[0]);
+	const v_t ay = V::mul (a, w[1]);
+	const v_t az = V::mul (a, w[2]);
+	const v_t bxy = V::mul (bx, w[1]);
+	const v_t bxz = V::mul (bx, w[2]);
+	const v_t byz = V::mul (by, w[2]);
+	r[0] = V::fma (bx, w[0], c);
+	r[1] = V::sub (bxy, az);
+	r[2] = V::add (bxz, ay);
+	r[3] = V::add (bxy, az);
+	r[4] = V::fma (by, w[1], c);
+	r[5] = V::sub (byz, ax);
+	r[6] = V::sub (bxz, ay);
+	r[7] = V::add (byz, ax);
+	r[8] = V::fma (bz, w[2], c);
+      }
+
+      static void so3 (const v_t* w, v_t* r)
+      {
+	const v_t theta2 = V::fma (w[0], w[0],
+				   V::fma (w[1], w[1], V::mul (w[2], w[2])));
+	v_t c, a, b, d;
+	coefficients (theta2, c, a, b, d);
+	rotation (w, c, a, b, r);
+      }
+
+      /// \brief r = exp ([w]) and p = V (w) v.
+      static void se3 (const v_t* v, const v_t* w, v_t* r, v_t* p)
+      {
+	const v_t theta2 = V::fma (w[0], w[0],
+				   V::fma (w[1], w[1], V::mul (w[2], w[2])));
+	v_t c, a, b, d;
+	coefficients (theta2, c, a, b, d);
+	rotation (w, c, a, b, r);
+
+	// p = a v + b w x v + d (w.v) w.
+	const v_t dwv = V::mul (d, V::fma (w[0], v[0],
+					   V::fma (w[1], v[1],
+						   V::mul (w[2], v[2]))));
+	const v_t cx = V::sub (V::mul (w[1], v[2]), V::mul (w[2], v[1]));
+	const v_t cy = V::sub (V::mul (w[2], v[0]), V::mul (w[0], v[2]));
+	const v_t cz = V::sub (V::mul (w[0], v[1]), V::mul (w[1], v[0]));
+	p[0] = V::fma (a, v[0], V::fma (b, cx, V::mul (dwv, w[0])));
+	p[1] = V::fma (a, v[1], V::fma (b, cy, V::mul (dwv, w[1])));
+	p[2] = V::fma (a, v[2], V::fma (b, cz, V::mul (dwv, w[2])));
+      }
+    };
+
+    template <typename T>
+    void setRotation (const T* r, Matrix3x3<T>& R)
+    {
+      for (unsigned int k = 0; k < 9; ++k)
+	R.m[k] = r[k];
+    }
+
+    template <typename T>
+    void setTransformation (const T* r, const T* p, Matrix4x4<T>& M)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+	{
+	  for (unsigned int j = 0; j < 3; ++j)
+	    M.m[4 * i + j] = r[3 * i + j];
+	  M.m[4 * i + 3] = p[i];
+	}
+      M.m[12] = M.m[13] = M.m[14] = T ();
+      M.m[15] = T (1);
+    }
+
+    /// \brief Batched exponentials of the first twists of arrays, four
+    /// at a time, return how many were processed.
+    template <typename T, bool Vectorized = HasSimd4<T>::value>
+    struct ExponentialSimd4
+    {
+      static std::size_t so3 (const Vector3D<T>*, Matrix3x3<T>*, std::size_t)
+      {
+	return 0;
+      }
+
+      static std::size_t se3 (const Vector3D<T>*, const Vector3D<T>*,
+			      Matrix4x4<T>*, std::size_t)
+      {
+	return 0;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <typename T>
+    struct ExponentialSimd4<T, true>
+    {
+      typedef Simd4<T> V;
+      typedef typename V::type v_t;
+
+      /// \brief Coordinates of u[0..3], one register per coordinate.
+      static void gather (const Vector3D<T>* u, v_t* out)
+      {
+	out[0] = V::set (u[0].m_x, u[1].m_x, u[2].m_x, u[3].m_x);
+	out[1] = V::set (u[0].m_y, u[1].m_y, u[2].m_y, u[3].m_y);
+	out[2] = V::set (u[0].m_z, u[1].m_z, u[2].m_z, u[3].m_z);
+      }
+
+      /// \brief Transpose n registers into four arrays of n values.
+      static void scatter (const v_t* in, unsigned int n, T (*out)[12])
+      {
+	T lanes[4];
+	for (unsigned int k = 0; k < n; ++k)
+	  {
+	    V::store (lanes, in[k]);
+	    for (unsigned int l = 0; l < 4; ++l)
+	      out[l][k] = lanes[l];
+	  }
+      }
+
+      static std::size_t so3 (const Vector3D<T>* w, Matrix3x3<T>* R,
+			      std::size_t n)
+      {
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t wv[3], r[9];
+	    gather (w + i, wv);
+	    ExponentialMap<T, V>::so3 (wv, r);
+	    T out[4][12];
+	    scatter (r, 9, out);
+	    for (unsigned int l = 0; l < 4; ++l)
+	      setRotation (out[l], R[i + l]);
+	  }
+	return i;
+      }
+
+      static std::size_t se3 (const Vector3D<T>* v, const Vector3D<T>* w,
+			      Matrix4x4<T>* M, std::size_t n)
+      {
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    v_t vv[3], wv[3], rp[12];
+	    gather (v + i, vv);
+	    gather (w + i, wv);
+	    ExponentialMap<T, V>::se3 (vv, wv, rp, rp + 9);
+	    T out[4][12];
+	    scatter (rp, 12, out);
+	    for (unsigned int l = 0; l < 4; ++l)
+	      setTransformation (out[l], out[l] + 9, M[i + l]);
+	  }
+	return i;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Rotation vector w of the rotation represented by the
+    /// quaternion q, which must have a non-negative real part but
+    /// needs not be normalized.
+    ///
+    /// Also computes (theta / 2) cot (theta / 2), theta being the
+    /// angle, for the logarithm of SE(3).
+    template <typename T>
+    void logQuaternion (const Quaternion<T>& q, T* w, T& halfCot)
+    {
+      const T n2 = q.m_x * q.m_x + q.m_y * q.m_y + q.m_z * q.m_z;
+      const T w2 = q.m_w * q.m_w;
+
+      // w = 2 atan (n / q.w) / n (x, y, z), n being the norm of the
+      // imaginary part.
+      T k;
+      if (n2 < smallAngleThreshold<T> () * w2)
+	{
+	  const T r2 = n2 / w2;
+	  k = 2 / q.m_w * (1 + r2 * (T (-1. / 3.) + r2 * T (1. / 5.)));
+	}
+      else
+	{
+	  const T n = std::sqrt (n2);
+	  k = 2 * std::atan2 (n, q.m_w) / n;
+	}
+      w[0] = k * q.m_x;
+      w[1] = k * q.m_y;
+      w[2] = k * q.m_z;
+      halfCot = k * q.m_w / 2;
+    }
+
+    template <typename T>
+    void logTransformation (const Matrix4x4<T>& M, T* v, T* w)
+    {
+      const Quaternion<T> q (Matrix3x3<T> (M.m[0], M.m[1], M.m[2],
+					   M.m[4], M.m[5], M.m[6],
+					   M.m[8], M.m[9], M.m[10]));
+      T halfCot;
+      logQuaternion (q, w, halfCot);
+
+      // V (w)^-1 = h I - [w] / 2 + e w w^T, with
+      // h = (theta / 2) cot (theta / 2) and e = (1 - h) / theta^2.
+      const T theta2 = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+      const T e = theta2 < smallAngleThreshold<T> ()
+	? T (1. / 12.) + theta2 * (T (1. / 720.) + theta2 * T (1. / 30240.))
+	: (1 - halfCot) / theta2;
+      const T t[3] = {M.m[3], M.m[7], M.m[11]};
+      const T ewt = e * (w[0] * t[0] + w[1] * t[1] + w[2] * t[2]);
+      v[0] = halfCot * t[0] - (w[1] * t[2] - w[2] * t[1]) / 2 + ewt * w[0];
+      v[1] = halfCot * t[1] - (w[2] * t[0] - w[0] * t[2]) / 2 + ewt * w[1];
+      v[2] = halfCot * t[2] - (w[0] * t[1] - w[1] * t[0]) / 2 + ewt * w[2];
+    }
+  } // end of namespace detail.
+
+  /// \brief Rotation matrix of the rotation vector w.
+  template <typename T>
+  Matrix3x3<T> expSO3 (const Vector3D<T>& w)
+  {
+    const T wv[3] = {w.m_x, w.m_y, w.m_z};
+    T r[9];
+    detail::ExponentialMap<T, detail::ScalarOps<T> >::so3 (wv, r);
+    return Matrix3x3<T> (r[0], r[1], r[2],
+			 r[3], r[4], r[5],
+			 r[6], r[7], r[8]);
+  }
+
+  /// \brief Rotation vector of the rotation matrix R.
+  ///
+  /// The angle of the result lies in [0, pi]. R is expected to be
+  /// orthonormal.
+  template <typename T>
+  Vector3D<T> logSO3 (const Matrix3x3<T>& R)
+  {
+    T w[3];
+    T halfCot;
+    detail::logQuaternion (Quaternion<T> (R), w, halfCot);
+    return Vector3D<T> (w[0], w[1], w[2]);
+  }
+
+  /// \brief Rigid transformation of the twist (v, w).
+  template <typename T>
+  Matrix4x4<T> expSE3 (const Vector3D<T>& v, const Vector3D<T>& w)
+  {
+    const T vv[3] = {v.m_x, v.m_y, v.m_z};
+    const T wv[3] = {w.m_x, w.m_y, w.m_z};
+    T r[9];
+    T p[3];
+    detail::ExponentialMap<T, detail::ScalarOps<T> >::se3 (vv, wv, r, p);
+    Matrix4x4<T> M;
+    detail::setTransformation (r, p, M);
+    return M;
+  }
+
+  /// \brief Twist (v, w) of the rigid transformation M.
+  ///
+  /// The angle of w lies in [0, pi]. The rotation part of M is
+  /// expected to be orthonormal.
+  template <typename T>
+  void logSE3 (const Matrix4x4<T>& M, Vector3D<T>& v, Vector3D<T>& w)
+  {
+    T vv[3];
+    T wv[3];
+    detail::logTransformation (M, vv, wv);
+    v = Vector3D<T> (vv[0], vv[1], vv[2]);
+    w = Vector3D<T> (wv[0], wv[1], wv[2]);
+  }
+
+  /// \brief Batched expSO3: R[i] = expSO3 (w[i]).
+  template <typename T>
+  void expSO3 (const Vector3D<T>* w, Matrix3x3<T>* R, std::size_t n)
+  {
+    typedef detail::ExponentialMap<T, detail::ScalarOps<T> > scalar_t;
+    std::size_t i = detail::ExponentialSimd4<T>::so3 (w, R, n);
+    for (; i < n; ++i)
+      {
+	const T wv[3] = {w[i].m_x, w[i].m_y, w[i].m_z};
+	T r[9];
+	scalar_t::so3 (wv, r);
+	detail::setRotation (r, R[i]);
+      }
+  }
+
+  /// \brief Batched logSO3: w[i] = logSO3 (R[i]).
+  template <typename T>
+  void logSO3 (const Matrix3x3<T>* R, Vector3D<T>* w, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      w[i] = logSO3 (R[i]);
+  }
+
+  /// \brief Batched expSE3: M[i] = expSE3 (v[i], w[i]).
+  template <typename T>
+  void expSE3 (const Vector3D<T>* v, const Vector3D<T>* w, Matrix4x4<T>* M,
+	       std::size_t n)
+  {
+    typedef detail::ExponentialMap<T, detail::ScalarOps<T> > scalar_t;
+    std::size_t i = detail::ExponentialSimd4<T>::se3 (v, w, M, n);
+    for (; i < n; ++i)
+      {
+	const T vv[3] = {v[i].m_x, v[i].m_y, v[i].m_z};
+	const T wv[3] = {w[i].m_x, w[i].m_y, w[i].m_z};
+	T r[9];
+	T p[3];
+	scalar_t::se3 (vv, wv, r, p);
+	detail::setTransformation (r, p, M[i]);
+      }
+  }
+
+  /// \brief Batched logSE3: (v[i], w[i]) = logSE3 (M[i]).
+  template <typename T>
+  void logSE3 (const Matrix4x4<T>* M, Vector3D<T>* v, Vector3D<T>* w,
+	       std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      logSE3 (M[i], v[i], w[i]);
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_LIEGROUPS_HH
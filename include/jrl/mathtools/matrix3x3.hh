@@ -17,6 +17,9 @@
 # define JRL_MATHTOOLS_MATRIX3x3_HH
 # include <stdexcept>
 # include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/format.hh>
+# include <jrl/mathtools/solvers.hh>
 # include <jrl/mathtools/vector3.hh>
 
 namespace jrlMathTools
@@ -32,79 +35,69 @@ namespace jrlMathTools
     T m[9];
 
     /// Default constructor.
-    Matrix3x3<T> ()
-    {
-      m[0]=T (); m[1] = T (); m[2]=T ();
-      m[3]=T (); m[4] = T (); m[5]=T ();
-      m[6]=T (); m[7] = T (); m[8]=T ();
-    }
+    constexpr Matrix3x3<T> ()
+      : m ()
+    {}
 
     /// \brief Constructor form a scalar.
-    Matrix3x3<T> (const T x)
-    {
-      m[0]=x; m[1] = x; m[2]=x;
-      m[3]=x; m[4] = x; m[5]=x;
-      m[6]=x; m[7] = x; m[8]=x;
-    }
+    constexpr Matrix3x3<T> (const T x)
+      : m {x, x, x,
+	   x, x, x,
+	   x, x, x}
+    {}
 
     /// \brief Constructor from 9 scalars.
-    explicit Matrix3x3<T> (
-			   const T x0, const T x1, const T x2,
-			   const T x3, const T x4, const T x5,
-			   const T x6, const T x7, const T x8
-			   )
-    {
-      m[0]=x0; m[1] = x1; m[2]=x2;
-      m[3]=x3; m[4] = x4; m[5]=x5;
-      m[6]=x6; m[7] = x7; m[8]=x8;
-    }
-
-    /// \brief Copy constructor.
-    Matrix3x3<T> (const Matrix3x3<T>& v)
-    {
-      m[0] = v.m[0]; m[1] = v.m[1]; m[2] = v.m[2];
-      m[3] = v.m[3]; m[4] = v.m[4]; m[5] = v.m[5];
-      m[6] = v.m[6]; m[7] = v.m[7]; m[8] = v.m[8];
-    }
+    constexpr explicit Matrix3x3<T> (
+				     const T x0, const T x1, const T x2,
+				     const T x3, const T x4, const T x5,
+				     const T x6, const T x7, const T x8
+				     )
+      : m {x0, x1, x2,
+	   x3, x4, x5,
+	   x6, x7, x8}
+    {}
 
     /// \brief Hybrid copy constructor.
+    ///
+    /// Copy and assignment between matrices of the same type are the
+    /// implicit ones so that the matrix stays trivially copyable.
     template <typename T2>
-    Matrix3x3<T> (const Matrix3x3<T2>& v)
-    {
-      m[0] = v.m[0]; m[1] = v.m[1]; m[2] = v.m[2];
-      m[3] = v.m[3]; m[4] = v.m[4]; m[5] = v.m[5];
-      m[6] = v.m[6]; m[7] = v.m[7]; m[8] = v.m[8];
-    }
+    constexpr Matrix3x3<T> (const Matrix3x3<T2>& v)
+      : m {static_cast<T> (v.m[0]), static_cast<T> (v.m[1]),
+	   static_cast<T> (v.m[2]), static_cast<T> (v.m[3]),
+	   static_cast<T> (v.m[4]), static_cast<T> (v.m[5]),
+	   static_cast<T> (v.m[6]), static_cast<T> (v.m[7]),
+	   static_cast<T> (v.m[8])}
+    {}
 
     /// \brief i-th element considering the matrix as an array.
-    inline T& operator[] (unsigned int i)
+    inline T& operator[] (unsigned int i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 9)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 9);
       return m[i];
     }
 
     /// \brief i-th element considering the matrix as an array.
     inline const T& operator[] (unsigned int i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 9)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 9);
       return m[i];
     }
 
     /// \brief Access by giving the (i,j) element.
     inline T& operator() (unsigned int i, unsigned int j)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 3 || j >= 3)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 3 && j < 3);
       return m[3*i+j];
     }
 
     /// \brief Access by giving the (i,j) element.
     inline const T & operator() (unsigned int i, unsigned int j) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 3 || j >= 3)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 3 && j < 3);
       return m[3*i+j];
     }
 
@@ -125,39 +118,36 @@ namespace jrlMathTools
     }
 
     /// \brief Adition operator.
-    Matrix3x3<T> operator+(const Matrix3x3<T> & B) const
+    constexpr Matrix3x3<T> operator+(const Matrix3x3<T> & B) const
     {
-      Matrix3x3<T> A;
-      A.m[0] = m[0] + B.m[0]; A.m[1] = m[1] + B.m[1]; A.m[2] = m[2] + B.m[2];
-      A.m[3] = m[3] + B.m[3]; A.m[4] = m[4] + B.m[4]; A.m[5] = m[5] + B.m[5];
-      A.m[6] = m[6] + B.m[6]; A.m[7] = m[7] + B.m[7]; A.m[8] = m[8] + B.m[8];
-      return A;
+      return Matrix3x3<T>
+	(m[0] + B.m[0], m[1] + B.m[1], m[2] + B.m[2],
+	 m[3] + B.m[3], m[4] + B.m[4], m[5] + B.m[5],
+	 m[6] + B.m[6], m[7] + B.m[7], m[8] + B.m[8]);
     }
 
     /// \brief Substraction operator.
-    Matrix3x3<T>  operator-(const Matrix3x3<T> &B) const
+    constexpr Matrix3x3<T>  operator-(const Matrix3x3<T> &B) const
     {
-      Matrix3x3<T> A;
-      A.m[0] = m[0] - B.m[0]; A.m[1] = m[1] - B.m[1]; A.m[2] = m[2] - B.m[2];
-      A.m[3] = m[3] - B.m[3]; A.m[4] = m[4] - B.m[4]; A.m[5] = m[5] - B.m[5];
-      A.m[6] = m[6] - B.m[6]; A.m[7] = m[7] - B.m[7]; A.m[8] = m[8] - B.m[8];
-      return A;
+      return Matrix3x3<T>
+	(m[0] - B.m[0], m[1] - B.m[1], m[2] - B.m[2],
+	 m[3] - B.m[3], m[4] - B.m[4], m[5] - B.m[5],
+	 m[6] - B.m[6], m[7] - B.m[7], m[8] - B.m[8]);
     }
 
     /// \brief Multiplication operator with another matrix.
-    Matrix3x3<T>  operator* (const Matrix3x3<T> &B) const
+    constexpr Matrix3x3<T>  operator* (const Matrix3x3<T> &B) const
     {
-      Matrix3x3<T> A;
-      A.m[0] = m[0] * B.m[0] + m[1] * B.m[3] + m[2] * B.m[6];
-      A.m[1] = m[0] * B.m[1] + m[1] * B.m[4] + m[2] * B.m[7];
-      A.m[2] = m[0] * B.m[2] + m[1] * B.m[5] + m[2] * B.m[8];
-      A.m[3] = m[3] * B.m[0] + m[4] * B.m[3] + m[5] * B.m[6];
-      A.m[4] = m[3] * B.m[1] + m[4] * B.m[4] + m[5] * B.m[7];
-      A.m[5] = m[3] * B.m[2] + m[4] * B.m[5] + m[5] * B.m[8];
-      A.m[6] = m[6] * B.m[0] + m[7] * B.m[3] + m[8] * B.m[6];
-      A.m[7] = m[6] * B.m[1] + m[7] * B.m[4] + m[8] * B.m[7];
-      A.m[8] = m[6] * B.m[2] + m[7] * B.m[5] + m[8] * B.m[8];
-      return A;
+      return Matrix3x3<T>
+	(m[0] * B.m[0] + m[1] * B.m[3] + m[2] * B.m[6],
+	 m[0] * B.m[1] + m[1] * B.m[4] + m[2] * B.m[7],
+	 m[0] * B.m[2] + m[1] * B.m[5] + m[2] * B.m[8],
+	 m[3] * B.m[0] + m[4] * B.m[3] + m[5] * B.m[6],
+	 m[3] * B.m[1] + m[4] * B.m[4] + m[5] * B.m[7],
+	 m[3] * B.m[2] + m[4] * B.m[5] + m[5] * B.m[8],
+	 m[6] * B.m[0] + m[7] * B.m[3] + m[8] * B.m[6],
+	 m[6] * B.m[1] + m[7] * B.m[4] + m[8] * B.m[7],
+	 m[6] * B.m[2] + m[7] * B.m[5] + m[8] * B.m[8]);
     }
 
     void CeqthismulB (const Matrix3x3<T> &B, Matrix3x3<T> &C) const
@@ -174,19 +164,12 @@ namespace jrlMathTools
     }
 
     /// \brief Multiplication operator with a constant.
-    Matrix3x3<T> operator * (const T& r) const
+    constexpr Matrix3x3<T> operator * (const T& r) const
     {
-      Matrix3x3<T> result;
-      result.m[0] = m[0] * r;
-      result.m[1] = m[1] * r;
-      result.m[2] = m[2] * r;
-      result.m[3] = m[3] * r;
-      result.m[4] = m[4] * r;
-      result.m[5] = m[5] * r;
-      result.m[6] = m[6] * r;
-      result.m[7] = m[7] * r;
-      result.m[8] = m[8] * r;
-      return result;
+      return Matrix3x3<T>
+	(m[0] * r, m[1] * r, m[2] * r,
+	 m[3] * r, m[4] * r, m[5] * r,
+	 m[6] * r, m[7] * r, m[8] * r);
     }
 
 # ifdef MAL_S3_VECTOR_TYPE
@@ -210,13 +193,11 @@ namespace jrlMathTools
 # endif // MAL_S3_VECTOR_
 
     /// \brief Transposition.
-    Matrix3x3<T> Transpose () const
+    constexpr Matrix3x3<T> Transpose () const
     {
-      Matrix3x3<T> A;
-      A.m[0] = m[0]; A.m[1] = m[3]; A.m[2] = m[6];
-      A.m[3] = m[1]; A.m[4] = m[4]; A.m[5] = m[7];
-      A.m[6] = m[2]; A.m[7] = m[5]; A.m[8] = m[8];
-      return A;
+      return Matrix3x3<T> (m[0], m[3], m[6],
+			   m[1], m[4], m[7],
+			   m[2], m[5], m[8]);
     }
 
     /// \brief Transposition.
@@ -242,8 +223,116 @@ namespace jrlMathTools
       A.m[8] = ( m[0] * m[4] - m[1] * m[3] ) * det;
     }
 
+    /// \brief Solve this * x = b using a LU decomposition with partial
+    /// pivoting.
+    ///
+    /// \return false if the matrix is singular, x is then left unchanged.
+    bool luSolve (const Vector3D<T>& b, Vector3D<T>& x) const
+    {
+      T f[9];
+      unsigned int p[3];
+      std::copy (m, m + 9, f);
+      if (! luFactorize<3> (f, p))
+	return false;
+      x = b;
+      luSolveInPlace<3, 1> (f, p, x.data ());
+      return true;
+    }
+
+    /// \brief Solve this * X = B using a LU decomposition with partial
+    /// pivoting.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if the matrix is singular, X is then left unchanged.
+    bool luSolve (const Matrix3x3<T>& B, Matrix3x3<T>& X) const
+    {
+      T f[9];
+      unsigned int p[3];
+      std::copy (m, m + 9, f);
+      if (! luFactorize<3> (f, p))
+	return false;
+      X = B;
+      luSolveInPlace<3, 3> (f, p, X.m);
+      return true;
+    }
+
+    /// \brief Solve this * x = b using a Cholesky decomposition.
+    ///
+    /// The matrix must be symmetric positive definite, only its lower
+    /// triangular part is read.
+    ///
+    /// \return false if the matrix is not positive definite, x is then
+    /// left unchanged.
+    bool choleskySolve (const Vector3D<T>& b, Vector3D<T>& x) const
+    {
+      T f[9];
+      std::copy (m, m + 9, f);
+      if (! choleskyFactorize<3> (f))
+	return false;
+      x = b;
+      choleskySolveInPlace<3, 1> (f, x.data ());
+      return true;
+    }
+
+    /// \brief Solve this * X = B using a Cholesky decomposition.
+    ///
+    /// The matrix must be symmetric positive definite, only its lower
+    /// triangular part is read.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if the matrix is not positive definite, X is then
+    /// left unchanged.
+    bool choleskySolve (const Matrix3x3<T>& B, Matrix3x3<T>& X) const
+    {
+      T f[9];
+      std::copy (m, m + 9, f);
+      if (! choleskyFactorize<3> (f))
+	return false;
+      X = B;
+      choleskySolveInPlace<3, 3> (f, X.m);
+      return true;
+    }
+
+    /// \brief Solve this * x = b using a LDL^T decomposition.
+    ///
+    /// The matrix must be symmetric, only its lower triangular part is
+    /// read.
+    ///
+    /// \return false if a pivot vanishes, x is then left unchanged.
+    bool ldltSolve (const Vector3D<T>& b, Vector3D<T>& x) const
+    {
+      T f[9];
+      std::copy (m, m + 9, f);
+      if (! ldltFactorize<3> (f))
+	return false;
+      x = b;
+      ldltSolveInPlace<3, 1> (f, x.data ());
+      return true;
+    }
+
+    /// \brief Solve this * X = B using a LDL^T decomposition.
+    ///
+    /// The matrix must be symmetric, only its lower triangular part is
+    /// read.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if a pivot vanishes, X is then left unchanged.
+    bool ldltSolve (const Matrix3x3<T>& B, Matrix3x3<T>& X) const
+    {
+      T f[9];
+      std::copy (m, m + 9, f);
+      if (! ldltFactorize<3> (f))
+	return false;
+      X = B;
+      ldltSolveInPlace<3, 3> (f, X.m);
+      return true;
+    }
+
     /// \brief Determinant.
-    T determinant() const
+    constexpr T determinant() const
     {
       return m[0] * m[4] * m[8]
 	+ m[1] * m[5] * m[6]
@@ -268,7 +357,7 @@ namespace jrlMathTools
     }
 
     /// \brief returns true if matrix is identity.
-    bool IsIdentity () const
+    constexpr bool IsIdentity () const
     {
       return
 	((m[0] == 1) && (m[4] == 1) && (m[8] == 1) && (m[1] == T ())
@@ -307,7 +396,7 @@ namespace jrlMathTools
     /// \brief Local matrix multiplication.
     void operator *= (const Matrix3x3<T>& B)
     {
-      Matrix3x3<T> temp(*this);
+      const Matrix3x3<T> temp(*this);
       m[0] = temp.m[0] * B.m[0] + temp.m[1] * B.m[3] + temp.m[2] * B.m[6];
       m[1] = temp.m[0] * B.m[1] + temp.m[1] * B.m[4] + temp.m[2] * B.m[7];
       m[2] = temp.m[0] * B.m[2] + temp.m[1] * B.m[5] + temp.m[2] * B.m[8];
@@ -335,13 +424,7 @@ namespace jrlMathTools
 
     inline std::ostream& display (std::ostream& os) const
     {
-      for(int i = 0; i < 3; ++i)
-	{
-	  for(int j = 0; j < 3; ++j)
-	    os << m[i*3+j] << " ";
-	  os << std::endl;
-	}
-      return os;
+      return formatRows (os, m, 3, 3);
     }
   };
 
@@ -15,15 +15,205 @@
 
 #ifndef JRL_MATHTOOLS_MATRIX4x4_HH
 # define JRL_MATHTOOLS_MATRIX4x4_HH
+# include <cmath>
 # include <stdexcept>
 
 # include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/format.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/solvers.hh>
 
 # include <jrl/mathtools/vector4.hh>
 # include <jrl/mathtools/matrix3x3.hh>
 
 namespace jrlMathTools
 {
+  namespace detail
+  {
+    /// \brief General 4x4 inverse from the 2x2 minors of the matrix.
+    ///
+    /// The twelve 2x2 minors of the two upper and the two lower rows
+    /// give every cofactor with a single multiply-add per term, and the
+    /// determinant is obtained from the first column of the adjugate.
+    /// When Check is true, nothing is written and false is returned if
+    /// |det| <= threshold.
+    template <typename T>
+    struct Inverse4x4
+    {
+      template <bool Check>
+      static bool run (const T* m, T* inv, T& det, const T& threshold)
+      {
+	const T s0 = m[0] * m[5] - m[4] * m[1];
+	const T s1 = m[0] * m[6] - m[4] * m[2];
+	const T s2 = m[0] * m[7] - m[4] * m[3];
+	const T s3 = m[1] * m[6] - m[5] * m[2];
+	const T s4 = m[1] * m[7] - m[5] * m[3];
+	const T s5 = m[2] * m[7] - m[6] * m[3];
+
+	const T c5 = m[10] * m[15] - m[14] * m[11];
+	const T c4 = m[9] * m[15] - m[13] * m[11];
+	const T c3 = m[9] * m[14] - m[13] * m[10];
+	const T c2 = m[8] * m[15] - m[12] * m[11];
+	const T c1 = m[8] * m[14] - m[12] * m[10];
+	const T c0 = m[8] * m[13] - m[12] * m[9];
+
+	det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (Check && ! (std::abs (det) > threshold))
+	  return false;
+	const T r = 1 / det;
+
+	// Cofactors are kept in registers until every coefficient of
+	// the input has been read, so that inv may alias m.
+	const T a0 = (m[5] * c5 - m[6] * c4 + m[7] * c3) * r;
+	const T a1 = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * r;
+	const T a2 = (m[13] * s5 - m[14] * s4 + m[15] * s3) * r;
+	const T a3 = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * r;
+
+	const T a4 = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * r;
+	const T a5 = (m[0] * c5 - m[2] * c2 + m[3] * c1) * r;
+	const T a6 = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * r;
+	const T a7 = (m[8] * s5 - m[10] * s2 + m[11] * s1) * r;
+
+	const T a8 = (m[4] * c4 - m[5] * c2 + m[7] * c0) * r;
+	const T a9 = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * r;
+	const T a10 = (m[12] * s4 - m[13] * s2 + m[15] * s0) * r;
+	const T a11 = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * r;
+
+	const T a12 = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * r;
+	const T a13 = (m[0] * c3 - m[1] * c1 + m[2] * c0) * r;
+	const T a14 = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * r;
+	const T a15 = (m[8] * s3 - m[9] * s1 + m[10] * s0) * r;
+
+	inv[0] = a0; inv[1] = a1; inv[2] = a2; inv[3] = a3;
+	inv[4] = a4; inv[5] = a5; inv[6] = a6; inv[7] = a7;
+	inv[8] = a8; inv[9] = a9; inv[10] = a10; inv[11] = a11;
+	inv[12] = a12; inv[13] = a13; inv[14] = a14; inv[15] = a15;
+	return true;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    /// \brief AVX2 version of the 4x4 inverse for doubles.
+    ///
+    /// Same algorithm as the scalar version, with one row of the
+    /// inverse per register. Lanes hold the columns in the order
+    /// (1, 0, 3, 2) so that a row of the adjugate is the signed sum of
+    /// three lane-wise products.
+    template <>
+    struct Inverse4x4<double>
+    {
+      static __m256d fms (__m256d a, __m256d b, __m256d c)
+      {
+#  if JRL_MATHTOOLS_HAS_FMA
+	return _mm256_fmsub_pd (a, b, c);
+#  else
+	return _mm256_sub_pd (_mm256_mul_pd (a, b), c);
+#  endif
+      }
+
+      static __m256d fma (__m256d a, __m256d b, __m256d c)
+      {
+#  if JRL_MATHTOOLS_HAS_FMA
+	return _mm256_fmadd_pd (a, b, c);
+#  else
+	return _mm256_add_pd (_mm256_mul_pd (a, b), c);
+#  endif
+      }
+
+      static __m256d fnma (__m256d a, __m256d b, __m256d c)
+      {
+#  if JRL_MATHTOOLS_HAS_FMA
+	return _mm256_fnmadd_pd (a, b, c);
+#  else
+	return _mm256_sub_pd (c, _mm256_mul_pd (a, b));
+#  endif
+      }
+
+      // (c_k, s_k, s_k) where s_k and c_k are the minors of
+      // columns (i, j) in the upper and lower rows.
+      static __m256d minor (__m256d ei, __m256d oi, __m256d ej, __m256d oj)
+      {
+	return fms (ei, oj, _mm256_mul_pd (oi, ej));
+      }
+
+      template <bool Check>
+      static bool run (const double* m, double* inv, double& det,
+		       const double& threshold)
+      {
+	const __m256d r0 = _mm256_loadu_pd (m);
+	const __m256d r1 = _mm256_loadu_pd (m + 4);
+	const __m256d r2 = _mm256_loadu_pd (m + 8);
+	const __m256d r3 = _mm256_loadu_pd (m + 12);
+
+	// vj = (m[4 + j], m[j], m[12 + j], m[8 + j]).
+	const __m256d t0 = _mm256_unpacklo_pd (r1, r0);
+	const __m256d t1 = _mm256_unpackhi_pd (r1, r0);
+	const __m256d t2 = _mm256_unpacklo_pd (r3, r2);
+	const __m256d t3 = _mm256_unpackhi_pd (r3, r2);
+	const __m256d v0 = _mm256_permute2f128_pd (t0, t2, 0x20);
+	const __m256d v1 = _mm256_permute2f128_pd (t1, t3, 0x20);
+	const __m256d v2 = _mm256_permute2f128_pd (t0, t2, 0x31);
+	const __m256d v3 = _mm256_permute2f128_pd (t1, t3, 0x31);
+
+	// ej = (m[8 + j], m[8 + j], m[j], m[j]),
+	// oj = (m[12 + j], m[12 + j], m[4 + j], m[4 + j]).
+	const int even = _MM_SHUFFLE (1, 1, 3, 3);
+	const int odd = _MM_SHUFFLE (0, 0, 2, 2);
+	const __m256d e0 = _mm256_permute4x64_pd (v0, even);
+	const __m256d e1 = _mm256_permute4x64_pd (v1, even);
+	const __m256d e2 = _mm256_permute4x64_pd (v2, even);
+	const __m256d e3 = _mm256_permute4x64_pd (v3, even);
+	const __m256d o0 = _mm256_permute4x64_pd (v0, odd);
+	const __m256d o1 = _mm256_permute4x64_pd (v1, odd);
+	const __m256d o2 = _mm256_permute4x64_pd (v2, odd);
+	const __m256d o3 = _mm256_permute4x64_pd (v3, odd);
+
+	const __m256d p0 = minor (e0, o0, e1, o1);
+	const __m256d p1 = minor (e0, o0, e2, o2);
+	const __m256d p2 = minor (e0, o0, e3, o3);
+	const __m256d p3 = minor (e1, o1, e2, o2);
+	const __m256d p4 = minor (e1, o1, e3, o3);
+	const __m256d p5 = minor (e2, o2, e3, o3);
+
+	// Rows of the adjugate. The odd ones are computed negated so
+	// that every row has the signs (+, -, +, -).
+	const __m256d sign = _mm256_set_pd (-0., 0., -0., 0.);
+	const __m256d a0 =
+	  _mm256_xor_pd (fma (v3, p3, fms (v1, p5, _mm256_mul_pd (v2, p4))),
+			 sign);
+	const __m256d a1 =
+	  _mm256_xor_pd (fnma (v3, p1, fms (v2, p2, _mm256_mul_pd (v0, p5))),
+			 sign);
+	const __m256d a2 =
+	  _mm256_xor_pd (fma (v3, p0, fms (v0, p4, _mm256_mul_pd (v1, p2))),
+			 sign);
+	const __m256d a3 =
+	  _mm256_xor_pd (fnma (v2, p0, fms (v1, p1, _mm256_mul_pd (v0, p3))),
+			 sign);
+
+	// det = m[0] a[0] + m[1] a[4] + m[2] a[8] + m[3] a[12].
+	const __m256d column =
+	  _mm256_permute2f128_pd (_mm256_unpacklo_pd (a0, a1),
+				  _mm256_unpacklo_pd (a2, a3), 0x20);
+	__m256d d = _mm256_mul_pd (column, r0);
+	d = _mm256_hadd_pd (d, d);
+	d = _mm256_add_pd (d, _mm256_permute2f128_pd (d, d, 0x01));
+	det = _mm256_cvtsd_f64 (d);
+	if (Check && ! (std::abs (det) > threshold))
+	  return false;
+
+	const __m256d r = _mm256_div_pd (_mm256_set1_pd (1.), d);
+	_mm256_storeu_pd (inv, _mm256_mul_pd (a0, r));
+	_mm256_storeu_pd (inv + 4, _mm256_mul_pd (a1, r));
+	_mm256_storeu_pd (inv + 8, _mm256_mul_pd (a2, r));
+	_mm256_storeu_pd (inv + 12, _mm256_mul_pd (a3, r));
+	return true;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+  } // end of namespace detail.
+
   /// \brief Generic 4x4 matrix.
   template <typename T>
   struct Matrix4x4
@@ -32,65 +222,79 @@ namespace jrlMathTools
     T m[16];
 
     /// \brief Defaut constructor.
-    Matrix4x4<T> ()
-    {
-      m[0]  = T ();  m[1]  = T (); m[2]  = T (); m[3]  = T ();
-      m[4]  = T ();  m[5]  = T (); m[6]  = T (); m[7]  = T ();
-      m[8]  = T ();  m[9]  = T (); m[10] = T (); m[11] = T ();
-      m[12] = T ();  m[13] = T (); m[14] = T (); m[15] = T ();
-    }
+    constexpr Matrix4x4<T> ()
+      : m ()
+    {}
 
     /// \brief Constructor form a scalar.
-    Matrix4x4<T> (const T x)
-    {
-      for (int i = 0; i < 16; ++i)
-	m[i] = x;
-    }
-
-    /// \brief Copy constructor.
-    Matrix4x4<T> (const Matrix4x4<T>& v)
-    {
-      for(int i = 0; i < 16; ++i)
-	m[i] = v.m[i];
-    }
+    constexpr Matrix4x4<T> (const T x)
+      : m {x, x, x, x,
+	   x, x, x, x,
+	   x, x, x, x,
+	   x, x, x, x}
+    {}
+
+    /// \brief Constructor from 16 scalars.
+    constexpr explicit Matrix4x4<T> (
+				     const T x0, const T x1,
+				     const T x2, const T x3,
+				     const T x4, const T x5,
+				     const T x6, const T x7,
+				     const T x8, const T x9,
+				     const T x10, const T x11,
+				     const T x12, const T x13,
+				     const T x14, const T x15
+				     )
+      : m {x0, x1, x2, x3,
+	   x4, x5, x6, x7,
+	   x8, x9, x10, x11,
+	   x12, x13, x14, x15}
+    {}
 
     /// \brief Hybrid copy constructor
+    ///
+    /// Copy and assignment between matrices of the same type are the
+    /// implicit ones so that the matrix stays trivially copyable.
     template <typename T2>
-    Matrix4x4<T> (const Matrix4x4<T2>& v)
-    {
-      for(int i = 0; i < 16; ++i)
-	m[i] = v.m[i];
-    }
+    constexpr Matrix4x4<T> (const Matrix4x4<T2>& v)
+      : m {static_cast<T> (v.m[0]), static_cast<T> (v.m[1]),
+	   static_cast<T> (v.m[2]), static_cast<T> (v.m[3]),
+	   static_cast<T> (v.m[4]), static_cast<T> (v.m[5]),
+	   static_cast<T> (v.m[6]), static_cast<T> (v.m[7]),
+	   static_cast<T> (v.m[8]), static_cast<T> (v.m[9]),
+	   static_cast<T> (v.m[10]), static_cast<T> (v.m[11]),
+	   static_cast<T> (v.m[12]), static_cast<T> (v.m[13]),
+	   static_cast<T> (v.m[14]), static_cast<T> (v.m[15])}
+    {}
 
     /// \brief ith element considering the matrix as an array.
-    inline T& operator[] (unsigned int i)
+    inline T& operator[] (unsigned int i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 16)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 16);
       return m[i];
     }
 
     /// \brief ith element considering the matrix as an array.
     inline const T& operator[] (unsigned int i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 16)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 16);
       return m[i];
     }
 
     /// \brief Access by giving the (i,j) element.
     inline T& operator() (unsigned int i, unsigned int j)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 4 || j >= 4)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4 && j < 4);
       return m[4*i+j];
     }
 
     /// \brief Access by giving the (i,j) element.
     inline T operator() (unsigned int i, unsigned int j) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i >= 4 || j >= 4)
-	throw std::logic_error ("bad index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4 && j < 4);
       return m[4*i+j];
     }
 
@@ -109,86 +313,45 @@ namespace jrlMathTools
     }
 
     /// \brief Addition operator.
-    Matrix4x4<T> operator+(const Matrix4x4<T>& B) const
+    constexpr Matrix4x4<T> operator+(const Matrix4x4<T>& B) const
     {
-      Matrix4x4<T> A;
-      A.m[0] = m[0] + B.m[0];
-      A.m[1] = m[1] + B.m[1];
-      A.m[2] = m[2] + B.m[2];
-      A.m[3] = m[3] + B.m[3];
-
-      A.m[4] = m[4] + B.m[4];
-      A.m[5] = m[5] + B.m[5];
-      A.m[6] = m[6] + B.m[6];
-      A.m[7] = m[7] + B.m[7];
-
-      A.m[8] = m[8] + B.m[8];
-      A.m[9] = m[9] + B.m[9];
-      A.m[10] = m[10] + B.m[10];
-      A.m[11] = m[11] + B.m[11];
-
-      A.m[12] = m[12] + B.m[12];
-      A.m[13] = m[13] + B.m[13];
-      A.m[14] = m[14] + B.m[14];
-      A.m[15] = m[15] + B.m[15];
-
-      return A;
+      return Matrix4x4<T>
+	(m[0] + B.m[0], m[1] + B.m[1], m[2] + B.m[2], m[3] + B.m[3],
+	 m[4] + B.m[4], m[5] + B.m[5], m[6] + B.m[6], m[7] + B.m[7],
+	 m[8] + B.m[8], m[9] + B.m[9], m[10] + B.m[10], m[11] + B.m[11],
+	 m[12] + B.m[12], m[13] + B.m[13], m[14] + B.m[14], m[15] + B.m[15]);
     }
 
     /// \brief Substraction operator.
-    Matrix4x4<T>  operator-(const Matrix4x4<T>& B) const
+    constexpr Matrix4x4<T>  operator-(const Matrix4x4<T>& B) const
     {
-      Matrix4x4<T> A;
-      A.m[0] = m[0] - B.m[0];
-      A.m[1] = m[1] - B.m[1];
-      A.m[2] = m[2] - B.m[2];
-      A.m[3] = m[3] - B.m[3];
-
-      A.m[4] = m[4] - B.m[4];
-      A.m[5] = m[5] - B.m[5];
-      A.m[6] = m[6] - B.m[6];
-      A.m[7] = m[7] - B.m[7];
-
-      A.m[8] = m[8] - B.m[8];
-      A.m[9] = m[9] - B.m[9];
-      A.m[10] = m[10] - B.m[10];
-      A.m[11] = m[11] - B.m[11];
-
-      A.m[12] = m[12] - B.m[12];
-      A.m[13] = m[13] - B.m[13];
-      A.m[14] = m[14] - B.m[14];
-      A.m[15] = m[15] - B.m[15];
-      return A;
-    };
+      return Matrix4x4<T>
+	(m[0] - B.m[0], m[1] - B.m[1], m[2] - B.m[2], m[3] - B.m[3],
+	 m[4] - B.m[4], m[5] - B.m[5], m[6] - B.m[6], m[7] - B.m[7],
+	 m[8] - B.m[8], m[9] - B.m[9], m[10] - B.m[10], m[11] - B.m[11],
+	 m[12] - B.m[12], m[13] - B.m[13], m[14] - B.m[14], m[15] - B.m[15]);
+    }
 
     /// \brief Multiplication operator with another matrix.
-    Matrix4x4<T> operator* (const Matrix4x4<T>& B) const
+    constexpr Matrix4x4<T> operator* (const Matrix4x4<T>& B) const
     {
-      Matrix4x4<T> A;
-      A.m[0] = m[0] * B.m[0] + m[1] * B.m[3] + m[2] * B.m[6];
-      A.m[0] = m[0] * B.m[0] + m[1] * B.m[4] + m[2] * B.m[8] + m[3] * B.m[12];
-      A.m[1] = m[0] * B.m[1] + m[1] * B.m[5] + m[2] * B.m[9] + m[3] * B.m[13];
-      A.m[2] = m[0] * B.m[2] + m[1] * B.m[6] + m[2] * B.m[10] + m[3] * B.m[14];
-      A.m[3] = m[0] * B.m[3] + m[1] * B.m[7] + m[2] * B.m[11] + m[3] * B.m[15];
-      A.m[4] = m[4] * B.m[0] + m[5] * B.m[4] + m[6] * B.m[8] + m[7] * B.m[12];
-      A.m[5] = m[4] * B.m[1] + m[5] * B.m[5] + m[6] * B.m[9] + m[7] * B.m[13];
-      A.m[6] = m[4] * B.m[2] + m[5] * B.m[6] + m[6] * B.m[10] + m[7] * B.m[14];
-      A.m[7] = m[4] * B.m[3] + m[5] * B.m[7] + m[6] * B.m[11] + m[7] * B.m[15];
-      A.m[8] = m[8] * B.m[0] + m[9] * B.m[4] + m[10] * B.m[8] + m[11] * B.m[12];
-      A.m[9] = m[8] * B.m[1] + m[9] * B.m[5] + m[10] * B.m[9] + m[11] * B.m[13];
-      A.m[10] =
-	m[8] * B.m[2] + m[9] * B.m[6] + m[10] * B.m[10] + m[11] * B.m[14];
-      A.m[11] =
-	m[8] * B.m[3] + m[9] * B.m[7] + m[10] * B.m[11] + m[11] * B.m[15];
-      A.m[12] =
-	m[12] * B.m[0] + m[13] * B.m[4] + m[14] * B.m[8] + m[15] * B.m[12];
-      A.m[13] =
-	m[12] * B.m[1] + m[13] * B.m[5] + m[14] * B.m[9] + m[15] * B.m[13];
-      A.m[14] =
-	m[12] * B.m[2] + m[13] * B.m[6] + m[14] * B.m[10] + m[15] * B.m[14];
-      A.m[15] =
-	m[12] * B.m[3] + m[13] * B.m[7] + m[14] * B.m[11] + m[15] * B.m[15];
-      return A;
+      return Matrix4x4<T>
+	(m[0] * B.m[0] + m[1] * B.m[4] + m[2] * B.m[8] + m[3] * B.m[12],
+	 m[0] * B.m[1] + m[1] * B.m[5] + m[2] * B.m[9] + m[3] * B.m[13],
+	 m[0] * B.m[2] + m[1] * B.m[6] + m[2] * B.m[10] + m[3] * B.m[14],
+	 m[0] * B.m[3] + m[1] * B.m[7] + m[2] * B.m[11] + m[3] * B.m[15],
+	 m[4] * B.m[0] + m[5] * B.m[4] + m[6] * B.m[8] + m[7] * B.m[12],
+	 m[4] * B.m[1] + m[5] * B.m[5] + m[6] * B.m[9] + m[7] * B.m[13],
+	 m[4] * B.m[2] + m[5] * B.m[6] + m[6] * B.m[10] + m[7] * B.m[14],
+	 m[4] * B.m[3] + m[5] * B.m[7] + m[6] * B.m[11] + m[7] * B.m[15],
+	 m[8] * B.m[0] + m[9] * B.m[4] + m[10] * B.m[8] + m[11] * B.m[12],
+	 m[8] * B.m[1] + m[9] * B.m[5] + m[10] * B.m[9] + m[11] * B.m[13],
+	 m[8] * B.m[2] + m[9] * B.m[6] + m[10] * B.m[10] + m[11] * B.m[14],
+	 m[8] * B.m[3] + m[9] * B.m[7] + m[10] * B.m[11] + m[11] * B.m[15],
+	 m[12] * B.m[0] + m[13] * B.m[4] + m[14] * B.m[8] + m[15] * B.m[12],
+	 m[12] * B.m[1] + m[13] * B.m[5] + m[14] * B.m[9] + m[15] * B.m[13],
+	 m[12] * B.m[2] + m[13] * B.m[6] + m[14] * B.m[10] + m[15] * B.m[14],
+	 m[12] * B.m[3] + m[13] * B.m[7] + m[14] * B.m[11] + m[15] * B.m[15]);
     }
 
     void  CeqthismulB (const Matrix4x4<T>& B, Matrix4x4<T>& C) const
@@ -225,120 +388,210 @@ namespace jrlMathTools
       C.m_w = m[12] * B.m_x + m[13] * B.m_y + m[14] * B.m_z + m[15] * B.m_w;
     }
 
+    /// \brief Product of two affine transformations, C = this * B.
+    ///
+    /// The last row of both matrices is taken to be (0, 0, 0, 1),
+    /// which saves 28 multiplications over CeqthismulB. C must alias
+    /// neither this matrix nor B.
+    void CeqthismulBAffine (const Matrix4x4<T>& B, Matrix4x4<T>& C) const
+    {
+      C.m[0] = m[0] * B.m[0] + m[1] * B.m[4] + m[2] * B.m[8];
+      C.m[1] = m[0] * B.m[1] + m[1] * B.m[5] + m[2] * B.m[9];
+      C.m[2] = m[0] * B.m[2] + m[1] * B.m[6] + m[2] * B.m[10];
+      C.m[3] = m[0] * B.m[3] + m[1] * B.m[7] + m[2] * B.m[11] + m[3];
+      C.m[4] = m[4] * B.m[0] + m[5] * B.m[4] + m[6] * B.m[8];
+      C.m[5] = m[4] * B.m[1] + m[5] * B.m[5] + m[6] * B.m[9];
+      C.m[6] = m[4] * B.m[2] + m[5] * B.m[6] + m[6] * B.m[10];
+      C.m[7] = m[4] * B.m[3] + m[5] * B.m[7] + m[6] * B.m[11] + m[7];
+      C.m[8] = m[8] * B.m[0] + m[9] * B.m[4] + m[10] * B.m[8];
+      C.m[9] = m[8] * B.m[1] + m[9] * B.m[5] + m[10] * B.m[9];
+      C.m[10] = m[8] * B.m[2] + m[9] * B.m[6] + m[10] * B.m[10];
+      C.m[11] = m[8] * B.m[3] + m[9] * B.m[7] + m[10] * B.m[11] + m[11];
+      C.m[12] = T ();
+      C.m[13] = T ();
+      C.m[14] = T ();
+      C.m[15] = T (1);
+    }
+
     /// \brief Multiplication operator with another vector.
-    Vector3D<T> operator* (const Vector3D<T>& B) const
+    constexpr Vector3D<T> operator* (const Vector3D<T>& B) const
     {
-      Vector3D<T> C;
-      C.m_x = m[0] * B.m_x + m[1] * B.m_y + m[2] * B.m_z + m[3];
-      C.m_y = m[4] * B.m_x + m[5] * B.m_y + m[6] * B.m_z + m[7];
-      C.m_z = m[8] * B.m_x + m[9] * B.m_y + m[10] * B.m_z + m[11];
-      return C;
+      return Vector3D<T>
+	(m[0] * B.m_x + m[1] * B.m_y + m[2] * B.m_z + m[3],
+	 m[4] * B.m_x + m[5] * B.m_y + m[6] * B.m_z + m[7],
+	 m[8] * B.m_x + m[9] * B.m_y + m[10] * B.m_z + m[11]);
     }
 
     /// \brief Multiplication operator with a vector 4d.
-    Vector4D<T> operator* (const Vector4D<T> &B) const
+    constexpr Vector4D<T> operator* (const Vector4D<T> &B) const
     {
-      Vector4D<T> C;
-      C.m_x = m[0] * B.m_x + m[1] * B.m_y + m[2] * B.m_z + m[3] * B.m_w;
-      C.m_y = m[4] * B.m_x + m[5] * B.m_y + m[6] * B.m_z + m[7] * B.m_w;
-      C.m_z = m[8] * B.m_x + m[9] * B.m_y + m[10] * B.m_z + m[11] * B.m_w;
-      C.m_w = m[12] * B.m_x + m[13] * B.m_y + m[14] * B.m_z + m[15] * B.m_w;
-      return C;
+      return Vector4D<T>
+	(m[0] * B.m_x + m[1] * B.m_y + m[2] * B.m_z + m[3] * B.m_w,
+	 m[4] * B.m_x + m[5] * B.m_y + m[6] * B.m_z + m[7] * B.m_w,
+	 m[8] * B.m_x + m[9] * B.m_y + m[10] * B.m_z + m[11] * B.m_w,
+	 m[12] * B.m_x + m[13] * B.m_y + m[14] * B.m_z + m[15] * B.m_w);
     }
 
     /// \brief Multiplication operator with a constant.
-    Matrix4x4<T> operator* (const T& r) const
-    {
-      Matrix4x4<T> result;
-      result.m[0] = m[0] * r;
-      result.m[1] = m[1] * r;
-      result.m[2] = m[2] * r;
-      result.m[3] = m[3] * r;
-      result.m[4] = m[4] * r;
-      result.m[5] = m[5] * r;
-      result.m[6] = m[6] * r;
-      result.m[7] = m[7] * r;
-      result.m[8] = m[8] * r;
-      result.m[9] = m[9] * r;
-      result.m[10] = m[10] * r;
-      result.m[11] = m[11] * r;
-      result.m[12] = m[12] * r;
-      result.m[13] = m[13] * r;
-      result.m[14] = m[14] * r;
-      result.m[15] = m[15] * r;
-      return result;
+    constexpr Matrix4x4<T> operator* (const T& r) const
+    {
+      return Matrix4x4<T>
+	(m[0] * r, m[1] * r, m[2] * r, m[3] * r,
+	 m[4] * r, m[5] * r, m[6] * r, m[7] * r,
+	 m[8] * r, m[9] * r, m[10] * r, m[11] * r,
+	 m[12] * r, m[13] * r, m[14] * r, m[15] * r);
     }
 
     /// \brief Transposition
-    Matrix4x4<T> Transpose() const
+    constexpr Matrix4x4<T> Transpose() const
     {
-      struct Matrix4x4 A;
-      A.m[0]  = m[0];  A.m[1]  = m[4]; A.m[2]  = m[8];  A.m[3]  = m[12];
-      A.m[4]  = m[1];  A.m[5]  = m[5]; A.m[6]  = m[9];  A.m[7]  = m[13];
-      A.m[8]  = m[2];  A.m[9]  = m[6]; A.m[10] = m[10]; A.m[11] = m[14];
-      A.m[12] = m[3];  A.m[13] = m[7]; A.m[14] = m[11]; A.m[15] = m[15];
-      return A;
-    };
+      return Matrix4x4<T> (m[0], m[4], m[8],  m[12],
+			   m[1], m[5], m[9],  m[13],
+			   m[2], m[6], m[10], m[14],
+			   m[3], m[7], m[11], m[15]);
+    }
 
-    /// \brief Inversion
-    void Inversion(Matrix4x4 &A) const
+    /// \brief Inversion.
+    ///
+    /// The inverse is written directly into A, which may alias this
+    /// matrix. A singular matrix gives non-finite coefficients.
+    void Inversion (Matrix4x4<T>& A) const
     {
-      T det = 1. / determinant ();
-
-      A.m[0]=m[6]*m[11]*m[13] - m[7]*m[10]*m[13] + m[7]*m[9]*m[14] - m[5]*m[11]*m[14] - m[6]*m[9]*m[15] +m[5]*m[10]*m[15];
-      A.m[1]=m[3]*m[10]*m[13] - m[2]*m[11]*m[13] - m[3]*m[9]*m[14] + m[1]*m[11]*m[14] + m[2]*m[9]*m[15] -m[1]*m[10]*m[15];
-      A.m[2]=m[2]*m[7]*m[13] - m[3]*m[6]*m[13] + m[3]*m[5]*m[14] - m[1]*m[7]*m[14] - m[2]*m[5]*m[15] + m[1]*m[6]*m[15];
-      A.m[3]=m[3]*m[6]*m[9] - m[2]*m[7]*m[9] - m[3]*m[5]*m[10] + m[1]*m[7]*m[10] + m[2]*m[5]*m[11] - m[1]*m[6]*m[11];
-
-      A.m[4]=m[7]*m[10]*m[12] -m[6]*m[11]*m[12] -m[7]*m[8]*m[14] + m[4]*m[11]*m[14] + m[6]*m[8]*m[15] - m[4]*m[10]*m[15];
-      A.m[5]=m[2]*m[11]*m[12] -m[3]*m[10]*m[12] +m[3]*m[8]*m[14] - m[0]*m[11]*m[14] - m[2]*m[8]*m[15] + m[0]*m[10]*m[15];
-      A.m[6]=m[3]*m[6]*m[12] - m[2]*m[7]*m[12] - m[3]*m[4]*m[14] + m[0]*m[7]*m[14] + m[2]*m[4]*m[15] - m[0]*m[6]*m[15];
-      A.m[7]=m[2]*m[7]*m[8] - m[3]*m[6]*m[8] + m[3]*m[4]*m[10] - m[0]*m[7]*m[10] - m[2]*m[4]*m[11] + m[0]*m[6]*m[11];
-
-      A.m[8]=m[5]*m[11]*m[12] - m[7]*m[9]*m[12] + m[7]*m[8]*m[13] - m[4]*m[11]*m[13] - m[5]*m[8]*m[15] + m[4]*m[9]*m[15];
-      A.m[9]=m[0]*m[11]*m[13] + m[1]*m[8]*m[15] + m[3]*m[9]*m[12] - m[0]*m[9]*m[15] - m[1]*m[11]*m[12] - m[3]*m[8]*m[13];
-      A.m[10]=m[1]*m[7]*m[12] - m[3]*m[5]*m[12] + m[3]*m[4]*m[13] - m[0]*m[7]*m[13] - m[1]*m[4]*m[15] + m[0]*m[5]*m[15];
-      A.m[11]=m[3]*m[5]*m[8] - m[1]*m[7]*m[8] - m[3]*m[4]*m[9] + m[0]*m[7]*m[9] + m[1]*m[4]*m[11] - m[0]*m[5]*m[11];
-
-      A.m[12]=m[6]*m[9]*m[12] - m[5]*m[10]*m[12] - m[6]*m[8]*m[13] + m[4]*m[10]*m[13] + m[5]*m[8]*m[14] - m[4]*m[9]*m[14];
-      A.m[13]=m[1]*m[10]*m[12] - m[2]*m[9]*m[12] + m[2]*m[8]*m[13] - m[0]*m[10]*m[13] - m[1]*m[8]*m[14] + m[0]*m[9]*m[14];
-      A.m[14]=m[2]*m[5]*m[12] - m[1]*m[6]*m[12] - m[2]*m[4]*m[13] + m[0]*m[6]*m[13] + m[1]*m[4]*m[14] - m[0]*m[5]*m[14];
-      A.m[15]=m[1]*m[6]*m[8] - m[2]*m[5]*m[8] + m[2]*m[4]*m[9] - m[0]*m[6]*m[9] - m[1]*m[4]*m[10] + m[0]*m[5]*m[10];
+      T det;
+      detail::Inverse4x4<T>::template run<false> (m, A.m, det, T ());
+    }
 
-      A = A * det;
+    /// \brief Inversion reporting singular matrices.
+    ///
+    /// \param A receives the inverse, it may alias this matrix.
+    /// \param det receives the determinant, which is computed from the
+    /// cofactors at no extra cost.
+    /// \param threshold the matrix is considered singular when the
+    /// absolute value of its determinant is not above it.
+    /// \return false if the matrix is singular, A is then left unchanged.
+    bool Inversion (Matrix4x4<T>& A, T& det, const T& threshold = T ()) const
+    {
+      return detail::Inverse4x4<T>::template run<true> (m, A.m, det, threshold);
     }
 
     /// \brief Inversion.
-    Matrix4x4<T> Inversion ()
+    Matrix4x4<T> Inversion () const
+    {
+      Matrix4x4<T> A;
+      Inversion (A);
+      return A;
+    }
+
+    /// \brief Solve this * x = b using a LU decomposition with partial
+    /// pivoting.
+    ///
+    /// \return false if the matrix is singular, x is then left unchanged.
+    bool luSolve (const Vector4D<T>& b, Vector4D<T>& x) const
     {
-      Matrix4x4 A;
-      T det = 1. / determinant ();
+      T f[16];
+      unsigned int p[4];
+      std::copy (m, m + 16, f);
+      if (! luFactorize<4> (f, p))
+	return false;
+      x = b;
+      luSolveInPlace<4, 1> (f, p, x.data ());
+      return true;
+    }
 
-      A[0] = m[6]*m[11]*m[13] - m[7]*m[10]*m[13] + m[7]*m[9]*m[14] - m[5]*m[11]*m[14] - m[6]*m[9]*m[15] + m[5]*m[10]*m[15];
-      A[1] = m[3]*m[10]*m[13] - m[2]*m[11]*m[13] - m[3]*m[9]*m[14] + m[1]*m[11]*m[14] + m[2]*m[9]*m[15] - m[1]*m[10]*m[15];
-      A[2] = m[2]*m[7]*m[13] - m[3]*m[6]*m[13] + m[3]*m[5]*m[14] - m[1]*m[7]*m[14] - m[2]*m[5]*m[15] + m[1]*m[6]*m[15];
-      A[3] = m[3]*m[6]*m[9] - m[2]*m[7]*m[9] - m[3]*m[5]*m[10] + m[1]*m[7]*m[10] + m[2]*m[5]*m[11] - m[1]*m[6]*m[11];
+    /// \brief Solve this * X = B using a LU decomposition with partial
+    /// pivoting.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if the matrix is singular, X is then left unchanged.
+    bool luSolve (const Matrix4x4<T>& B, Matrix4x4<T>& X) const
+    {
+      T f[16];
+      unsigned int p[4];
+      std::copy (m, m + 16, f);
+      if (! luFactorize<4> (f, p))
+	return false;
+      X = B;
+      luSolveInPlace<4, 4> (f, p, X.m);
+      return true;
+    }
 
-      A[4] = m[7]*m[10]*m[12] -m[6]*m[11]*m[12] -m[7]*m[8]*m[14] + m[4]*m[11]*m[14] + m[6]*m[8]*m[15] - m[4]*m[10]*m[15];
-      A[5] = m[2]*m[11]*m[12] -m[3]*m[10]*m[12] +m[3]*m[8]*m[14] - m[0]*m[11]*m[14] - m[2]*m[8]*m[15] + m[0]*m[10]*m[15];
-      A[6] = m[3]*m[6]*m[12] - m[2]*m[7]*m[12] - m[3]*m[4]*m[14] + m[0]*m[7]*m[14] + m[2]*m[4]*m[15] - m[0]*m[6]*m[15];
-      A[7] = m[2]*m[7]*m[8] - m[3]*m[6]*m[8] + m[3]*m[4]*m[10] - m[0]*m[7]*m[10] - m[2]*m[4]*m[11] + m[0]*m[6]*m[11];
+    /// \brief Solve this * x = b using a Cholesky decomposition.
+    ///
+    /// The matrix must be symmetric positive definite, only its lower
+    /// triangular part is read.
+    ///
+    /// \return false if the matrix is not positive definite, x is then
+    /// left unchanged.
+    bool choleskySolve (const Vector4D<T>& b, Vector4D<T>& x) const
+    {
+      T f[16];
+      std::copy (m, m + 16, f);
+      if (! choleskyFactorize<4> (f))
+	return false;
+      x = b;
+      choleskySolveInPlace<4, 1> (f, x.data ());
+      return true;
+    }
 
-      A[8] = m[5]*m[11]*m[12] - m[7]*m[9]*m[12] + m[7]*m[8]*m[13] - m[4]*m[11]*m[13] - m[5]*m[8]*m[15] + m[4]*m[9]*m[15];
-      A[9] = m[0]*m[11]*m[13] + m[1]*m[8]*m[15] + m[3]*m[9]*m[12] - m[0]*m[9]*m[15] - m[1]*m[11]*m[12] - m[3]*m[8]*m[13];
-      A[10] = m[1]*m[7]*m[12] - m[3]*m[5]*m[12] + m[3]*m[4]*m[13] - m[0]*m[7]*m[13] - m[1]*m[4]*m[15] + m[0]*m[5]*m[15];
-      A[11] = m[3]*m[5]*m[8] - m[1]*m[7]*m[8] - m[3]*m[4]*m[9] + m[0]*m[7]*m[9] + m[1]*m[4]*m[11] - m[0]*m[5]*m[11];
+    /// \brief Solve this * X = B using a Cholesky decomposition.
+    ///
+    /// The matrix must be symmetric positive definite, only its lower
+    /// triangular part is read.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if the matrix is not positive definite, X is then
+    /// left unchanged.
+    bool choleskySolve (const Matrix4x4<T>& B, Matrix4x4<T>& X) const
+    {
+      T f[16];
+      std::copy (m, m + 16, f);
+      if (! choleskyFactorize<4> (f))
+	return false;
+      X = B;
+      choleskySolveInPlace<4, 4> (f, X.m);
+      return true;
+    }
 
-      A[12] = m[6]*m[9]*m[12] - m[5]*m[10]*m[12] - m[6]*m[8]*m[13] + m[4]*m[10]*m[13] + m[5]*m[8]*m[14] - m[4]*m[9]*m[14];
-      A[13] = m[1]*m[10]*m[12] - m[2]*m[9]*m[12] + m[2]*m[8]*m[13] - m[0]*m[10]*m[13] - m[1]*m[8]*m[14] + m[0]*m[9]*m[14];
-      A[14] = m[2]*m[5]*m[12] - m[1]*m[6]*m[12] - m[2]*m[4]*m[13] + m[0]*m[6]*m[13] + m[1]*m[4]*m[14] - m[0]*m[5]*m[14];
-      A[15] = m[1]*m[6]*m[8] - m[2]*m[5]*m[8] + m[2]*m[4]*m[9] - m[0]*m[6]*m[9] - m[1]*m[4]*m[10] + m[0]*m[5]*m[10];
+    /// \brief Solve this * x = b using a LDL^T decomposition.
+    ///
+    /// The matrix must be symmetric, only its lower triangular part is
+    /// read.
+    ///
+    /// \return false if a pivot vanishes, x is then left unchanged.
+    bool ldltSolve (const Vector4D<T>& b, Vector4D<T>& x) const
+    {
+      T f[16];
+      std::copy (m, m + 16, f);
+      if (! ldltFactorize<4> (f))
+	return false;
+      x = b;
+      ldltSolveInPlace<4, 1> (f, x.data ());
+      return true;
+    }
 
-      return A * det;
+    /// \brief Solve this * X = B using a LDL^T decomposition.
+    ///
+    /// The matrix must be symmetric, only its lower triangular part is
+    /// read.
+    ///
+    /// Each column of B is a right-hand side.
+    ///
+    /// \return false if a pivot vanishes, X is then left unchanged.
+    bool ldltSolve (const Matrix4x4<T>& B, Matrix4x4<T>& X) const
+    {
+      T f[16];
+      std::copy (m, m + 16, f);
+      if (! ldltFactorize<4> (f))
+	return false;
+      X = B;
+      ldltSolveInPlace<4, 4> (f, X.m);
+      return true;
     }
 
     /// \brief Determinant.
-    T determinant() const
+    constexpr T determinant() const
     {
       return m[3] * m[6] * m[9] * m[12]-m[2] * m[7] * m[9] * m[12]-m[3] * m[5] * m[10] * m[12]+m[1] * m[7]* m[10] * m[12]+
 	m[2] * m[5] * m[11] * m[12]-m[1] * m[6] * m[11] * m[12]-m[3] * m[6] * m[8] * m[13]+m[2] * m[7]* m[8] * m[13]+
@@ -348,7 +601,7 @@ namespace jrlMathTools
 	m[2] * m[4] * m[9] * m[15]-m[0] * m[6] * m[9] * m[15]-m[1] * m[4] * m[10] * m[15]+m[0] * m[5] * m[10] * m[15];
     }
 
-    T trace() const
+    constexpr T trace() const
     {
       return m[0]+m[5]+m[10]+m[15];
     }
@@ -399,7 +652,7 @@ namespace jrlMathTools
     /// Local matrix multiplication.
     void operator *= (const Matrix4x4<T>& B)
     {
-      Matrix4x4<T> temp (*this);
+      const Matrix4x4<T> temp (*this);
       m[0] = temp.m[0] * B.m[0] + temp.m[1] * B.m[4] + temp.m[2] * B.m[8] + temp.m[3] * B.m[12];
       m[1] = temp.m[0] * B.m[1] + temp.m[1] * B.m[5] + temp.m[2] * B.m[9] + temp.m[3] * B.m[13];
       m[2] = temp.m[0] * B.m[2] + temp.m[1] * B.m[6] + temp.m[2] * B.m[10] + temp.m[3] * B.m[14];
@@ -441,13 +694,7 @@ namespace jrlMathTools
 
     inline std::ostream& display (std::ostream& os) const
     {
-      for (int i = 0; i  <4; ++i)
-	{
-	  for(int j = 0; j < 4; ++j)
-	    os << m[i*4+j] << " ";
-	  os << std::endl;
-	}
-      return os;
+      return formatRows (os, m, 4, 4);
     }
   };
 
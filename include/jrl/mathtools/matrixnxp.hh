@@ -20,6 +20,10 @@
 # include <boost/numeric/ublas/matrix.hpp>
 # include <boost/numeric/ublas/io.hpp>
 
+# include <algorithm>
+# include <cmath>
+# include <vector>
+
 # include <jrl/mathtools/fwd.hh>
 # include <jrl/mathtools/vectorn.hh>
 
@@ -277,6 +281,154 @@ namespace jrlMathTools
       }
       return invMatrix;
     }
+
+  /// \brief Buffers of the pseudo-inverse, kept from one call to the
+  /// next.
+  ///
+  /// pseudoInverse and dampedInverse allocate their copy of the
+  /// matrix, the singular vectors and the LAPACK work array at each
+  /// call. The overloads taking a workspace reuse its buffers instead:
+  /// once the workspace has seen the largest shape, and if the output
+  /// matrix already has the shape of the result, they do not allocate.
+  /// Only the thin singular vectors are computed.
+  class PseudoInverseWorkspace
+  {
+  public:
+    PseudoInverseWorkspace ()
+      : rows_ (0),
+	cols_ (0)
+    {}
+
+    /// \brief Constructor allocating the buffers for rows x cols
+    /// matrices.
+    PseudoInverseWorkspace (matrixNxP::size_type rows,
+			    matrixNxP::size_type cols)
+      : rows_ (0),
+	cols_ (0)
+    {
+      reserve (rows, cols);
+    }
+
+    /// \brief Allocate the buffers for rows x cols matrices.
+    void reserve (matrixNxP::size_type rows, matrixNxP::size_type cols)
+    {
+      const int m = static_cast<int> (std::max (rows, cols));
+      const int n = static_cast<int> (std::min (rows, cols));
+      if (m == rows_ && n == cols_)
+	return;
+      rows_ = m;
+      cols_ = n;
+      a_.resize (static_cast<std::size_t> (m) * n);
+      s_.resize (n);
+      u_.resize (static_cast<std::size_t> (m) * n);
+      vt_.resize (static_cast<std::size_t> (n) * n);
+      if (n == 0)
+	return;
+
+      // Query the size of the LAPACK work array.
+      const char jobu = 'S';
+      const char jobvt = 'A';
+      const int lwork = -1;
+      double size;
+      int info;
+      dgesvd_ (&jobu, &jobvt, &m, &n, 0, &m, 0, 0, &m, 0, &n,
+	       &size, &lwork, &info);
+      work_.resize (std::max (static_cast<std::size_t> (size),
+			      work_.size ()));
+    }
+
+    /// \brief Compute the pseudo-inverse of matrix into inverse.
+    ///
+    /// Singular values below threshold are ignored. If damped, the
+    /// singular values s are inverted as s / (s^2 + threshold^2), and
+    /// only those below threshold / 10 are ignored, as dampedInverse
+    /// does.
+    void compute (const matrixNxP& matrix, matrixNxP& inverse,
+		  double threshold, bool damped)
+    {
+      const matrixNxP::size_type rows = matrix.size1 ();
+      const matrixNxP::size_type cols = matrix.size2 ();
+      if (inverse.size1 () != cols || inverse.size2 () != rows)
+	inverse.resize (cols, rows, false);
+      reserve (rows, cols);
+      const int m = rows_;
+      const int n = cols_;
+      if (n == 0)
+	return;
+
+      // Decompose the matrix, or its transpose if it is wide, so that
+      // m >= n, in column-major order.
+      const bool transposed = rows <= cols;
+      for (int j = 0; j < n; ++j)
+	for (int i = 0; i < m; ++i)
+	  a_[i + m * j] = transposed ? matrix (j, i) : matrix (i, j);
+      const char jobu = 'S';
+      const char jobvt = 'A';
+      const int lwork = static_cast<int> (work_.size ());
+      int info;
+      dgesvd_ (&jobu, &jobvt, &m, &n, &a_[0], &m, &s_[0], &u_[0], &m,
+	       &vt_[0], &n, &work_[0], &lwork, &info);
+
+      // Scale the rows of V^T by the inverted singular values, sorted
+      // in decreasing order.
+      int rank = 0;
+      const double limit = damped ? threshold * .1 : threshold;
+      while (rank < n && std::fabs (s_[rank]) > limit)
+	{
+	  const double s = s_[rank];
+	  const double inverted = damped
+	    ? s / (s * s + threshold * threshold) : 1. / s;
+	  for (int i = 0; i < n; ++i)
+	    vt_[rank + n * i] *= inverted;
+	  ++rank;
+	}
+
+      // V S^+ U^T, n x m, transposed back if needed.
+      for (int i = 0; i < n; ++i)
+	for (int j = 0; j < m; ++j)
+	  {
+	    double sum = 0.;
+	    for (int k = 0; k < rank; ++k)
+	      sum += vt_[k + n * i] * u_[j + m * k];
+	    if (transposed)
+	      inverse (j, i) = sum;
+	    else
+	      inverse (i, j) = sum;
+	  }
+    }
+
+  private:
+    /// \brief Shape of the decomposed matrix, rows_ >= cols_.
+    int rows_;
+    int cols_;
+    std::vector<double> a_;
+    std::vector<double> s_;
+    std::vector<double> u_;
+    std::vector<double> vt_;
+    std::vector<double> work_;
+  };
+
+  /// \brief Compute the pseudo-inverse of the matrix, with the buffers
+  /// of workspace.
+  inline matrixNxP& pseudoInverse (const matrixNxP& matrix,
+				   matrixNxP& outInverse,
+				   PseudoInverseWorkspace& workspace,
+				   const double threshold = 1e-6)
+  {
+    workspace.compute (matrix, outInverse, threshold, false);
+    return outInverse;
+  }
+
+  /// \brief Compute the damped inverse of the matrix, with the buffers
+  /// of workspace.
+  inline matrixNxP& dampedInverse (const matrixNxP& matrix,
+				   matrixNxP& outInverse,
+				   PseudoInverseWorkspace& workspace,
+				   const double threshold = 1e-6)
+  {
+    workspace.compute (matrix, outInverse, threshold, true);
+    return outInverse;
+  }
 } // end of namespace jrlMathTools.
 
 #endif //! JRL_MATHTOOLS_MATRIXNXP_HH
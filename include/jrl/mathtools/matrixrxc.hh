@@ -0,0 +1,387 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_MATRIXRXC_HH
+# define JRL_MATHTOOLS_MATRIXRXC_HH
+# include <algorithm>
+# include <cmath>
+# include <iostream>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/format.hh>
+# include <jrl/mathtools/solvers.hh>
+
+# include <jrl/mathtools/matrix3x3.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+
+// Loops shorter than this bound are unrolled at compile-time by the
+// fixed-size kernels, longer ones are left to the compiler.
+# ifndef JRL_MATHTOOLS_MAX_UNROLL
+#  define JRL_MATHTOOLS_MAX_UNROLL 16
+# endif //! JRL_MATHTOOLS_MAX_UNROLL
+
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Call f (0), ..., f (N - 1).
+    ///
+    /// The calls are unrolled when N is small enough.
+    template <unsigned int N, bool Unroll = (N <= JRL_MATHTOOLS_MAX_UNROLL)>
+    struct StaticFor
+    {
+      template <typename F>
+      static inline void run (const F& f)
+      {
+	StaticFor<N - 1, true>::run (f);
+	f (N - 1);
+      }
+    };
+
+    template <>
+    struct StaticFor<0, true>
+    {
+      template <typename F>
+      static inline void run (const F&)
+      {}
+    };
+
+    template <unsigned int N>
+    struct StaticFor<N, false>
+    {
+      template <typename F>
+      static inline void run (const F& f)
+      {
+	for (unsigned int i = 0; i < N; ++i)
+	  f (i);
+      }
+    };
+  } // end of namespace detail.
+
+  /// \brief Generic fixed-size RxC matrix.
+  ///
+  /// Elements are stored row-major on the stack, like Matrix3x3 and
+  /// Matrix4x4, so that no operation ever allocates memory.
+  template <typename T, unsigned int R, unsigned int C>
+  struct MatrixRxC
+  {
+    static const unsigned int rows = R;
+    static const unsigned int cols = C;
+    static const unsigned int size = R * C;
+
+    /// \brief The data array.
+    T m[R * C];
+
+    /// \brief Default constructor: all elements are set to zero.
+    constexpr MatrixRxC ()
+      : m ()
+    {}
+
+    /// \brief Constructor from a scalar.
+    explicit MatrixRxC (const T x)
+    {
+      Fill (x);
+    }
+
+    /// \brief Constructor from a row-major array.
+    explicit MatrixRxC (const T (&data)[R * C])
+    {
+      detail::StaticFor<R * C>::run ([&] (unsigned int i)
+				     { m[i] = data[i]; });
+    }
+
+    /// \brief Constructor from a 3x3 matrix.
+    explicit MatrixRxC (const Matrix3x3<T>& v)
+    {
+      static_assert (R == 3 && C == 3, "matrix must be 3x3");
+      detail::StaticFor<9>::run ([&] (unsigned int i) { m[i] = v.m[i]; });
+    }
+
+    /// \brief Constructor from a 4x4 matrix.
+    explicit MatrixRxC (const Matrix4x4<T>& v)
+    {
+      static_assert (R == 4 && C == 4, "matrix must be 4x4");
+      detail::StaticFor<16>::run ([&] (unsigned int i) { m[i] = v.m[i]; });
+    }
+
+    /// \brief Identity matrix.
+    static MatrixRxC<T, R, C> identity ()
+    {
+      MatrixRxC<T, R, C> A;
+      A.setIdentity ();
+      return A;
+    }
+
+    /// \brief Conversion to a 3x3 matrix.
+    Matrix3x3<T> toMatrix3x3 () const
+    {
+      static_assert (R == 3 && C == 3, "matrix must be 3x3");
+      Matrix3x3<T> A;
+      detail::StaticFor<9>::run ([&] (unsigned int i) { A.m[i] = m[i]; });
+      return A;
+    }
+
+    /// \brief Conversion to a 4x4 matrix.
+    Matrix4x4<T> toMatrix4x4 () const
+    {
+      static_assert (R == 4 && C == 4, "matrix must be 4x4");
+      Matrix4x4<T> A;
+      detail::StaticFor<16>::run ([&] (unsigned int i) { A.m[i] = m[i]; });
+      return A;
+    }
+
+    /// \brief i-th element considering the matrix as an array.
+    inline T& operator[] (unsigned int i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < R * C);
+      return m[i];
+    }
+
+    /// \brief i-th element considering the matrix as an array.
+    inline const T& operator[] (unsigned int i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < R * C);
+      return m[i];
+    }
+
+    /// \brief Access by giving the (i,j) element.
+    inline T& operator() (unsigned int i, unsigned int j)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < R && j < C);
+      return m[C * i + j];
+    }
+
+    /// \brief Access by giving the (i,j) element.
+    inline const T& operator() (unsigned int i, unsigned int j) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < R && j < C);
+      return m[C * i + j];
+    }
+
+    /// \brief Fills with value.
+    void Fill (T value)
+    {
+      detail::StaticFor<R * C>::run ([&] (unsigned int i) { m[i] = value; });
+    }
+
+    /// \brief Set to zero matrix.
+    void setZero ()
+    {
+      Fill (T ());
+    }
+
+    /// \brief Set to identity.
+    void setIdentity ()
+    {
+      static_assert (R == C, "matrix must be square");
+      setZero ();
+      detail::StaticFor<R>::run ([&] (unsigned int i) { m[i * (C + 1)] = 1; });
+    }
+
+    /// \brief Binary operator ==.
+    bool operator== (const MatrixRxC<T, R, C>& B) const
+    {
+      for (unsigned int i = 0; i < R * C; ++i)
+	if (! (m[i] == B.m[i]))
+	  return false;
+      return true;
+    }
+
+    /// \brief Binary operator !=.
+    bool operator!= (const MatrixRxC<T, R, C>& B) const
+    {
+      return ! (*this == B);
+    }
+
+    /// \brief Addition operator.
+    MatrixRxC<T, R, C> operator+ (const MatrixRxC<T, R, C>& B) const
+    {
+      MatrixRxC<T, R, C> A;
+      detail::StaticFor<R * C>::run ([&] (unsigned int i)
+				     { A.m[i] = m[i] + B.m[i]; });
+      return A;
+    }
+
+    /// \brief Substraction operator.
+    MatrixRxC<T, R, C> operator- (const MatrixRxC<T, R, C>& B) const
+    {
+      MatrixRxC<T, R, C> A;
+      detail::StaticFor<R * C>::run ([&] (unsigned int i)
+				     { A.m[i] = m[i] - B.m[i]; });
+      return A;
+    }
+
+    /// \brief Multiplication operator with a constant.
+    MatrixRxC<T, R, C> operator* (const T& r) const
+    {
+      MatrixRxC<T, R, C> A;
+      detail::StaticFor<R * C>::run ([&] (unsigned int i)
+				     { A.m[i] = m[i] * r; });
+      return A;
+    }
+
+    /// \brief Multiplication operator with another matrix.
+    template <unsigned int K>
+    MatrixRxC<T, R, K> operator* (const MatrixRxC<T, C, K>& B) const
+    {
+      MatrixRxC<T, R, K> A;
+      CeqthismulB (B, A);
+      return A;
+    }
+
+    /// \brief Compute C = this * B.
+    template <unsigned int K>
+    void CeqthismulB (const MatrixRxC<T, C, K>& B, MatrixRxC<T, R, K>& A) const
+    {
+      detail::StaticFor<R>::run ([&] (unsigned int i) {
+	  detail::StaticFor<K>::run ([&] (unsigned int j) {
+	      T s = m[C * i] * B.m[j];
+	      detail::StaticFor<C - 1>::run ([&] (unsigned int k) {
+		  s += m[C * i + k + 1] * B.m[K * (k + 1) + j];
+		});
+	      A.m[K * i + j] = s;
+	    });
+	});
+    }
+
+    /// \brief Self matrix addition.
+    void operator+= (const MatrixRxC<T, R, C>& B)
+    {
+      detail::StaticFor<R * C>::run ([&] (unsigned int i) { m[i] += B.m[i]; });
+    }
+
+    /// \brief Local matrix subtraction.
+    void operator-= (const MatrixRxC<T, R, C>& B)
+    {
+      detail::StaticFor<R * C>::run ([&] (unsigned int i) { m[i] -= B.m[i]; });
+    }
+
+    /// \brief Matrix product with a scalar.
+    void operator*= (const T& t)
+    {
+      detail::StaticFor<R * C>::run ([&] (unsigned int i) { m[i] *= t; });
+    }
+
+    /// \brief Transposition.
+    MatrixRxC<T, C, R> Transpose () const
+    {
+      MatrixRxC<T, C, R> A;
+      Transpose (A);
+      return A;
+    }
+
+    /// \brief Transposition.
+    void Transpose (MatrixRxC<T, C, R>& A) const
+    {
+      detail::StaticFor<R>::run ([&] (unsigned int i) {
+	  detail::StaticFor<C>::run ([&] (unsigned int j) {
+	      A.m[R * j + i] = m[C * i + j];
+	    });
+	});
+    }
+
+    /// \brief Trace.
+    T trace () const
+    {
+      static_assert (R == C, "matrix must be square");
+      T t = m[0];
+      detail::StaticFor<R - 1>::run ([&] (unsigned int i)
+				     { t += m[(i + 1) * (C + 1)]; });
+      return t;
+    }
+
+    /// \brief Solve this * X = B using a LU decomposition with partial
+    /// pivoting.
+    ///
+    /// \return false if the matrix is singular, X is then left unchanged.
+    template <unsigned int K>
+    bool luSolve (const MatrixRxC<T, R, K>& B, MatrixRxC<T, R, K>& X) const
+    {
+      static_assert (R == C, "matrix must be square");
+      MatrixRxC<T, R, C> LU (*this);
+      unsigned int p[R];
+      if (! luFactorize<R> (LU.m, p))
+	return false;
+      X = B;
+      luSolveInPlace<R, K> (LU.m, p, X.m);
+      return true;
+    }
+
+    /// \brief Solve this * X = B using a Cholesky decomposition.
+    ///
+    /// The matrix must be symmetric positive definite, only its lower
+    /// triangular part is read.
+    ///
+    /// \return false if the matrix is not positive definite, X is then
+    /// left unchanged.
+    template <unsigned int K>
+    bool choleskySolve (const MatrixRxC<T, R, K>& B,
+			MatrixRxC<T, R, K>& X) const
+    {
+      static_assert (R == C, "matrix must be square");
+      MatrixRxC<T, R, C> L (*this);
+      if (! choleskyFactorize<R> (L.m))
+	return false;
+      X = B;
+      choleskySolveInPlace<R, K> (L.m, X.m);
+      return true;
+    }
+
+    /// \brief Solve this * X = B using a LDL^T decomposition.
+    ///
+    /// The matrix must be symmetric, only its lower triangular part is
+    /// read.
+    ///
+    /// \return false if a pivot vanishes, X is then left unchanged.
+    template <unsigned int K>
+    bool ldltSolve (const MatrixRxC<T, R, K>& B, MatrixRxC<T, R, K>& X) const
+    {
+      static_assert (R == C, "matrix must be square");
+      MatrixRxC<T, R, C> LD (*this);
+      if (! ldltFactorize<R> (LD.m))
+	return false;
+      X = B;
+      ldltSolveInPlace<R, K> (LD.m, X.m);
+      return true;
+    }
+
+    /// \brief Inversion.
+    ///
+    /// \return false if the matrix is singular, A is then left unchanged.
+    bool Inversion (MatrixRxC<T, R, C>& A) const
+    {
+      return luSolve (identity (), A);
+    }
+
+    inline std::ostream& display (std::ostream& os) const
+    {
+      return formatRows (os, m, R, C);
+    }
+  };
+
+  template <typename T, unsigned int R, unsigned int C>
+  inline std::ostream& operator<< (std::ostream& os,
+				   const MatrixRxC<T, R, C>& m)
+  {
+    return m.display (os);
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_MATRIXRXC_HH
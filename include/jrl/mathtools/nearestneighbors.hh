@@ -0,0 +1,461 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef JRL_MATHTOOLS_NEARESTNEIGHBORS_HH
+# define JRL_MATHTOOLS_NEARESTNEIGHBORS_HH
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+# include <limits>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/distances.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Nearest neighbour index on products of lines and circles,
+  /// e.g. SE(2) configurations or the joint angles of a robot.
+  ///
+  /// Points have D coordinates. A circular coordinate is an angle,
+  /// wrapped into [-PI, PI] on insertion, and is compared along the
+  /// shortest arc. The distance is the Euclidean norm of the weighted
+  /// coordinate differences.
+  ///
+  /// Points are indexed by a forest of static k-d trees whose sizes
+  /// are distinct powers of two, as the bits of a binary counter: an
+  /// insertion builds a tree from the new points and the trees that
+  /// are not larger, so that the insertion cost is amortized and
+  /// queries search O(log n) balanced trees. Leaves are contiguous,
+  /// coordinate-wise ranges scanned with the vectorized distance
+  /// kernels. Queries do not allocate memory.
+  ///
+  /// Points are identified by their insertion rank.
+  template <unsigned int D>
+  class KdTree
+  {
+  public:
+    /// \brief Maximum number of points in a leaf.
+    static const std::size_t leafSize = 16;
+
+    /// \brief Constructor.
+    /// \param circular D flags, whether the coordinates are angles;
+    /// none if null.
+    /// \param weights D scale factors of the coordinates; ones if null.
+    explicit KdTree (const bool* circular = 0, const double* weights = 0)
+      : points_ (),
+	blocks_ ()
+    {
+      for (unsigned int k = 0; k < D; ++k)
+	{
+	  circular_[k] = circular ? circular[k] : false;
+	  weights_[k] = weights ? weights[k] : 1.;
+	}
+    }
+
+    /// \brief Number of points.
+    std::size_t size () const
+    {
+      return points_.size () / D;
+    }
+
+    /// \brief Remove all points.
+    void clear ()
+    {
+      points_.clear ();
+      blocks_.clear ();
+    }
+
+    /// \brief Coordinates of the point inserted in i-th position, with
+    /// the angles wrapped.
+    const double* point (std::size_t i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < size ());
+      return &points_[D * i];
+    }
+
+    /// \brief Distance between two points.
+    double distance (const double* a, const double* b) const
+    {
+      double d2 = 0.;
+      for (unsigned int k = 0; k < D; ++k)
+	{
+	  const double d = circular_[k]
+	    ? detail::circularDifference<detail::ScalarOps<double> >
+	    (wrap (a[k]), wrap (b[k]))
+	    : a[k] - b[k];
+	  d2 += weights_[k] * weights_[k] * d * d;
+	}
+      return std::sqrt (d2);
+    }
+
+    /// \brief Insert one point.
+    void insert (const double* point)
+    {
+      insert (point, 1);
+    }
+
+    /// \brief Insert n points, stored one after the other.
+    void insert (const double* points, std::size_t n)
+    {
+      if (! n)
+	return;
+      const std::size_t first = size ();
+      points_.insert (points_.end (), points, points + D * n);
+      for (std::size_t i = first; i < first + n; ++i)
+	for (unsigned int k = 0; k < D; ++k)
+	  if (circular_[k])
+	    points_[D * i + k] = wrap (points_[D * i + k]);
+
+      // Merge the trees which are not larger than the new one.
+      std::vector<std::size_t> ids (n);
+      for (std::size_t i = 0; i < n; ++i)
+	ids[i] = first + i;
+      while (! blocks_.empty ()
+	     && blocks_.back ().m_ids.size () <= ids.size ())
+	{
+	  const std::vector<std::size_t>& merged = blocks_.back ().m_ids;
+	  ids.insert (ids.end (), merged.begin (), merged.end ());
+	  blocks_.pop_back ();
+	}
+      blocks_.push_back (Block ());
+      build (blocks_.back (), ids);
+    }
+
+    /// \brief k nearest neighbours of query.
+    ///
+    /// ids and distances receive the neighbours sorted by increasing
+    /// distance and must hold k values.
+    ///
+    /// \return the number of neighbours found, min (k, size ()).
+    std::size_t nearest (const double* query, std::size_t k,
+			 std::size_t* ids, double* distances) const
+    {
+      if (! k)
+	return 0;
+      KNearest result (k, ids, distances);
+      search (query, result);
+      for (std::size_t i = 0; i < result.m_count; ++i)
+	distances[i] = std::sqrt (distances[i]);
+      return result.m_count;
+    }
+
+    /// \brief Neighbours of query closer than radius.
+    ///
+    /// Their ids and distances are appended to ids and distances, in
+    /// no particular order.
+    void radius (const double* query, double radius,
+		 std::vector<std::size_t>& ids,
+		 std::vector<double>& distances) const
+    {
+      const std::size_t first = distances.size ();
+      Radius result (radius * radius, ids, distances);
+      search (query, result);
+      for (std::size_t i = first; i < distances.size (); ++i)
+	distances[i] = std::sqrt (distances[i]);
+    }
+
+  private:
+    /// \brief Node of a tree, covering the points [m_begin, m_end) of
+    /// its block. Leaves have no children, m_left is then null.
+    struct Node
+    {
+      std::size_t m_begin;
+      std::size_t m_end;
+      std::size_t m_left;
+      std::size_t m_right;
+      unsigned int m_dimension;
+      double m_split;
+    };
+
+    /// \brief Static tree. Coordinate k of its j-th point is
+    /// m_coordinates[k * m_ids.size () + j].
+    struct Block
+    {
+      std::vector<std::size_t> m_ids;
+      std::vector<double> m_coordinates;
+      std::vector<Node> m_nodes;
+    };
+
+    /// \brief Sorted k nearest neighbours, by squared distance.
+    struct KNearest
+    {
+      KNearest (std::size_t k, std::size_t* ids, double* distances)
+	: m_k (k),
+	  m_count (0),
+	  m_ids (ids),
+	  m_distances (distances)
+      {}
+
+      double bound () const
+      {
+	return m_count < m_k
+	  ? std::numeric_limits<double>::infinity ()
+	  : m_distances[m_k - 1];
+      }
+
+      void add (std::size_t id, double d2)
+      {
+	std::size_t i;
+	if (m_count < m_k)
+	  i = m_count++;
+	else if (d2 < m_distances[m_k - 1])
+	  i = m_k - 1;
+	else
+	  return;
+	for (; i > 0 && m_distances[i - 1] > d2; --i)
+	  {
+	    m_ids[i] = m_ids[i - 1];
+	    m_distances[i] = m_distances[i - 1];
+	  }
+	m_ids[i] = id;
+	m_distances[i] = d2;
+      }
+
+      std::size_t m_k;
+      std::size_t m_count;
+      std::size_t* m_ids;
+      double* m_distances;
+    };
+
+    /// \brief Neighbours within a squared radius.
+    struct Radius
+    {
+      Radius (double r2, std::vector<std::size_t>& ids,
+	      std::vector<double>& distances)
+	: m_r2 (r2),
+	  m_ids (ids),
+	  m_distances (distances)
+      {}
+
+      double bound () const
+      {
+	return m_r2;
+      }
+
+      void add (std::size_t id, double d2)
+      {
+	if (d2 <= m_r2)
+	  {
+	    m_ids.push_back (id);
+	    m_distances.push_back (d2);
+	  }
+      }
+
+      double m_r2;
+      std::vector<std::size_t>& m_ids;
+      std::vector<double>& m_distances;
+    };
+
+    /// \brief Cell of a node and squared distance from the query, per
+    /// coordinate and in total.
+    struct Cell
+    {
+      double m_low[D];
+      double m_high[D];
+      double m_offset[D];
+      double m_distance;
+    };
+
+    static double wrap (double x)
+    {
+      return detail::Trigonometry<double, detail::ScalarOps<double> >::wrap
+	(x);
+    }
+
+    /// \brief Weighted squared distance from q to [low, high] along
+    /// coordinate k.
+    double offset (unsigned int k, double q, double low, double high) const
+    {
+      double d = 0.;
+      if (q < low || q > high)
+	d = circular_[k]
+	  ? std::min
+	  (detail::circularDifference<detail::ScalarOps<double> > (q, low),
+	   detail::circularDifference<detail::ScalarOps<double> > (q, high))
+	  : (q < low ? low - q : q - high);
+      return weights_[k] * weights_[k] * d * d;
+    }
+
+    const double& coordinate (std::size_t id, unsigned int k) const
+    {
+      return points_[D * id + k];
+    }
+
+    /// \brief Build the tree of block over the points ids.
+    void build (Block& block, std::vector<std::size_t>& ids)
+    {
+      const std::size_t m = ids.size ();
+      block.m_nodes.reserve (2 * (m / leafSize + 1));
+      buildNode (block, ids, 0, m);
+      block.m_ids.swap (ids);
+      block.m_coordinates.resize (D * m);
+      for (unsigned int k = 0; k < D; ++k)
+	for (std::size_t j = 0; j < m; ++j)
+	  block.m_coordinates[k * m + j] = coordinate (block.m_ids[j], k);
+    }
+
+    /// \brief Build the subtree over ids[begin, end), split at the
+    /// median of the coordinate of largest weighted spread.
+    std::size_t buildNode (Block& block, std::vector<std::size_t>& ids,
+			   std::size_t begin, std::size_t end)
+    {
+      const std::size_t index = block.m_nodes.size ();
+      Node node = {begin, end, 0, 0, 0, 0.};
+      block.m_nodes.push_back (node);
+      if (end - begin <= leafSize)
+	return index;
+
+      double spread = -1.;
+      for (unsigned int k = 0; k < D; ++k)
+	{
+	  double low = coordinate (ids[begin], k);
+	  double high = low;
+	  for (std::size_t i = begin + 1; i < end; ++i)
+	    {
+	      low = std::min (low, coordinate (ids[i], k));
+	      high = std::max (high, coordinate (ids[i], k));
+	    }
+	  if (weights_[k] * (high - low) > spread)
+	    {
+	      spread = weights_[k] * (high - low);
+	      node.m_dimension = k;
+	    }
+	}
+
+      const std::size_t middle = begin + (end - begin) / 2;
+      const unsigned int k = node.m_dimension;
+      std::nth_element (ids.begin () + begin, ids.begin () + middle,
+			ids.begin () + end, CompareCoordinate (*this, k));
+      node.m_split = coordinate (ids[middle], k);
+      node.m_left = buildNode (block, ids, begin, middle);
+      node.m_right = buildNode (block, ids, middle, end);
+      block.m_nodes[index] = node;
+      return index;
+    }
+
+    struct CompareCoordinate
+    {
+      CompareCoordinate (const KdTree& tree, unsigned int k)
+	: m_tree (tree),
+	  m_k (k)
+      {}
+
+      bool operator() (std::size_t a, std::size_t b) const
+      {
+	return m_tree.coordinate (a, m_k) < m_tree.coordinate (b, m_k);
+      }
+
+      const KdTree& m_tree;
+      unsigned int m_k;
+    };
+
+    template <typename R>
+    void search (const double* query, R& result) const
+    {
+      double q[D];
+      Cell cell;
+      cell.m_distance = 0.;
+      for (unsigned int k = 0; k < D; ++k)
+	{
+	  q[k] = circular_[k] ? wrap (query[k]) : query[k];
+	  cell.m_low[k] = circular_[k]
+	    ? -M_PI : -std::numeric_limits<double>::infinity ();
+	  cell.m_high[k] = circular_[k]
+	    ? M_PI : std::numeric_limits<double>::infinity ();
+	  cell.m_offset[k] = 0.;
+	}
+      for (std::size_t b = 0; b < blocks_.size (); ++b)
+	searchNode (blocks_[b], 0, q, cell, result);
+    }
+
+    template <typename R>
+    void searchNode (const Block& block, std::size_t index, const double* q,
+		     Cell& cell, R& result) const
+    {
+      if (cell.m_distance > result.bound ())
+	return;
+      const Node& node = block.m_nodes[index];
+      if (! node.m_left)
+	{
+	  scanLeaf (block, node, q, result);
+	  return;
+	}
+
+      // Nearest child first, then the other one if its cell may
+      // still contain closer points.
+      const unsigned int k = node.m_dimension;
+      const bool leftFirst = q[k] < node.m_split;
+      const double low = cell.m_low[k];
+      const double high = cell.m_high[k];
+      const double previous = cell.m_offset[k];
+      const double distance = cell.m_distance;
+      for (unsigned int c = 0; c < 2; ++c)
+	{
+	  const bool left = (c == 0) == leftFirst;
+	  if (left)
+	    cell.m_high[k] = node.m_split;
+	  else
+	    cell.m_low[k] = node.m_split;
+	  cell.m_offset[k] = offset (k, q[k], cell.m_low[k], cell.m_high[k]);
+	  cell.m_distance = distance + cell.m_offset[k] - previous;
+	  searchNode (block, left ? node.m_left : node.m_right, q, cell,
+		      result);
+	  cell.m_distance = distance;
+	  cell.m_low[k] = low;
+	  cell.m_high[k] = high;
+	  cell.m_offset[k] = previous;
+	}
+    }
+
+    template <typename R>
+    void scanLeaf (const Block& block, const Node& node, const double* q,
+		   R& result) const
+    {
+      const std::size_t m = block.m_ids.size ();
+      const std::size_t n = node.m_end - node.m_begin;
+      const double* coordinates = &block.m_coordinates[node.m_begin];
+      double d2[leafSize];
+      std::fill (d2, d2 + n, 0.);
+      for (unsigned int k = 0; k < D; ++k)
+	{
+	  const double w2 = weights_[k] * weights_[k];
+	  if (circular_[k])
+	    detail::accumulateSquaredDifferences<true>
+	      (q[k], coordinates + k * m, w2, d2, n);
+	  else
+	    detail::accumulateSquaredDifferences<false>
+	      (q[k], coordinates + k * m, w2, d2, n);
+	}
+      for (std::size_t j = 0; j < n; ++j)
+	result.add (block.m_ids[node.m_begin + j], d2[j]);
+    }
+
+    bool circular_[D];
+    double weights_[D];
+    std::vector<double> points_;
+    std::vector<Block> blocks_;
+  };
+
+  template <unsigned int D>
+  const std::size_t KdTree<D>::leafSize;
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_NEARESTNEIGHBORS_HH
@@ -0,0 +1,381 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_POINTCLOUD_HH
+# define JRL_MATHTOOLS_POINTCLOUD_HH
+# include <algorithm>
+# include <atomic>
+# include <cstddef>
+# include <system_error>
+# include <thread>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/matrix3x3.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+
+// Bulk transformation of point buffers.
+//
+// transformPoints applies the affine part of a homogeneous
+// transformation, as Matrix4x4::operator* (const Vector3D&) does, to a
+// whole buffer of points stored either as an array of Vector3D (AoS)
+// or as three coordinate arrays (SoA). The output may be the input
+// itself, but must not partially overlap it.
+//
+// The buffer is cut into tiles which are processed by up to `threads'
+// threads, the calling one included. Passing 0 uses one thread per
+// hardware thread. Small buffers are always processed by the calling
+// thread.
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Number of points processed at once by a thread.
+    static const std::size_t transformTileSize = 4096;
+
+    /// \brief Minimum number of points worth starting a thread.
+    static const std::size_t transformPointsPerThread = 16384;
+
+    /// \brief Scalar transformation of n interleaved points.
+    ///
+    /// a is the 3x4 row-major affine part of the transformation.
+    template <typename T>
+    void transformAoSScalar (const T* a, const T* in, T* out, std::size_t n)
+    {
+      for (std::size_t i = 0; i < n; ++i, in += 3, out += 3)
+	{
+	  const T x = in[0];
+	  const T y = in[1];
+	  const T z = in[2];
+	  out[0] = a[0] * x + a[1] * y + a[2] * z + a[3];
+	  out[1] = a[4] * x + a[5] * y + a[6] * z + a[7];
+	  out[2] = a[8] * x + a[9] * y + a[10] * z + a[11];
+	}
+    }
+
+    /// \brief Scalar transformation of n points stored as coordinate
+    /// arrays.
+    template <typename T>
+    void transformSoAScalar (const T* a,
+			     const T* xi, const T* yi, const T* zi,
+			     T* xo, T* yo, T* zo, std::size_t n)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+	{
+	  const T x = xi[i];
+	  const T y = yi[i];
+	  const T z = zi[i];
+	  xo[i] = a[0] * x + a[1] * y + a[2] * z + a[3];
+	  yo[i] = a[4] * x + a[5] * y + a[6] * z + a[7];
+	  zo[i] = a[8] * x + a[9] * y + a[10] * z + a[11];
+	}
+    }
+
+    /// \brief Point transformation kernels, specialized below for the
+    /// types having a vectorized implementation.
+    template <typename T>
+    struct TransformPoints
+    {
+      static void aos (const T* a, const T* in, T* out, std::size_t n)
+      {
+	transformAoSScalar (a, in, out, n);
+      }
+
+      static void soa (const T* a,
+		       const T* xi, const T* yi, const T* zi,
+		       T* xo, T* yo, T* zo, std::size_t n)
+      {
+	transformSoAScalar (a, xi, yi, zi, xo, yo, zo, n);
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    /// \brief Vectorized kernels, four points per iteration.
+    ///
+    /// Four interleaved points fill exactly three vectors,
+    ///   v0 = (x0 y0 z0 x1), v1 = (y1 z1 x2 y2), v2 = (z2 x3 y3 z3),
+    /// so the output is computed in the same layout: each output
+    /// vector is a sum of three lane-wise products between a shuffled
+    /// copy of the coefficients and the matching coordinates,
+    /// gathered from the inputs with a blend and a permutation.
+    template <typename T>
+    struct SimdTransformPoints
+    {
+      typedef Simd4<T> V;
+      typedef typename V::type v_t;
+
+      static void aos (const T* a, const T* in, T* out, std::size_t n)
+      {
+	// Coefficients of the rows (0 1 2 0), (1 2 0 1) and (2 0 1 2).
+	const v_t c00 = V::set (a[0], a[4], a[8], a[0]);
+	const v_t c01 = V::set (a[1], a[5], a[9], a[1]);
+	const v_t c02 = V::set (a[2], a[6], a[10], a[2]);
+	const v_t c03 = V::set (a[3], a[7], a[11], a[3]);
+	const v_t c10 = V::set (a[4], a[8], a[0], a[4]);
+	const v_t c11 = V::set (a[5], a[9], a[1], a[5]);
+	const v_t c12 = V::set (a[6], a[10], a[2], a[6]);
+	const v_t c13 = V::set (a[7], a[11], a[3], a[7]);
+	const v_t c20 = V::set (a[8], a[0], a[4], a[8]);
+	const v_t c21 = V::set (a[9], a[1], a[5], a[9]);
+	const v_t c22 = V::set (a[10], a[2], a[6], a[10]);
+	const v_t c23 = V::set (a[11], a[3], a[7], a[11]);
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4, in += 12, out += 12)
+	  {
+	    const v_t v0 = V::load (in);
+	    const v_t v1 = V::load (in + 4);
+	    const v_t v2 = V::load (in + 8);
+
+	    // (x0 x0 x0 x1), (y0 y0 y0 y1), (z0 z0 z0 z1).
+	    const v_t x0 = V::template permute<0, 0, 0, 3> (v0);
+	    const v_t y0 = V::template permute<1, 1, 1, 0>
+	      (V::template blend<0x1> (v0, v1));
+	    const v_t z0 = V::template permute<2, 2, 2, 1>
+	      (V::template blend<0x2> (v0, v1));
+
+	    // (x1 x1 x2 x2), (y1 y1 y2 y2), (z1 z1 z2 z2).
+	    const v_t x1 = V::template permute<3, 3, 2, 2>
+	      (V::template blend<0x8> (v1, v0));
+	    const v_t y1 = V::template permute<0, 0, 3, 3> (v1);
+	    const v_t z1 = V::template permute<1, 1, 0, 0>
+	      (V::template blend<0x1> (v1, v2));
+
+	    // (x2 x3 x3 x3), (y2 y3 y3 y3), (z2 z3 z3 z3).
+	    const v_t x2 = V::template permute<2, 1, 1, 1>
+	      (V::template blend<0x4> (v2, v1));
+	    const v_t y2 = V::template permute<3, 2, 2, 2>
+	      (V::template blend<0x8> (v2, v1));
+	    const v_t z2 = V::template permute<0, 3, 3, 3> (v2);
+
+	    V::store (out, V::fma (c00, x0,
+				   V::fma (c01, y0, V::fma (c02, z0, c03))));
+	    V::store (out + 4, V::fma (c10, x1,
+				       V::fma (c11, y1, V::fma (c12, z1, c13))));
+	    V::store (out + 8, V::fma (c20, x2,
+				       V::fma (c21, y2, V::fma (c22, z2, c23))));
+	  }
+	transformAoSScalar (a, in, out, n - i);
+      }
+
+      static void soa (const T* a,
+		       const T* xi, const T* yi, const T* zi,
+		       T* xo, T* yo, T* zo, std::size_t n)
+      {
+	v_t c[12];
+	for (unsigned int k = 0; k < 12; ++k)
+	  c[k] = V::set1 (a[k]);
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    const v_t x = V::load (xi + i);
+	    const v_t y = V::load (yi + i);
+	    const v_t z = V::load (zi + i);
+	    V::store (xo + i, V::fma (c[0], x,
+				      V::fma (c[1], y, V::fma (c[2], z, c[3]))));
+	    V::store (yo + i, V::fma (c[4], x,
+				      V::fma (c[5], y, V::fma (c[6], z, c[7]))));
+	    V::store (zo + i, V::fma (c[8], x,
+				      V::fma (c[9], y, V::fma (c[10], z, c[11]))));
+	  }
+	transformSoAScalar (a, xi + i, yi + i, zi + i,
+			    xo + i, yo + i, zo + i, n - i);
+      }
+    };
+
+    template <>
+    struct TransformPoints<double> : SimdTransformPoints<double>
+    {};
+
+    template <>
+    struct TransformPoints<float> : SimdTransformPoints<float>
+    {};
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Call f (begin, end) on every tile of [0, n).
+    ///
+    /// Tiles are distributed dynamically between the threads so that
+    /// a slow thread does not delay the whole batch.
+    template <typename F>
+    void forEachTile (std::size_t n, unsigned int threads, const F& f)
+    {
+      if (threads == 0)
+	threads = std::max (std::thread::hardware_concurrency (), 1u);
+      const std::size_t useful = n / transformPointsPerThread;
+      if (useful < threads)
+	threads = static_cast<unsigned int> (std::max<std::size_t> (useful, 1));
+
+      if (threads == 1)
+	{
+	  f (std::size_t (0), n);
+	  return;
+	}
+
+      const std::size_t tiles =
+	(n + transformTileSize - 1) / transformTileSize;
+      std::atomic<std::size_t> next (0);
+      auto work = [&] ()
+	{
+	  for (std::size_t t = next++; t < tiles; t = next++)
+	    f (t * transformTileSize,
+	       std::min (n, (t + 1) * transformTileSize));
+	};
+
+      // If a thread cannot be started, the tiles are shared by the
+      // threads already running and the caller, which joins them.
+      std::vector<std::thread> pool;
+      pool.reserve (threads - 1);
+      try
+	{
+	  for (unsigned int i = 1; i < threads; ++i)
+	    pool.push_back (std::thread (work));
+	}
+      catch (const std::system_error&)
+	{}
+      work ();
+      for (std::size_t i = 0; i < pool.size (); ++i)
+	pool[i].join ();
+    }
+
+    template <typename T>
+    void transformPoints (const T* a, const T* in, T* out,
+			  std::size_t n, unsigned int threads)
+    {
+      forEachTile (n, threads, [=] (std::size_t begin, std::size_t end)
+		   {
+		     TransformPoints<T>::aos
+		       (a, in + 3 * begin, out + 3 * begin, end - begin);
+		   });
+    }
+
+    template <typename T>
+    void transformPoints (const T* a,
+			  const T* xi, const T* yi, const T* zi,
+			  T* xo, T* yo, T* zo,
+			  std::size_t n, unsigned int threads)
+    {
+      forEachTile (n, threads, [=] (std::size_t begin, std::size_t end)
+		   {
+		     TransformPoints<T>::soa
+		       (a, xi + begin, yi + begin, zi + begin,
+			xo + begin, yo + begin, zo + begin, end - begin);
+		   });
+    }
+
+    /// \brief Affine part of a rotation and a translation.
+    template <typename T>
+    void rigidCoefficients (const Matrix3x3<T>& R, const Vector3D<T>& t,
+			    T* a)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+	{
+	  a[4 * i] = R.m[3 * i];
+	  a[4 * i + 1] = R.m[3 * i + 1];
+	  a[4 * i + 2] = R.m[3 * i + 2];
+	  a[4 * i + 3] = t[i];
+	}
+    }
+  } // end of namespace detail.
+
+  /// \brief Transform n points: out[i] = M * in[i].
+  template <typename T>
+  void transformPoints (const Matrix4x4<T>& M,
+			const Vector3D<T>* in, Vector3D<T>* out,
+			std::size_t n, unsigned int threads = 1)
+  {
+    detail::transformPoints (M.m, reinterpret_cast<const T*> (in),
+			     reinterpret_cast<T*> (out), n, threads);
+  }
+
+  /// \brief Transform n points in place: points[i] = M * points[i].
+  template <typename T>
+  void transformPoints (const Matrix4x4<T>& M,
+			Vector3D<T>* points,
+			std::size_t n, unsigned int threads = 1)
+  {
+    transformPoints (M, points, points, n, threads);
+  }
+
+  /// \brief Transform n points stored as coordinate arrays.
+  template <typename T>
+  void transformPoints (const Matrix4x4<T>& M,
+			const T* x, const T* y, const T* z,
+			T* xOut, T* yOut, T* zOut,
+			std::size_t n, unsigned int threads = 1)
+  {
+    detail::transformPoints (M.m, x, y, z, xOut, yOut, zOut, n, threads);
+  }
+
+  /// \brief Transform n points stored as coordinate arrays, in place.
+  template <typename T>
+  void transformPoints (const Matrix4x4<T>& M,
+			T* x, T* y, T* z,
+			std::size_t n, unsigned int threads = 1)
+  {
+    detail::transformPoints (M.m, x, y, z, x, y, z, n, threads);
+  }
+
+  /// \brief Apply the rigid transformation (R, t) to n points:
+  /// out[i] = R * in[i] + t.
+  template <typename T>
+  void transformPoints (const Matrix3x3<T>& R, const Vector3D<T>& t,
+			const Vector3D<T>* in, Vector3D<T>* out,
+			std::size_t n, unsigned int threads = 1)
+  {
+    T a[12];
+    detail::rigidCoefficients (R, t, a);
+    detail::transformPoints (a, reinterpret_cast<const T*> (in),
+			     reinterpret_cast<T*> (out), n, threads);
+  }
+
+  /// \brief Apply the rigid transformation (R, t) to n points, in place.
+  template <typename T>
+  void transformPoints (const Matrix3x3<T>& R, const Vector3D<T>& t,
+			Vector3D<T>* points,
+			std::size_t n, unsigned int threads = 1)
+  {
+    transformPoints (R, t, points, points, n, threads);
+  }
+
+  /// \brief Apply the rigid transformation (R, t) to n points stored as
+  /// coordinate arrays.
+  template <typename T>
+  void transformPoints (const Matrix3x3<T>& R, const Vector3D<T>& t,
+			const T* x, const T* y, const T* z,
+			T* xOut, T* yOut, T* zOut,
+			std::size_t n, unsigned int threads = 1)
+  {
+    T a[12];
+    detail::rigidCoefficients (R, t, a);
+    detail::transformPoints (a, x, y, z, xOut, yOut, zOut, n, threads);
+  }
+
+  /// \brief Apply the rigid transformation (R, t) to n points stored as
+  /// coordinate arrays, in place.
+  template <typename T>
+  void transformPoints (const Matrix3x3<T>& R, const Vector3D<T>& t,
+			T* x, T* y, T* z,
+			std::size_t n, unsigned int threads = 1)
+  {
+    transformPoints (R, t, x, y, z, x, y, z, n, threads);
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_POINTCLOUD_HH
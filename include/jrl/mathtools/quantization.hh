@@ -0,0 +1,540 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_QUANTIZATION_HH
+# define JRL_MATHTOOLS_QUANTIZATION_HH
+# include <cmath>
+# include <cstddef>
+# include <cstdint>
+# include <stdexcept>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/quaternion.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+
+// Compact storage of positions and rigid transforms, with a bounded
+// error.
+//
+// A position is quantized to 16 bits per coordinate on a regular grid
+// over a box given by a Vector3Quantizer: 6 bytes instead of 24, with
+// an error of at most half a step per axis.
+//
+// A rotation is stored in 64 bits with the "smallest three" encoding:
+// the index of the largest coefficient of its unit quaternion, in 2
+// bits, and the three others, made relative to a positive largest
+// coefficient, in 20 bits each. They lie in [-1/sqrt(2), 1/sqrt(2)],
+// so that a coefficient is off by at most 6.8e-7 and the rotation
+// angle by less than 5e-6 rad. The largest coefficient is recomputed
+// from the unit norm.
+//
+// A Matrix4x4 pose thus fits in the 16 bytes of a QuantizedPose, 8
+// times less than its 128 bytes. The batched functions encode and
+// decode four poses at a time when Simd4 is available.
+namespace jrlMathTools
+{
+  /// \brief Position quantized by a Vector3Quantizer.
+  struct QuantizedVector3D
+  {
+    std::uint16_t m_x;
+    std::uint16_t m_y;
+    std::uint16_t m_z;
+  };
+
+  /// \brief Rigid transform: smallest-three rotation and quantized
+  /// translation.
+  struct QuantizedPose
+  {
+    /// \brief Index of the largest coefficient in bits 0-1, the other
+    /// coefficients, in (x, y, z, w) order, in bits 2-21, 22-41 and
+    /// 42-61.
+    std::uint64_t m_rotation;
+    QuantizedVector3D m_translation;
+    std::uint16_t m_reserved;
+  };
+
+  static_assert (sizeof (QuantizedVector3D) == 6,
+		 "QuantizedVector3D must be 6 bytes long");
+  static_assert (sizeof (QuantizedPose) == 16,
+		 "QuantizedPose must be 16 bytes long");
+
+  namespace detail
+  {
+    /// \brief Number of bits of a coefficient of a quantized rotation.
+    static const unsigned int rotationBits = 20;
+
+    /// \brief Largest count of a coefficient of a quantized rotation.
+    static const double rotationCounts = double ((1 << rotationBits) - 1);
+
+    /// \brief Largest count of a quantized coordinate.
+    static const double coordinateCounts = 65535.;
+
+    /// \brief Quantization kernels, written once against the
+    /// ScalarOps / Simd4 interface. Counts are held as doubles.
+    template <typename V>
+    struct Quantization
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+
+      /// \brief Count of x on the grid min + k step, clamped to
+      /// [0, counts].
+      static v_t encode (v_t x, v_t min, v_t inverseStep, v_t counts)
+      {
+	const v_t zero = V::set1 (0.);
+	v_t k = V::floor (V::fma (V::sub (x, min), inverseStep,
+				  V::set1 (.5)));
+	k = V::select (V::lt (k, zero), zero, k);
+	return V::select (V::lt (counts, k), counts, k);
+      }
+
+      static v_t decode (v_t k, v_t min, v_t step)
+      {
+	return V::fma (k, step, min);
+      }
+
+      /// \brief Smallest-three encoding of row-major rotation matrices:
+      /// index of the largest quaternion coefficient and counts of the
+      /// three others.
+      ///
+      /// The largest coefficient is found from the diagonal and the
+      /// others from the off-diagonal sums and differences, as in the
+      /// usual robust matrix to quaternion conversion, with selects
+      /// instead of branches.
+      static void encodeRotation (const v_t* r, v_t& index, v_t* counts)
+      {
+	const v_t one = V::set1 (1.);
+	const v_t tw = V::add (V::add (one, r[0]), V::add (r[4], r[8]));
+	const v_t tx = V::sub (V::add (one, r[0]), V::add (r[4], r[8]));
+	const v_t ty = V::sub (V::add (one, r[4]), V::add (r[0], r[8]));
+	const v_t tz = V::sub (V::add (one, r[8]), V::add (r[0], r[4]));
+	// 4 w x, 4 w y, 4 w z, 4 x y, 4 x z and 4 y z.
+	const v_t wx = V::sub (r[7], r[5]);
+	const v_t wy = V::sub (r[2], r[6]);
+	const v_t wz = V::sub (r[3], r[1]);
+	const v_t xy = V::add (r[1], r[3]);
+	const v_t xz = V::add (r[2], r[6]);
+	const v_t yz = V::add (r[5], r[7]);
+
+	v_t t = tw;
+	v_t c[3] = {wx, wy, wz};
+	index = V::set1 (3.);
+	m_t m = V::lt (t, tx);
+	t = V::select (m, tx, t);
+	index = V::select (m, V::set1 (0.), index);
+	c[0] = V::select (m, xy, c[0]);
+	c[1] = V::select (m, xz, c[1]);
+	c[2] = V::select (m, wx, c[2]);
+	m = V::lt (t, ty);
+	t = V::select (m, ty, t);
+	index = V::select (m, V::set1 (1.), index);
+	c[0] = V::select (m, xy, c[0]);
+	c[1] = V::select (m, yz, c[1]);
+	c[2] = V::select (m, wy, c[2]);
+	m = V::lt (t, tz);
+	t = V::select (m, tz, t);
+	index = V::select (m, V::set1 (2.), index);
+	c[0] = V::select (m, xz, c[0]);
+	c[1] = V::select (m, yz, c[1]);
+	c[2] = V::select (m, wz, c[2]);
+
+	// t = 4 l^2 >= 1, l being the largest coefficient.
+	const v_t s = V::div (V::set1 (.5), V::sqrt (t));
+	const v_t min = V::set1 (-M_SQRT1_2);
+	const v_t inverseStep = V::set1 (rotationCounts / (2. * M_SQRT1_2));
+	const v_t maxCount = V::set1 (rotationCounts);
+	for (unsigned int k = 0; k < 3; ++k)
+	  counts[k] = encode (V::mul (c[k], s), min, inverseStep, maxCount);
+      }
+
+      /// \brief Unit quaternion (x, y, z, w) of a smallest-three
+      /// encoding.
+      static void decodeRotation (v_t index, const v_t* counts, v_t* q)
+      {
+	const v_t min = V::set1 (-M_SQRT1_2);
+	const v_t step = V::set1 (2. * M_SQRT1_2 / rotationCounts);
+	v_t c[3];
+	v_t l = V::set1 (1.);
+	for (unsigned int k = 0; k < 3; ++k)
+	  {
+	    c[k] = decode (counts[k], min, step);
+	    l = V::sub (l, V::mul (c[k], c[k]));
+	  }
+	const v_t zero = V::set1 (0.);
+	l = V::sqrt (V::select (V::lt (l, zero), zero, l));
+
+	const m_t is0 = V::lt (index, V::set1 (.5));
+	const m_t upTo1 = V::lt (index, V::set1 (1.5));
+	const m_t upTo2 = V::lt (index, V::set1 (2.5));
+	q[0] = V::select (is0, l, c[0]);
+	q[1] = V::select (is0, c[0], V::select (upTo1, l, c[1]));
+	q[2] = V::select (upTo1, c[1], V::select (upTo2, l, c[2]));
+	q[3] = V::select (upTo2, c[2], l);
+      }
+    };
+
+    /// \brief Pack a smallest-three encoding in 64 bits.
+    inline std::uint64_t packRotation (double index, const double* counts)
+    {
+      return std::uint64_t (index)
+	| std::uint64_t (counts[0]) << 2
+	| std::uint64_t (counts[1]) << (2 + rotationBits)
+	| std::uint64_t (counts[2]) << (2 + 2 * rotationBits);
+    }
+
+    inline void unpackRotation (std::uint64_t bits, double& index,
+				double* counts)
+    {
+      const std::uint64_t mask = (std::uint64_t (1) << rotationBits) - 1;
+      index = double (bits & 3);
+      counts[0] = double ((bits >> 2) & mask);
+      counts[1] = double ((bits >> (2 + rotationBits)) & mask);
+      counts[2] = double ((bits >> (2 + 2 * rotationBits)) & mask);
+    }
+  } // end of namespace detail.
+
+  /// \brief Regular grid of 65536 values per axis over a box.
+  class Vector3Quantizer
+  {
+  public:
+    /// \brief Constructor.
+    /// \param min lower corner of the box.
+    /// \param max upper corner, larger than min on every axis.
+    Vector3Quantizer (const Vector3D<double>& min,
+		      const Vector3D<double>& max)
+      : min_ (min),
+	max_ (max),
+	step_ ((max.m_x - min.m_x) / detail::coordinateCounts,
+	       (max.m_y - min.m_y) / detail::coordinateCounts,
+	       (max.m_z - min.m_z) / detail::coordinateCounts)
+    {
+      if (! (step_.m_x > 0. && step_.m_y > 0. && step_.m_z > 0.))
+	throw std::invalid_argument ("empty quantization box");
+    }
+
+    const Vector3D<double>& min () const
+    {
+      return min_;
+    }
+
+    const Vector3D<double>& max () const
+    {
+      return max_;
+    }
+
+    const Vector3D<double>& step () const
+    {
+      return step_;
+    }
+
+    /// \brief Largest error per axis inside the box, half a step.
+    Vector3D<double> maxError () const
+    {
+      return step_ * .5;
+    }
+
+    /// \brief Nearest point of the grid; points outside of the box are
+    /// clamped to it.
+    QuantizedVector3D encode (const Vector3D<double>& v) const
+    {
+      typedef detail::Quantization<detail::ScalarOps<double> > scalar_t;
+      const QuantizedVector3D result =
+	{std::uint16_t (scalar_t::encode (v.m_x, min_.m_x, 1. / step_.m_x,
+				     detail::coordinateCounts)),
+	 std::uint16_t (scalar_t::encode (v.m_y, min_.m_y, 1. / step_.m_y,
+				     detail::coordinateCounts)),
+	 std::uint16_t (scalar_t::encode (v.m_z, min_.m_z, 1. / step_.m_z,
+				     detail::coordinateCounts))};
+      return result;
+    }
+
+    Vector3D<double> decode (const QuantizedVector3D& q) const
+    {
+      return Vector3D<double> (min_.m_x + q.m_x * step_.m_x,
+			       min_.m_y + q.m_y * step_.m_y,
+			       min_.m_z + q.m_z * step_.m_z);
+    }
+
+  private:
+    Vector3D<double> min_;
+    Vector3D<double> max_;
+    Vector3D<double> step_;
+  };
+
+  /// \brief Smallest-three encoding of a unit quaternion.
+  inline std::uint64_t encodeRotation (const Quaternion<double>& q)
+  {
+    typedef detail::Quantization<detail::ScalarOps<double> > scalar_t;
+    const double* c = q.data ();
+    unsigned int index = 0;
+    for (unsigned int k = 1; k < 4; ++k)
+      if (std::abs (c[k]) > std::abs (c[index]))
+	index = k;
+    const double sign = c[index] < 0. ? -1. : 1.;
+    double counts[3];
+    for (unsigned int k = 0, j = 0; k < 4; ++k)
+      if (k != index)
+	counts[j++] = scalar_t::encode (sign * c[k], -M_SQRT1_2,
+				   detail::rotationCounts / (2. * M_SQRT1_2),
+				   detail::rotationCounts);
+    return detail::packRotation (index, counts);
+  }
+
+  /// \brief Unit quaternion of a smallest-three encoding, with a
+  /// non-negative largest coefficient.
+  inline Quaternion<double> decodeRotation (std::uint64_t bits)
+  {
+    double index, counts[3], q[4];
+    detail::unpackRotation (bits, index, counts);
+    detail::Quantization<detail::ScalarOps<double> >::decodeRotation
+      (index, counts, q);
+    return Quaternion<double> (q[0], q[1], q[2], q[3]);
+  }
+
+  /// \brief Quantize n positions.
+  inline void encodeVectors (const Vector3Quantizer& quantizer,
+			     const Vector3D<double>* in,
+			     QuantizedVector3D* out, std::size_t n)
+  {
+    typedef detail::Quantization<detail::ScalarOps<double> > scalar_t;
+    const double* x = reinterpret_cast<const double*> (in);
+    std::uint16_t* k = reinterpret_cast<std::uint16_t*> (out);
+    const double min[3] =
+      {quantizer.min ().m_x, quantizer.min ().m_y, quantizer.min ().m_z};
+    const double inverseStep[3] =
+      {1. / quantizer.step ().m_x, 1. / quantizer.step ().m_y,
+       1. / quantizer.step ().m_z};
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    // Four positions are three registers, each axis coming at the
+    // same place every three registers.
+    typedef detail::Simd4<double> V;
+    typedef detail::Quantization<V> kernel_t;
+    V::type mins[3], inverseSteps[3];
+    for (unsigned int r = 0; r < 3; ++r)
+      {
+	mins[r] = V::set (min[r % 3], min[(r + 1) % 3], min[(r + 2) % 3],
+			  min[r % 3]);
+	inverseSteps[r] =
+	  V::set (inverseStep[r % 3], inverseStep[(r + 1) % 3],
+		  inverseStep[(r + 2) % 3], inverseStep[r % 3]);
+      }
+    const V::type counts = V::set1 (detail::coordinateCounts);
+    for (; i + 4 <= n; i += 4)
+      {
+	double buffer[12];
+	for (unsigned int r = 0; r < 3; ++r)
+	  V::store (buffer + 4 * r,
+		    kernel_t::encode (V::load (x + 3 * i + 4 * r), mins[r],
+				 inverseSteps[r], counts));
+	for (unsigned int j = 0; j < 12; ++j)
+	  k[3 * i + j] = std::uint16_t (buffer[j]);
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (std::size_t j = 3 * i; j < 3 * n; ++j)
+      k[j] = std::uint16_t (scalar_t::encode (x[j], min[j % 3],
+					       inverseStep[j % 3],
+					       detail::coordinateCounts));
+  }
+
+  /// \brief Positions of n quantized positions.
+  inline void decodeVectors (const Vector3Quantizer& quantizer,
+			     const QuantizedVector3D* in,
+			     Vector3D<double>* out, std::size_t n)
+  {
+    const std::uint16_t* k = reinterpret_cast<const std::uint16_t*> (in);
+    double* x = reinterpret_cast<double*> (out);
+    const double min[3] =
+      {quantizer.min ().m_x, quantizer.min ().m_y, quantizer.min ().m_z};
+    const double step[3] =
+      {quantizer.step ().m_x, quantizer.step ().m_y, quantizer.step ().m_z};
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    typedef detail::Quantization<V> kernel_t;
+    V::type mins[3], steps[3];
+    for (unsigned int r = 0; r < 3; ++r)
+      {
+	mins[r] = V::set (min[r % 3], min[(r + 1) % 3], min[(r + 2) % 3],
+			  min[r % 3]);
+	steps[r] = V::set (step[r % 3], step[(r + 1) % 3], step[(r + 2) % 3],
+			   step[r % 3]);
+      }
+    for (; i + 4 <= n; i += 4)
+      {
+	double buffer[12];
+	for (unsigned int j = 0; j < 12; ++j)
+	  buffer[j] = k[3 * i + j];
+	for (unsigned int r = 0; r < 3; ++r)
+	  V::store (x + 3 * i + 4 * r,
+		    kernel_t::decode (V::load (buffer + 4 * r), mins[r],
+				      steps[r]));
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (std::size_t j = 3 * i; j < 3 * n; ++j)
+      x[j] = min[j % 3] + k[j] * step[j % 3];
+  }
+
+  /// \brief Quantize n poses, the translations with a quantizer.
+  ///
+  /// The upper 3x3 block of the poses must be a rotation matrix; the
+  /// last row is not stored.
+  inline void encodePoses (const Vector3Quantizer& translations,
+			   const Matrix4x4<double>* in, QuantizedPose* out,
+			   std::size_t n)
+  {
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    typedef detail::Quantization<V> kernel_t;
+    const Vector3D<double>& min = translations.min ();
+    const Vector3D<double>& step = translations.step ();
+    const V::type mins[3] =
+      {V::set1 (min.m_x), V::set1 (min.m_y), V::set1 (min.m_z)};
+    const V::type inverseSteps[3] =
+      {V::set1 (1. / step.m_x), V::set1 (1. / step.m_y),
+       V::set1 (1. / step.m_z)};
+    const V::type counts = V::set1 (detail::coordinateCounts);
+    for (; i + 4 <= n; i += 4)
+      {
+	// Columns of the first three rows of four poses.
+	V::type r[9], t[3];
+	for (unsigned int row = 0; row < 3; ++row)
+	  {
+	    V::type a = V::load (in[i].m + 4 * row);
+	    V::type b = V::load (in[i + 1].m + 4 * row);
+	    V::type c = V::load (in[i + 2].m + 4 * row);
+	    V::type d = V::load (in[i + 3].m + 4 * row);
+	    V::transpose (a, b, c, d);
+	    r[3 * row] = a;
+	    r[3 * row + 1] = b;
+	    r[3 * row + 2] = c;
+	    t[row] = kernel_t::encode (d, mins[row], inverseSteps[row], counts);
+	  }
+	V::type index, c[3];
+	kernel_t::encodeRotation (r, index, c);
+
+	double indices[4], rotations[3][4], coordinates[3][4];
+	V::store (indices, index);
+	for (unsigned int k = 0; k < 3; ++k)
+	  {
+	    V::store (rotations[k], c[k]);
+	    V::store (coordinates[k], t[k]);
+	  }
+	for (unsigned int j = 0; j < 4; ++j)
+	  {
+	    const double rotation[3] =
+	      {rotations[0][j], rotations[1][j], rotations[2][j]};
+	    QuantizedPose& pose = out[i + j];
+	    pose.m_rotation = detail::packRotation (indices[j], rotation);
+	    pose.m_translation.m_x = std::uint16_t (coordinates[0][j]);
+	    pose.m_translation.m_y = std::uint16_t (coordinates[1][j]);
+	    pose.m_translation.m_z = std::uint16_t (coordinates[2][j]);
+	    pose.m_reserved = 0;
+	  }
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Quantization<detail::ScalarOps<double> > scalar_t;
+    for (; i < n; ++i)
+      {
+	const double* m = in[i].m;
+	const double r[9] = {m[0], m[1], m[2], m[4], m[5], m[6],
+			     m[8], m[9], m[10]};
+	double index, c[3];
+	scalar_t::encodeRotation (r, index, c);
+	out[i].m_rotation = detail::packRotation (index, c);
+	out[i].m_translation =
+	  translations.encode (Vector3D<double> (m[3], m[7], m[11]));
+	out[i].m_reserved = 0;
+      }
+  }
+
+  /// \brief Poses of n quantized poses.
+  inline void decodePoses (const Vector3Quantizer& translations,
+			   const QuantizedPose* in, Matrix4x4<double>* out,
+			   std::size_t n)
+  {
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    typedef detail::Quantization<V> kernel_t;
+    const Vector3D<double>& min = translations.min ();
+    const Vector3D<double>& step = translations.step ();
+    const V::type mins[3] =
+      {V::set1 (min.m_x), V::set1 (min.m_y), V::set1 (min.m_z)};
+    const V::type steps[3] =
+      {V::set1 (step.m_x), V::set1 (step.m_y), V::set1 (step.m_z)};
+    for (; i + 4 <= n; i += 4)
+      {
+	double indices[4], rotations[3][4], coordinates[3][4];
+	for (unsigned int j = 0; j < 4; ++j)
+	  {
+	    const QuantizedPose& pose = in[i + j];
+	    double rotation[3];
+	    detail::unpackRotation (pose.m_rotation, indices[j], rotation);
+	    for (unsigned int k = 0; k < 3; ++k)
+	      rotations[k][j] = rotation[k];
+	    coordinates[0][j] = pose.m_translation.m_x;
+	    coordinates[1][j] = pose.m_translation.m_y;
+	    coordinates[2][j] = pose.m_translation.m_z;
+	  }
+	V::type counts[3], q[4], r[9];
+	for (unsigned int k = 0; k < 3; ++k)
+	  counts[k] = V::load (rotations[k]);
+	kernel_t::decodeRotation (V::load (indices), counts, q);
+	detail::RotationFromQuaternion<V>::run (q, r);
+	for (unsigned int row = 0; row < 3; ++row)
+	  {
+	    V::type a = r[3 * row];
+	    V::type b = r[3 * row + 1];
+	    V::type c = r[3 * row + 2];
+	    V::type d = kernel_t::decode (V::load (coordinates[row]), mins[row],
+				     steps[row]);
+	    V::transpose (a, b, c, d);
+	    V::store (out[i].m + 4 * row, a);
+	    V::store (out[i + 1].m + 4 * row, b);
+	    V::store (out[i + 2].m + 4 * row, c);
+	    V::store (out[i + 3].m + 4 * row, d);
+	  }
+	for (unsigned int j = 0; j < 4; ++j)
+	  {
+	    double* m = out[i + j].m;
+	    m[12] = m[13] = m[14] = 0.;
+	    m[15] = 1.;
+	  }
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Quantization<detail::ScalarOps<double> > scalar_t;
+    for (; i < n; ++i)
+      {
+	double index, c[3], q[4], r[9];
+	detail::unpackRotation (in[i].m_rotation, index, c);
+	scalar_t::decodeRotation (index, c, q);
+	detail::RotationFromQuaternion<detail::ScalarOps<double> >::run (q, r);
+	const Vector3D<double> t = translations.decode (in[i].m_translation);
+	double* m = out[i].m;
+	m[0] = r[0]; m[1] = r[1]; m[2] = r[2]; m[3] = t.m_x;
+	m[4] = r[3]; m[5] = r[4]; m[6] = r[5]; m[7] = t.m_y;
+	m[8] = r[6]; m[9] = r[7]; m[10] = r[8]; m[11] = t.m_z;
+	m[12] = m[13] = m[14] = 0.;
+	m[15] = 1.;
+      }
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_QUANTIZATION_HH
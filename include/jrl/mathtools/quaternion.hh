@@ -0,0 +1,583 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_QUATERNION_HH
+# define JRL_MATHTOOLS_QUATERNION_HH
+# include <cmath>
+# include <cstddef>
+# include <iostream>
+# include <limits>
+# include <type_traits>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+# include <jrl/mathtools/constants.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/vector4.hh>
+# include <jrl/mathtools/matrix3x3.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Generic quaternion.
+  ///
+  /// Coefficients are stored as (x, y, z, w), w being the real part,
+  /// in the same order as Vector4D. Rotations are represented by unit
+  /// quaternions, with the Hamilton convention: q * v * q^-1 rotates
+  /// v, and p * q applies q first.
+  template <typename T>
+  struct Quaternion
+  {
+    T m_x;
+    T m_y;
+    T m_z;
+    T m_w;
+
+    /// \brief Default constructor: the identity rotation.
+    constexpr Quaternion ()
+      : m_x (),
+	m_y (),
+	m_z (),
+	m_w (1)
+    {}
+
+    /// \brief Constructor from the coefficients, in storage order.
+    constexpr Quaternion (const T x, const T y, const T z, const T w)
+      : m_x (x),
+	m_y (y),
+	m_z (z),
+	m_w (w)
+    {}
+
+    /// \brief Constructor from the coefficients of a Vector4D.
+    constexpr explicit Quaternion (const Vector4D<T>& v)
+      : m_x (v.m_x),
+	m_y (v.m_y),
+	m_z (v.m_z),
+	m_w (v.m_w)
+    {}
+
+    /// \brief Constructor from a rotation matrix.
+    ///
+    /// The matrix is assumed to be orthonormal. The real part of the
+    /// result is non-negative.
+    explicit Quaternion (const Matrix3x3<T>& R)
+    {
+      fromRotationMatrix (R);
+    }
+
+    /// \brief Rotation of angle about a unit axis.
+    static Quaternion<T> fromAxisAngle (const Vector3D<T>& axis,
+					const T angle)
+    {
+      const T s = std::sin (angle / 2);
+      return Quaternion<T> (axis.m_x * s, axis.m_y * s, axis.m_z * s,
+			    std::cos (angle / 2));
+    }
+
+    /// \brief Coefficients as a Vector4D.
+    constexpr Vector4D<T> toVector4D () const
+    {
+      return Vector4D<T> (m_x, m_y, m_z, m_w);
+    }
+
+    /// \brief Coefficient members, in storage order.
+    ///
+    /// Element access goes through this table rather than through
+    /// data (), so that it does not index past a single member.
+    static constexpr T Quaternion::* const members[4] =
+      {&Quaternion::m_x, &Quaternion::m_y, &Quaternion::m_z, &Quaternion::m_w};
+
+    /// \brief Coefficients as a contiguous array.
+    ///
+    /// Quaternion is a standard-layout struct of four T without padding,
+    /// which is checked below. Arrays of Quaternion can therefore be
+    /// passed to kernels working on flat arrays of T, as the
+    /// batched slerp, nlerp and se3Distances do.
+    inline T* data ()
+    {
+      static_assert (std::is_standard_layout<Quaternion<T> >::value,
+		     "Quaternion must have a standard layout");
+      static_assert (sizeof (Quaternion<T>) == 4 * sizeof (T),
+		     "Quaternion coefficients must be contiguous");
+      return &m_x;
+    }
+
+    /// \brief Coefficients as a contiguous array.
+    inline const T* data () const
+    {
+      static_assert (std::is_standard_layout<Quaternion<T> >::value,
+		     "Quaternion must have a standard layout");
+      static_assert (sizeof (Quaternion<T>) == 4 * sizeof (T),
+		     "Quaternion coefficients must be contiguous");
+      return &m_x;
+    }
+
+    /// \brief Array operator, in storage order.
+    inline T& operator[] (unsigned i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4);
+      return this->*members[i];
+    }
+
+    /// \brief Array operator, in storage order.
+    inline T operator[] (unsigned i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4);
+      return this->*members[i];
+    }
+
+    /// \brief Binary operator ==.
+    constexpr bool operator== (const Quaternion<T>& q) const
+    {
+      return m_x == q.m_x && m_y == q.m_y && m_z == q.m_z && m_w == q.m_w;
+    }
+
+    /// \brief Binary operator !=.
+    constexpr bool operator!= (const Quaternion<T>& q) const
+    {
+      return ! (*this == q);
+    }
+
+    /// \brief Unary operator -.
+    ///
+    /// -q represents the same rotation as q.
+    constexpr Quaternion<T> operator- () const
+    {
+      return Quaternion<T> (-m_x, -m_y, -m_z, -m_w);
+    }
+
+    /// \brief Composition: the rotation q followed by this one.
+    constexpr Quaternion<T> operator* (const Quaternion<T>& q) const
+    {
+      return Quaternion<T>
+	(m_w * q.m_x + m_x * q.m_w + m_y * q.m_z - m_z * q.m_y,
+	 m_w * q.m_y - m_x * q.m_z + m_y * q.m_w + m_z * q.m_x,
+	 m_w * q.m_z + m_x * q.m_y - m_y * q.m_x + m_z * q.m_w,
+	 m_w * q.m_w - m_x * q.m_x - m_y * q.m_y - m_z * q.m_z);
+    }
+
+    /// \brief Binary operator *=.
+    inline void operator*= (const Quaternion<T>& q)
+    {
+      *this = *this * q;
+    }
+
+    /// \brief Rotation of a vector.
+    ///
+    /// Uses v + 2w (u x v) + 2u x (u x v), u being the vector part,
+    /// which needs 15 multiplications instead of 27 for the matrix.
+    constexpr Vector3D<T> operator* (const Vector3D<T>& v) const
+    {
+      return rotate (v, Vector3D<T> (2 * (m_y * v.m_z - m_z * v.m_y),
+				     2 * (m_z * v.m_x - m_x * v.m_z),
+				     2 * (m_x * v.m_y - m_y * v.m_x)));
+    }
+
+    /// \brief Conjugate, the inverse rotation for a unit quaternion.
+    constexpr Quaternion<T> conjugate () const
+    {
+      return Quaternion<T> (-m_x, -m_y, -m_z, m_w);
+    }
+
+    /// \brief Inverse.
+    constexpr Quaternion<T> inverse () const
+    {
+      return Quaternion<T> (-m_x / normsquared (), -m_y / normsquared (),
+			    -m_z / normsquared (), m_w / normsquared ());
+    }
+
+    /// \brief Dot product of the coefficients.
+    constexpr T dot (const Quaternion<T>& q) const
+    {
+      return m_x * q.m_x + m_y * q.m_y + m_z * q.m_z + m_w * q.m_w;
+    }
+
+    /// \brief Get the norm squared.
+    constexpr T normsquared () const
+    {
+      return dot (*this);
+    }
+
+    /// \brief Get the norm.
+    inline T norm () const
+    {
+      return std::sqrt (normsquared ());
+    }
+
+    /// \brief Normalize.
+    inline void normalize ()
+    {
+      const T in = 1 / norm ();
+      m_x *= in;
+      m_y *= in;
+      m_z *= in;
+      m_w *= in;
+    }
+
+    /// \brief Normalized copy.
+    inline Quaternion<T> normalized () const
+    {
+      Quaternion<T> q (*this);
+      q.normalize ();
+      return q;
+    }
+
+    /// \brief Rotation matrix of a unit quaternion.
+    Matrix3x3<T> toRotationMatrix () const
+    {
+      const T x2 = m_x + m_x;
+      const T y2 = m_y + m_y;
+      const T z2 = m_z + m_z;
+      const T xx = m_x * x2;
+      const T yy = m_y * y2;
+      const T zz = m_z * z2;
+      const T xy = m_x * y2;
+      const T xz = m_x * z2;
+      const T yz = m_y * z2;
+      const T wx = m_w * x2;
+      const T wy = m_w * y2;
+      const T wz = m_w * z2;
+      return Matrix3x3<T> (1 - yy - zz, xy - wz, xz + wy,
+			   xy + wz, 1 - xx - zz, yz - wx,
+			   xz - wy, yz + wx, 1 - xx - yy);
+    }
+
+    inline std::ostream& display (std::ostream& os) const
+    {
+      os << m_x << " " << m_y << " " << m_z << " " << m_w;
+      return os;
+    }
+
+  private:
+    constexpr Vector3D<T> rotate (const Vector3D<T>& v,
+				  const Vector3D<T>& t) const
+    {
+      return Vector3D<T> (v.m_x + m_w * t.m_x + m_y * t.m_z - m_z * t.m_y,
+			  v.m_y + m_w * t.m_y + m_z * t.m_x - m_x * t.m_z,
+			  v.m_z + m_w * t.m_z + m_x * t.m_y - m_y * t.m_x);
+    }
+
+    /// \brief Shepperd's method: the largest of the four squared
+    /// coefficients is extracted first, so that the square root and
+    /// the division are always well conditioned.
+    void fromRotationMatrix (const Matrix3x3<T>& R)
+    {
+      const T* m = R.m;
+      const T trace = m[0] + m[4] + m[8];
+      if (trace > m[0] && trace > m[4] && trace > m[8])
+	{
+	  const T s = 2 * std::sqrt (1 + trace);
+	  m_w = s / 4;
+	  m_x = (m[7] - m[5]) / s;
+	  m_y = (m[2] - m[6]) / s;
+	  m_z = (m[3] - m[1]) / s;
+	}
+      else if (m[0] >= m[4] && m[0] >= m[8])
+	{
+	  const T s = 2 * std::sqrt (1 + m[0] - m[4] - m[8]);
+	  m_w = (m[7] - m[5]) / s;
+	  m_x = s / 4;
+	  m_y = (m[1] + m[3]) / s;
+	  m_z = (m[2] + m[6]) / s;
+	}
+      else if (m[4] >= m[8])
+	{
+	  const T s = 2 * std::sqrt (1 + m[4] - m[0] - m[8]);
+	  m_w = (m[2] - m[6]) / s;
+	  m_x = (m[1] + m[3]) / s;
+	  m_y = s / 4;
+	  m_z = (m[5] + m[7]) / s;
+	}
+      else
+	{
+	  const T s = 2 * std::sqrt (1 + m[8] - m[0] - m[4]);
+	  m_w = (m[3] - m[1]) / s;
+	  m_x = (m[2] + m[6]) / s;
+	  m_y = (m[5] + m[7]) / s;
+	  m_z = s / 4;
+	}
+      if (m_w < T ())
+	{
+	  m_x = -m_x;
+	  m_y = -m_y;
+	  m_z = -m_z;
+	  m_w = -m_w;
+	}
+    }
+  };
+
+# if __cplusplus < 201703L
+  // Namespace-scope definition, needed before C++17 inline variables.
+  template <typename T>
+  constexpr T Quaternion<T>::* const Quaternion<T>::members[4];
+# endif //! __cplusplus < 201703L
+
+  template <typename T>
+  inline std::ostream& operator<< (std::ostream& os, const Quaternion<T>& q)
+  {
+    return q.display (os);
+  }
+
+  namespace detail
+  {
+    /// \brief Interpolation kernels, written once against the
+    /// ScalarOps / Simd4 interface.
+    ///
+    /// Quaternions are passed coefficient-wise so that V may hold one
+    /// or four of them. b is replaced by -b when needed so that the
+    /// shortest path is followed.
+    template <typename T, typename V>
+    struct Interpolation
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+      typedef Trigonometry<T, V> trigonometry_t;
+
+      /// \brief Flip b so that it lies in the half-space of a.
+      static void shortestPath (const v_t* a, v_t* b)
+      {
+	const v_t d = V::fma (a[0], b[0],
+			      V::fma (a[1], b[1],
+				      V::fma (a[2], b[2],
+					      V::mul (a[3], b[3]))));
+	const m_t flip = V::lt (d, V::set1 (T ()));
+	for (unsigned int k = 0; k < 4; ++k)
+	  b[k] = V::select (flip, V::neg (b[k]), b[k]);
+      }
+
+      static void slerp (const v_t* a, const v_t* bIn, v_t t, v_t* out)
+      {
+	v_t b[4] = {bIn[0], bIn[1], bIn[2], bIn[3]};
+	shortestPath (a, b);
+
+	// The angle between a and b is 2 atan (|b - a| / |b + a|), which
+	// is accurate even for nearby quaternions, unlike acos (a.b).
+	v_t diff = V::set1 (T ());
+	v_t sum = V::set1 (T ());
+	for (unsigned int k = 0; k < 4; ++k)
+	  {
+	    const v_t dk = V::sub (b[k], a[k]);
+	    const v_t sk = V::add (b[k], a[k]);
+	    diff = V::fma (dk, dk, diff);
+	    sum = V::fma (sk, sk, sum);
+	  }
+	const v_t half =
+	  trigonometry_t::atan (V::sqrt (V::div (diff, sum)));
+	const v_t angle = V::add (half, half);
+
+	// sin (k angle) / sin (angle) tends to k for small angles, and
+	// is computed this way below the square root of the epsilon.
+	const v_t one = V::set1 (T (1));
+	const v_t s = V::sub (one, t);
+	const m_t small =
+	  V::lt (angle,
+		 V::set1 (std::sqrt (std::numeric_limits<T>::epsilon ())));
+	const v_t inv =
+	  V::div (one, trigonometry_t::sin (V::select (small, one, angle)));
+	const v_t wa = V::select
+	  (small, s, V::mul (trigonometry_t::sin (V::mul (s, angle)), inv));
+	const v_t wb = V::select
+	  (small, t, V::mul (trigonometry_t::sin (V::mul (t, angle)), inv));
+	for (unsigned int k = 0; k < 4; ++k)
+	  out[k] = V::fma (a[k], wa, V::mul (b[k], wb));
+      }
+
+      static void nlerp (const v_t* a, const v_t* bIn, v_t t, v_t* out)
+      {
+	v_t b[4] = {bIn[0], bIn[1], bIn[2], bIn[3]};
+	shortestPath (a, b);
+
+	const v_t s = V::sub (V::set1 (T (1)), t);
+	v_t n = V::set1 (T ());
+	for (unsigned int k = 0; k < 4; ++k)
+	  {
+	    out[k] = V::fma (a[k], s, V::mul (b[k], t));
+	    n = V::fma (out[k], out[k], n);
+	  }
+	const v_t inv = V::div (V::set1 (T (1)), V::sqrt (n));
+	for (unsigned int k = 0; k < 4; ++k)
+	  out[k] = V::mul (out[k], inv);
+      }
+    };
+
+    /// \brief Interpolate the first quaternions of arrays, four at a
+    /// time, return how many were processed.
+    template <typename T, bool Spherical,
+	      bool Vectorized = HasSimd4<T>::value>
+    struct InterpolateQuaternionsSimd4
+    {
+      static std::size_t run (const T*, const T*, const T*, T*, std::size_t)
+      {
+	return 0;
+      }
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <typename T, bool Spherical>
+    struct InterpolateQuaternionsSimd4<T, Spherical, true>
+    {
+      static std::size_t run (const T* a, const T* b, const T* t, T* out,
+			      std::size_t n)
+      {
+	typedef Simd4<T> V;
+	typedef typename V::type v_t;
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	  {
+	    // Load four quaternions and transpose them, so that each
+	    // register holds one coefficient of the four of them.
+	    v_t qa[4], qb[4], r[4];
+	    for (unsigned int k = 0; k < 4; ++k)
+	      {
+		qa[k] = V::load (a + 4 * (i + k));
+		qb[k] = V::load (b + 4 * (i + k));
+	      }
+	    V::transpose (qa[0], qa[1], qa[2], qa[3]);
+	    V::transpose (qb[0], qb[1], qb[2], qb[3]);
+	    const v_t tv = V::load (t + i);
+	    if (Spherical)
+	      Interpolation<T, V>::slerp (qa, qb, tv, r);
+	    else
+	      Interpolation<T, V>::nlerp (qa, qb, tv, r);
+	    V::transpose (r[0], r[1], r[2], r[3]);
+	    for (unsigned int k = 0; k < 4; ++k)
+	      V::store (out + 4 * (i + k), r[k]);
+	  }
+	return i;
+      }
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Apply an interpolation kernel to arrays of quaternions.
+    template <typename T, bool Spherical>
+    struct InterpolateQuaternions
+    {
+      typedef Interpolation<T, ScalarOps<T> > scalar_t;
+
+      static void one (const T* a, const T* b, T t, T* out)
+      {
+	T r[4];
+	if (Spherical)
+	  scalar_t::slerp (a, b, t, r);
+	else
+	  scalar_t::nlerp (a, b, t, r);
+	for (unsigned int k = 0; k < 4; ++k)
+	  out[k] = r[k];
+      }
+
+      static void run (const T* a, const T* b, const T* t, T* out,
+		       std::size_t n)
+      {
+	std::size_t i =
+	  InterpolateQuaternionsSimd4<T, Spherical>::run (a, b, t, out, n);
+	for (; i < n; ++i)
+	  one (a + 4 * i, b + 4 * i, t[i], out + 4 * i);
+      }
+    };
+
+    /// \brief Row-major rotation matrix of unit quaternions passed
+    /// coefficient-wise, as Quaternion::toRotationMatrix.
+    template <typename V>
+    struct RotationFromQuaternion
+    {
+      typedef typename V::type v_t;
+
+      static void run (const v_t* q, v_t* r)
+      {
+	const v_t x2 = V::add (q[0], q[0]);
+	const v_t y2 = V::add (q[1], q[1]);
+	const v_t z2 = V::add (q[2], q[2]);
+	const v_t xx = V::mul (q[0], x2);
+	const v_t yy = V::mul (q[1], y2);
+	const v_t zz = V::mul (q[2], z2);
+	const v_t xy = V::mul (q[0], y2);
+	const v_t xz = V::mul (q[0], z2);
+	const v_t yz = V::mul (q[1], z2);
+	const v_t wx = V::mul (q[3], x2);
+	const v_t wy = V::mul (q[3], y2);
+	const v_t wz = V::mul (q[3], z2);
+	const v_t one = V::set1 (1.);
+	r[0] = V::sub (V::sub (one, yy), zz);
+	r[1] = V::sub (xy, wz);
+	r[2] = V::add (xz, wy);
+	r[3] = V::add (xy, wz);
+	r[4] = V::sub (V::sub (one, xx), zz);
+	r[5] = V::sub (yz, wx);
+	r[6] = V::sub (xz, wy);
+	r[7] = V::add (yz, wx);
+	r[8] = V::sub (V::sub (one, xx), yy);
+      }
+    };
+  } // end of namespace detail.
+
+  /// \brief Spherical linear interpolation between unit quaternions.
+  ///
+  /// Follows the shortest path, the result is a for t = 0 and b (or -b)
+  /// for t = 1. t is expected to lie in [0, 1].
+  template <typename T>
+  Quaternion<T> slerp (const Quaternion<T>& a, const Quaternion<T>& b,
+		       const T t)
+  {
+    Quaternion<T> r;
+    detail::InterpolateQuaternions<T, true>::one (a.data (), b.data (), t,
+						  r.data ());
+    return r;
+  }
+
+  /// \brief Normalized linear interpolation between unit quaternions.
+  ///
+  /// Cheaper than slerp, with the same end points, but the angular
+  /// velocity is not constant.
+  template <typename T>
+  Quaternion<T> nlerp (const Quaternion<T>& a, const Quaternion<T>& b,
+		       const T t)
+  {
+    Quaternion<T> r;
+    detail::InterpolateQuaternions<T, false>::one (a.data (), b.data (), t,
+						   r.data ());
+    return r;
+  }
+
+  /// \brief Batched slerp: out[i] = slerp (a[i], b[i], t[i]).
+  ///
+  /// out may be a or b.
+  template <typename T>
+  void slerp (const Quaternion<T>* a, const Quaternion<T>* b, const T* t,
+	      Quaternion<T>* out, std::size_t n)
+  {
+    detail::InterpolateQuaternions<T, true>::run
+      (reinterpret_cast<const T*> (a), reinterpret_cast<const T*> (b), t,
+       reinterpret_cast<T*> (out), n);
+  }
+
+  /// \brief Batched nlerp: out[i] = nlerp (a[i], b[i], t[i]).
+  ///
+  /// out may be a or b.
+  template <typename T>
+  void nlerp (const Quaternion<T>* a, const Quaternion<T>* b, const T* t,
+	      Quaternion<T>* out, std::size_t n)
+  {
+    detail::InterpolateQuaternions<T, false>::run
+      (reinterpret_cast<const T*> (a), reinterpret_cast<const T*> (b), t,
+       reinterpret_cast<T*> (out), n);
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_QUATERNION_HH
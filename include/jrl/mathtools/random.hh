@@ -0,0 +1,304 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef JRL_MATHTOOLS_RANDOM_HH
+# define JRL_MATHTOOLS_RANDOM_HH
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+# include <cstdint>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/simd.hh>
+# include <jrl/mathtools/trigonometry.hh>
+
+# include <jrl/mathtools/matrix3x3.hh>
+# include <jrl/mathtools/quaternion.hh>
+
+// Bulk sampling of uniformly distributed angles and rotations.
+//
+// Random numbers come from Philox4x32-10 (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC 2011), a counter-based
+// generator: the n-th block of 128 bits of a stream is a bijective
+// function of (seed, stream, n). Streams are thus reproducible,
+// independent whatever the order in which they are drawn, and do not
+// overlap, which makes them suitable for one stream per thread.
+//
+// The batched samplers fill coordinate-wise (SoA) buffers: coordinate
+// k of sample i is out[k * n + i]. Uniform numbers are drawn first
+// into the output, then mapped in place four samples at a time when
+// Simd4 is available.
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Philox4x32-10 block function.
+    inline void philox4x32 (const std::uint32_t* counter,
+			    const std::uint32_t* key, std::uint32_t* out)
+    {
+      std::uint32_t c[4] = {counter[0], counter[1], counter[2], counter[3]};
+      std::uint32_t k[2] = {key[0], key[1]};
+      for (unsigned int round = 0; round < 10; ++round)
+	{
+	  const std::uint64_t p0 = std::uint64_t (0xD2511F53) * c[0];
+	  const std::uint64_t p1 = std::uint64_t (0xCD9E8D57) * c[2];
+	  const std::uint32_t hi0 = std::uint32_t (p0 >> 32);
+	  const std::uint32_t hi1 = std::uint32_t (p1 >> 32);
+	  c[0] = hi1 ^ c[1] ^ k[0];
+	  c[1] = std::uint32_t (p1);
+	  c[2] = hi0 ^ c[3] ^ k[1];
+	  c[3] = std::uint32_t (p0);
+	  k[0] += 0x9E3779B9;
+	  k[1] += 0xBB67AE85;
+	}
+      for (unsigned int i = 0; i < 4; ++i)
+	out[i] = c[i];
+    }
+
+    /// \brief Double in [0, 1) from the 53 high bits of (hi, lo).
+    inline double toUniform (std::uint32_t hi, std::uint32_t lo)
+    {
+      const std::uint64_t bits = (std::uint64_t (hi) << 21) | (lo >> 11);
+      return static_cast<double> (bits) * (1. / 9007199254740992.);
+    }
+
+    /// \brief Maps of uniform numbers to samples, written once against
+    /// the ScalarOps / Simd4 interface.
+    template <typename V>
+    struct Sampling
+    {
+      typedef typename V::type v_t;
+
+      /// \brief Angle in [-pi, pi) from u in [0, 1).
+      static v_t angle (v_t u)
+      {
+	return V::fma (u, V::set1 (2. * M_PI), V::set1 (-M_PI));
+      }
+
+      /// \brief Uniform unit quaternion (x, y, z, w) from three uniform
+      /// numbers (K. Shoemake, "Uniform random rotations", Graphics
+      /// Gems III, 1992).
+      static void quaternion (const v_t* u, v_t* q)
+      {
+	const v_t one = V::set1 (1.);
+	const v_t r1 = V::sqrt (V::sub (one, u[0]));
+	const v_t r2 = V::sqrt (u[0]);
+	v_t s1, c1, s2, c2;
+	WrappedSinCos<double, V, FULL_PRECISION>::run (angle (u[1]), s1, c1);
+	WrappedSinCos<double, V, FULL_PRECISION>::run (angle (u[2]), s2, c2);
+	q[0] = V::mul (r1, s1);
+	q[1] = V::mul (r1, c1);
+	q[2] = V::mul (r2, s2);
+	q[3] = V::mul (r2, c2);
+      }
+    };
+  } // end of namespace detail.
+
+  /// \brief Stream of random numbers, Philox4x32-10 keyed by a seed.
+  ///
+  /// Streams with different (seed, stream) pairs are independent: give
+  /// each thread its own stream index to sample in parallel. Each
+  /// call consumes whole 128-bit blocks, that is two doubles.
+  class RandomStream
+  {
+  public:
+    /// \brief Constructor.
+    /// \param seed key of the generator.
+    /// \param stream index of the stream for this key.
+    explicit RandomStream (std::uint64_t seed = 0, std::uint64_t stream = 0)
+      : seed_ (seed),
+	stream_ (stream),
+	position_ (0)
+    {}
+
+    std::uint64_t seed () const
+    {
+      return seed_;
+    }
+
+    std::uint64_t stream () const
+    {
+      return stream_;
+    }
+
+    /// \brief Index of the next block.
+    std::uint64_t position () const
+    {
+      return position_;
+    }
+
+    /// \brief Jump to the block of index position, in constant time.
+    void seek (std::uint64_t position)
+    {
+      position_ = position;
+    }
+
+    /// \brief Next 128 random bits.
+    void next (std::uint32_t* out)
+    {
+      const std::uint32_t counter[4] =
+	{std::uint32_t (position_), std::uint32_t (position_ >> 32),
+	 std::uint32_t (stream_), std::uint32_t (stream_ >> 32)};
+      const std::uint32_t key[2] =
+	{std::uint32_t (seed_), std::uint32_t (seed_ >> 32)};
+      detail::philox4x32 (counter, key, out);
+      ++position_;
+    }
+
+    /// \brief Uniform double in [0, 1).
+    double uniform ()
+    {
+      std::uint32_t bits[4];
+      next (bits);
+      return detail::toUniform (bits[0], bits[1]);
+    }
+
+    /// \brief Fill out with n uniform doubles in [0, 1).
+    void uniform (double* out, std::size_t n)
+    {
+      std::uint32_t bits[4];
+      std::size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+	{
+	  next (bits);
+	  out[i] = detail::toUniform (bits[0], bits[1]);
+	  out[i + 1] = detail::toUniform (bits[2], bits[3]);
+	}
+      if (i < n)
+	out[i] = uniform ();
+    }
+
+  private:
+    std::uint64_t seed_;
+    std::uint64_t stream_;
+    std::uint64_t position_;
+  };
+
+  /// \brief n uniform angles in [-PI, PI).
+  inline void randomAngles (RandomStream& random, double* out,
+			    std::size_t n)
+  {
+    random.uniform (out, n);
+    typedef detail::ScalarOps<double> S;
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    for (; i + 4 <= n; i += 4)
+      V::store (out + i, detail::Sampling<V>::angle (V::load (out + i)));
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      out[i] = detail::Sampling<S>::angle (out[i]);
+  }
+
+  /// \brief n uniform unit quaternions, coordinate-wise: x, y, z and w
+  /// of quaternion i are out[i], out[n + i], out[2 n + i] and
+  /// out[3 n + i].
+  inline void randomQuaternions (RandomStream& random, double* out,
+				 std::size_t n)
+  {
+    random.uniform (out, 3 * n);
+    typedef detail::ScalarOps<double> S;
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    for (; i + 4 <= n; i += 4)
+      {
+	V::type u[3], q[4];
+	for (unsigned int k = 0; k < 3; ++k)
+	  u[k] = V::load (out + k * n + i);
+	detail::Sampling<V>::quaternion (u, q);
+	for (unsigned int k = 0; k < 4; ++k)
+	  V::store (out + k * n + i, q[k]);
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      {
+	double u[3], q[4];
+	for (unsigned int k = 0; k < 3; ++k)
+	  u[k] = out[k * n + i];
+	detail::Sampling<S>::quaternion (u, q);
+	for (unsigned int k = 0; k < 4; ++k)
+	  out[k * n + i] = q[k];
+      }
+  }
+
+  /// \brief n uniform rotation matrices, coordinate-wise: the entry
+  /// (r, c) of matrix i is out[(3 r + c) n + i].
+  inline void randomRotations (RandomStream& random, double* out,
+			       std::size_t n)
+  {
+    randomQuaternions (random, out, n);
+    typedef detail::ScalarOps<double> S;
+    std::size_t i = 0;
+# if JRL_MATHTOOLS_HAS_AVX2
+    typedef detail::Simd4<double> V;
+    for (; i + 4 <= n; i += 4)
+      {
+	V::type q[4], r[9];
+	for (unsigned int k = 0; k < 4; ++k)
+	  q[k] = V::load (out + k * n + i);
+	detail::RotationFromQuaternion<V>::run (q, r);
+	for (unsigned int k = 0; k < 9; ++k)
+	  V::store (out + k * n + i, r[k]);
+      }
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+    for (; i < n; ++i)
+      {
+	double q[4], r[9];
+	for (unsigned int k = 0; k < 4; ++k)
+	  q[k] = out[k * n + i];
+	detail::RotationFromQuaternion<S>::run (q, r);
+	for (unsigned int k = 0; k < 9; ++k)
+	  out[k * n + i] = r[k];
+      }
+  }
+
+  /// \brief n uniform unit quaternions.
+  inline void randomQuaternions (RandomStream& random,
+				 Quaternion<double>* out, std::size_t n)
+  {
+    const std::size_t chunk = 64;
+    double buffer[4 * chunk];
+    for (std::size_t i = 0; i < n; i += chunk)
+      {
+	const std::size_t m = std::min (chunk, n - i);
+	randomQuaternions (random, buffer, m);
+	for (std::size_t j = 0; j < m; ++j)
+	  out[i + j] = Quaternion<double> (buffer[j], buffer[m + j],
+					   buffer[2 * m + j],
+					   buffer[3 * m + j]);
+      }
+  }
+
+  /// \brief n uniform rotation matrices.
+  inline void randomRotations (RandomStream& random, Matrix3x3<double>* out,
+			       std::size_t n)
+  {
+    const std::size_t chunk = 64;
+    double buffer[9 * chunk];
+    for (std::size_t i = 0; i < n; i += chunk)
+      {
+	const std::size_t m = std::min (chunk, n - i);
+	randomRotations (random, buffer, m);
+	for (std::size_t j = 0; j < m; ++j)
+	  for (unsigned int k = 0; k < 9; ++k)
+	    out[i + j].m[k] = buffer[k * m + j];
+      }
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_RANDOM_HH
@@ -0,0 +1,390 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_SIMD_HH
+# define JRL_MATHTOOLS_SIMD_HH
+# include <cmath>
+
+// Selection of the hand-vectorized code paths.
+//
+// Some kernels have an intrinsic-based implementation which is used
+// when the compiler targets an instruction set supporting it (e.g.
+// -mavx2 or -march=native). The portable scalar code is used
+// otherwise, and gives identical results up to rounding.
+//
+// Hand-vectorized paths can be disabled by defining
+// JRL_MATHTOOLS_DISABLE_SIMD before including any jrl-mathtools header.
+# ifndef JRL_MATHTOOLS_DISABLE_SIMD
+#  if defined __AVX2__
+#   define JRL_MATHTOOLS_HAS_AVX2 1
+#  endif
+#  if defined __FMA__
+#   define JRL_MATHTOOLS_HAS_FMA 1
+#  endif
+# endif //! JRL_MATHTOOLS_DISABLE_SIMD
+
+# ifndef JRL_MATHTOOLS_HAS_AVX2
+#  define JRL_MATHTOOLS_HAS_AVX2 0
+# endif
+# ifndef JRL_MATHTOOLS_HAS_FMA
+#  define JRL_MATHTOOLS_HAS_FMA 0
+# endif
+
+# if JRL_MATHTOOLS_HAS_AVX2
+#  include <immintrin.h>
+# endif
+
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Whether Simd4<T> is available.
+    template <typename T>
+    struct HasSimd4
+    {
+      static const bool value = false;
+    };
+
+# if JRL_MATHTOOLS_HAS_AVX2
+    template <>
+    struct HasSimd4<double>
+    {
+      static const bool value = true;
+    };
+
+    template <>
+    struct HasSimd4<float>
+    {
+      static const bool value = true;
+    };
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+    /// \brief Arithmetic on plain scalars with the interface of Simd4.
+    ///
+    /// Kernels written against this interface run unchanged on one
+    /// element, for the remainder of a batch, or on four lanes.
+    template <typename T>
+    struct ScalarOps
+    {
+      typedef T type;
+      typedef bool mask;
+
+      static type set1 (T x)
+      {
+	return x;
+      }
+
+      static type add (type a, type b)
+      {
+	return a + b;
+      }
+
+      static type sub (type a, type b)
+      {
+	return a - b;
+      }
+
+      static type mul (type a, type b)
+      {
+	return a * b;
+      }
+
+      static type div (type a, type b)
+      {
+	return a / b;
+      }
+
+      /// \brief a * b + c.
+      static type fma (type a, type b, type c)
+      {
+	return a * b + c;
+      }
+
+      static type neg (type a)
+      {
+	return -a;
+      }
+
+      static type sqrt (type a)
+      {
+	return std::sqrt (a);
+      }
+
+      static type floor (type a)
+      {
+	return std::floor (a);
+      }
+
+      static mask lt (type a, type b)
+      {
+	return a < b;
+      }
+
+      /// \brief Whether the mask is set in every lane.
+      static bool all (mask m)
+      {
+	return m;
+      }
+
+      /// \brief m ? a : b.
+      static type select (mask m, type a, type b)
+      {
+	return m ? a : b;
+      }
+    };
+  } // end of namespace detail.
+} // end of namespace jrlMathTools.
+
+# if JRL_MATHTOOLS_HAS_AVX2
+
+namespace jrlMathTools
+{
+  namespace detail
+  {
+    /// \brief Four-lane vector of T.
+    ///
+    /// Lanes are always numbered from the lowest address, set() and
+    /// permute() take them in that order. blend() takes lane i from b
+    /// when bit i of the mask is set.
+    template <typename T>
+    struct Simd4;
+
+    template <>
+    struct Simd4<double>
+    {
+      typedef __m256d type;
+
+      static type load (const double* p)
+      {
+	return _mm256_loadu_pd (p);
+      }
+
+      static void store (double* p, type v)
+      {
+	_mm256_storeu_pd (p, v);
+      }
+
+      static type set1 (double x)
+      {
+	return _mm256_set1_pd (x);
+      }
+
+      static type set (double x0, double x1, double x2, double x3)
+      {
+	return _mm256_setr_pd (x0, x1, x2, x3);
+      }
+
+      /// \brief a * b + c.
+      static type fma (type a, type b, type c)
+      {
+#  if JRL_MATHTOOLS_HAS_FMA
+	return _mm256_fmadd_pd (a, b, c);
+#  else
+	return _mm256_add_pd (_mm256_mul_pd (a, b), c);
+#  endif
+      }
+
+      template <int Mask>
+      static type blend (type a, type b)
+      {
+	return _mm256_blend_pd (a, b, Mask);
+      }
+
+      template <int L0, int L1, int L2, int L3>
+      static type permute (type v)
+      {
+	return _mm256_permute4x64_pd (v, _MM_SHUFFLE (L3, L2, L1, L0));
+      }
+
+      typedef __m256d mask;
+
+      static type add (type a, type b)
+      {
+	return _mm256_add_pd (a, b);
+      }
+
+      static type sub (type a, type b)
+      {
+	return _mm256_sub_pd (a, b);
+      }
+
+      static type mul (type a, type b)
+      {
+	return _mm256_mul_pd (a, b);
+      }
+
+      static type div (type a, type b)
+      {
+	return _mm256_div_pd (a, b);
+      }
+
+      static type neg (type a)
+      {
+	return _mm256_xor_pd (a, _mm256_set1_pd (-0.));
+      }
+
+      static type sqrt (type a)
+      {
+	return _mm256_sqrt_pd (a);
+      }
+
+      static type floor (type a)
+      {
+	return _mm256_floor_pd (a);
+      }
+
+      static mask lt (type a, type b)
+      {
+	return _mm256_cmp_pd (a, b, _CMP_LT_OQ);
+      }
+
+      /// \brief Whether the mask is set in every lane.
+      static bool all (mask m)
+      {
+	return _mm256_movemask_pd (m) == 0xf;
+      }
+
+      /// \brief m ? a : b, lane-wise.
+      static type select (mask m, type a, type b)
+      {
+	return _mm256_blendv_pd (b, a, m);
+      }
+
+      /// \brief Transpose the 4x4 matrix whose rows are a, b, c, d.
+      static void transpose (type& a, type& b, type& c, type& d)
+      {
+	const type t0 = _mm256_unpacklo_pd (a, b);
+	const type t1 = _mm256_unpackhi_pd (a, b);
+	const type t2 = _mm256_unpacklo_pd (c, d);
+	const type t3 = _mm256_unpackhi_pd (c, d);
+	a = _mm256_permute2f128_pd (t0, t2, 0x20);
+	b = _mm256_permute2f128_pd (t1, t3, 0x20);
+	c = _mm256_permute2f128_pd (t0, t2, 0x31);
+	d = _mm256_permute2f128_pd (t1, t3, 0x31);
+      }
+    };
+
+    template <>
+    struct Simd4<float>
+    {
+      typedef __m128 type;
+
+      static type load (const float* p)
+      {
+	return _mm_loadu_ps (p);
+      }
+
+      static void store (float* p, type v)
+      {
+	_mm_storeu_ps (p, v);
+      }
+
+      static type set1 (float x)
+      {
+	return _mm_set1_ps (x);
+      }
+
+      static type set (float x0, float x1, float x2, float x3)
+      {
+	return _mm_setr_ps (x0, x1, x2, x3);
+      }
+
+      /// \brief a * b + c.
+      static type fma (type a, type b, type c)
+      {
+#  if JRL_MATHTOOLS_HAS_FMA
+	return _mm_fmadd_ps (a, b, c);
+#  else
+	return _mm_add_ps (_mm_mul_ps (a, b), c);
+#  endif
+      }
+
+      template <int Mask>
+      static type blend (type a, type b)
+      {
+	return _mm_blend_ps (a, b, Mask);
+      }
+
+      template <int L0, int L1, int L2, int L3>
+      static type permute (type v)
+      {
+	return _mm_permute_ps (v, _MM_SHUFFLE (L3, L2, L1, L0));
+      }
+
+      typedef __m128 mask;
+
+      static type add (type a, type b)
+      {
+	return _mm_add_ps (a, b);
+      }
+
+      static type sub (type a, type b)
+      {
+	return _mm_sub_ps (a, b);
+      }
+
+      static type mul (type a, type b)
+      {
+	return _mm_mul_ps (a, b);
+      }
+
+      static type div (type a, type b)
+      {
+	return _mm_div_ps (a, b);
+      }
+
+      static type neg (type a)
+      {
+	return _mm_xor_ps (a, _mm_set1_ps (-0.f));
+      }
+
+      static type sqrt (type a)
+      {
+	return _mm_sqrt_ps (a);
+      }
+
+      static type floor (type a)
+      {
+	return _mm_floor_ps (a);
+      }
+
+      static mask lt (type a, type b)
+      {
+	return _mm_cmplt_ps (a, b);
+      }
+
+      /// \brief Whether the mask is set in every lane.
+      static bool all (mask m)
+      {
+	return _mm_movemask_ps (m) == 0xf;
+      }
+
+      /// \brief m ? a : b, lane-wise.
+      static type select (mask m, type a, type b)
+      {
+	return _mm_blendv_ps (b, a, m);
+      }
+
+      /// \brief Transpose the 4x4 matrix whose rows are a, b, c, d.
+      static void transpose (type& a, type& b, type& c, type& d)
+      {
+	_MM_TRANSPOSE4_PS (a, b, c, d);
+      }
+    };
+  } // end of namespace detail.
+} // end of namespace jrlMathTools.
+# endif //! JRL_MATHTOOLS_HAS_AVX2
+
+#endif //! JRL_MATHTOOLS_SIMD_HH
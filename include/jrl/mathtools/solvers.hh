@@ -0,0 +1,193 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_SOLVERS_HH
+# define JRL_MATHTOOLS_SOLVERS_HH
+# include <algorithm>
+# include <cmath>
+
+// Allocation-free factorizations of small dense NxN systems.
+//
+// The kernels work in place on row-major arrays: the matrix is
+// overwritten by its factors and the NxK right-hand side by the
+// solution. They are used by Matrix3x3, Matrix4x4 and MatrixRxC, and
+// by the decomposition objects of decompositions.hh when a
+// factorization has to be reused for several right-hand sides.
+namespace jrlMathTools
+{
+  /// \brief In-place LU decomposition with partial pivoting.
+  ///
+  /// L has a unit diagonal and is stored below U. Row k has been
+  /// swapped with row p[k] at step k, as in LAPACK getrf.
+  ///
+  /// \return false if the matrix is singular.
+  template <unsigned int N, typename T>
+  bool luFactorize (T* a, unsigned int* p)
+  {
+    for (unsigned int k = 0; k < N; ++k)
+      {
+	unsigned int pivot = k;
+	T maxAbs = std::abs (a[N * k + k]);
+	for (unsigned int i = k + 1; i < N; ++i)
+	  if (std::abs (a[N * i + k]) > maxAbs)
+	    {
+	      maxAbs = std::abs (a[N * i + k]);
+	      pivot = i;
+	    }
+	p[k] = pivot;
+	if (maxAbs == T ())
+	  return false;
+	if (pivot != k)
+	  std::swap_ranges (a + N * k, a + N * (k + 1), a + N * pivot);
+	const T inv = 1 / a[N * k + k];
+	for (unsigned int i = k + 1; i < N; ++i)
+	  {
+	    const T l = a[N * i + k] *= inv;
+	    for (unsigned int j = k + 1; j < N; ++j)
+	      a[N * i + j] -= l * a[N * k + j];
+	  }
+      }
+    return true;
+  }
+
+  /// \brief Solve A X = B in place from the output of luFactorize.
+  template <unsigned int N, unsigned int K, typename T>
+  void luSolveInPlace (const T* lu, const unsigned int* p, T* b)
+  {
+    for (unsigned int k = 0; k < N; ++k)
+      if (p[k] != k)
+	std::swap_ranges (b + K * k, b + K * (k + 1), b + K * p[k]);
+    for (unsigned int i = 1; i < N; ++i)
+      for (unsigned int k = 0; k < i; ++k)
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] -= lu[N * i + k] * b[K * k + j];
+    for (unsigned int i = N; i-- > 0;)
+      {
+	for (unsigned int k = i + 1; k < N; ++k)
+	  for (unsigned int j = 0; j < K; ++j)
+	    b[K * i + j] -= lu[N * i + k] * b[K * k + j];
+	const T inv = 1 / lu[N * i + i];
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] *= inv;
+      }
+  }
+
+  /// \brief In-place Cholesky decomposition A = L L^T.
+  ///
+  /// Only the lower triangular part of the matrix is read, L is
+  /// stored there.
+  ///
+  /// \return false if the matrix is not positive definite.
+  template <unsigned int N, typename T>
+  bool choleskyFactorize (T* a)
+  {
+    for (unsigned int j = 0; j < N; ++j)
+      {
+	T d = a[N * j + j];
+	for (unsigned int k = 0; k < j; ++k)
+	  d -= a[N * j + k] * a[N * j + k];
+	if (! (d > T ()))
+	  return false;
+	d = std::sqrt (d);
+	a[N * j + j] = d;
+	const T inv = 1 / d;
+	for (unsigned int i = j + 1; i < N; ++i)
+	  {
+	    T s = a[N * i + j];
+	    for (unsigned int k = 0; k < j; ++k)
+	      s -= a[N * i + k] * a[N * j + k];
+	    a[N * i + j] = s * inv;
+	  }
+      }
+    return true;
+  }
+
+  /// \brief Solve A X = B in place from the output of choleskyFactorize.
+  template <unsigned int N, unsigned int K, typename T>
+  void choleskySolveInPlace (const T* l, T* b)
+  {
+    for (unsigned int i = 0; i < N; ++i)
+      {
+	for (unsigned int k = 0; k < i; ++k)
+	  for (unsigned int j = 0; j < K; ++j)
+	    b[K * i + j] -= l[N * i + k] * b[K * k + j];
+	const T inv = 1 / l[N * i + i];
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] *= inv;
+      }
+    for (unsigned int i = N; i-- > 0;)
+      {
+	for (unsigned int k = i + 1; k < N; ++k)
+	  for (unsigned int j = 0; j < K; ++j)
+	    b[K * i + j] -= l[N * k + i] * b[K * k + j];
+	const T inv = 1 / l[N * i + i];
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] *= inv;
+      }
+  }
+
+  /// \brief In-place LDL^T decomposition, without square roots.
+  ///
+  /// Only the lower triangular part of the matrix is read. L has a
+  /// unit diagonal and is stored below D.
+  ///
+  /// \return false if a pivot is zero. Symmetric indefinite matrices
+  /// are accepted as long as no pivot vanishes.
+  template <unsigned int N, typename T>
+  bool ldltFactorize (T* a)
+  {
+    for (unsigned int j = 0; j < N; ++j)
+      {
+	T d = a[N * j + j];
+	for (unsigned int k = 0; k < j; ++k)
+	  d -= a[N * j + k] * a[N * j + k] * a[N * k + k];
+	if (d == T ())
+	  return false;
+	a[N * j + j] = d;
+	const T inv = 1 / d;
+	for (unsigned int i = j + 1; i < N; ++i)
+	  {
+	    T s = a[N * i + j];
+	    for (unsigned int k = 0; k < j; ++k)
+	      s -= a[N * i + k] * a[N * j + k] * a[N * k + k];
+	    a[N * i + j] = s * inv;
+	  }
+      }
+    return true;
+  }
+
+  /// \brief Solve A X = B in place from the output of ldltFactorize.
+  template <unsigned int N, unsigned int K, typename T>
+  void ldltSolveInPlace (const T* ld, T* b)
+  {
+    for (unsigned int i = 1; i < N; ++i)
+      for (unsigned int k = 0; k < i; ++k)
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] -= ld[N * i + k] * b[K * k + j];
+    for (unsigned int i = 0; i < N; ++i)
+      {
+	const T inv = 1 / ld[N * i + i];
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] *= inv;
+      }
+    for (unsigned int i = N; i-- > 0;)
+      for (unsigned int k = i + 1; k < N; ++k)
+	for (unsigned int j = 0; j < K; ++j)
+	  b[K * i + j] -= ld[N * k + i] * b[K * k + j];
+  }
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_SOLVERS_HH
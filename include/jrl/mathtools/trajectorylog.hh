@@ -0,0 +1,655 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_TRAJECTORYLOG_HH
+# define JRL_MATHTOOLS_TRAJECTORYLOG_HH
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cmath>
+# include <cstddef>
+# include <exception>
+# include <limits>
+# include <sstream>
+# include <stdexcept>
+# include <string>
+# include <thread>
+# include <vector>
+
+# include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
+
+# include <jrl/mathtools/angle.hh>
+# include <jrl/mathtools/vector3.hh>
+# include <jrl/mathtools/matrix4x4.hh>
+# include <jrl/mathtools/io.hh>
+
+// Columnar logs of time-indexed poses, positions and angles.
+//
+// A log has a fixed layout of channels, each one made of columns of
+// doubles: 16 for a Matrix4x4 pose, row-major so that the translation
+// is in its columns 3, 7 and 11, 3 for a Vector3D position and 1 for
+// an Angle. Column 0 is the time, which must not decrease.
+//
+// The file is a binary file of io.hh whose records are chunks: chunk k
+// is a columns x chunkSize row-major matrix, i.e. one array of
+// chunkSize values per column, so that scanning a column only reads
+// its pages. The layout is stored as text between the header and the
+// first chunk. Past the last sample, the times of the last chunk are
+// NaN.
+//
+// TrajectoryLogWriter is fed by a real-time loop. Samples go through a
+// lock-free single-producer single-consumer ring buffer to a
+// background thread, which transposes them into chunks and writes
+// them: the producer never blocks, allocates or makes a system call.
+// When the ring buffer is full, samples are dropped and counted.
+//
+// TrajectoryLog maps a file and gives access to its columns in place,
+// and to samples by time through the index of the chunk start times.
+namespace jrlMathTools
+{
+  /// \brief Kind of a channel of a trajectory log.
+  enum TrajectoryChannelKind
+  {
+    TRAJECTORY_POSE,
+    TRAJECTORY_POSITION,
+    TRAJECTORY_ANGLE
+  };
+
+  /// \brief Channels of a trajectory log and their columns.
+  class TrajectoryLayout
+  {
+  public:
+    TrajectoryLayout ()
+      : channels_ (),
+	columns_ (1)
+    {}
+
+    /// \brief Add a Matrix4x4 channel.
+    /// \return index of the channel.
+    std::size_t addPose (const std::string& name)
+    {
+      return add (name, TRAJECTORY_POSE);
+    }
+
+    /// \brief Add a Vector3D channel.
+    std::size_t addPosition (const std::string& name)
+    {
+      return add (name, TRAJECTORY_POSITION);
+    }
+
+    /// \brief Add an Angle channel.
+    std::size_t addAngle (const std::string& name)
+    {
+      return add (name, TRAJECTORY_ANGLE);
+    }
+
+    std::size_t channels () const
+    {
+      return channels_.size ();
+    }
+
+    /// \brief Number of columns, including the time.
+    std::size_t columns () const
+    {
+      return columns_;
+    }
+
+    /// Channel accessors, following the accessor policy of
+    /// jrl/mathtools/checks.hh: the recorder calls them on the
+    /// real-time path.
+    /// \{
+    const std::string& name (std::size_t channel) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < channels_.size ());
+      return channels_[channel].m_name;
+    }
+
+    TrajectoryChannelKind kind (std::size_t channel) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < channels_.size ());
+      return channels_[channel].m_kind;
+    }
+
+    /// \brief First column of a channel.
+    std::size_t column (std::size_t channel) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < channels_.size ());
+      return channels_[channel].m_column;
+    }
+    /// \}
+
+    /// \brief Index of the channel of the given name, or channels () if
+    /// there is none.
+    std::size_t find (const std::string& name) const
+    {
+      std::size_t channel = 0;
+      while (channel < channels_.size ()
+	     && channels_[channel].m_name != name)
+	++channel;
+      return channel;
+    }
+
+    /// \brief Number of columns of a kind of channel.
+    static std::size_t width (TrajectoryChannelKind kind)
+    {
+      return kind == TRAJECTORY_POSE ? 16
+	: kind == TRAJECTORY_POSITION ? 3 : 1;
+    }
+
+    /// \brief Text form, one "kind name" line per channel.
+    std::string toString () const
+    {
+      static const char* kinds[] = {"pose", "position", "angle"};
+      std::string result;
+      for (std::size_t i = 0; i < channels_.size (); ++i)
+	result += std::string (kinds[channels_[i].m_kind]) + ' '
+	  + channels_[i].m_name + '\n';
+      return result;
+    }
+
+    /// \brief Parse the text form.
+    static TrajectoryLayout fromString (const std::string& text)
+    {
+      TrajectoryLayout layout;
+      std::istringstream is (text);
+      std::string kind, name;
+      while (is >> kind >> name)
+	{
+	  if (kind == "pose")
+	    layout.addPose (name);
+	  else if (kind == "position")
+	    layout.addPosition (name);
+	  else if (kind == "angle")
+	    layout.addAngle (name);
+	  else
+	    throw std::runtime_error ("bad trajectory channel kind " + kind);
+	}
+      if (!is.eof ())
+	throw std::runtime_error ("bad trajectory layout");
+      return layout;
+    }
+
+  private:
+    std::size_t add (const std::string& name, TrajectoryChannelKind kind)
+    {
+      if (name.empty ()
+	  || name.find_first_of (" \t\n\r\f\v") != std::string::npos
+	  || find (name) != channels ())
+	throw std::invalid_argument ("bad trajectory channel name " + name);
+      const Channel channel = {name, kind, columns_};
+      channels_.push_back (channel);
+      columns_ += width (kind);
+      return channels_.size () - 1;
+    }
+
+    struct Channel
+    {
+      std::string m_name;
+      TrajectoryChannelKind m_kind;
+      std::size_t m_column;
+    };
+
+    std::vector<Channel> channels_;
+    std::size_t columns_;
+  };
+
+  namespace detail
+  {
+    /// \brief Lock-free ring buffer of samples of stride doubles, for
+    /// one producer and one consumer thread.
+    ///
+    /// Indices only grow; the producer owns head_ and the consumer
+    /// tail_, which lie on separate cache lines.
+    class SampleRing
+    {
+    public:
+      /// \brief Constructor.
+      /// \param capacity number of samples, rounded up to a power of 2.
+      SampleRing (std::size_t stride, std::size_t capacity)
+	: stride_ (stride),
+	  mask_ (0),
+	  data_ (),
+	  head_ (0),
+	  tail_ (0)
+      {
+	std::size_t size = 1;
+	while (size < capacity)
+	  size *= 2;
+	mask_ = size - 1;
+	data_.resize (size * stride);
+      }
+
+      /// \brief Slot of the next sample, or 0 if the ring is full.
+      double* back ()
+      {
+	const std::size_t head = head_.load (std::memory_order_relaxed);
+	if (head - tail_.load (std::memory_order_acquire) > mask_)
+	  return 0;
+	return &data_[(head & mask_) * stride_];
+      }
+
+      /// \brief Publish the sample written in back ().
+      void push ()
+      {
+	head_.store (head_.load (std::memory_order_relaxed) + 1,
+		     std::memory_order_release);
+      }
+
+      /// \brief Oldest sample, or 0 if the ring is empty.
+      const double* front () const
+      {
+	const std::size_t tail = tail_.load (std::memory_order_relaxed);
+	if (tail == head_.load (std::memory_order_acquire))
+	  return 0;
+	return &data_[(tail & mask_) * stride_];
+      }
+
+      /// \brief Release the sample read in front ().
+      void pop ()
+      {
+	tail_.store (tail_.load (std::memory_order_relaxed) + 1,
+		     std::memory_order_release);
+      }
+
+      std::size_t capacity () const
+      {
+	return mask_ + 1;
+      }
+
+    private:
+      SampleRing (const SampleRing&);
+      SampleRing& operator= (const SampleRing&);
+
+      std::size_t stride_;
+      std::size_t mask_;
+      std::vector<double> data_;
+      std::atomic<std::size_t> head_;
+      char padding_[64];
+      std::atomic<std::size_t> tail_;
+    };
+
+    /// \brief Header of a trajectory log file.
+    inline BinaryHeader trajectoryHeader (const TrajectoryLayout& layout,
+					  std::size_t chunkSize,
+					  const std::string& metadata)
+    {
+      BinaryHeader header =
+	BinaryHeader::make (BINARY_FLOAT64, std::uint32_t (layout.columns ()),
+			    std::uint32_t (chunkSize));
+      const std::size_t alignment = BinaryHeader::alignment;
+      header.m_alignment = std::uint32_t
+	((sizeof (header) + metadata.size () + alignment) / alignment
+	 * alignment);
+      return header;
+    }
+  } // end of namespace detail.
+
+  /// \brief Writer of a trajectory log, fed by one real-time thread.
+  ///
+  /// The real-time thread sets the values of the channels and commits
+  /// them with their time. Channels that are not set keep their last
+  /// value.
+  class TrajectoryLogWriter
+  {
+  public:
+    /// \brief Create the file and start the background thread.
+    /// \param chunkSize number of samples per chunk.
+    /// \param capacity number of samples of the ring buffer.
+    TrajectoryLogWriter (const std::string& path,
+			 const TrajectoryLayout& layout,
+			 std::size_t chunkSize = 1024,
+			 std::size_t capacity = 8192)
+      : layout_ (layout),
+	chunkSize_ (chunkSize),
+	file_ (path, detail::trajectoryHeader (layout, chunkSize,
+					       layout.toString ()),
+	       false, layout.toString ()),
+	ring_ (layout.columns (), capacity),
+	sample_ (layout.columns (), 0.),
+	chunk_ (layout.columns () * chunkSize),
+	filled_ (0),
+	written_ (0),
+	dropped_ (0),
+	running_ (true),
+	error_ (),
+	thread_ ()
+    {
+      thread_ = std::thread (&TrajectoryLogWriter::run, this);
+    }
+
+    /// \brief Write the pending samples and close the file.
+    ~TrajectoryLogWriter ()
+    {
+      try
+	{
+	  close ();
+	}
+      catch (...)
+	{}
+    }
+
+    const TrajectoryLayout& layout () const
+    {
+      return layout_;
+    }
+
+    /// Set the value of a channel for the next sample.
+    /// \{
+    void set (std::size_t channel, const Matrix4x4<double>& pose)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_POSE);
+      std::copy (pose.m, pose.m + 16,
+		 sample_.begin () + layout_.column (channel));
+    }
+
+    void set (std::size_t channel, const Vector3D<double>& position)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_POSITION);
+      double* column = &sample_[layout_.column (channel)];
+      column[0] = position.m_x;
+      column[1] = position.m_y;
+      column[2] = position.m_z;
+    }
+
+    void set (std::size_t channel, const Angle& angle)
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_ANGLE);
+      sample_[layout_.column (channel)] = angle.value ();
+    }
+    /// \}
+
+    /// \brief Queue the current values as the sample at the given
+    /// time, without blocking.
+    ///
+    /// \return false if the ring buffer is full and the sample has
+    /// been dropped.
+    bool commit (double time)
+    {
+      double* slot = ring_.back ();
+      if (!slot)
+	{
+	  dropped_.fetch_add (1, std::memory_order_relaxed);
+	  return false;
+	}
+      sample_[0] = time;
+      std::copy (sample_.begin (), sample_.end (), slot);
+      ring_.push ();
+      return true;
+    }
+
+    /// \brief Number of samples dropped because the ring buffer was
+    /// full.
+    std::size_t dropped () const
+    {
+      return dropped_.load (std::memory_order_relaxed);
+    }
+
+    /// \brief Number of samples taken out of the ring buffer by the
+    /// background thread.
+    std::size_t size () const
+    {
+      return written_.load (std::memory_order_relaxed);
+    }
+
+    /// \brief Stop the background thread, write the remaining samples
+    /// and close the file.
+    ///
+    /// Rethrows the error that stopped the background thread, if any.
+    void close ()
+    {
+      if (!thread_.joinable ())
+	return;
+      running_.store (false, std::memory_order_release);
+      thread_.join ();
+      if (!error_)
+	{
+	  try
+	    {
+	      writeChunk ();
+	      file_.close ();
+	    }
+	  catch (...)
+	    {
+	      error_ = std::current_exception ();
+	    }
+	}
+      if (error_)
+	std::rethrow_exception (error_);
+    }
+
+  private:
+    TrajectoryLogWriter (const TrajectoryLogWriter&);
+    TrajectoryLogWriter& operator= (const TrajectoryLogWriter&);
+
+    /// \brief Body of the background thread.
+    void run ()
+    {
+      try
+	{
+	  while (running_.load (std::memory_order_acquire))
+	    if (!drain ())
+	      std::this_thread::sleep_for (std::chrono::microseconds (500));
+	  drain ();
+	}
+      catch (...)
+	{
+	  error_ = std::current_exception ();
+	}
+    }
+
+    /// \brief Move the queued samples into chunks.
+    /// \return whether there was any.
+    bool drain ()
+    {
+      const std::size_t columns = layout_.columns ();
+      bool any = false;
+      for (const double* sample = ring_.front (); sample;
+	   sample = ring_.front ())
+	{
+	  for (std::size_t c = 0; c < columns; ++c)
+	    chunk_[c * chunkSize_ + filled_] = sample[c];
+	  ring_.pop ();
+	  written_.fetch_add (1, std::memory_order_relaxed);
+	  any = true;
+	  if (++filled_ == chunkSize_)
+	    writeChunk ();
+	}
+      return any;
+    }
+
+    /// \brief Write the current chunk, if not empty.
+    void writeChunk ()
+    {
+      if (filled_ == 0)
+	return;
+      std::fill (chunk_.begin () + filled_, chunk_.begin () + chunkSize_,
+		 std::numeric_limits<double>::quiet_NaN ());
+      file_.write (&chunk_[0], 1);
+      filled_ = 0;
+    }
+
+    TrajectoryLayout layout_;
+    std::size_t chunkSize_;
+    detail::BinaryFileWriter file_;
+    detail::SampleRing ring_;
+    /// \brief Values of the next sample, owned by the producer.
+    std::vector<double> sample_;
+    /// \brief Chunk being filled, owned by the background thread.
+    std::vector<double> chunk_;
+    std::size_t filled_;
+    std::atomic<std::size_t> written_;
+    std::atomic<std::size_t> dropped_;
+    std::atomic<bool> running_;
+    std::exception_ptr error_;
+    std::thread thread_;
+  };
+
+  /// \brief Read-only, memory-mapped trajectory log.
+  class TrajectoryLog
+  {
+  public:
+    explicit TrajectoryLog (const std::string& path)
+      : mapping_ (path),
+	layout_ (),
+	chunkSize_ (mapping_.header ().m_cols),
+	size_ (0),
+	index_ ()
+    {
+      const char* metadata = mapping_.metadata ();
+      layout_ = TrajectoryLayout::fromString
+	(std::string (metadata, std::find (metadata, metadata
+					   + mapping_.metadataSize (), 0)));
+      if (mapping_.header ().m_scalarType != BINARY_FLOAT64
+	  || mapping_.header ().m_rows != layout_.columns ())
+	throw std::runtime_error (path + " is not a trajectory log");
+
+      // Index of the chunk start times.
+      const std::size_t chunks = mapping_.size ();
+      index_.resize (chunks);
+      for (std::size_t k = 0; k < chunks; ++k)
+	index_[k] = column (k, 0)[0];
+      if (chunks > 0)
+	{
+	  const double* times = column (chunks - 1, 0);
+	  std::size_t last = 0;
+	  while (last < chunkSize_ && !std::isnan (times[last]))
+	    ++last;
+	  size_ = (chunks - 1) * chunkSize_ + last;
+	}
+    }
+
+    const TrajectoryLayout& layout () const
+    {
+      return layout_;
+    }
+
+    /// \brief Number of samples.
+    std::size_t size () const
+    {
+      return size_;
+    }
+
+    std::size_t chunkSize () const
+    {
+      return chunkSize_;
+    }
+
+    std::size_t chunks () const
+    {
+      return index_.size ();
+    }
+
+    /// \brief The chunkSize () values of a column in a chunk, in place.
+    const double* column (std::size_t chunk, std::size_t column) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (chunk < chunks ()
+				 && column < layout_.columns ());
+      return static_cast<const double*> (mapping_.data ())
+	+ (chunk * layout_.columns () + column) * chunkSize_;
+    }
+
+    /// \brief Value of a column for a sample.
+    double value (std::size_t sample, std::size_t column) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (sample < size_);
+      return this->column (sample / chunkSize_, column)[sample % chunkSize_];
+    }
+
+    double time (std::size_t sample) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
+    {
+      return value (sample, 0);
+    }
+
+    /// \brief Index of the last sample at or before time, or size () if
+    /// time is before the first sample.
+    std::size_t find (double time) const
+    {
+      // Last chunk starting at or before time, then the last sample.
+      const std::size_t chunk =
+	std::upper_bound (index_.begin (), index_.end (), time)
+	- index_.begin ();
+      if (chunk == 0)
+	return size_;
+      const std::size_t first = (chunk - 1) * chunkSize_;
+      const std::size_t count = std::min (chunkSize_, size_ - first);
+      const double* times = column (chunk - 1, 0);
+      return first + (std::upper_bound (times, times + count, time) - times)
+	- 1;
+    }
+
+    Matrix4x4<double> pose (std::size_t channel, std::size_t sample) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_POSE);
+      JRL_MATHTOOLS_CHECK_INDEX (sample < size_);
+      const double* first = column (sample / chunkSize_,
+				    layout_.column (channel))
+	+ sample % chunkSize_;
+      Matrix4x4<double> result;
+      for (std::size_t k = 0; k < 16; ++k)
+	result.m[k] = first[k * chunkSize_];
+      return result;
+    }
+
+    Vector3D<double> position (std::size_t channel, std::size_t sample) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_POSITION);
+      JRL_MATHTOOLS_CHECK_INDEX (sample < size_);
+      const double* first = column (sample / chunkSize_,
+				    layout_.column (channel))
+	+ sample % chunkSize_;
+      return Vector3D<double> (first[0], first[chunkSize_],
+			       first[2 * chunkSize_]);
+    }
+
+    Angle angle (std::size_t channel, std::size_t sample) const
+    {
+      JRL_MATHTOOLS_CHECK_INDEX (channel < layout_.channels ()
+				 && layout_.kind (channel)
+				 == TRAJECTORY_ANGLE);
+      return Angle (value (sample, layout_.column (channel)));
+    }
+
+  private:
+    BinaryMapping mapping_;
+    TrajectoryLayout layout_;
+    std::size_t chunkSize_;
+    std::size_t size_;
+    /// \brief Time of the first sample of each chunk.
+    std::vector<double> index_;
+  };
+
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_TRAJECTORYLOG_HH
@@ -0,0 +1,364 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_TRIGONOMETRY_HH
+# define JRL_MATHTOOLS_TRIGONOMETRY_HH
+
+# include <cmath>
+# include <limits>
+
+# include <jrl/mathtools/constants.hh>
+# include <jrl/mathtools/simd.hh>
+
+namespace jrlMathTools
+{
+  /// \brief Precision of the batched sine, cosine and tangent of
+  /// angles in [-PI, PI].
+  ///
+  /// The bounds are the absolute errors on the sine and cosine.
+  enum TrigonometryPrecision
+    {
+      /// Double precision, a few 1e-16.
+      FULL_PRECISION,
+      /// About 1e-8: degree 9 minimax polynomial.
+      MEDIUM_PRECISION,
+      /// About 1e-4: degree 5 minimax polynomial.
+      LOW_PRECISION
+    };
+
+  namespace detail
+  {
+    /// \brief Split of pi in two parts, the first one being pi rounded
+    /// to T, so that pi - x is exact for pi / 2 <= x <= pi.
+    template <typename T>
+    struct PiSplit
+    {
+      static T high ()
+      {
+	return T (3.14159265358979311600E0);
+      }
+
+      static T low ()
+      {
+	return T (1.22464679914735317720E-16);
+      }
+    };
+
+    template <>
+    struct PiSplit<float>
+    {
+      static float high ()
+      {
+	return 3.14159274101257324219f;
+      }
+
+      static float low ()
+      {
+	return -8.74227765734758577e-8f;
+      }
+    };
+
+    /// \brief Split of pi / 2 in three parts for the argument
+    /// reduction, the first ones having trailing zero bits so that
+    /// k * part is exact for moderate k.
+    template <typename T>
+    struct HalfPiSplit
+    {
+      static T first ()
+      {
+	return T (1.57079625129699707031);
+      }
+
+      static T second ()
+      {
+	return T (7.54978941586159635336E-8);
+      }
+
+      static T third ()
+      {
+	return T (5.39030285815811905290E-15);
+      }
+    };
+
+    template <>
+    struct HalfPiSplit<float>
+    {
+      static float first ()
+      {
+	return 1.5703125f;
+      }
+
+      static float second ()
+      {
+	return 4.83751296997070312500E-4f;
+      }
+
+      static float third ()
+      {
+	return 7.54978995489188216e-8f;
+      }
+    };
+
+    /// \brief Polynomial approximations of elementary functions,
+    /// written once against the ScalarOps / Simd4 interface.
+    template <typename T, typename V>
+    struct Trigonometry
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+
+      /// \brief atan (r) for 0 <= r <= 1 (Cephes' rational
+      /// approximation, accurate to the double precision).
+      static v_t atan (v_t r)
+      {
+	const m_t large = V::lt (V::set1 (T (0.66)), r);
+	const v_t one = V::set1 (T (1));
+	const v_t x = V::select (large,
+				 V::div (V::sub (r, one), V::add (r, one)), r);
+	const v_t y = V::select (large, V::set1 (T (M_PI / 4)), V::set1 (T ()));
+	const v_t z = V::mul (x, x);
+
+	v_t p = V::set1 (T (-8.750608600031904122785E-1));
+	p = V::fma (p, z, V::set1 (T (-1.615753718733365076637E1)));
+	p = V::fma (p, z, V::set1 (T (-7.500855792314704667340E1)));
+	p = V::fma (p, z, V::set1 (T (-1.228866684490136173410E2)));
+	p = V::fma (p, z, V::set1 (T (-6.485021904942025371773E1)));
+	v_t q = V::add (z, V::set1 (T (2.485846490142306297962E1)));
+	q = V::fma (q, z, V::set1 (T (1.650270098316988542046E2)));
+	q = V::fma (q, z, V::set1 (T (4.328810604912902668951E2)));
+	q = V::fma (q, z, V::set1 (T (4.853903996359136964868E2)));
+	q = V::fma (q, z, V::set1 (T (1.945506571482613964425E2)));
+
+	return V::add (y, V::fma (V::mul (x, z), V::div (p, q), x));
+      }
+
+      /// \brief sin (x) for |x| <= pi / 2 (Taylor series up to x^21,
+      /// accurate to the double precision).
+      static v_t sin (v_t x)
+      {
+	const v_t z = V::mul (x, x);
+	v_t s = V::set1 (T (1. / 51090942171709440000.));
+	s = V::fma (s, z, V::set1 (T (-1. / 121645100408832000.)));
+	s = V::fma (s, z, V::set1 (T (1. / 355687428096000.)));
+	s = V::fma (s, z, V::set1 (T (-1. / 1307674368000.)));
+	s = V::fma (s, z, V::set1 (T (1. / 6227020800.)));
+	s = V::fma (s, z, V::set1 (T (-1. / 39916800.)));
+	s = V::fma (s, z, V::set1 (T (1. / 362880.)));
+	s = V::fma (s, z, V::set1 (T (-1. / 5040.)));
+	s = V::fma (s, z, V::set1 (T (1. / 120.)));
+	s = V::fma (s, z, V::set1 (T (-1. / 6.)));
+	return V::fma (V::mul (s, z), x, x);
+      }
+
+      /// \brief x - 2 k pi, in [-pi, pi], in constant time.
+      ///
+      /// Values already in [-pi, pi] are returned as is. Otherwise, 2
+      /// pi rounded to T is split in three parts (Cody and Waite) of a
+      /// third of the significand each, so that their products by k
+      /// are exact for |k| < 2^(2 digits / 3), even without a fused
+      /// multiply-add. The result then matches std::remainder (x, 2 *
+      /// pi) up to the last bit for |x| < 2e11 in double precision (4e5
+      /// in single precision); beyond, the error grows with |x|. Within
+      /// |x| epsilon of -pi or pi, k may be rounded the other way and
+      /// the result is then clamped to the nearest bound.
+      static v_t wrap (v_t x)
+      {
+	const T twoPi = T (2 * M_PI);
+	const T split =
+	  T (1ULL << (std::numeric_limits<T>::digits
+		      - (std::numeric_limits<T>::digits + 2) / 3)) + 1;
+	const T t1 = twoPi * split;
+	const T first = t1 - (t1 - twoPi);
+	const T rest = twoPi - first;
+	const T t2 = rest * split;
+	const T second = t2 - (t2 - rest);
+	const T third = rest - second;
+
+	const v_t k = V::floor (V::fma (x, V::set1 (1 / twoPi),
+					V::set1 (T (0.5))));
+	v_t r = V::fma (k, V::set1 (-first), x);
+	r = V::fma (k, V::set1 (-second), r);
+	r = V::fma (k, V::set1 (-third), r);
+
+	const v_t pi = V::set1 (T (M_PI));
+	const v_t minusPi = V::set1 (T (-M_PI));
+	const v_t absX = V::select (V::lt (x, V::set1 (T ())), V::neg (x), x);
+	r = V::select (V::lt (pi, absX), r, x);
+	r = V::select (V::lt (pi, r), pi, r);
+	return V::select (V::lt (r, minusPi), minusPi, r);
+      }
+
+      /// \brief sin (x) and cos (x) for |x| <= pi / 4 (Cephes'
+      /// minimax polynomials).
+      static void sincosReduced (v_t x, v_t& s, v_t& c)
+      {
+	const v_t z = V::mul (x, x);
+
+	v_t ps = V::set1 (T (1.58962301576546568060E-10));
+	ps = V::fma (ps, z, V::set1 (T (-2.50507477628578072866E-8)));
+	ps = V::fma (ps, z, V::set1 (T (2.75573136213857245213E-6)));
+	ps = V::fma (ps, z, V::set1 (T (-1.98412698295895385996E-4)));
+	ps = V::fma (ps, z, V::set1 (T (8.33333333332211858878E-3)));
+	ps = V::fma (ps, z, V::set1 (T (-1.66666666666666307295E-1)));
+	s = V::fma (V::mul (ps, z), x, x);
+
+	v_t pc = V::set1 (T (-1.13585365213876817300E-11));
+	pc = V::fma (pc, z, V::set1 (T (2.08757008419747316778E-9)));
+	pc = V::fma (pc, z, V::set1 (T (-2.75573141792967388112E-7)));
+	pc = V::fma (pc, z, V::set1 (T (2.48015872888517045348E-5)));
+	pc = V::fma (pc, z, V::set1 (T (-1.38888888888730564116E-3)));
+	pc = V::fma (pc, z, V::set1 (T (4.16666666666665929218E-2)));
+	c = V::fma (V::mul (pc, z), z,
+		    V::fma (z, V::set1 (T (-0.5)), V::set1 (T (1))));
+      }
+
+      /// \brief sin (x) and cos (x) for any x.
+      ///
+      /// x is reduced modulo pi / 2 with a three-part split of pi / 2,
+      /// the error grows with |x| but stays at the double precision
+      /// for |x| below a few thousands.
+      static void sincos (v_t x, v_t& s, v_t& c)
+      {
+	// x = k pi / 2 + r, with |r| <= pi / 4.
+	const v_t k = V::floor (V::fma (x, V::set1 (T (2 / M_PI)),
+					V::set1 (T (0.5))));
+	v_t r = V::fma (k, V::set1 (-HalfPiSplit<T>::first ()), x);
+	r = V::fma (k, V::set1 (-HalfPiSplit<T>::second ()), r);
+	r = V::fma (k, V::set1 (-HalfPiSplit<T>::third ()), r);
+
+	v_t sr, cr;
+	sincosReduced (r, sr, cr);
+
+	// Quadrant q = k mod 4: sin x is (sr, cr, -sr, -cr) and cos x is
+	// (cr, -sr, -cr, sr) for q = (0, 1, 2, 3).
+	const v_t quarter = V::set1 (T (0.25));
+	const v_t four = V::set1 (T (4));
+	const v_t q = V::sub (k, V::mul (four, V::floor (V::mul (k, quarter))));
+	const v_t q1 = V::add (q, V::set1 (T (1)));
+	const v_t qc =
+	  V::sub (q1, V::mul (four, V::floor (V::mul (q1, quarter))));
+	const v_t odd =
+	  V::sub (q, V::mul (V::set1 (T (2)),
+			     V::floor (V::mul (q, V::set1 (T (0.5))))));
+
+	const v_t half = V::set1 (T (0.5));
+	const v_t threeHalves = V::set1 (T (1.5));
+	const m_t swap = V::lt (half, odd);
+	s = V::select (swap, cr, sr);
+	c = V::select (swap, sr, cr);
+	s = V::select (V::lt (threeHalves, q), V::neg (s), s);
+	c = V::select (V::lt (threeHalves, qc), V::neg (c), c);
+      }
+    };
+
+    /// \brief sin (x) for |x| <= pi / 2, with the polynomial matching
+    /// the precision P.
+    template <typename T, typename V, TrigonometryPrecision P>
+    struct SinPolynomial
+    {
+      static typename V::type run (typename V::type x)
+      {
+	return Trigonometry<T, V>::sin (x);
+      }
+    };
+
+    template <typename T, typename V>
+    struct SinPolynomial<T, V, MEDIUM_PRECISION>
+    {
+      static typename V::type run (typename V::type x)
+      {
+	const typename V::type z = V::mul (x, x);
+	typename V::type p = V::set1 (T (2.590488501433902e-06));
+	p = V::fma (p, z, V::set1 (T (-1.9800897763281068e-04)));
+	p = V::fma (p, z, V::set1 (T (8.332899823360418e-03)));
+	p = V::fma (p, z, V::set1 (T (-1.666664763464029e-01)));
+	p = V::fma (p, z, V::set1 (T (9.99999976589883e-01)));
+	return V::mul (p, x);
+      }
+    };
+
+    template <typename T, typename V>
+    struct SinPolynomial<T, V, LOW_PRECISION>
+    {
+      static typename V::type run (typename V::type x)
+      {
+	const typename V::type z = V::mul (x, x);
+	typename V::type p = V::set1 (T (7.514377180223107e-03));
+	p = V::fma (p, z, V::set1 (T (-1.6567307932680503e-01)));
+	p = V::fma (p, z, V::set1 (T (9.996967731418155e-01)));
+	return V::mul (p, x);
+      }
+    };
+
+    /// \brief sin (x) and cos (x) for |x| <= pi, as Angle values are.
+    ///
+    /// There is no reduction modulo pi / 2: the argument is only
+    /// folded into [-pi / 2, pi / 2] with sin x = sin (pi - x) and
+    /// cos x = sin (pi / 2 - |x|), both differences being exact
+    /// where they matter thanks to the split of pi.
+    template <typename T, typename V, TrigonometryPrecision P>
+    struct WrappedSinCos
+    {
+      typedef typename V::type v_t;
+      typedef typename V::mask m_t;
+      typedef SinPolynomial<T, V, P> polynomial_t;
+
+      static void run (v_t x, v_t& s, v_t& c)
+      {
+	const T half = T (0.5);
+	const m_t negative = V::lt (x, V::set1 (T ()));
+	const v_t absX = V::select (negative, V::neg (x), x);
+
+	c = polynomial_t::run
+	  (V::add (V::sub (V::set1 (half * PiSplit<T>::high ()), absX),
+		   V::set1 (half * PiSplit<T>::low ())));
+
+	const v_t folded =
+	  V::add (V::sub (V::set1 (PiSplit<T>::high ()), absX),
+		  V::set1 (PiSplit<T>::low ()));
+	const m_t large =
+	  V::lt (V::set1 (half * PiSplit<T>::high ()), absX);
+	const v_t sinAbs = polynomial_t::run (V::select (large, folded, absX));
+	s = V::select (negative, V::neg (sinAbs), sinAbs);
+      }
+    };
+
+    /// \brief sin (x) and cos (x) for any x: the standard library for
+    /// a single value, which is faster than the reduction of
+    /// Trigonometry::sincos done without vector instructions, and the
+    /// polynomial kernel for vectors.
+    template <typename T, typename V>
+    struct SinCos
+    {
+      static void run (typename V::type x, typename V::type& s,
+		       typename V::type& c)
+      {
+	Trigonometry<T, V>::sincos (x, s, c);
+      }
+    };
+
+    template <typename T>
+    struct SinCos<T, ScalarOps<T> >
+    {
+      static void run (T x, T& s, T& c)
+      {
+	s = std::sin (x);
+	c = std::cos (x);
+      }
+    };
+  } // end of namespace detail.
+} // end of namespace jrlMathTools.
+
+#endif //! JRL_MATHTOOLS_TRIGONOMETRY_HH
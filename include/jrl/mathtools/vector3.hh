@@ -18,8 +18,10 @@
 # include <iostream>
 # include <cmath>
 # include <stdexcept>
+# include <type_traits>
 
 # include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
 
 namespace jrlMathTools
 {
@@ -32,71 +34,86 @@ namespace jrlMathTools
     T m_z;
 
     /// \brief Default constructor: all fields are set to zero.
-    inline Vector3D ()
+    ///
+    /// Copy and assignment are the implicit ones so that the vector
+    /// stays trivially copyable.
+    constexpr Vector3D ()
       : m_x (),
 	m_y (),
 	m_z ()
     {}
 
-    inline Vector3D (const T x, const T y, const T z)
+    constexpr Vector3D (const T x, const T y, const T z)
       : m_x (x), m_y (y), m_z (z)
     {}
 
-    /// Assignment operator.
-    inline Vector3D<T>& operator= (const Vector3D<T>& v)
+    /// \brief Unary operator -
+    constexpr Vector3D<T> operator-() const
     {
-      if (&v == this)
-	return *this;
-      m_x = v.m_x;
-      m_y = v.m_y;
-      m_z = v.m_z;
-      return *this;
+      return Vector3D<T> (-m_x, -m_y, -m_z);
     }
 
-    /// \brief Unary operator -
-    inline Vector3D<T> operator-() const
+    /// \brief Coordinate members, in storage order.
+    ///
+    /// Element access goes through this table rather than through
+    /// data (), so that it does not index past a single member.
+    static constexpr T Vector3D::* const members[3] =
+      {&Vector3D::m_x, &Vector3D::m_y, &Vector3D::m_z};
+
+    /// \brief Coordinates as a contiguous array.
+    ///
+    /// Vector3D is a standard-layout struct of three T without padding,
+    /// which is checked below. Arrays of Vector3D can therefore be
+    /// passed to kernels working on flat arrays of T: se3Distances,
+    /// encodeVectors, decodeVectors, transformPoints and MappedArray
+    /// rely on it.
+    inline T* data ()
     {
-      return Vector3D<T> (-m_x, -m_y, -m_z);
+      static_assert (std::is_standard_layout<Vector3D<T> >::value,
+		     "Vector3D must have a standard layout");
+      static_assert (sizeof (Vector3D<T>) == 3 * sizeof (T),
+		     "Vector3D coordinates must be contiguous");
+      return &m_x;
+    }
+
+    /// \brief Coordinates as a contiguous array.
+    inline const T* data () const
+    {
+      static_assert (std::is_standard_layout<Vector3D<T> >::value,
+		     "Vector3D must have a standard layout");
+      static_assert (sizeof (Vector3D<T>) == 3 * sizeof (T),
+		     "Vector3D coordinates must be contiguous");
+      return &m_x;
     }
 
     /// \brief Array operator.
-    inline T& operator[](unsigned i)
+    inline T& operator[](unsigned i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i == 0)
-	return m_x;
-      else if (i == 1)
-	return m_y;
-      else if (i == 2)
-	return m_z;
-      throw std::logic_error("invalid index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 3);
+      return this->*members[i];
     }
 
     /// \brief Array operator.
-    inline T operator[](unsigned i) const
+    inline T operator[](unsigned i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i == 0)
-	return m_x;
-      else if (i == 1)
-	return m_y;
-      else if (i == 2)
-	return m_z;
-      throw std::logic_error("invalid index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 3);
+      return this->*members[i];
     }
 
     /// \brief Array operator.
-    inline T& operator()(unsigned i)
+    inline T& operator()(unsigned i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
       return (*this)[i];
     }
 
     /// \brief Array operator.
-    inline T operator()(unsigned i) const
+    inline T operator()(unsigned i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
       return (*this)[i];
     }
 
     /// \brief Binary operator ==.
-    inline bool operator==(const Vector3D<T>& v) const
+    constexpr bool operator==(const Vector3D<T>& v) const
     {
       return
 	(v.m_x == m_x) &&
@@ -105,7 +122,7 @@ namespace jrlMathTools
     }
 
     /// \brief Binary operator !=.
-    inline bool operator!=(const Vector3D<T>& v) const
+    constexpr bool operator!=(const Vector3D<T>& v) const
     {
       return
 	(v.m_x != m_x) ||
@@ -114,23 +131,15 @@ namespace jrlMathTools
     }
 
     /// \brief Binary operator +.
-    inline Vector3D<T> operator+ (const Vector3D<T>& v) const
+    constexpr Vector3D<T> operator+ (const Vector3D<T>& v) const
     {
-      Vector3D<T> vr;
-      vr.m_x = m_x + v.m_x;
-      vr.m_y = m_y + v.m_y;
-      vr.m_z = m_z + v.m_z;
-      return vr;
+      return Vector3D<T> (m_x + v.m_x, m_y + v.m_y, m_z + v.m_z);
     }
 
     /// \brief Binary operator -.
-    inline Vector3D<T> operator- (const Vector3D<T>& v) const
+    constexpr Vector3D<T> operator- (const Vector3D<T>& v) const
     {
-      Vector3D<T> vr;
-      vr.m_x = m_x - v.m_x;
-      vr.m_y = m_y - v.m_y;
-      vr.m_z = m_z - v.m_z;
-      return vr;
+      return Vector3D<T> (m_x - v.m_x, m_y - v.m_y, m_z - v.m_z);
     }
 
     /// \brief Binary operator +=.
@@ -150,33 +159,22 @@ namespace jrlMathTools
     }
 
     /// \brief Binary operator *.
-    inline Vector3D<T> operator* (const T& t) const
+    constexpr Vector3D<T> operator* (const T& t) const
     {
-      Vector3D<T> vr;
-      vr.m_x = m_x * t;
-      vr.m_y = m_y * t;
-      vr.m_z = m_z * t;
-      return vr;
+      return Vector3D<T> (m_x * t, m_y * t, m_z * t);
     }
 
 
     /// \brief Binary operator * : dot product.
-    inline T operator* (const Vector3D<T>& v) const
+    constexpr T operator* (const Vector3D<T>& v) const
     {
-      T tr = m_x * v.m_x;
-      tr += (m_y * v.m_y);
-      tr += (m_z * v.m_z);
-      return tr;
+      return m_x * v.m_x + m_y * v.m_y + m_z * v.m_z;
     }
 
     /// \brief Binary operator /.
-    inline Vector3D<T> operator/ (const T& t) const
+    constexpr Vector3D<T> operator/ (const T& t) const
     {
-      Vector3D<T> vr;
-      vr.m_x = m_x / t;
-      vr.m_y = m_y / t;
-      vr.m_z = m_z / t;
-      return vr;
+      return Vector3D<T> (m_x / t, m_y / t, m_z / t);
     }
 
     /// \brief Binary operator *=.
@@ -212,25 +210,23 @@ namespace jrlMathTools
     }
 
     /// \brief Check if the vector is set to zero.
-    inline bool IsZero () const
+    constexpr bool IsZero () const
     {
       return (m_x == T ()) && (m_y == T ()) && (m_z == T ());
     }
 
     /// \brief Get the norm squared.
-    inline T normsquared () const
+    constexpr T normsquared () const
     {
       return m_x * m_x + m_y * m_y + m_z * m_z;
     }
 
     /// \brief Cross product.
-    inline Vector3D<T> operator ^ (const Vector3D<T>& v2) const
+    constexpr Vector3D<T> operator ^ (const Vector3D<T>& v2) const
     {
-      Vector3D<T> vr;
-      vr.m_x = m_y*v2.m_z - v2.m_y*m_z;
-      vr.m_y = m_z*v2.m_x - v2.m_z*m_x;
-      vr.m_z = m_x*v2.m_y - v2.m_x*m_y;
-      return vr;
+      return Vector3D<T> (m_y*v2.m_z - v2.m_y*m_z,
+			  m_z*v2.m_x - v2.m_z*m_x,
+			  m_x*v2.m_y - v2.m_x*m_y);
     }
 
     std::ostream& display (std::ostream& os) const
@@ -240,6 +236,12 @@ namespace jrlMathTools
     }
   };
 
+# if __cplusplus < 201703L
+  // Namespace-scope definition, needed before C++17 inline variables.
+  template <typename T>
+  constexpr T Vector3D<T>::* const Vector3D<T>::members[3];
+# endif //! __cplusplus < 201703L
+
   template <typename T>
   std::ostream& operator<< (std::ostream& os, const Vector3D<T>& v)
   {
@@ -18,8 +18,10 @@
 # include <cmath>
 # include <iostream>
 # include <stdexcept>
+# include <type_traits>
 
 # include <jrl/mathtools/fwd.hh>
+# include <jrl/mathtools/checks.hh>
 
 namespace jrlMathTools
 {
@@ -33,33 +35,26 @@ namespace jrlMathTools
     T m_w;
 
     /// Default constructor: all fields are set to zero.
-    inline Vector4D ()
+    ///
+    /// Copy and assignment are the implicit ones so that the vector
+    /// stays trivially copyable.
+    constexpr Vector4D ()
       : m_x (),
 	m_y (),
 	m_z (),
 	m_w ()
     {}
 
-    explicit Vector4D<T> (const T& x,
-			  const T& y,
-			  const T& z,
-			  const T& w=1.)
+    constexpr explicit Vector4D<T> (const T& x,
+				    const T& y,
+				    const T& z,
+				    const T& w=1.)
     : m_x (x),
       m_y (y),
       m_z (z),
       m_w (w)
     {}
 
-    /// \brief Assignement operator.
-    inline Vector4D<T> operator= (const Vector4D<T>& v)
-    {
-      m_x = v.m_x;
-      m_y = v.m_y;
-      m_z = v.m_z;
-      m_w = v.m_w;
-      return *this;
-    }
-
     /// \brief Assignement operator from vector3d.
     ///   Set last component to 1.
     inline Vector4D<T> operator= (const Vector3D<T>& v)
@@ -73,53 +68,71 @@ namespace jrlMathTools
 
 
     /// \brief Unary operator -.
-    inline Vector4D<T> operator- ()
+    constexpr Vector4D<T> operator- () const
     {
       return Vector4D<T> (-m_x, -m_y, -m_z, -m_w);
     }
 
+    /// \brief Coordinate members, in storage order.
+    ///
+    /// Element access goes through this table rather than through
+    /// data (), so that it does not index past a single member.
+    static constexpr T Vector4D::* const members[4] =
+      {&Vector4D::m_x, &Vector4D::m_y, &Vector4D::m_z, &Vector4D::m_w};
+
+    /// \brief Coordinates as a contiguous array.
+    ///
+    /// Vector4D is a standard-layout struct of four T without padding,
+    /// which is checked below. Arrays of Vector4D can therefore be
+    /// passed to kernels working on flat arrays of T.
+    inline T* data ()
+    {
+      static_assert (std::is_standard_layout<Vector4D<T> >::value,
+		     "Vector4D must have a standard layout");
+      static_assert (sizeof (Vector4D<T>) == 4 * sizeof (T),
+		     "Vector4D coordinates must be contiguous");
+      return &m_x;
+    }
+
+    /// \brief Coordinates as a contiguous array.
+    inline const T* data () const
+    {
+      static_assert (std::is_standard_layout<Vector4D<T> >::value,
+		     "Vector4D must have a standard layout");
+      static_assert (sizeof (Vector4D<T>) == 4 * sizeof (T),
+		     "Vector4D coordinates must be contiguous");
+      return &m_x;
+    }
+
     /// \brief Array operator.
-    inline T& operator[] (unsigned i)
+    inline T& operator[] (unsigned i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i == 0)
-	return m_x;
-      else if (i == 1)
-	return m_y;
-      else if (i == 2)
-	return m_z;
-      else if (i == 3)
-	return m_w;
-      throw std::logic_error ("invalid index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4);
+      return this->*members[i];
     }
 
     /// \brief Array operator.
     inline const T& operator[](unsigned i) const
+      JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
-      if (i == 0)
-	return m_x;
-      else if (i == 1)
-	return m_y;
-      else if (i == 2)
-	return m_z;
-      else if (i == 3)
-	return m_w;
-      throw std::logic_error ("invalid index");
+      JRL_MATHTOOLS_CHECK_INDEX (i < 4);
+      return this->*members[i];
     }
 
     /// \brief Array operator.
-    inline T& operator()(unsigned i)
+    inline T& operator()(unsigned i) JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
       return (*this)[i];
     }
 
     /// \brief Array operator.
-    inline T operator()(unsigned i) const
+    inline T operator()(unsigned i) const JRL_MATHTOOLS_ACCESSOR_NOEXCEPT
     {
       return (*this)[i];
     }
 
     /// \brief Binary operator ==.
-    inline bool operator==(const Vector4D<T>& v) const
+    constexpr bool operator==(const Vector4D<T>& v) const
     {
       return
 	(v.m_x==m_x) &&
@@ -129,25 +142,17 @@ namespace jrlMathTools
     }
 
     /// \brief Binary operator +.
-    inline Vector4D<T> operator+ (const Vector4D<T>& v) const
+    constexpr Vector4D<T> operator+ (const Vector4D<T>& v) const
     {
-      Vector4D<T> vr;
-      vr.m_x = m_x + v.m_x;
-      vr.m_y = m_y + v.m_y;
-      vr.m_z = m_z + v.m_z;
-      vr.m_w = m_w + v.m_w;
-      return vr;
+      return Vector4D<T>
+	(m_x + v.m_x, m_y + v.m_y, m_z + v.m_z, m_w + v.m_w);
     }
 
     /// \brief Binary operator -.
-    inline Vector4D<T> operator- (const Vector4D<T>& v) const
+    constexpr Vector4D<T> operator- (const Vector4D<T>& v) const
     {
-      Vector4D<T> vr;
-      vr.m_x = m_x - v.m_x;
-      vr.m_y = m_y - v.m_y;
-      vr.m_z = m_z - v.m_z;
-      vr.m_w = m_w - v.m_w;
-      return vr;
+      return Vector4D<T>
+	(m_x - v.m_x, m_y - v.m_y, m_z - v.m_z, m_w - v.m_w);
     }
 
     /// \brief Binary operator +=.
@@ -169,26 +174,16 @@ namespace jrlMathTools
     }
 
     /// \brief Binary operator *.
-    inline Vector4D<T> operator* (const T& t) const
+    constexpr Vector4D<T> operator* (const T& t) const
     {
-      Vector4D<T> vr;
-      vr.m_x = m_x * t;
-      vr.m_y = m_y * t;
-      vr.m_z = m_z * t;
-      vr.m_w = m_w * t;
-      return vr;
+      return Vector4D<T> (m_x * t, m_y * t, m_z * t, m_w * t);
     }
 
 
     /// \brief Binary operator /.
-    inline Vector4D<T> operator/ (const T& t) const
+    constexpr Vector4D<T> operator/ (const T& t) const
     {
-      Vector4D<T> vr;
-      vr.m_x = m_x / t;
-      vr.m_y = m_y / t;
-      vr.m_z = m_z / t;
-      vr.m_w = m_w / t;
-      return vr;
+      return Vector4D<T> (m_x / t, m_y / t, m_z / t, m_w / t);
     }
 
     /// \brief Binary operator *=.
@@ -229,7 +224,7 @@ namespace jrlMathTools
     }
 
     /// \brief Get the norm squared.
-    inline T normsquared() const
+    constexpr T normsquared() const
     {
       return m_x * m_x + m_y * m_y + m_z * m_z + m_w * m_w;
     }
@@ -242,6 +237,12 @@ namespace jrlMathTools
     }
   };
 
+# if __cplusplus < 201703L
+  // Namespace-scope definition, needed before C++17 inline variables.
+  template <typename T>
+  constexpr T Vector4D<T>::* const Vector4D<T>::members[4];
+# endif //! __cplusplus < 201703L
+
   template <typename T>
   inline std::ostream& operator<< (std::ostream& os, const Vector4D<T>& v)
   {
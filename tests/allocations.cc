@@ -0,0 +1,309 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <jrl/mathtools/angle.hh>
+#include <jrl/mathtools/circularstatistics.hh>
+#include <jrl/mathtools/decompositions.hh>
+#include <jrl/mathtools/decompositions3x3.hh>
+#include <jrl/mathtools/frametree.hh>
+#include <jrl/mathtools/kinematicchain.hh>
+#include <jrl/mathtools/liegroups.hh>
+#include <jrl/mathtools/matrix3x3.hh>
+#include <jrl/mathtools/matrix4x4.hh>
+#include <jrl/mathtools/matrixnxp.hh>
+#include <jrl/mathtools/matrixrxc.hh>
+#include <jrl/mathtools/nearestneighbors.hh>
+#include <jrl/mathtools/quaternion.hh>
+#include <jrl/mathtools/trajectorylog.hh>
+#include <jrl/mathtools/vector3.hh>
+#include <jrl/mathtools/vector4.hh>
+
+#define BOOST_TEST_MODULE allocations
+
+#include <boost/test/unit_test.hpp>
+
+#include "allocations.hh"
+
+using namespace jrlMathTools;
+
+// Keeps allocated pointers alive, so that the compiler cannot remove
+// the allocations.
+static void* volatile sink;
+
+// Deterministic rows x cols matrix.
+static matrixNxP sample (unsigned rows, unsigned cols)
+{
+  matrixNxP A (rows, cols);
+  for (unsigned i = 0; i < rows; ++i)
+    for (unsigned j = 0; j < cols; ++j)
+      A (i, j) = std::sin (static_cast<double> (i * cols + j + 1));
+  return A;
+}
+
+// Deterministic rigid transformation.
+static Matrix4x4<double> pose (double k)
+{
+  return expSE3 (Vector3D<double> (0.1 * k, -0.2, 0.3 * k),
+		 Vector3D<double> (std::sin (k), 0.5, std::cos (k)));
+}
+
+BOOST_AUTO_TEST_CASE (counter)
+{
+  allocations::AllocationCounter counter;
+  BOOST_CHECK_EQUAL (counter.count (), 0u);
+
+  int* i = new int (1);
+  sink = i;
+  BOOST_CHECK_EQUAL (counter.count (), 1u);
+  delete i;
+
+  int* a = new int[4];
+  sink = a;
+  BOOST_CHECK_EQUAL (counter.count (), 2u);
+  delete[] a;
+
+  const allocations::AllocationCounter inner;
+  std::vector<double> v (16);
+  sink = &v[0];
+  BOOST_CHECK_EQUAL (inner.count (), 1u);
+  BOOST_CHECK_EQUAL (counter.count (), 3u);
+
+# if defined __GLIBC__
+  void* p = std::malloc (8);
+  sink = p;
+  p = std::realloc (p, 64);
+  std::free (p);
+  p = std::calloc (2, 8);
+  std::free (p);
+  BOOST_CHECK_EQUAL (inner.count (), 4u);
+# endif //! __GLIBC__
+}
+
+BOOST_AUTO_TEST_CASE (fixed_size)
+{
+  Vector3D<double> u (0.3, -1.2, 2.5);
+  const Vector3D<double> v (1.1, 0.4, -0.7);
+  CHECK_NO_ALLOCATION (u = (u + v) * 2. - (u ^ v) / 3.);
+  CHECK_NO_ALLOCATION (u.normalize ());
+  CHECK_NO_ALLOCATION (u[0] = u * v + u.norm ());
+
+  Vector4D<float> p (0.3f, -1.2f, 2.5f, 1.f);
+  const Vector4D<float> q (1.1f, 0.4f, -0.7f, 0.5f);
+  CHECK_NO_ALLOCATION (p = (p + q) * 2.f - q / 3.f);
+  CHECK_NO_ALLOCATION (p.normalize ());
+
+  // Symmetric positive definite.
+  const Matrix3x3<double> A (4., 1., .5,
+			     1., 3., .25,
+			     .5, .25, 2.);
+  Matrix3x3<double> B;
+  Vector3D<double> x;
+  CHECK_NO_ALLOCATION (B = A * A.Transpose () + A * 2.);
+  CHECK_NO_ALLOCATION (A.Inversion (B));
+  CHECK_NO_ALLOCATION (A.luSolve (v, x));
+  CHECK_NO_ALLOCATION (A.choleskySolve (v, x));
+  CHECK_NO_ALLOCATION (A.ldltSolve (A, B));
+  CHECK_NO_ALLOCATION (x[0] = A.determinant ());
+
+  const Matrix4x4<double> M (5., 1., 2., .5,
+			     1., 6., 3., 1.,
+			     2., 3., 7., 2.,
+			     .5, 1., 2., 8.);
+  Matrix4x4<double> N;
+  Vector4D<double> b (1., 2., 3., 1.);
+  Vector4D<double> y;
+  CHECK_NO_ALLOCATION (N = M * M.Transpose () - M * 2.);
+  CHECK_NO_ALLOCATION (M.CeqthismulBAffine (M, N));
+  CHECK_NO_ALLOCATION (N = M.Inversion ());
+  CHECK_NO_ALLOCATION (y = M * b);
+  CHECK_NO_ALLOCATION (M.luSolve (b, y));
+  CHECK_NO_ALLOCATION (M.choleskySolve (M, N));
+  CHECK_NO_ALLOCATION (M.ldltSolve (b, y));
+  CHECK_NO_ALLOCATION (x = M * v);
+
+  MatrixRxC<double, 6, 6> C (MatrixRxC<double, 6, 6>::identity ());
+  MatrixRxC<double, 6, 6> D;
+  MatrixRxC<double, 6, 1> c (1.);
+  CHECK_NO_ALLOCATION (D = (C + C) * C.Transpose ());
+  LUDecomposition<double, 6> lu;
+  CHECK_NO_ALLOCATION (lu.compute (D));
+  CHECK_NO_ALLOCATION (lu.solveInPlace (c));
+  CholeskyDecomposition<double, 6> cholesky;
+  CHECK_NO_ALLOCATION (cholesky.compute (D));
+  CHECK_NO_ALLOCATION (cholesky.solveInPlace (c));
+  LDLTDecomposition<double, 6> ldlt;
+  CHECK_NO_ALLOCATION (ldlt.compute (D));
+  CHECK_NO_ALLOCATION (ldlt.solveInPlace (c));
+
+  CHECK_NO_ALLOCATION (SymmetricEigenDecomposition<double> e (A));
+  CHECK_NO_ALLOCATION (SingularValueDecomposition<double> s (A));
+  CHECK_NO_ALLOCATION (B = nearestRotation (A));
+
+  Quaternion<double> r (Matrix3x3<double> (expSO3 (v)));
+  const Quaternion<double> s (0., 0., 0., 1.);
+  CHECK_NO_ALLOCATION (r = slerp (r, s, .3));
+  CHECK_NO_ALLOCATION (r *= s);
+  CHECK_NO_ALLOCATION (B = expSO3 (v));
+  CHECK_NO_ALLOCATION (x = logSO3 (B));
+  CHECK_NO_ALLOCATION (N = expSE3 (u, v));
+  CHECK_NO_ALLOCATION (logSE3 (N, u, x));
+
+  Angle theta (2.5);
+  const Angle phi (-1.3);
+  CHECK_NO_ALLOCATION (theta = (theta + phi).interpolate (.3, phi));
+  CHECK_NO_ALLOCATION (x[0] = theta.distance (phi) + cos (theta));
+  UnitComplex z (theta);
+  CHECK_NO_ALLOCATION (z = (z * UnitComplex (phi)).inverse ());
+  CHECK_NO_ALLOCATION (z.rotate (x[0], x[1]));
+}
+
+// pseudoInverse and dampedInverse allocate at each call; their
+// workspace overloads do not, once the workspace and the output have
+// the right size.
+BOOST_AUTO_TEST_CASE (pseudo_inverse)
+{
+  static const unsigned shapes[][2] =
+    {{6, 30}, {30, 6}, {6, 6}, {3, 7}};
+  PseudoInverseWorkspace workspace;
+  for (unsigned s = 0; s < sizeof (shapes) / sizeof (shapes[0]); ++s)
+    {
+      const matrixNxP A = sample (shapes[s][0], shapes[s][1]);
+      matrixNxP Ainv (A.size2 (), A.size1 ());
+
+      allocations::AllocationCounter counter;
+      pseudoInverse (A, Ainv);
+      BOOST_TEST_MESSAGE ("pseudoInverse " << A.size1 () << "x"
+			  << A.size2 () << ": " << counter.count ()
+			  << " allocations");
+      counter = allocations::AllocationCounter ();
+      dampedInverse (A, Ainv);
+      BOOST_TEST_MESSAGE ("dampedInverse " << A.size1 () << "x"
+			  << A.size2 () << ": " << counter.count ()
+			  << " allocations");
+
+      // The first shape grows the workspace, the next ones reuse it.
+      pseudoInverse (A, Ainv, workspace);
+      CHECK_NO_ALLOCATION (pseudoInverse (A, Ainv, workspace));
+      CHECK_NO_ALLOCATION (dampedInverse (A, Ainv, workspace, 1e-2));
+    }
+
+  // A reserved workspace does not allocate from the first call.
+  const matrixNxP A = sample (12, 30);
+  matrixNxP Ainv (30, 12);
+  PseudoInverseWorkspace reserved (12, 30);
+  CHECK_NO_ALLOCATION (dampedInverse (A, Ainv, reserved, 1e-2));
+  CHECK_NO_ALLOCATION (pseudoInverse (A, Ainv, reserved));
+}
+
+// Real-time paths of the containers: once built, updating and
+// querying them does not allocate.
+BOOST_AUTO_TEST_CASE (frame_tree)
+{
+  FrameTree<double> tree;
+  const std::size_t base = tree.addFrame ("base", 0, pose (1.));
+  const std::size_t arm = tree.addFrame ("arm", base, pose (2.));
+  const std::size_t hand = tree.addFrame ("hand", arm, pose (3.));
+  const std::size_t camera = tree.addFrame ("camera", 0, pose (4.));
+  const std::string from ("hand");
+  const std::string to ("camera");
+
+  Matrix4x4<double> M;
+  CHECK_NO_ALLOCATION (tree.setLocal (arm, pose (5.)));
+  CHECK_NO_ALLOCATION (tree.publish ());
+  CHECK_NO_ALLOCATION (tree.setLocal (base, pose (6.)); tree.publish ());
+  CHECK_NO_ALLOCATION (M = tree.world (hand));
+  CHECK_NO_ALLOCATION (M = tree.transform (hand, camera));
+  CHECK_NO_ALLOCATION (M = tree.transform (from, to));
+}
+
+BOOST_AUTO_TEST_CASE (kinematic_chain)
+{
+  KinematicChain<double> chain (12);
+  std::vector<Matrix4x4<double> > locals (4);
+  for (std::size_t i = 0; i < locals.size (); ++i)
+    locals[i] = pose (static_cast<double> (i));
+
+  Matrix4x4<double> M;
+  CHECK_NO_ALLOCATION (chain.setLocal (3, pose (7.)));
+  CHECK_NO_ALLOCATION (M = chain.world (5));
+  CHECK_NO_ALLOCATION (chain.setLocals (6, locals.begin (), locals.end ()));
+  CHECK_NO_ALLOCATION (chain.setBase (pose (8.)));
+  CHECK_NO_ALLOCATION (chain.update ());
+  CHECK_NO_ALLOCATION (M = chain.end ());
+}
+
+BOOST_AUTO_TEST_CASE (trajectory_log)
+{
+  const char* path = "allocations.bin";
+  TrajectoryLayout layout;
+  const std::size_t base = layout.addPose ("base");
+  const std::size_t com = layout.addPosition ("com");
+  const std::size_t knee = layout.addAngle ("knee");
+  {
+    TrajectoryLogWriter writer (path, layout, 64, 256);
+    const Matrix4x4<double> M = pose (1.);
+    const Vector3D<double> p (1., 2., 3.);
+    for (unsigned i = 0; i < 100; ++i)
+      {
+	CHECK_NO_ALLOCATION (writer.set (base, M));
+	CHECK_NO_ALLOCATION (writer.set (com, p));
+	CHECK_NO_ALLOCATION (writer.set (knee, Angle (0.1 * i)));
+	CHECK_NO_ALLOCATION (writer.commit (0.001 * i));
+      }
+    writer.close ();
+  }
+  std::remove (path);
+}
+
+BOOST_AUTO_TEST_CASE (nearest_neighbors)
+{
+  const bool circular[] = {false, false, true};
+  KdTree<3> tree (circular);
+  std::vector<double> points (3 * 500);
+  for (std::size_t i = 0; i < points.size (); ++i)
+    points[i] = std::sin (static_cast<double> (i) * 1.7);
+  tree.insert (&points[0], points.size () / 3);
+
+  const double query[] = {0.2, -0.4, 3.};
+  std::size_t ids[8];
+  double distances[8];
+  std::size_t found = 0;
+  CHECK_NO_ALLOCATION (found = tree.nearest (query, 8, ids, distances));
+  BOOST_CHECK_EQUAL (found, 8u);
+}
+
+BOOST_AUTO_TEST_CASE (circular_statistics)
+{
+  CircularStatistics statistics (64);
+  std::vector<double> angles (200);
+  std::vector<double> means (angles.size ());
+  std::vector<double> variances (angles.size ());
+  for (std::size_t i = 0; i < angles.size (); ++i)
+    angles[i] = std::remainder (0.3 * static_cast<double> (i), 2 * M_PI);
+
+  double x = 0.;
+  CHECK_NO_ALLOCATION (statistics.push (Angle (1.)));
+  CHECK_NO_ALLOCATION (statistics.push (&angles[0], angles.size (),
+					&means[0], &variances[0]));
+  CHECK_NO_ALLOCATION (x = statistics.mean ().value ()
+		       + statistics.variance ()
+		       + statistics.standardDeviation ());
+  BOOST_CHECK (std::isfinite (x));
+}
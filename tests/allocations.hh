@@ -0,0 +1,211 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef JRL_MATHTOOLS_ALLOCATIONS_HH
+# define JRL_MATHTOOLS_ALLOCATIONS_HH
+# include <cstddef>
+# include <cstdlib>
+# include <new>
+
+// Counting of the heap allocations of the calling thread.
+//
+// This header replaces the global operator new and, with the GNU C
+// library, malloc, calloc, realloc and the aligned allocations, by
+// versions counting each call. Replacement functions cannot be inline:
+// include it in one source file of a test program only.
+//
+// The allocations made in a scope are counted by an AllocationCounter,
+// and CHECK_NO_ALLOCATION checks that a statement allocates nothing.
+// Statements meant to run in real-time loops are first run once, so
+// that buffers are grown and lazy initializations happen, then checked
+// in steady state.
+
+namespace allocations
+{
+  /// \brief Number of allocations of this thread since its start.
+  static thread_local unsigned long count = 0;
+
+# if defined __GLIBC__
+  extern "C"
+  {
+    void* __libc_malloc (std::size_t size);
+    void* __libc_calloc (std::size_t n, std::size_t size);
+    void* __libc_realloc (void* ptr, std::size_t size);
+    void* __libc_memalign (std::size_t alignment, std::size_t size);
+    void __libc_free (void* ptr);
+  }
+
+  inline void* allocate (std::size_t size)
+  {
+    ++count;
+    return __libc_malloc (size);
+  }
+
+  inline void release (void* ptr)
+  {
+    __libc_free (ptr);
+  }
+# else
+  // Only operator new can be counted.
+  inline void* allocate (std::size_t size)
+  {
+    ++count;
+    return std::malloc (size);
+  }
+
+  inline void release (void* ptr)
+  {
+    std::free (ptr);
+  }
+# endif //! __GLIBC__
+
+  /// \brief Count the allocations of the calling thread from its
+  /// construction.
+  class AllocationCounter
+  {
+  public:
+    AllocationCounter ()
+      : start_ (allocations::count)
+    {}
+
+    /// \brief Number of allocations since the construction.
+    unsigned long count () const
+    {
+      return allocations::count - start_;
+    }
+
+  private:
+    unsigned long start_;
+  };
+} // end of namespace allocations.
+
+void* operator new (std::size_t size)
+{
+  void* ptr = allocations::allocate (size ? size : 1);
+  if (! ptr)
+    throw std::bad_alloc ();
+  return ptr;
+}
+
+void* operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocations::allocate (size ? size : 1);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocations::allocate (size ? size : 1);
+}
+
+void operator delete (void* ptr) noexcept
+{
+  allocations::release (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+  allocations::release (ptr);
+}
+
+void operator delete (void* ptr, const std::nothrow_t&) noexcept
+{
+  allocations::release (ptr);
+}
+
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept
+{
+  allocations::release (ptr);
+}
+
+# if defined __cpp_sized_deallocation
+void operator delete (void* ptr, std::size_t) noexcept
+{
+  allocations::release (ptr);
+}
+
+void operator delete[] (void* ptr, std::size_t) noexcept
+{
+  allocations::release (ptr);
+}
+# endif //! __cpp_sized_deallocation
+
+# if defined __GLIBC__
+extern "C"
+{
+  void* malloc (std::size_t size) noexcept
+  {
+    return allocations::allocate (size);
+  }
+
+  void* calloc (std::size_t n, std::size_t size) noexcept
+  {
+    ++allocations::count;
+    return allocations::__libc_calloc (n, size);
+  }
+
+  void* realloc (void* ptr, std::size_t size) noexcept
+  {
+    ++allocations::count;
+    return allocations::__libc_realloc (ptr, size);
+  }
+
+  void free (void* ptr) noexcept
+  {
+    allocations::release (ptr);
+  }
+
+  int posix_memalign (void** ptr, std::size_t alignment,
+		      std::size_t size) noexcept
+  {
+    if (alignment % sizeof (void*) || alignment & (alignment - 1))
+      return 22; // EINVAL
+    ++allocations::count;
+    *ptr = allocations::__libc_memalign (alignment, size);
+    return *ptr ? 0 : 12; // ENOMEM
+  }
+
+  void* aligned_alloc (std::size_t alignment, std::size_t size) noexcept
+  {
+    ++allocations::count;
+    return allocations::__libc_memalign (alignment, size);
+  }
+
+  void* memalign (std::size_t alignment, std::size_t size) noexcept
+  {
+    ++allocations::count;
+    return allocations::__libc_memalign (alignment, size);
+  }
+}
+# endif //! __GLIBC__
+
+/// \brief Check that STATEMENT makes no heap allocation.
+# define CHECK_NO_ALLOCATION(STATEMENT)				\
+  do								\
+    {								\
+      const allocations::AllocationCounter counter_;		\
+      STATEMENT;						\
+      const unsigned long allocations_ = counter_.count ();	\
+      BOOST_CHECK_MESSAGE (allocations_ == 0,			\
+			   #STATEMENT " made " << allocations_	\
+			   << " allocations");			\
+    }								\
+  while (0)
+
+#endif //! JRL_MATHTOOLS_ALLOCATIONS_HH
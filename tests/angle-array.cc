@@ -0,0 +1,167 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <jrl/mathtools/anglearray.hh>
+
+#define BOOST_TEST_MODULE angle-array
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using jrlMathTools::Angle;
+using jrlMathTools::AngleArray;
+
+// Eleven angles, two full vectors and a remainder, covering the
+// bounds and large values.
+static std::vector<double> samples (double phase)
+{
+  static const double values[] =
+    {0., M_PI, -M_PI, 3. * M_PI, 0.5, -2., 1e4, -1e6, 7., 2.5, -3.1};
+  std::vector<double> result;
+  for (unsigned i = 0; i < sizeof (values) / sizeof (values[0]); ++i)
+    result.push_back (values[i] + phase * i);
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE (construction)
+{
+  const AngleArray empty;
+  BOOST_CHECK_EQUAL (empty.size (), 0u);
+  BOOST_CHECK_EQUAL (AngleArray (3)[2].value (), 0.);
+
+  const std::vector<double> v = samples (0.);
+  AngleArray a (&v[0], v.size ());
+  BOOST_CHECK_EQUAL (a.size (), v.size ());
+  for (std::size_t i = 0; i < v.size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (a[i].value (), Angle (v[i]).value ());
+      BOOST_CHECK_EQUAL (a.data ()[i], a[i].value ());
+    }
+
+  a.set (1, Angle (0.25));
+  BOOST_CHECK_EQUAL (a[1].value (), 0.25);
+  CHECK_BAD_INDEX (a[v.size ()]);
+  CHECK_BAD_INDEX (a.set (v.size (), Angle ()));
+
+  std::vector<double> w (v.size ());
+  jrlMathTools::wrapAngles (&v[0], &w[0], v.size ());
+  for (std::size_t i = 0; i < v.size (); ++i)
+    BOOST_CHECK_EQUAL (w[i], Angle (v[i]).value ());
+}
+
+BOOST_AUTO_TEST_CASE (arithmetic)
+{
+  const std::vector<double> u = samples (0.3);
+  const std::vector<double> v = samples (-1.1);
+  const AngleArray a (&u[0], u.size ());
+  const AngleArray b (&v[0], v.size ());
+
+  const AngleArray sum = a + b;
+  const AngleArray difference = a - b;
+  std::vector<double> distance (u.size ());
+  a.distance (b, &distance[0]);
+  for (std::size_t i = 0; i < u.size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (sum[i].value (), (a[i] + b[i]).value ());
+      BOOST_CHECK_EQUAL (difference[i].value (), (a[i] - b[i]).value ());
+      BOOST_CHECK_EQUAL (distance[i], a[i].distance (b[i]));
+      BOOST_CHECK (distance[i] <= M_PI);
+    }
+
+  AngleArray c (a);
+  c += b;
+  c -= b;
+  for (std::size_t i = 0; i < u.size (); ++i)
+    BOOST_CHECK_SMALL (c[i].distance (a[i]), 1e-12);
+
+  BOOST_CHECK_THROW (c += AngleArray (2), std::invalid_argument);
+  BOOST_CHECK_THROW (c -= AngleArray (2), std::invalid_argument);
+  BOOST_CHECK_THROW (a.distance (AngleArray (2), &distance[0]),
+		     std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE (interpolation)
+{
+  const std::vector<double> u = samples (0.3);
+  const std::vector<double> v = samples (-1.1);
+  const AngleArray a (&u[0], u.size ());
+  const AngleArray b (&v[0], v.size ());
+
+  for (double alpha = 0.; alpha <= 1.; alpha += 0.25)
+    {
+      const AngleArray c = a.interpolate (alpha, b);
+      for (std::size_t i = 0; i < u.size (); ++i)
+	BOOST_CHECK_SMALL (c[i].distance (a[i].interpolate (alpha, b[i])),
+			   1e-12);
+    }
+
+  // Along the shortest arc, across PI.
+  const double x[] = {3.};
+  const double y[] = {-3.};
+  const AngleArray middle =
+    AngleArray (x, 1).interpolate (0.5, AngleArray (y, 1));
+  BOOST_CHECK_CLOSE (std::fabs (middle[0].value ()), M_PI, 1e-12);
+
+  BOOST_CHECK_THROW (a.interpolate (0.5, AngleArray (2)),
+		     std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE (trigonometry)
+{
+  using jrlMathTools::TrigonometryPrecision;
+  static const TrigonometryPrecision precisions[] =
+    {jrlMathTools::FULL_PRECISION, jrlMathTools::MEDIUM_PRECISION,
+     jrlMathTools::LOW_PRECISION};
+  static const double bounds[] = {4e-16, 1e-8, 1e-4};
+
+  // [-PI, PI] with both bounds, exactly symmetric, and a remainder.
+  const std::size_t n = 4003;
+  std::vector<double> x (n);
+  for (std::size_t i = 0; i < n; ++i)
+    x[i] = M_PI * (2. * static_cast<double> (i) - (n - 1)) / (n - 1);
+  const AngleArray a (&x[0], n);
+
+  std::vector<double> s (n), c (n), t (n);
+  for (unsigned p = 0; p < 3; ++p)
+    {
+      a.sinCos (&s[0], &c[0], precisions[p]);
+      a.tan (&t[0], precisions[p]);
+      for (std::size_t i = 0; i < n; ++i)
+	{
+	  BOOST_CHECK_SMALL (s[i] - std::sin (x[i]), bounds[p]);
+	  BOOST_CHECK_SMALL (c[i] - std::cos (x[i]), bounds[p]);
+	  const double tangent = std::tan (x[i]);
+	  if (std::abs (c[i]) > 0.1)
+	    BOOST_CHECK_SMALL (t[i] - tangent,
+			       20. * bounds[p] * (1. + tangent * tangent));
+	}
+    }
+
+  // Exact symmetries and values.
+  jrlMathTools::sinCosAngles (&x[0], &s[0], &c[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      BOOST_CHECK_EQUAL (s[i], -s[n - 1 - i]);
+      BOOST_CHECK_EQUAL (c[i], c[n - 1 - i]);
+    }
+  BOOST_CHECK_EQUAL (s[0], std::sin (-M_PI));
+  BOOST_CHECK_EQUAL (s[(n - 1) / 2], 0.);
+  BOOST_CHECK_EQUAL (c[(n - 1) / 2], 1.);
+}
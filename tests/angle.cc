@@ -121,3 +121,82 @@ BOOST_AUTO_TEST_CASE (angle_tan)
 
   BOOST_CHECK_EQUAL (tan (angle), std::tan (0.5));
 }
+
+BOOST_AUTO_TEST_CASE (unit_complex)
+{
+  using jrlMathTools::Angle;
+  using jrlMathTools::UnitComplex;
+
+  const UnitComplex identity;
+  BOOST_CHECK_EQUAL (cos (identity), 1.);
+  BOOST_CHECK_EQUAL (sin (identity), 0.);
+
+  const UnitComplex a (Angle (0.5));
+  BOOST_CHECK_EQUAL (cos (a), std::cos (0.5));
+  BOOST_CHECK_EQUAL (sin (a), std::sin (0.5));
+  BOOST_CHECK_CLOSE (tan (a), std::tan (0.5), 1e-12);
+  BOOST_CHECK_CLOSE (a.angle ().value (), 0.5, 1e-12);
+
+  // Composition adds the angles, and wraps them.
+  const UnitComplex b (Angle (3.));
+  const UnitComplex ab = a * b;
+  BOOST_CHECK_SMALL (ab.cos () - std::cos (3.5), 1e-15);
+  BOOST_CHECK_SMALL (ab.sin () - std::sin (3.5), 1e-15);
+  BOOST_CHECK_CLOSE (ab.angle ().value (), 3.5 - 2. * M_PI, 1e-12);
+  const UnitComplex ba = ab / b;
+  BOOST_CHECK_SMALL (ba.cos () - a.cos (), 1e-15);
+  BOOST_CHECK_SMALL (ba.sin () - a.sin (), 1e-15);
+
+  UnitComplex c = a;
+  c *= a.inverse ();
+  BOOST_CHECK_SMALL (c.sin (), 1e-15);
+  c /= b;
+  BOOST_CHECK_CLOSE (c.angle ().value (), -3., 1e-12);
+
+  // Long sequences of compositions.
+  UnitComplex d;
+  const UnitComplex step (Angle (1e-3));
+  for (int i = 0; i < 100000; ++i)
+    d *= step;
+  d.normalize ();
+  BOOST_CHECK_CLOSE (d.cos () * d.cos () + d.sin () * d.sin (), 1., 1e-12);
+  BOOST_CHECK_SMALL (d.distance (UnitComplex (Angle (100.))), 1e-9);
+
+  double x = 1.;
+  double y = 0.;
+  UnitComplex (Angle (M_PI / 2.)).rotate (x, y);
+  BOOST_CHECK_SMALL (x, 1e-15);
+  BOOST_CHECK_CLOSE (y, 1., 1e-12);
+
+  BOOST_CHECK_CLOSE (a.distance (b), 2.5, 1e-12);
+  BOOST_CHECK_CLOSE (b.distance (UnitComplex (Angle (-3.))),
+		     2. * M_PI - 6., 1e-10);
+
+  output_test_stream output;
+  output << UnitComplex ();
+  BOOST_CHECK (output.is_equal ("(1, 0)"));
+}
+
+BOOST_AUTO_TEST_CASE (wrap)
+{
+  using jrlMathTools::Angle;
+
+  // The bounds are kept.
+  BOOST_CHECK_EQUAL (Angle (M_PI).value (), M_PI);
+  BOOST_CHECK_EQUAL (Angle (-M_PI).value (), -M_PI);
+  BOOST_CHECK_CLOSE (Angle (3. * M_PI).value (), -M_PI, 1e-12);
+  BOOST_CHECK_CLOSE (Angle (-2.5 * M_PI).value (), -0.5 * M_PI, 1e-12);
+
+  // Large values, e.g. accumulated odometry, are wrapped in constant
+  // time and stay accurate.
+  for (double x = 1.; x < 1e9; x *= 7.3)
+    {
+      const Angle a (x);
+      BOOST_CHECK (a.value () >= -M_PI && a.value () <= M_PI);
+      BOOST_CHECK_SMALL (a.value () - std::remainder (x, 2. * M_PI),
+			 1e-15 * x + 1e-15);
+      BOOST_CHECK_SMALL (Angle (-x).value () + a.value (), 1e-15 * x + 1e-15);
+    }
+  BOOST_CHECK_CLOSE ((Angle (1.) * 1e6).value (),
+		     std::remainder (1e6, 2. * M_PI), 1e-7);
+}
@@ -0,0 +1,166 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <jrl/mathtools/binaryangle.hh>
+
+#define BOOST_TEST_MODULE binary-angle
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using jrlMathTools::Angle;
+using jrlMathTools::BinaryAngle;
+
+typedef boost::mpl::list<std::uint32_t, std::uint64_t> countTypes_t;
+
+// Half a step for 32 bits, the double precision for 64 bits.
+template <typename U>
+static double tolerance ()
+{
+  return sizeof (U) == 4 ? M_PI / 4294967296. : 4e-16;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (conversion, U, countTypes_t)
+{
+  typedef BinaryAngle<U> angle_t;
+  const U half = U (U (1) << (angle_t::digits - 1));
+
+  BOOST_CHECK_EQUAL (angle_t ().count (), 0u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (M_PI / 2)).count (), U (half / 2));
+  BOOST_CHECK_EQUAL (angle_t (Angle (-M_PI / 2)).count (), U (-(half / 2)));
+  BOOST_CHECK_EQUAL (angle_t (Angle (M_PI)).count (), half);
+  BOOST_CHECK_EQUAL (angle_t (Angle (-M_PI)).count (), half);
+  BOOST_CHECK_EQUAL (angle_t::fromCount (half).value (), -M_PI);
+
+  for (int i = -1000; i <= 1000; ++i)
+    {
+      const Angle angle (M_PI * i / 1000);
+      const angle_t binary (angle);
+      BOOST_CHECK_SMALL (binary.angle ().distance (angle),
+			 tolerance<U> ());
+      BOOST_CHECK (binary.value () >= -M_PI);
+      BOOST_CHECK (binary.value () < M_PI);
+    }
+
+  std::vector<double> values (11), back (11);
+  std::vector<U> counts (11);
+  for (std::size_t i = 0; i < values.size (); ++i)
+    values[i] = 0.6 * static_cast<double> (i) - 3.;
+  jrlMathTools::toBinaryAngles (&values[0], &counts[0], values.size ());
+  jrlMathTools::fromBinaryAngles (&counts[0], &back[0], counts.size ());
+  for (std::size_t i = 0; i < values.size (); ++i)
+    {
+      BOOST_CHECK_EQUAL (counts[i], angle_t (Angle (values[i])).count ());
+      BOOST_CHECK_SMALL (back[i] - values[i], tolerance<U> ());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (arithmetic, U, countTypes_t)
+{
+  typedef BinaryAngle<U> angle_t;
+  const angle_t a (Angle (3.));
+  const angle_t b (Angle (2.5));
+
+  // Wrapping is the integer overflow.
+  BOOST_CHECK_SMALL ((a + b).angle ().distance (Angle (5.5)),
+		     2 * tolerance<U> ());
+  BOOST_CHECK_SMALL ((b - a).angle ().distance (Angle (-0.5)),
+		     2 * tolerance<U> ());
+  BOOST_CHECK (a + b - b == a);
+  BOOST_CHECK (-a + a == angle_t ());
+  BOOST_CHECK (a * 3 == a + a + a);
+  BOOST_CHECK (a * -1 == -a);
+
+  // No drift: a thousandth of a turn added a thousand times.
+  const angle_t step = angle_t::fromCount (U (U (-1) / 1000 + 1));
+  angle_t sum;
+  for (unsigned i = 0; i < 1000; ++i)
+    sum += step;
+  BOOST_CHECK (sum == step * 1000);
+  BOOST_CHECK (sum - step * 1000 == angle_t ());
+  sum -= step * 1000;
+  BOOST_CHECK_EQUAL (sum.count (), 0u);
+}
+
+BOOST_AUTO_TEST_CASE (narrowMultiplication)
+{
+  // 16-bit counts are promoted to int: the product must not overflow.
+  typedef BinaryAngle<std::uint16_t> angle_t;
+  const angle_t a = angle_t::fromCount (0xFFFF);
+
+  BOOST_CHECK (a * -1 == -a);
+  BOOST_CHECK_EQUAL ((a * -1).count (), 1u);
+  BOOST_CHECK_EQUAL ((a * 0x7FFF).count (), 0x8001u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (interpolation, U, countTypes_t)
+{
+  typedef BinaryAngle<U> angle_t;
+  const angle_t a (Angle (3.));
+  const angle_t b (Angle (-3.));
+
+  BOOST_CHECK (a.interpolate (0., b) == a);
+  BOOST_CHECK (a.interpolate (1., b) == b);
+  BOOST_CHECK (b.interpolate (1., a) == a);
+
+  // Along the shortest arc, across PI.
+  BOOST_CHECK_CLOSE (std::fabs (a.interpolate (0.5, b).value ()), M_PI,
+		     1e-6);
+  BOOST_CHECK_SMALL (a.distance (b) - (2. * M_PI - 6.), 2 * tolerance<U> ());
+  BOOST_CHECK_EQUAL (a.distance (b), b.distance (a));
+  BOOST_CHECK_SMALL (a.distance (-a + a) - 3., tolerance<U> ());
+  for (double alpha = 0.; alpha <= 1.; alpha += 0.125)
+    BOOST_CHECK_SMALL (a.interpolate (alpha, b).angle ()
+		       .distance (Angle (3.).interpolate (alpha, Angle (-3.))),
+		       4 * tolerance<U> ());
+
+  // Opposite angles: the distance is PI.
+  const angle_t opposite =
+    angle_t::fromCount (U (U (1) << (angle_t::digits - 1)));
+  BOOST_CHECK_EQUAL (angle_t ().distance (opposite), M_PI);
+}
+
+BOOST_AUTO_TEST_CASE (binning)
+{
+  typedef BinaryAngle<std::uint32_t> angle_t;
+
+  // Four bins: [0, PI / 2), [PI / 2, PI), [-PI, -PI / 2), [-PI / 2, 0).
+  BOOST_CHECK_EQUAL (angle_t (Angle (0.1)).bin (2), 0u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (2.)).bin (2), 1u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (-2.)).bin (2), 2u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (2), 3u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (0), 0u);
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (32),
+		     angle_t (Angle (-0.1)).count ());
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (33),
+		     angle_t (Angle (-0.1)).count ());
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (64),
+		     angle_t (Angle (-0.1)).count ());
+  BOOST_CHECK_EQUAL (angle_t (Angle (-0.1)).bin (-1), 0u);
+  BOOST_CHECK_EQUAL (BinaryAngle<std::uint16_t> (Angle (-2.)).bin (20),
+		     BinaryAngle<std::uint16_t> (Angle (-2.)).count ());
+
+  const std::hash<angle_t> hash;
+  BOOST_CHECK_EQUAL (hash (angle_t (Angle (1.))),
+		     hash (angle_t (Angle (1.))));
+  BOOST_CHECK_EQUAL (jrlMathTools::cos (angle_t (Angle (1.))),
+		     std::cos (angle_t (Angle (1.)).value ()));
+}
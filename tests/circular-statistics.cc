@@ -0,0 +1,140 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <jrl/mathtools/circularstatistics.hh>
+
+#define BOOST_TEST_MODULE circular-statistics
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using jrlMathTools::Angle;
+using jrlMathTools::AngleUnwrapper;
+using jrlMathTools::CircularStatistics;
+
+// A heading turning several times in both directions, and its wrapped
+// samples.
+static double heading (std::size_t i)
+{
+  const double t = static_cast<double> (i);
+  return 30. * std::sin (0.003 * t) + 0.01 * t - 2.;
+}
+
+static std::vector<double> wrappedHeading (std::size_t n)
+{
+  std::vector<double> result (n);
+  for (std::size_t i = 0; i < n; ++i)
+    result[i] = Angle (heading (i)).value ();
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE (unwrap)
+{
+  const std::size_t n = 5000;
+  const std::vector<double> x = wrappedHeading (n);
+  static const std::size_t chunks[] = {n, 1, 3, 4, 7, 100};
+
+  for (unsigned k = 0; k < sizeof (chunks) / sizeof (chunks[0]); ++k)
+    {
+      AngleUnwrapper unwrapper;
+      std::vector<double> y (n);
+      for (std::size_t i = 0; i < n; i += chunks[k])
+	unwrapper.unwrap (&x[i], &y[i], std::min (chunks[k], n - i));
+      for (std::size_t i = 0; i < n; ++i)
+	BOOST_CHECK_SMALL (y[i] - heading (i), 1e-12 * (1. + std::abs (y[i])));
+      BOOST_CHECK_EQUAL (unwrapper.turns (),
+			 std::floor ((heading (n - 1) + M_PI) / (2. * M_PI)));
+    }
+
+  // A new signal starts without any turn.
+  AngleUnwrapper unwrapper;
+  std::vector<double> y (n);
+  unwrapper.unwrap (&x[0], &y[0], n);
+  unwrapper.reset ();
+  BOOST_CHECK_EQUAL (unwrapper.turns (), 0.);
+  unwrapper.unwrap (&x[n - 1], &y[0], 1);
+  BOOST_CHECK_EQUAL (y[0], x[n - 1]);
+  unwrapper.unwrap (&x[0], &y[0], 0);
+  BOOST_CHECK_EQUAL (unwrapper.turns (), 0.);
+}
+
+// Statistics of samples [begin, end) computed directly.
+static void directStatistics (const std::vector<double>& x,
+			      std::size_t begin, std::size_t end,
+			      double& mean, double& variance)
+{
+  double c = 0.;
+  double s = 0.;
+  for (std::size_t i = begin; i < end; ++i)
+    {
+      c += std::cos (x[i]);
+      s += std::sin (x[i]);
+    }
+  mean = std::atan2 (s, c);
+  variance = 1. - std::sqrt (c * c + s * s) / static_cast<double> (end - begin);
+}
+
+BOOST_AUTO_TEST_CASE (statistics)
+{
+  BOOST_CHECK_THROW (CircularStatistics (0), std::invalid_argument);
+
+  // Samples around PI: the mean is PI, not 0.
+  CircularStatistics around (4);
+  BOOST_CHECK_EQUAL (around.size (), 0u);
+  BOOST_CHECK_EQUAL (around.variance (), 1.);
+  around.push (Angle (3.));
+  around.push (Angle (-3.));
+  BOOST_CHECK_EQUAL (around.size (), 2u);
+  BOOST_CHECK_CLOSE (std::abs (around.mean ().value ()), M_PI, 1e-12);
+  BOOST_CHECK_CLOSE (around.resultantLength (), std::cos (M_PI - 3.), 1e-12);
+  BOOST_CHECK_CLOSE (around.standardDeviation (),
+		     std::sqrt (-2. * std::log (std::cos (M_PI - 3.))), 1e-12);
+  around.clear ();
+  BOOST_CHECK_EQUAL (around.size (), 0u);
+
+  const std::size_t n = 3000;
+  const std::vector<double> x = wrappedHeading (n);
+  static const std::size_t windows[] = {1, 5, 64, 1000};
+  static const std::size_t chunks[] = {1, 3, 17, 500};
+  for (unsigned w = 0; w < 4; ++w)
+    for (unsigned k = 0; k < 4; ++k)
+      {
+	CircularStatistics statistics (windows[w]);
+	std::vector<double> means (n), variances (n);
+	for (std::size_t i = 0; i < n; i += chunks[k])
+	  statistics.push (&x[i], std::min (chunks[k], n - i), &means[i],
+			   &variances[i]);
+	BOOST_CHECK_EQUAL (statistics.window (), windows[w]);
+	BOOST_CHECK_EQUAL (statistics.size (), windows[w]);
+
+	for (std::size_t i = 0; i < n; i += 7)
+	  {
+	    const std::size_t begin =
+	      i + 1 > windows[w] ? i + 1 - windows[w] : 0;
+	    double mean, variance;
+	    directStatistics (x, begin, i + 1, mean, variance);
+	    BOOST_CHECK_SMALL (Angle (means[i]).distance (mean), 1e-9);
+	    BOOST_CHECK_SMALL (variances[i] - variance, 1e-12);
+	  }
+	double mean, variance;
+	directStatistics (x, n - windows[w], n, mean, variance);
+	BOOST_CHECK_SMALL (statistics.mean ().distance (mean), 1e-9);
+	BOOST_CHECK_SMALL (statistics.variance () - variance, 1e-12);
+      }
+}
@@ -15,6 +15,7 @@
 
 #ifndef JRL_MATHTOOLS_COMMON_HH
 # define JRL_MATHTOOLS_COMMON_HH
+# include <jrl/mathtools/checks.hh>
 
 // This is a custom numeric type used to check
 // that the container can handle non-native types.
@@ -39,4 +40,12 @@ std::ostream& operator<< (std::ostream& os, const MyNumericType& mnt)
   return os;
 }
 
+// Out-of-range accesses are only diagnosed when bounds checking is
+// enabled, see jrl/mathtools/checks.hh.
+# if JRL_MATHTOOLS_BOUNDS_CHECK
+#  define CHECK_BAD_INDEX(EXPR) BOOST_CHECK_THROW (EXPR, std::logic_error)
+# else
+#  define CHECK_BAD_INDEX(EXPR) do {} while (0)
+# endif //! JRL_MATHTOOLS_BOUNDS_CHECK
+
 #endif //! JRL_MATHTOOLS_COMMON_HH
@@ -0,0 +1,283 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include <jrl/mathtools/decompositions3x3.hh>
+
+#define BOOST_TEST_MODULE decompositions3x3
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+template <typename T>
+static T tolerance ()
+{
+  return std::is_same<T, float>::value ? T (1e-5) : T (1e-13);
+}
+
+// Deterministic symmetric matrices, including diagonal ones and
+// repeated or nearly repeated eigenvalues.
+template <typename T>
+static std::vector<Matrix3x3<T> > samples ()
+{
+  std::vector<Matrix3x3<T> > result;
+  result.push_back (Matrix3x3<T> (T ()));
+  result.push_back (Matrix3x3<T> (3, 0, 0, 0, 1, 0, 0, 0, 2));
+  result.push_back (Matrix3x3<T> (1, 0, 0, 0, 1, 0, 0, 0, 1));
+  result.push_back (Matrix3x3<T> (2, 1, 0, 1, 2, 0, 0, 0, 3));
+  result.push_back (Matrix3x3<T> (1, 1, 1, 1, 1, 1, 1, 1, 1));
+  result.push_back (Matrix3x3<T> (1, T (1e-7), 0, T (1e-7), 1, 0, 0, 0, -4));
+  for (unsigned i = 0; i < 9; ++i)
+    {
+      const T a = std::cos (T (0.9) * i);
+      const T b = std::sin (T (1.7) * i);
+      const T c = T (0.3) * i - 1;
+      const T d = std::cos (T (2.3) * i) * 2;
+      const T e = std::sin (T (0.4) * i);
+      const T f = T (i % 4) - T (1.5);
+      result.push_back (Matrix3x3<T> (a, d, e, d, b, f, e, f, c));
+    }
+  return result;
+}
+
+template <typename T>
+static void checkDecomposition (const Matrix3x3<T>& A,
+				const Vector3D<T>& values,
+				const Matrix3x3<T>& vectors)
+{
+  T scale = T (1);
+  for (unsigned k = 0; k < 9; ++k)
+    scale = std::max (scale, std::abs (A.m[k]));
+
+  BOOST_CHECK (values[0] <= values[1]);
+  BOOST_CHECK (values[1] <= values[2]);
+  BOOST_CHECK_CLOSE (vectors.determinant (), T (1), 100 * tolerance<T> ());
+  for (unsigned r = 0; r < 3; ++r)
+    for (unsigned c = 0; c < 3; ++c)
+      {
+	// A V = V diag (values) and V^T V = I.
+	T av = T ();
+	T vv = T ();
+	for (unsigned k = 0; k < 3; ++k)
+	  {
+	    av += A.m[3 * r + k] * vectors.m[3 * k + c];
+	    vv += vectors.m[3 * k + r] * vectors.m[3 * k + c];
+	  }
+	BOOST_CHECK_SMALL (av - vectors.m[3 * r + c] * values[c],
+			   scale * tolerance<T> ());
+	BOOST_CHECK_SMALL (vv - T (r == c), tolerance<T> ());
+      }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (symmetricEigen, T, floatingTypes_t)
+{
+  const std::vector<Matrix3x3<T> > A = samples<T> ();
+  for (std::size_t i = 0; i < A.size (); ++i)
+    {
+      const SymmetricEigenDecomposition<T> e (A[i]);
+      checkDecomposition (A[i], e.eigenvalues (), e.eigenvectors ());
+    }
+
+  // Known spectrum.
+  const SymmetricEigenDecomposition<T> e (A[3]);
+  BOOST_CHECK_SMALL (e.eigenvalues ()[0] - T (1), tolerance<T> ());
+  BOOST_CHECK_SMALL (e.eigenvalues ()[1] - T (3), tolerance<T> ());
+  BOOST_CHECK_SMALL (e.eigenvalues ()[2] - T (3), tolerance<T> ());
+
+  // Only the lower triangular part is read.
+  Matrix3x3<T> L (A.back ());
+  L.m[1] = L.m[2] = L.m[5] = T (42);
+  const SymmetricEigenDecomposition<T> l (L);
+  const SymmetricEigenDecomposition<T> s (A.back ());
+  for (unsigned k = 0; k < 3; ++k)
+    BOOST_CHECK_EQUAL (l.eigenvalues ()[k], s.eigenvalues ()[k]);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (batchedSymmetricEigen, T, floatingTypes_t)
+{
+  const std::vector<Matrix3x3<T> > A = samples<T> ();
+  const std::size_t n = A.size ();
+  std::vector<T> a (6 * n), values (3 * n), vectors (9 * n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      a[i] = A[i].m[0];
+      a[n + i] = A[i].m[4];
+      a[2 * n + i] = A[i].m[8];
+      a[3 * n + i] = A[i].m[3];
+      a[4 * n + i] = A[i].m[6];
+      a[5 * n + i] = A[i].m[7];
+    }
+  symmetricEigenDecomposition (&a[0], &values[0], &vectors[0], n);
+
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      Vector3D<T> l (values[i], values[n + i], values[2 * n + i]);
+      Matrix3x3<T> V;
+      for (unsigned k = 0; k < 9; ++k)
+	V.m[k] = vectors[k * n + i];
+      checkDecomposition (A[i], l, V);
+
+      const SymmetricEigenDecomposition<T> e (A[i]);
+      for (unsigned k = 0; k < 3; ++k)
+	BOOST_CHECK_SMALL (l[k] - e.eigenvalues ()[k],
+			   10 * tolerance<T> ());
+    }
+}
+
+// General matrices: rank deficient, with a negative determinant, and
+// with repeated singular values.
+template <typename T>
+static std::vector<Matrix3x3<T> > generalSamples ()
+{
+  std::vector<Matrix3x3<T> > result;
+  result.push_back (Matrix3x3<T> (T ()));
+  result.push_back (Matrix3x3<T> (0, 0, 0, 0, 0, 0, 0, 0, -2));
+  result.push_back (Matrix3x3<T> (1, 0, 0, 0, 1, 0, 0, 0, -1));
+  result.push_back (Matrix3x3<T> (0, 2, 0, 0, 0, 2, 2, 0, 0));
+  result.push_back (Matrix3x3<T> (1, 2, 3, 2, 4, 6, -1, 0, 1));
+  for (unsigned i = 0; i < 9; ++i)
+    {
+      Matrix3x3<T> A;
+      for (unsigned k = 0; k < 9; ++k)
+	A.m[k] = std::cos (T (0.37) * (9 * i + k) + T (0.1) * k * k);
+      result.push_back (A);
+    }
+  return result;
+}
+
+template <typename T>
+static void checkRotation (const Matrix3x3<T>& R)
+{
+  BOOST_CHECK_CLOSE (R.determinant (), T (1), 100 * tolerance<T> ());
+  for (unsigned r = 0; r < 3; ++r)
+    for (unsigned c = 0; c < 3; ++c)
+      {
+	T rr = T ();
+	for (unsigned k = 0; k < 3; ++k)
+	  rr += R.m[3 * k + r] * R.m[3 * k + c];
+	BOOST_CHECK_SMALL (rr - T (r == c), tolerance<T> ());
+      }
+}
+
+template <typename T>
+static void checkSvd (const Matrix3x3<T>& A, const Matrix3x3<T>& U,
+		      const Vector3D<T>& sigma, const Matrix3x3<T>& V)
+{
+  checkRotation (U);
+  checkRotation (V);
+  BOOST_CHECK (sigma[0] + tolerance<T> () >= sigma[1]);
+  BOOST_CHECK (sigma[1] + tolerance<T> () >= std::abs (sigma[2]));
+  BOOST_CHECK (sigma[2] * A.determinant () >= -tolerance<T> ());
+  for (unsigned r = 0; r < 3; ++r)
+    for (unsigned c = 0; c < 3; ++c)
+      {
+	T usv = T ();
+	for (unsigned k = 0; k < 3; ++k)
+	  usv += U.m[3 * r + k] * sigma[k] * V.m[3 * c + k];
+	BOOST_CHECK_SMALL (usv - A.m[3 * r + c], 10 * tolerance<T> ());
+      }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (svd, T, floatingTypes_t)
+{
+  const std::vector<Matrix3x3<T> > A = generalSamples<T> ();
+  for (std::size_t i = 0; i < A.size (); ++i)
+    {
+      const SingularValueDecomposition<T> svd (A[i]);
+      checkSvd (A[i], svd.matrixU (), svd.singularValues (),
+		svd.matrixV ());
+    }
+
+  // Known singular values.
+  const SingularValueDecomposition<T> svd (A[1]);
+  BOOST_CHECK_SMALL (svd.singularValues ()[0] - T (2), tolerance<T> ());
+  BOOST_CHECK_SMALL (svd.singularValues ()[1], tolerance<T> ());
+  BOOST_CHECK_SMALL (svd.singularValues ()[2], tolerance<T> ());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (nearestRotations, T, floatingTypes_t)
+{
+  // A rotation is its own nearest rotation.
+  const Matrix3x3<T> R (T (0.36), T (0.48), T (-0.8),
+			T (-0.8), T (0.6), T (0),
+			T (0.48), T (0.64), T (0.6));
+  const Matrix3x3<T> N = nearestRotation (R);
+  for (unsigned k = 0; k < 9; ++k)
+    BOOST_CHECK_SMALL (N.m[k] - R.m[k], tolerance<T> ());
+
+  // R S, with S symmetric positive definite, is projected onto R.
+  const Matrix3x3<T> S (2, T (0.1), T (0.3),
+			T (0.1), 1, T (-0.2),
+			T (0.3), T (-0.2), T (0.5));
+  const Matrix3x3<T> P = nearestRotation (R * S);
+  for (unsigned k = 0; k < 9; ++k)
+    BOOST_CHECK_SMALL (P.m[k] - R.m[k], 10 * tolerance<T> ());
+
+  // A drifting rotation.
+  Matrix3x3<T> D (R);
+  D.m[1] += T (1e-3);
+  D.m[5] -= T (2e-3);
+  const Matrix3x3<T> Q = nearestRotation (D);
+  checkRotation (Q);
+  for (unsigned k = 0; k < 9; ++k)
+    BOOST_CHECK_SMALL (Q.m[k] - R.m[k], T (3e-3));
+
+  // Reflections give a proper rotation.
+  const std::vector<Matrix3x3<T> > A = generalSamples<T> ();
+  for (std::size_t i = 0; i < A.size (); ++i)
+    checkRotation (nearestRotation (A[i]));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (batchedSvd, T, floatingTypes_t)
+{
+  const std::vector<Matrix3x3<T> > A = generalSamples<T> ();
+  const std::size_t n = A.size ();
+  std::vector<T> a (9 * n), u (9 * n), sigma (3 * n), v (9 * n), r (9 * n);
+  for (std::size_t i = 0; i < n; ++i)
+    for (unsigned k = 0; k < 9; ++k)
+      a[k * n + i] = A[i].m[k];
+  singularValueDecomposition (&a[0], &u[0], &sigma[0], &v[0], n);
+  nearestRotation (&a[0], &r[0], n);
+
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      Matrix3x3<T> U, V;
+      for (unsigned k = 0; k < 9; ++k)
+	{
+	  U.m[k] = u[k * n + i];
+	  V.m[k] = v[k * n + i];
+	}
+      const Vector3D<T> s (sigma[i], sigma[n + i], sigma[2 * n + i]);
+      checkSvd (A[i], U, s, V);
+
+      const Matrix3x3<T> N = nearestRotation (A[i]);
+      for (unsigned k = 0; k < 9; ++k)
+	BOOST_CHECK_SMALL (r[k * n + i] - N.m[k], 10 * tolerance<T> ());
+    }
+
+  // In place.
+  nearestRotation (&a[0], &a[0], n);
+  for (std::size_t k = 0; k < 9 * n; ++k)
+    BOOST_CHECK_EQUAL (a[k], r[k]);
+}
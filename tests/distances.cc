@@ -0,0 +1,138 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include <jrl/mathtools/distances.hh>
+
+#define BOOST_TEST_MODULE distances
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+template <typename T>
+static T tolerance ()
+{
+  return std::is_same<T, float>::value ? T (1e-5) : T (1e-13);
+}
+
+// Deterministic samples in [-scale, scale].
+static double sample (std::size_t i, double frequency, double scale)
+{
+  return scale * std::sin (frequency * static_cast<double> (i) + 0.3);
+}
+
+// Thirteen angles: three full vectors and a remainder, with the bounds.
+BOOST_AUTO_TEST_CASE (angles)
+{
+  std::vector<double> angles (13);
+  for (std::size_t i = 0; i < angles.size (); ++i)
+    angles[i] = Angle (1.7 * static_cast<double> (i) - 3.).value ();
+  angles[3] = M_PI;
+  angles[4] = -M_PI;
+
+  static const double queries[] = {0., 3., -3., M_PI, -M_PI};
+  std::vector<double> out (angles.size ());
+  for (unsigned q = 0; q < 5; ++q)
+    {
+      const Angle query (queries[q]);
+      angleDistances (query, &angles[0], &out[0], angles.size ());
+      for (std::size_t i = 0; i < angles.size (); ++i)
+	BOOST_CHECK_SMALL (out[i] - query.distance (Angle (angles[i])),
+			   1e-15);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (se2)
+{
+  const std::size_t n = 11;
+  std::vector<double> poses (3 * n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      poses[i] = sample (i, 1.3, 2.);
+      poses[n + i] = sample (i, 0.7, 2.);
+      poses[2 * n + i] = sample (i, 2.9, M_PI);
+    }
+  const double query[] = {0.5, -1., 3.};
+  std::vector<double> out (n);
+  se2Distances (query, &poses[0], &out[0], n, 0.5);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const double dx = poses[i] - query[0];
+      const double dy = poses[n + i] - query[1];
+      const double dtheta =
+	0.5 * Angle (poses[2 * n + i]).distance (Angle (query[2]));
+      BOOST_CHECK_SMALL (out[i] - std::sqrt (dx * dx + dy * dy
+					     + dtheta * dtheta), 1e-14);
+    }
+}
+
+template <typename T>
+static Quaternion<T> rotationSample (std::size_t i)
+{
+  Quaternion<T> q (T (sample (i, 1.3, 1.)), T (sample (i, 0.7, 1.)),
+		   T (sample (i, 2.9, 1.)), T (sample (i, 0.4, 1.) + 0.5));
+  q.normalize ();
+  return q;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (se3, T, floatingTypes_t)
+{
+  const std::size_t n = 11;
+  std::vector<Quaternion<T> > rotations (n);
+  std::vector<Vector3D<T> > translations (n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      rotations[i] = rotationSample<T> (i);
+      translations[i] = Vector3D<T> (T (sample (i, 0.9, 1.)),
+				     T (sample (i, 1.7, 1.)),
+				     T (sample (i, 2.3, 1.)));
+    }
+  const Quaternion<T> q = rotations[2];
+  const Vector3D<T> t (T (0.1), T (0.2), T (-0.3));
+
+  // The same rotation, as q or -q, and a quarter turn.
+  rotations[3] = q;
+  rotations[4] = -q;
+  rotations[5] = q * Quaternion<T> (T (0), T (0), T (std::sqrt (.5)),
+				    T (std::sqrt (.5)));
+
+  // acos loses half of the digits close to 1.
+  const T acosTolerance = std::sqrt (tolerance<T> ());
+  std::vector<T> angles (n), out (n);
+  rotationDistances (q, &rotations[0], &angles[0], n);
+  se3Distances (t, q, &translations[0], &rotations[0], &out[0], n, T (2));
+  BOOST_CHECK_EQUAL (angles[3], T (0));
+  BOOST_CHECK_EQUAL (angles[4], T (0));
+  BOOST_CHECK_SMALL (angles[5] - T (M_PI / 2), tolerance<T> ());
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const T dot = std::abs (q.dot (rotations[i]));
+      const T angle = 2 * std::acos (std::min (dot, T (1)));
+      BOOST_CHECK_SMALL (angles[i] - angle, acosTolerance);
+      BOOST_CHECK (angles[i] >= T (0) && angles[i] <= T (M_PI));
+      const Vector3D<T> d = translations[i] - t;
+      BOOST_CHECK_SMALL (out[i] - std::sqrt (d.normsquared () + 4 * angles[i]
+					     * angles[i]),
+			 tolerance<T> ());
+    }
+}
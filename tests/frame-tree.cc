@@ -0,0 +1,146 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <jrl/mathtools/frametree.hh>
+
+#define BOOST_TEST_MODULE frame-tree
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+typedef jrlMathTools::Matrix4x4<double> matrix_t;
+typedef jrlMathTools::FrameTree<double> tree_t;
+
+static matrix_t rigid (double q, double x, double y, double z)
+{
+  const double c = std::cos (q);
+  const double s = std::sin (q);
+  return matrix_t (c, 0., s, x,
+		   0., 1., 0., y,
+		   -s, 0., c, z,
+		   0., 0., 0., 1.);
+}
+
+static void checkClose (const matrix_t& a, const matrix_t& b)
+{
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_SMALL (a.m[i] - b.m[i], 1e-12);
+}
+
+// world -> (base -> (arm -> hand, lidar), camera).
+static void makeTree (tree_t& tree)
+{
+  tree.addFrame ("base", "world", rigid (0.3, 1., 2., 0.));
+  tree.addFrame ("camera", "world", rigid (-1., 0., 0., 2.));
+  tree.addFrame ("arm", "base", rigid (0.5, 0., 0.2, 0.8));
+  tree.addFrame ("lidar", "base", rigid (0., 0.3, 0., 1.));
+  tree.addFrame ("hand", "arm", rigid (1.2, 0.4, 0., 0.));
+}
+
+BOOST_AUTO_TEST_CASE (lookups)
+{
+  tree_t tree;
+  makeTree (tree);
+  BOOST_CHECK_EQUAL (tree.size (), 6u);
+  BOOST_CHECK_EQUAL (tree.id ("world"), tree_t::root ());
+  BOOST_CHECK_EQUAL (tree.parent (tree.id ("hand")), tree.id ("arm"));
+  BOOST_CHECK_EQUAL (tree.name (tree.id ("lidar")), "lidar");
+
+  const matrix_t hand =
+    tree.local (tree.id ("base")) * tree.local (tree.id ("arm"))
+    * tree.local (tree.id ("hand"));
+  checkClose (tree.world ("hand"), hand);
+
+  // camera <- hand maps hand coordinates to camera coordinates.
+  const matrix_t camera = tree.local (tree.id ("camera"));
+  matrix_t inverse;
+  camera.Inversion (inverse);
+  checkClose (tree.transform ("hand", "camera"), inverse * hand);
+
+  matrix_t identity;
+  identity.setIdentity ();
+  checkClose (tree.transform ("lidar", "lidar"), identity);
+  checkClose (tree.transform ("world", "base"),
+	      tree.world ("base").Inversion ());
+
+  BOOST_CHECK_THROW (tree.id ("nowhere"), std::invalid_argument);
+  BOOST_CHECK_THROW (tree.addFrame ("arm", 0, identity),
+		     std::invalid_argument);
+  CHECK_BAD_INDEX (tree.world (6));
+}
+
+BOOST_AUTO_TEST_CASE (publication)
+{
+  tree_t tree;
+  makeTree (tree);
+  const matrix_t before = tree.world ("hand");
+  const matrix_t lidar = tree.world ("lidar");
+
+  // Changes are only visible once published.
+  tree.setLocal (tree.id ("arm"), rigid (-0.7, 0.1, 0.1, 0.5));
+  checkClose (tree.world ("hand"), before);
+  tree.publish ();
+  checkClose (tree.world ("hand"),
+	      tree.world ("arm") * tree.local (tree.id ("hand")));
+  BOOST_CHECK (std::abs (tree.world ("hand").m[3] - before.m[3]) > 1e-3);
+
+  // Siblings are not affected.
+  checkClose (tree.world ("lidar"), lidar);
+
+  // Moving a parent moves the whole subtree.
+  tree.setLocal (tree.id ("base"), rigid (0., 0., 0., 0.));
+  tree.publish ();
+  checkClose (tree.world ("lidar"), tree.local (tree.id ("lidar")));
+}
+
+BOOST_AUTO_TEST_CASE (concurrentReaders)
+{
+  // Both children are always moved together, so that in any consistent
+  // snapshot the transformation between them is the identity.
+  tree_t tree;
+  const std::size_t a = tree.addFrame ("a", 0, rigid (0., 0., 0., 0.));
+  const std::size_t b = tree.addFrame ("b", 0, rigid (0., 0., 0., 0.));
+
+  std::atomic<bool> done (false);
+  std::atomic<unsigned> torn (0);
+  std::vector<std::thread> readers;
+  for (unsigned r = 0; r < 3; ++r)
+    readers.push_back (std::thread ([&] {
+	  while (! done)
+	    {
+	      const matrix_t M = tree.transform (a, b);
+	      if (std::abs (M.m[3]) > 1e-9 || std::abs (M.m[0] - 1.) > 1e-9)
+		++torn;
+	    }
+	}));
+
+  for (unsigned i = 0; i < 20000; ++i)
+    {
+      const matrix_t M = rigid (0.001 * i, 1. * i, 0., 0.);
+      tree.setLocal (a, M);
+      tree.setLocal (b, M);
+      tree.publish ();
+    }
+  done = true;
+  for (std::size_t r = 0; r < readers.size (); ++r)
+    readers[r].join ();
+  BOOST_CHECK_EQUAL (torn.load (), 0u);
+}
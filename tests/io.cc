@@ -0,0 +1,328 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jrl/mathtools/io.hh>
+
+#define BOOST_TEST_MODULE io
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static Matrix4x4<double> pose (std::size_t i)
+{
+  const double k = static_cast<double> (i);
+  Matrix4x4<double> m;
+  for (unsigned int e = 0; e < 16; ++e)
+    m.m[e] = std::sin (k + 0.1 * e);
+  return m;
+}
+
+BOOST_AUTO_TEST_CASE (header)
+{
+  BOOST_CHECK_EQUAL (sizeof (BinaryHeader), 64u);
+  const BinaryHeader header = BinaryHeader::make (BINARY_FLOAT32, 3, 1);
+  BOOST_CHECK (header.valid ());
+  BOOST_CHECK_EQUAL (header.recordSize (), 12u);
+  BOOST_CHECK (!BinaryHeader::make (BINARY_FLOAT64, 0, 3).valid ());
+}
+
+BOOST_AUTO_TEST_CASE (matrix4x4)
+{
+  const char* path = "io-matrix4x4.bin";
+  const std::size_t n = 1000;
+  std::vector<Matrix4x4<double> > poses (n);
+  for (std::size_t i = 0; i < n; ++i)
+    poses[i] = pose (i);
+  {
+    BinaryWriter<Matrix4x4<double> > writer (path);
+    writer.write (poses[0]);
+    writer.write (&poses[1], n - 1);
+    BOOST_CHECK_EQUAL (writer.size (), n);
+  }
+
+  {
+    MappedArray<Matrix4x4<double> > mapped (path);
+    BOOST_CHECK_EQUAL (mapped.size (), n);
+    // Records are 64-byte aligned in the mapping.
+    BOOST_CHECK_EQUAL
+      (reinterpret_cast<std::size_t> (mapped.data ()) % 64, 0u);
+    for (std::size_t i = 0; i < n; ++i)
+      for (unsigned int e = 0; e < 16; ++e)
+	BOOST_CHECK_EQUAL (mapped[i].m[e], poses[i].m[e]);
+    CHECK_BAD_INDEX (mapped[n]);
+    BOOST_CHECK_EQUAL (mapped.end () - mapped.begin (),
+		       std::ptrdiff_t (n));
+
+    // Other records.
+    BOOST_CHECK_THROW (MappedArray<Matrix3x3<double> > other (path),
+		       std::runtime_error);
+    BOOST_CHECK_THROW (MappedArray<Matrix4x4<float> > other (path),
+		       std::runtime_error);
+  }
+
+  // Appending, after a truncated record.
+  {
+    std::ofstream file (path, std::ios::binary | std::ios::app);
+    file.write ("garbage", 7);
+  }
+  BOOST_CHECK_EQUAL (MappedArray<Matrix4x4<double> > (path).size (), n);
+  {
+    BinaryWriter<Matrix4x4<double> > writer (path, true);
+    BOOST_CHECK_EQUAL (writer.size (), n);
+    writer.write (pose (n));
+    writer.close ();
+    BOOST_CHECK_EQUAL (writer.size (), n + 1);
+  }
+  {
+    MappedArray<Matrix4x4<double> > mapped (path);
+    BOOST_CHECK_EQUAL (mapped.size (), n + 1);
+    BOOST_CHECK_EQUAL (mapped[n - 1].m[5], poses[n - 1].m[5]);
+    BOOST_CHECK_EQUAL (mapped[n].m[5], pose (n).m[5]);
+  }
+  BOOST_CHECK_THROW (BinaryWriter<Vector3D<double> > writer (path, true),
+		     std::runtime_error);
+  std::remove (path);
+}
+
+BOOST_AUTO_TEST_CASE (vector3)
+{
+  const char* path = "io-vector3.bin";
+  {
+    BinaryWriter<Vector3D<float> > writer (path);
+    for (int i = 0; i < 10; ++i)
+      writer.write (Vector3D<float> (float (i), float (2 * i), -1.f));
+  }
+  MappedArray<Vector3D<float> > mapped (path);
+  BOOST_CHECK_EQUAL (mapped.size (), 10u);
+  BOOST_CHECK_EQUAL (mapped[7].m_y, 14.f);
+  BOOST_CHECK_EQUAL (mapped[9].m_z, -1.f);
+  std::remove (path);
+}
+
+BOOST_AUTO_TEST_CASE (matrixnxp)
+{
+  const char* path = "io-matrixnxp.bin";
+  matrixNxP jacobian (6, 7);
+  {
+    BinaryWriter<matrixNxP> writer (path, 6, 7);
+    for (std::size_t k = 0; k < 3; ++k)
+      {
+	for (std::size_t i = 0; i < 6; ++i)
+	  for (std::size_t j = 0; j < 7; ++j)
+	    jacobian (i, j) = std::sin (double (k * 42 + 7 * i + j));
+	writer.write (jacobian);
+      }
+    BOOST_CHECK_THROW (writer.write (matrixNxP (7, 6)),
+		       std::invalid_argument);
+  }
+  MappedArray<matrixNxP> mapped (path);
+  BOOST_CHECK_EQUAL (mapped.size (), 3u);
+  BOOST_CHECK_EQUAL (mapped.rows (), 6u);
+  BOOST_CHECK_EQUAL (mapped.cols (), 7u);
+  BOOST_CHECK_EQUAL (mapped[2][7 * 3 + 4], jacobian (3, 4));
+  const matrixNxP copy = mapped.matrix (1);
+  BOOST_CHECK_EQUAL (copy (5, 6), std::sin (double (42 + 35 + 6)));
+  std::remove (path);
+
+  BOOST_CHECK_THROW (MappedArray<matrixNxP> missing (path),
+		     std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (number)
+{
+  char buffer[NUMBER_BUFFER_SIZE];
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, 0.1)), "0.1");
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, 0.1f)),
+		     "0.1");
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, M_PI, 4)),
+		     "3.142");
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, -1e300)),
+		     "-1e+300");
+
+  // Shortest round trip.
+  for (int i = 0; i < 1000; ++i)
+    {
+      const double x = std::sin (double (i)) * std::pow (10., i % 40 - 20);
+      const std::size_t length = formatNumber (buffer, x);
+      double y;
+      BOOST_CHECK (parseNumber (buffer, buffer + length, y)
+		   == buffer + length);
+      BOOST_CHECK_EQUAL (x, y);
+      BOOST_CHECK (length <= 24);
+      const float xf = float (x);
+      float yf;
+      parseNumber (buffer, buffer + formatNumber (buffer, xf), yf);
+      BOOST_CHECK_EQUAL (xf, yf);
+    }
+  const double tiny = std::numeric_limits<double>::denorm_min ();
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, tiny)),
+		     "5e-324");
+
+  const std::string text = "  1.5\t-2e3 x 4";
+  const char* first = text.c_str ();
+  const char* last = first + text.size ();
+  double values[3];
+  first = parseNumbers (first, last, values, 2);
+  BOOST_REQUIRE (first);
+  BOOST_CHECK_EQUAL (values[0], 1.5);
+  BOOST_CHECK_EQUAL (values[1], -2e3);
+  BOOST_CHECK (!parseNumber (first, last, values[2]));
+  BOOST_CHECK (!parseNumber (last, last, values[2]));
+}
+
+// display () writes what element-wise operator<< would, whatever the
+// formatting flags of the stream.
+static void checkDisplay (std::ios::fmtflags flags, int precision)
+{
+  const Matrix4x4<double> m = pose (3);
+  std::ostringstream expected;
+  expected.flags (flags);
+  expected.precision (precision);
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+      for (unsigned int j = 0; j < 4; ++j)
+	expected << m.m[4 * i + j] << " ";
+      expected << std::endl;
+    }
+  std::ostringstream display;
+  display.flags (flags);
+  display.precision (precision);
+  display << m;
+  BOOST_CHECK_EQUAL (display.str (), expected.str ());
+
+  const Matrix3x3<float> r (1.f / 3.f);
+  std::ostringstream expected3;
+  expected3.flags (flags);
+  expected3.precision (precision);
+  for (unsigned int i = 0; i < 9; ++i)
+    expected3 << r.m[i] << (i % 3 == 2 ? " \n" : " ");
+  std::ostringstream display3;
+  display3.flags (flags);
+  display3.precision (precision);
+  display3 << r;
+  BOOST_CHECK_EQUAL (display3.str (), expected3.str ());
+}
+
+BOOST_AUTO_TEST_CASE (display)
+{
+  const std::ios::fmtflags flags = std::ostringstream ().flags ();
+  checkDisplay (flags, 6);
+  checkDisplay (flags, 0);
+  checkDisplay (flags, 17);
+  checkDisplay (flags | std::ios::fixed, 3);
+  checkDisplay (flags | std::ios::scientific, 4);
+  checkDisplay (flags | std::ios::showpos, 6);
+  checkDisplay (flags, 40);
+  checkDisplay (flags, 60);
+}
+
+// Precisions beyond max_digits10 add no digit and fit the buffers.
+BOOST_AUTO_TEST_CASE (high_precision)
+{
+  char buffer[NUMBER_BUFFER_SIZE];
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, 0.1, 60)),
+		     std::string (buffer, formatNumber (buffer, 0.1, 17)));
+  BOOST_CHECK_EQUAL (std::string (buffer, formatNumber (buffer, 0.1f, 40)),
+		     std::string (buffer, formatNumber (buffer, 0.1f, 9)));
+
+  const Matrix4x4<double> m = pose (5);
+  std::ostringstream high;
+  std::ostringstream exact;
+  formatRows (high, m.m, 4, 4, 60);
+  formatRows (exact, m.m, 4, 4, 17);
+  BOOST_CHECK_EQUAL (high.str (), exact.str ());
+  BOOST_CHECK_EQUAL (high.str ().find ('\0'), std::string::npos);
+}
+
+// The decimal point of the C locale does not leak into the text.
+BOOST_AUTO_TEST_CASE (c_locale)
+{
+  static const char* locales[] =
+    {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German", "French"};
+  const std::string previous = std::setlocale (LC_NUMERIC, 0);
+  const char* locale = 0;
+  for (unsigned i = 0; i < 6 && ! locale; ++i)
+    if (std::setlocale (LC_NUMERIC, locales[i]))
+      locale = locales[i];
+  if (! locale || *std::localeconv ()->decimal_point == '.')
+    {
+      std::setlocale (LC_NUMERIC, previous.c_str ());
+      BOOST_TEST_MESSAGE ("no comma-decimal locale available, skipped");
+      return;
+    }
+
+  char buffer[NUMBER_BUFFER_SIZE];
+  const std::string text (buffer, formatNumber (buffer, 1.5));
+  double value = 0.;
+  const char* end = parseNumber (text.c_str (), text.c_str () + text.size (),
+				 value);
+  const Matrix3x3<double> r (0.25);
+  std::ostringstream os;
+  os << r;
+  std::setlocale (LC_NUMERIC, previous.c_str ());
+
+  BOOST_CHECK_EQUAL (text, "1.5");
+  BOOST_CHECK (end == text.c_str () + text.size ());
+  BOOST_CHECK_EQUAL (value, 1.5);
+  BOOST_CHECK_EQUAL (os.str (), "0.25 0.25 0.25 \n0.25 0.25 0.25 \n"
+		     "0.25 0.25 0.25 \n");
+}
+
+BOOST_AUTO_TEST_CASE (text)
+{
+  std::ostringstream os;
+  for (std::size_t i = 0; i < 100; ++i)
+    formatText (os, pose (i));
+  matrixNxP jacobian (2, 3);
+  for (std::size_t i = 0; i < 6; ++i)
+    jacobian.data ()[i] = 1. / double (i + 1);
+  formatText (os, jacobian);
+  formatText (os, Vector3D<float> (0.1f, 0.2f, 0.3f));
+  const std::string text = os.str ();
+  BOOST_CHECK_EQUAL (std::count (text.begin (), text.end (), '\n'), 102);
+
+  const char* first = text.c_str ();
+  const char* last = first + text.size ();
+  for (std::size_t i = 0; i < 100; ++i)
+    {
+      Matrix4x4<double> m;
+      first = parseText (first, last, m);
+      BOOST_REQUIRE (first);
+      const Matrix4x4<double> expected = pose (i);
+      for (unsigned int e = 0; e < 16; ++e)
+	BOOST_CHECK_EQUAL (m.m[e], expected.m[e]);
+    }
+  matrixNxP parsed (2, 3);
+  first = parseText (first, last, parsed);
+  BOOST_REQUIRE (first);
+  BOOST_CHECK_EQUAL (parsed (1, 2), 1. / 6.);
+  Vector3D<float> v;
+  first = parseText (first, last, v);
+  BOOST_REQUIRE (first);
+  BOOST_CHECK_EQUAL (v.m_y, 0.2f);
+  BOOST_CHECK (!parseText (first, last, v));
+}
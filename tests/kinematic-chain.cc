@@ -0,0 +1,133 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include <jrl/mathtools/kinematicchain.hh>
+
+#define BOOST_TEST_MODULE kinematic-chain
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+typedef jrlMathTools::Matrix4x4<double> matrix_t;
+typedef jrlMathTools::KinematicChain<double> chain_t;
+
+// Rotation about z by q followed by a translation along x.
+static matrix_t joint (double q)
+{
+  const double c = std::cos (q);
+  const double s = std::sin (q);
+  return matrix_t (c, -s, 0., 0.5,
+		   s, c, 0., 0.,
+		   0., 0., 1., 0.1,
+		   0., 0., 0., 1.);
+}
+
+static void checkClose (const matrix_t& a, const matrix_t& b)
+{
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_SMALL (a.m[i] - b.m[i], 1e-12);
+}
+
+// World transformations from scratch.
+static matrix_t naiveWorld (const chain_t& chain, std::size_t i)
+{
+  matrix_t M = chain.base ();
+  for (std::size_t k = 0; k <= i; ++k)
+    M = M * chain.local (k);
+  return M;
+}
+
+BOOST_AUTO_TEST_CASE (affineProduct)
+{
+  const matrix_t a = joint (0.3);
+  const matrix_t b = joint (-1.2) * joint (0.7);
+  matrix_t c;
+  a.CeqthismulBAffine (b, c);
+  checkClose (c, a * b);
+}
+
+BOOST_AUTO_TEST_CASE (forwardKinematics)
+{
+  chain_t chain (10);
+  for (std::size_t i = 0; i < chain.size (); ++i)
+    chain.setLocal (i, joint (0.1 * i));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 0u);
+
+  for (std::size_t i = 0; i < chain.size (); ++i)
+    checkClose (chain.world (i), naiveWorld (chain, i));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 10u);
+  checkClose (chain.end (), chain.world (9));
+
+  matrix_t base = joint (2.);
+  base.m[11] = 1.;
+  chain.setBase (base);
+  checkClose (chain.end (), naiveWorld (chain, 9));
+}
+
+BOOST_AUTO_TEST_CASE (incrementalUpdate)
+{
+  chain_t chain;
+  for (std::size_t i = 0; i < 10; ++i)
+    BOOST_CHECK_EQUAL (chain.addLink (joint (0.2 * i)), i);
+  chain.update ();
+  BOOST_CHECK_EQUAL (chain.upToDate (), 10u);
+
+  // Only the suffix starting at the modified link becomes dirty.
+  chain.setLocal (6, joint (1.));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 6u);
+  checkClose (chain.world (5), naiveWorld (chain, 5));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 6u);
+
+  // Queries only update what they need.
+  checkClose (chain.world (7), naiveWorld (chain, 7));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 8u);
+
+  // Batched updates share one pass from the first modified link.
+  chain.setLocal (8, joint (-0.4));
+  chain.setLocal (3, joint (0.9));
+  chain.setLocal (5, joint (0.1));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 3u);
+  const std::vector<matrix_t> locals (2, joint (-0.25));
+  chain.setLocals (1, locals.begin (), locals.end ());
+  BOOST_CHECK_EQUAL (chain.upToDate (), 1u);
+  for (std::size_t i = 0; i < chain.size (); ++i)
+    checkClose (chain.world (i), naiveWorld (chain, i));
+
+  // Appending a link does not invalidate its predecessors.
+  chain.addLink (joint (0.5));
+  BOOST_CHECK_EQUAL (chain.upToDate (), 10u);
+  checkClose (chain.end (), naiveWorld (chain, 10));
+
+  CHECK_BAD_INDEX (chain.world (11));
+  CHECK_BAD_INDEX (chain.setLocal (11, matrix_t ()));
+  BOOST_CHECK_THROW (chain.setLocals (10, locals.begin (), locals.end ()),
+		     std::invalid_argument);
+  BOOST_CHECK_THROW (chain.setLocals (12, locals.begin (), locals.begin ()),
+		     std::invalid_argument);
+  chain.setLocals (11, locals.begin (), locals.begin ());
+
+  // Any forward range will do.
+  const std::list<matrix_t> list (2, joint (0.75));
+  chain.setLocals (9, list.begin (), list.end ());
+  for (std::size_t i = 0; i < chain.size (); ++i)
+    checkClose (chain.world (i), naiveWorld (chain, i));
+  BOOST_CHECK_THROW (chain_t ().end (), std::logic_error);
+}
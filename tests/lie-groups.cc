@@ -0,0 +1,204 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include <jrl/mathtools/liegroups.hh>
+
+#define BOOST_TEST_MODULE lie-groups
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+template <typename T>
+static T tolerance ()
+{
+  return std::is_same<T, float>::value ? T (2e-5) : T (1e-12);
+}
+
+template <typename T>
+static void checkClose (const Vector3D<T>& a, const Vector3D<T>& b)
+{
+  for (unsigned i = 0; i < 3; ++i)
+    BOOST_CHECK_SMALL (a[i] - b[i], tolerance<T> ());
+}
+
+template <typename T>
+static void checkClose (const Matrix3x3<T>& a, const Matrix3x3<T>& b)
+{
+  for (unsigned i = 0; i < 9; ++i)
+    BOOST_CHECK_SMALL (a.m[i] - b.m[i], tolerance<T> ());
+}
+
+template <typename T>
+static void checkClose (const Matrix4x4<T>& a, const Matrix4x4<T>& b)
+{
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_SMALL (a.m[i] - b.m[i], tolerance<T> ());
+}
+
+// Rodrigues' formula, with the trigonometric functions of the
+// standard library.
+template <typename T>
+static Matrix3x3<T> rodrigues (const Vector3D<T>& w)
+{
+  const T theta = w.norm ();
+  if (theta == T ())
+    return Matrix3x3<T> (1, 0, 0, 0, 1, 0, 0, 0, 1);
+  const T x = w.m_x / theta;
+  const T y = w.m_y / theta;
+  const T z = w.m_z / theta;
+  const T c = std::cos (theta);
+  const T s = std::sin (theta);
+  const T k = 1 - c;
+  return Matrix3x3<T> (c + k * x * x, k * x * y - s * z, k * x * z + s * y,
+		       k * x * y + s * z, c + k * y * y, k * y * z - s * x,
+		       k * x * z - s * y, k * y * z + s * x, c + k * z * z);
+}
+
+// Rotation vectors covering the Taylor expansions, their threshold,
+// and angles up to a few turns.
+template <typename T>
+static std::vector<Vector3D<T> > samples ()
+{
+  static const T angles[] =
+    {T (0), T (1e-9), T (1e-5), T (2e-3), T (8e-3), T (0.1), T (1), T (3),
+     T (M_PI), T (10)};
+  std::vector<Vector3D<T> > result;
+  for (unsigned i = 0; i < sizeof (angles) / sizeof (angles[0]); ++i)
+    {
+      Vector3D<T> axis (std::cos (T (0.7) * i), std::sin (T (1.3) * i),
+			T (0.5) - T (i % 3));
+      axis.normalize ();
+      result.push_back (axis * angles[i]);
+    }
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (exponentialSO3, T, floatingTypes_t)
+{
+  const std::vector<Vector3D<T> > w = samples<T> ();
+  for (std::size_t i = 0; i < w.size (); ++i)
+    checkClose (expSO3 (w[i]), rodrigues (w[i]));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (logarithmSO3, T, floatingTypes_t)
+{
+  const std::vector<Vector3D<T> > w = samples<T> ();
+  for (std::size_t i = 0; i < w.size (); ++i)
+    {
+      const Matrix3x3<T> R = expSO3 (w[i]);
+      if (w[i].norm () < T (3))
+	checkClose (logSO3 (R), w[i]);
+      checkClose (expSO3 (logSO3 (R)), R);
+      BOOST_CHECK (logSO3 (R).norm () <= T (M_PI) + tolerance<T> ());
+    }
+
+  // Half a turn: w and -w give the same rotation.
+  const Vector3D<T> u (0, T (0.6), T (0.8));
+  const Matrix3x3<T> R = expSO3 (u * T (M_PI));
+  const Vector3D<T> l = logSO3 (R);
+  BOOST_CHECK_CLOSE (l.norm (), T (M_PI), T (1e-4));
+  checkClose (expSO3 (l), R);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (exponentialSE3, T, floatingTypes_t)
+{
+  const std::vector<Vector3D<T> > w = samples<T> ();
+  const Vector3D<T> v (T (0.3), T (-1.2), T (0.7));
+  for (std::size_t i = 0; i < w.size (); ++i)
+    {
+      const Matrix4x4<T> M = expSE3 (v, w[i]);
+      const Matrix3x3<T> R = expSO3 (w[i]);
+      for (unsigned r = 0; r < 3; ++r)
+	for (unsigned c = 0; c < 3; ++c)
+	  BOOST_CHECK_SMALL (M.m[4 * r + c] - R.m[3 * r + c], tolerance<T> ());
+      BOOST_CHECK_EQUAL (M.m[12], T (0));
+      BOOST_CHECK_EQUAL (M.m[13], T (0));
+      BOOST_CHECK_EQUAL (M.m[14], T (0));
+      BOOST_CHECK_EQUAL (M.m[15], T (1));
+
+      // Following the twist twice as long.
+      Matrix4x4<T> MM;
+      M.CeqthismulBAffine (M, MM);
+      checkClose (expSE3 (v * T (2), w[i] * T (2)), MM);
+
+      // A screw motion moves along its axis by the linear velocity.
+      if (w[i].norm () > T ())
+	{
+	  const Vector3D<T> axis = w[i] * (T (1.5) / w[i].norm ());
+	  const Matrix4x4<T> S = expSE3 (axis, w[i]);
+	  checkClose (Vector3D<T> (S.m[3], S.m[7], S.m[11]), axis);
+	}
+    }
+
+  // A pure translation.
+  const Matrix4x4<T> P = expSE3 (v, Vector3D<T> (0, 0, 0));
+  checkClose (Vector3D<T> (P.m[3], P.m[7], P.m[11]), v);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (logarithmSE3, T, floatingTypes_t)
+{
+  const std::vector<Vector3D<T> > w = samples<T> ();
+  const Vector3D<T> v (T (0.3), T (-1.2), T (0.7));
+  for (std::size_t i = 0; i < w.size (); ++i)
+    {
+      if (w[i].norm () >= T (3))
+	continue;
+      Vector3D<T> lv, lw;
+      logSE3 (expSE3 (v, w[i]), lv, lw);
+      checkClose (lv, v);
+      checkClose (lw, w[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (batches, T, floatingTypes_t)
+{
+  // Eleven twists: two full vectors and a remainder, mixing small and
+  // large angles within a vector.
+  std::vector<Vector3D<T> > w = samples<T> ();
+  w.push_back (Vector3D<T> (T (1e-4), 0, 0));
+  std::vector<Vector3D<T> > v;
+  for (std::size_t i = 0; i < w.size (); ++i)
+    v.push_back (Vector3D<T> (T (0.1) * i, T (1), -T (0.2) * i));
+  const std::size_t n = w.size ();
+
+  std::vector<Matrix3x3<T> > R (n);
+  std::vector<Matrix4x4<T> > M (n);
+  expSO3 (&w[0], &R[0], n);
+  expSE3 (&v[0], &w[0], &M[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      checkClose (R[i], expSO3 (w[i]));
+      checkClose (M[i], expSE3 (v[i], w[i]));
+    }
+
+  std::vector<Vector3D<T> > lw (n), lv (n), lw2 (n);
+  logSO3 (&R[0], &lw[0], n);
+  logSE3 (&M[0], &lv[0], &lw2[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      checkClose (lw[i], logSO3 (R[i]));
+      checkClose (lw2[i], lw[i]);
+    }
+}
@@ -22,6 +22,8 @@
 #include <boost/test/output_test_stream.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <type_traits>
+
 #include "common.hh"
 
 using boost::test_tools::output_test_stream;
@@ -35,10 +37,49 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
 
   for (unsigned i = 0; i < 9; ++i)
     BOOST_CHECK_EQUAL (m[i], T ());
-  BOOST_CHECK_THROW (m[9], std::logic_error);
+  CHECK_BAD_INDEX (m[9]);
 
   for (unsigned i = 0; i < 3; ++i)
     for (unsigned j = 0; j < 3; ++j)
       BOOST_CHECK_EQUAL (m (i, j), T ());
-  BOOST_CHECK_THROW (m (3, 3), std::logic_error);
+  CHECK_BAD_INDEX (m (3, 3));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (display, T, testTypes_t)
+{
+  jrlMathTools::Matrix3x3<T> m;
+  for (unsigned i = 0; i < 9; ++i)
+    m[i] = T (int (i));
+
+  output_test_stream output;
+
+  output << m;
+  BOOST_CHECK (output.is_equal ("0 1 2 \n3 4 5 \n6 7 8 \n"));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (triviallyCopyable, T, numericTypes_t)
+{
+  BOOST_CHECK (std::is_trivially_copyable<jrlMathTools::Matrix3x3<T> >::value);
+}
+
+BOOST_AUTO_TEST_CASE (constantExpression)
+{
+  typedef jrlMathTools::Matrix3x3<double> matrix_t;
+
+  constexpr matrix_t a (1., 2., 3.,
+			4., 5., 6.,
+			7., 8., 10.);
+  constexpr matrix_t b (2.);
+  constexpr matrix_t sum = a + b;
+  constexpr matrix_t product = a * a.Transpose ();
+  constexpr double det = a.determinant ();
+
+  static_assert (sum.m[8] == 12., "constexpr addition");
+  static_assert (product.m[0] == 14., "constexpr product");
+  static_assert (det == -3., "constexpr determinant");
+
+  BOOST_CHECK_EQUAL ((a - b).m[4], 3.);
+  BOOST_CHECK_EQUAL ((a * 2.).m[7], 16.);
+  BOOST_CHECK_EQUAL (product.m[5], a.m[3] * a.m[6] + a.m[4] * a.m[7]
+		     + a.m[5] * a.m[8]);
 }
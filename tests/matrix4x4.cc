@@ -22,12 +22,15 @@
 #include <boost/test/output_test_stream.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <type_traits>
+
 #include "common.hh"
 
 using boost::test_tools::output_test_stream;
 
 typedef boost::mpl::list<int, float, double> numericTypes_t;
 typedef boost::mpl::list<int, float, double, MyNumericType> testTypes_t;
+typedef boost::mpl::list<float, double> floatingTypes_t;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
 {
@@ -35,10 +38,113 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
 
   for (unsigned i = 0; i < 16; ++i)
     BOOST_CHECK_EQUAL (m[i], T ());
-  BOOST_CHECK_THROW (m[16], std::logic_error);
+  CHECK_BAD_INDEX (m[16]);
 
   for (unsigned i = 0; i < 4; ++i)
     for (unsigned j = 0; j < 4; ++j)
       BOOST_CHECK_EQUAL (m (i, j), T ());
-  BOOST_CHECK_THROW (m (4, 4), std::logic_error);
+  CHECK_BAD_INDEX (m (4, 4));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (display, T, testTypes_t)
+{
+  jrlMathTools::Matrix4x4<T> m;
+  for (unsigned i = 0; i < 16; ++i)
+    m[i] = T (int (i));
+
+  output_test_stream output;
+
+  output << m;
+  BOOST_CHECK (output.is_equal ("0 1 2 3 \n4 5 6 7 \n8 9 10 11 \n12 13 14 15 \n"));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (triviallyCopyable, T, numericTypes_t)
+{
+  BOOST_CHECK (std::is_trivially_copyable<jrlMathTools::Matrix4x4<T> >::value);
+}
+
+BOOST_AUTO_TEST_CASE (constantExpression)
+{
+  typedef jrlMathTools::Matrix4x4<double> matrix_t;
+
+  // Constant homogeneous transformations.
+  constexpr matrix_t a (0., -1., 0., 1.,
+			1., 0., 0., 2.,
+			0., 0., 1., 3.,
+			0., 0., 0., 1.);
+  constexpr matrix_t b (1., 0., 0., 0.5,
+			0., 1., 0., 0.,
+			0., 0., 1., 0.,
+			0., 0., 0., 1.);
+  constexpr matrix_t ab = a * b;
+  constexpr jrlMathTools::Vector3D<double> p =
+    ab * jrlMathTools::Vector3D<double> (1., 0., 0.);
+
+  static_assert (ab.m[3] == 1., "constexpr product");
+  static_assert (ab.m[7] == 2.5, "constexpr product");
+  static_assert (p.m_x == 1. && p.m_y == 3.5 && p.m_z == 3.,
+		 "constexpr point transformation");
+  static_assert (a.determinant () == 1., "constexpr determinant");
+  static_assert (a.Transpose ().m[4] == -1., "constexpr transposition");
+
+  BOOST_CHECK_EQUAL ((a + b).m[3], 1.5);
+  BOOST_CHECK_EQUAL ((a - b).m[0], -1.);
+  BOOST_CHECK_EQUAL ((a * 2.).m[11], 6.);
+  BOOST_CHECK_EQUAL (ab.trace (), 2.);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (inversion, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Matrix4x4<T> matrix_t;
+
+  const matrix_t a (T (2), T (1), T (0), T (1),
+		    T (1), T (3), T (1), T (0),
+		    T (0), T (1), T (4), T (1),
+		    T (1), T (0), T (1), T (5));
+  matrix_t inv;
+  a.Inversion (inv);
+  const matrix_t id = a * inv;
+  for (unsigned i = 0; i < 4; ++i)
+    for (unsigned j = 0; j < 4; ++j)
+      BOOST_CHECK_SMALL (id (i, j) - (i == j ? T (1) : T ()), T (1e-5));
+
+  // By value, and in place.
+  const matrix_t byValue = a.Inversion ();
+  matrix_t inPlace = a;
+  inPlace.Inversion (inPlace);
+  for (unsigned i = 0; i < 16; ++i)
+    {
+      BOOST_CHECK_EQUAL (byValue.m[i], inv.m[i]);
+      BOOST_CHECK_EQUAL (inPlace.m[i], inv.m[i]);
+    }
+
+  // The determinant is a by-product of the inversion.
+  T det;
+  BOOST_CHECK (a.Inversion (inPlace, det));
+  BOOST_CHECK_CLOSE (det, a.determinant (), T (1e-4));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (singularInversion, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Matrix4x4<T> matrix_t;
+
+  // Third row is the sum of the first two.
+  const matrix_t s (T (1), T (2), T (3), T (4),
+		    T (0), T (1), T (0), T (1),
+		    T (1), T (3), T (3), T (5),
+		    T (2), T (0), T (1), T (1));
+  matrix_t inv (T (7));
+  T det;
+  BOOST_CHECK (! s.Inversion (inv, det));
+  BOOST_CHECK_EQUAL (det, T ());
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_EQUAL (inv.m[i], T (7));
+
+  // A custom threshold rejects nearly singular matrices.
+  matrix_t d;
+  for (unsigned i = 0; i < 4; ++i)
+    d (i, i) = T (1e-2);
+  BOOST_CHECK (d.Inversion (inv, det));
+  BOOST_CHECK (! d.Inversion (inv, det, T (1e-6)));
+  BOOST_CHECK_SMALL (det - T (1e-8), T (1e-10));
 }
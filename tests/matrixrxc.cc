@@ -0,0 +1,203 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <jrl/mathtools/matrixrxc.hh>
+
+#define BOOST_TEST_MODULE matrixrxc
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/output_test_stream.hpp>
+#include <boost/mpl/list.hpp>
+
+#include <type_traits>
+
+#include "common.hh"
+
+using boost::test_tools::output_test_stream;
+
+typedef boost::mpl::list<int, float, double> numericTypes_t;
+typedef boost::mpl::list<int, float, double, MyNumericType> testTypes_t;
+
+typedef jrlMathTools::MatrixRxC<double, 2, 3> matrix2x3_t;
+typedef jrlMathTools::MatrixRxC<double, 3, 2> matrix3x2_t;
+typedef jrlMathTools::MatrixRxC<double, 6, 6> matrix6x6_t;
+typedef jrlMathTools::MatrixRxC<double, 6, 2> matrix6x2_t;
+
+// Symmetric positive definite 6x6 matrix.
+static matrix6x6_t spd6x6 ()
+{
+  matrix6x6_t A;
+  for (unsigned i = 0; i < 6; ++i)
+    for (unsigned j = 0; j < 6; ++j)
+      A (i, j) = 1. / (1. + i + j);
+  for (unsigned i = 0; i < 6; ++i)
+    A (i, i) += 6.;
+  return A;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
+{
+  jrlMathTools::MatrixRxC<T, 2, 5> m;
+
+  for (unsigned i = 0; i < 10; ++i)
+    BOOST_CHECK_EQUAL (m[i], T ());
+  CHECK_BAD_INDEX (m[10]);
+
+  for (unsigned i = 0; i < 2; ++i)
+    for (unsigned j = 0; j < 5; ++j)
+      BOOST_CHECK_EQUAL (m (i, j), T ());
+  CHECK_BAD_INDEX (m (2, 0));
+  CHECK_BAD_INDEX (m (0, 5));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (triviallyCopyable, T, numericTypes_t)
+{
+  typedef jrlMathTools::MatrixRxC<T, 6, 6> matrix_t;
+  BOOST_CHECK (std::is_trivially_copyable<matrix_t>::value);
+  BOOST_CHECK_EQUAL (sizeof (matrix_t), 36 * sizeof (T));
+}
+
+BOOST_AUTO_TEST_CASE (display)
+{
+  const double data[] = {1., 2., 3., 4., 5., 6.};
+  matrix2x3_t m (data);
+
+  output_test_stream output;
+
+  output << m;
+  BOOST_CHECK (output.is_equal ("1 2 3 \n4 5 6 \n"));
+}
+
+BOOST_AUTO_TEST_CASE (arithmetic)
+{
+  const double data[] = {1., 2., 3., 4., 5., 6.};
+  matrix2x3_t a (data);
+  matrix2x3_t b (2.);
+
+  BOOST_CHECK_EQUAL ((a + b) (1, 2), 8.);
+  BOOST_CHECK_EQUAL ((a - b) (0, 0), -1.);
+  BOOST_CHECK_EQUAL ((a * 3.) (1, 0), 12.);
+
+  a += b;
+  BOOST_CHECK_EQUAL (a (0, 1), 4.);
+  a -= b;
+  BOOST_CHECK_EQUAL (a (0, 1), 2.);
+  a *= 2.;
+  BOOST_CHECK_EQUAL (a (0, 1), 4.);
+  BOOST_CHECK (a != matrix2x3_t (data));
+}
+
+BOOST_AUTO_TEST_CASE (product)
+{
+  const double data[] = {1., 2., 3., 4., 5., 6.};
+  matrix2x3_t a (data);
+  matrix3x2_t at = a.Transpose ();
+
+  BOOST_CHECK_EQUAL (at (2, 1), 6.);
+  BOOST_CHECK_EQUAL (at (1, 0), 2.);
+
+  jrlMathTools::MatrixRxC<double, 2, 2> aat = a * at;
+  BOOST_CHECK_EQUAL (aat (0, 0), 14.);
+  BOOST_CHECK_EQUAL (aat (0, 1), 32.);
+  BOOST_CHECK_EQUAL (aat (1, 0), 32.);
+  BOOST_CHECK_EQUAL (aat (1, 1), 77.);
+  BOOST_CHECK_EQUAL (aat.trace (), 91.);
+
+  jrlMathTools::MatrixRxC<double, 3, 3> ata = at * a;
+  BOOST_CHECK_EQUAL (ata (2, 2), 45.);
+}
+
+BOOST_AUTO_TEST_CASE (matrix3x3Interoperability)
+{
+  jrlMathTools::Matrix3x3<double> m3 (1., 2., 3.,
+				      4., 5., 6.,
+				      7., 8., 10.);
+  jrlMathTools::MatrixRxC<double, 3, 3> m (m3);
+
+  for (unsigned i = 0; i < 9; ++i)
+    BOOST_CHECK_EQUAL (m[i], m3[i]);
+
+  jrlMathTools::Matrix3x3<double> p3 = (m * m).toMatrix3x3 ();
+  jrlMathTools::Matrix3x3<double> pref = m3 * m3;
+  for (unsigned i = 0; i < 9; ++i)
+    BOOST_CHECK_EQUAL (p3[i], pref[i]);
+}
+
+BOOST_AUTO_TEST_CASE (matrix4x4Interoperability)
+{
+  jrlMathTools::Matrix4x4<double> m4;
+  for (unsigned i = 0; i < 16; ++i)
+    m4[i] = i * i + 1.;
+  jrlMathTools::MatrixRxC<double, 4, 4> m (m4);
+
+  jrlMathTools::Matrix4x4<double> t4 = m.Transpose ().toMatrix4x4 ();
+  jrlMathTools::Matrix4x4<double> tref = m4.Transpose ();
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_EQUAL (t4[i], tref[i]);
+}
+
+BOOST_AUTO_TEST_CASE (luSolve)
+{
+  matrix6x6_t A = spd6x6 ();
+  // Make it non symmetric and require pivoting.
+  A (0, 0) = 0.;
+  A (5, 0) = 3.;
+
+  matrix6x2_t X;
+  for (unsigned i = 0; i < 12; ++i)
+    X[i] = i - 5.;
+  matrix6x2_t B = A * X;
+
+  matrix6x2_t Y;
+  BOOST_CHECK (A.luSolve (B, Y));
+  for (unsigned i = 0; i < 12; ++i)
+    BOOST_CHECK_SMALL (Y[i] - X[i], 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (choleskySolve)
+{
+  matrix6x6_t A = spd6x6 ();
+
+  matrix6x2_t X;
+  for (unsigned i = 0; i < 12; ++i)
+    X[i] = 0.5 * i;
+  matrix6x2_t B = A * X;
+
+  matrix6x2_t Y;
+  BOOST_CHECK (A.choleskySolve (B, Y));
+  for (unsigned i = 0; i < 12; ++i)
+    BOOST_CHECK_SMALL (Y[i] - X[i], 1e-12);
+
+  A (3, 3) = -1.;
+  BOOST_CHECK (! A.choleskySolve (B, Y));
+}
+
+BOOST_AUTO_TEST_CASE (inversion)
+{
+  matrix6x6_t A = spd6x6 ();
+  A (1, 4) = 2.;
+
+  matrix6x6_t Ainv;
+  BOOST_CHECK (A.Inversion (Ainv));
+
+  matrix6x6_t I = A * Ainv;
+  for (unsigned i = 0; i < 6; ++i)
+    for (unsigned j = 0; j < 6; ++j)
+      BOOST_CHECK_SMALL (I (i, j) - (i == j ? 1. : 0.), 1e-12);
+
+  matrix6x6_t S;
+  BOOST_CHECK (! S.Inversion (Ainv));
+}
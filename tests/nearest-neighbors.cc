@@ -0,0 +1,139 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <jrl/mathtools/nearestneighbors.hh>
+
+#define BOOST_TEST_MODULE nearest-neighbors
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using jrlMathTools::Angle;
+using jrlMathTools::KdTree;
+
+typedef KdTree<3> tree_t;
+
+static const bool circular[] = {false, false, true};
+static const double weights[] = {1., 2., 0.5};
+
+// SE(2) configurations, many of them with headings close to PI.
+static std::vector<double> configurations (std::size_t n, double phase)
+{
+  std::vector<double> result (3 * n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const double t = static_cast<double> (i) + phase;
+      result[3 * i] = std::sin (1.3 * t);
+      result[3 * i + 1] = std::sin (0.7 * t);
+      result[3 * i + 2] = i % 3 ? 3.1 + 0.2 * std::sin (2.9 * t)
+	: 7. * std::sin (0.4 * t);
+    }
+  return result;
+}
+
+// Distances from query to all the points, sorted.
+static std::vector<std::pair<double, std::size_t> >
+bruteForce (const tree_t& tree, const double* query)
+{
+  std::vector<std::pair<double, std::size_t> > result (tree.size ());
+  for (std::size_t i = 0; i < tree.size (); ++i)
+    result[i] = std::make_pair (tree.distance (query, tree.point (i)), i);
+  std::sort (result.begin (), result.end ());
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE (metric)
+{
+  const tree_t tree (circular, weights);
+  const double a[] = {0., 0., 3.};
+  const double b[] = {1., 1., -3.};
+  const double d = 2. * M_PI - 6.;
+  BOOST_CHECK_CLOSE (tree.distance (a, b),
+		     std::sqrt (1. + 4. + 0.25 * d * d), 1e-12);
+  BOOST_CHECK_SMALL (tree.distance (a, a), 1e-15);
+
+  std::size_t id;
+  double distance;
+  BOOST_CHECK_EQUAL (tree.nearest (a, 1, &id, &distance), 0u);
+  CHECK_BAD_INDEX (tree.point (0));
+}
+
+BOOST_AUTO_TEST_CASE (nearest)
+{
+  const std::size_t n = 2000;
+  const std::vector<double> points = configurations (n, 0.);
+  const std::vector<double> queries = configurations (50, 0.5);
+
+  // One by one, then by batches of growing sizes.
+  tree_t tree (circular, weights);
+  std::size_t i = 0;
+  for (; i < 100; ++i)
+    tree.insert (&points[3 * i]);
+  for (std::size_t batch = 1; i < n; batch *= 3)
+    {
+      const std::size_t m = std::min (batch, n - i);
+      tree.insert (&points[3 * i], m);
+      i += m;
+    }
+  BOOST_CHECK_EQUAL (tree.size (), n);
+  for (std::size_t j = 0; j < n; ++j)
+    BOOST_CHECK_EQUAL (tree.point (j)[2], Angle (points[3 * j + 2]).value ());
+
+  static const std::size_t ks[] = {1, 5, 40};
+  for (std::size_t q = 0; q < 50; ++q)
+    {
+      const double* query = &queries[3 * q];
+      const std::vector<std::pair<double, std::size_t> > expected =
+	bruteForce (tree, query);
+      for (unsigned j = 0; j < 3; ++j)
+	{
+	  std::vector<std::size_t> ids (ks[j]);
+	  std::vector<double> distances (ks[j]);
+	  BOOST_CHECK_EQUAL (tree.nearest (query, ks[j], &ids[0],
+					   &distances[0]), ks[j]);
+	  for (std::size_t l = 0; l < ks[j]; ++l)
+	    {
+	      BOOST_CHECK_SMALL (distances[l] - expected[l].first, 1e-12);
+	      BOOST_CHECK_SMALL (tree.distance (query, tree.point (ids[l]))
+				 - distances[l], 1e-12);
+	    }
+	}
+
+      // A radius away from the points, against the rounding errors.
+      const double radius = .5 * (expected[30].first + expected[31].first);
+      std::vector<std::size_t> ids;
+      std::vector<double> distances;
+      tree.radius (query, radius, ids, distances);
+      BOOST_CHECK_EQUAL (ids.size (), 31u);
+      BOOST_CHECK_EQUAL (distances.size (), 31u);
+      for (std::size_t l = 0; l < ids.size (); ++l)
+	BOOST_CHECK (distances[l] <= radius);
+    }
+
+  // More neighbours than points.
+  tree_t small (circular, weights);
+  small.insert (&points[0], 3);
+  std::size_t ids[5];
+  double distances[5];
+  BOOST_CHECK_EQUAL (small.nearest (&queries[0], 5, ids, distances), 3u);
+  BOOST_CHECK (distances[0] <= distances[1] && distances[1] <= distances[2]);
+  BOOST_CHECK_EQUAL (small.nearest (&queries[0], 0, ids, distances), 0u);
+  small.clear ();
+  BOOST_CHECK_EQUAL (small.size (), 0u);
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vector>
+
+#include <jrl/mathtools/pointcloud.hh>
+
+#define BOOST_TEST_MODULE pointcloud
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+// Sizes around the vector width, and a buffer large enough to be
+// split between several threads.
+static const std::size_t sizes[] = {0, 1, 3, 4, 5, 7, 8, 1001, 100003};
+
+template <typename T>
+static jrlMathTools::Matrix4x4<T> transformation ()
+{
+  return jrlMathTools::Matrix4x4<T> (T (0.36), T (0.48), T (-0.8), T (1.5),
+				     T (-0.8), T (0.6), T (0), T (-2),
+				     T (0.48), T (0.64), T (0.6), T (0.25),
+				     T (0), T (0), T (0), T (1));
+}
+
+template <typename T>
+static std::vector<jrlMathTools::Vector3D<T> > points (std::size_t n)
+{
+  std::vector<jrlMathTools::Vector3D<T> > p (n);
+  for (std::size_t i = 0; i < n; ++i)
+    p[i] = jrlMathTools::Vector3D<T> (T (i % 17) - T (8),
+				      T (i % 13) * T (0.5),
+				      T (1) - T (i % 7));
+  return p;
+}
+
+template <typename T>
+static void checkClose (const jrlMathTools::Vector3D<T>& a,
+			const jrlMathTools::Vector3D<T>& b)
+{
+  BOOST_CHECK_SMALL (a.m_x - b.m_x, T (1e-5));
+  BOOST_CHECK_SMALL (a.m_y - b.m_y, T (1e-5));
+  BOOST_CHECK_SMALL (a.m_z - b.m_z, T (1e-5));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (arrayOfStructures, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Vector3D<T> vector_t;
+  const jrlMathTools::Matrix4x4<T> M = transformation<T> ();
+
+  for (unsigned threads = 0; threads < 3; ++threads)
+    for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+      {
+	const std::size_t n = sizes[s];
+	const std::vector<vector_t> in = points<T> (n);
+
+	// Out of place, with a sentinel after the output.
+	std::vector<vector_t> out (n + 1, vector_t (T (42), T (42), T (42)));
+	jrlMathTools::transformPoints (M, in.data (), out.data (), n, threads);
+	for (std::size_t i = 0; i < n; ++i)
+	  checkClose (out[i], M * in[i]);
+	BOOST_CHECK_EQUAL (out[n].m_x, T (42));
+
+	// In place.
+	std::vector<vector_t> inPlace = in;
+	jrlMathTools::transformPoints (M, inPlace.data (), n, threads);
+	for (std::size_t i = 0; i < n; ++i)
+	  BOOST_CHECK_EQUAL (inPlace[i], out[i]);
+      }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (structureOfArrays, T, floatingTypes_t)
+{
+  const jrlMathTools::Matrix4x4<T> M = transformation<T> ();
+
+  for (unsigned threads = 0; threads < 3; ++threads)
+    for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+      {
+	const std::size_t n = sizes[s];
+	const std::vector<jrlMathTools::Vector3D<T> > p = points<T> (n);
+	std::vector<T> x (n), y (n), z (n);
+	for (std::size_t i = 0; i < n; ++i)
+	  {
+	    x[i] = p[i].m_x;
+	    y[i] = p[i].m_y;
+	    z[i] = p[i].m_z;
+	  }
+
+	std::vector<T> xo (n), yo (n), zo (n);
+	jrlMathTools::transformPoints (M, x.data (), y.data (), z.data (),
+				       xo.data (), yo.data (), zo.data (),
+				       n, threads);
+	for (std::size_t i = 0; i < n; ++i)
+	  checkClose (jrlMathTools::Vector3D<T> (xo[i], yo[i], zo[i]),
+		      M * p[i]);
+
+	jrlMathTools::transformPoints (M, x.data (), y.data (), z.data (),
+				       n, threads);
+	BOOST_CHECK (x == xo);
+	BOOST_CHECK (y == yo);
+	BOOST_CHECK (z == zo);
+      }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (rigidTransformation, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Vector3D<T> vector_t;
+  const jrlMathTools::Matrix4x4<T> M = transformation<T> ();
+  jrlMathTools::Matrix3x3<T> R;
+  for (unsigned i = 0; i < 3; ++i)
+    for (unsigned j = 0; j < 3; ++j)
+      R (i, j) = M (i, j);
+  const vector_t t (M (0, 3), M (1, 3), M (2, 3));
+
+  const std::size_t n = 1001;
+  const std::vector<vector_t> in = points<T> (n);
+  std::vector<vector_t> expected (n), out (n);
+  jrlMathTools::transformPoints (M, in.data (), expected.data (), n);
+  jrlMathTools::transformPoints (R, t, in.data (), out.data (), n);
+  BOOST_CHECK (out == expected);
+
+  std::vector<T> x (n), y (n), z (n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      x[i] = in[i].m_x;
+      y[i] = in[i].m_y;
+      z[i] = in[i].m_z;
+    }
+  jrlMathTools::transformPoints (R, t, x.data (), y.data (), z.data (), n);
+  for (std::size_t i = 0; i < n; ++i)
+    checkClose (vector_t (x[i], y[i], z[i]), expected[i]);
+}
@@ -13,6 +13,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cmath>
 #include <fstream>
 
 #include <jrl/mathtools/matrixnxp.hh>
@@ -70,3 +71,45 @@ BOOST_AUTO_TEST_CASE (main_test)
     }
   std::cout << result;
 }
+
+// The workspace overloads match the allocating functions, for tall,
+// wide and square matrices, including rank-deficient ones, and reuse
+// one workspace across shapes.
+BOOST_AUTO_TEST_CASE (workspace)
+{
+  static const unsigned shapes[][2] =
+    {{3, 3}, {6, 6}, {3, 30}, {6, 7}, {7, 6}, {30, 3}, {1, 5}, {5, 1}};
+  jrlMathTools::PseudoInverseWorkspace workspace;
+  for (unsigned s = 0; s < sizeof (shapes) / sizeof (shapes[0]); ++s)
+    for (unsigned deficient = 0; deficient < 2; ++deficient)
+      {
+	const unsigned rows = shapes[s][0];
+	const unsigned cols = shapes[s][1];
+	matrixNxP A (rows, cols);
+	for (unsigned i = 0; i < rows; ++i)
+	  for (unsigned j = 0; j < cols; ++j)
+	    A (i, j) = std::sin (static_cast<double> (i * cols + j + 1));
+	// Make the last row a copy of the first one.
+	if (deficient && rows > 1 && cols > 1)
+	  for (unsigned j = 0; j < cols; ++j)
+	    A (rows - 1, j) = A (0, j);
+
+	matrixNxP expected (cols, rows);
+	matrixNxP result;
+	jrlMathTools::pseudoInverse (A, expected, 1e-6);
+	jrlMathTools::pseudoInverse (A, result, workspace, 1e-6);
+	BOOST_REQUIRE_EQUAL (result.size1 (), cols);
+	BOOST_REQUIRE_EQUAL (result.size2 (), rows);
+	for (unsigned i = 0; i < cols; ++i)
+	  for (unsigned j = 0; j < rows; ++j)
+	    BOOST_CHECK_SMALL (result (i, j) - expected (i, j), 1e-10);
+
+	jrlMathTools::dampedInverse (A, expected, 1e-2);
+	jrlMathTools::dampedInverse (A, result, workspace, 1e-2);
+	BOOST_REQUIRE_EQUAL (result.size1 (), cols);
+	BOOST_REQUIRE_EQUAL (result.size2 (), rows);
+	for (unsigned i = 0; i < cols; ++i)
+	  for (unsigned j = 0; j < rows; ++j)
+	    BOOST_CHECK_SMALL (result (i, j) - expected (i, j), 1e-10);
+      }
+}
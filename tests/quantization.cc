@@ -0,0 +1,183 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <jrl/mathtools/quantization.hh>
+#include <jrl/mathtools/random.hh>
+
+#define BOOST_TEST_MODULE quantization
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+// Bound of the rotation angle error of the smallest-three encoding.
+static const double angleTolerance = 5e-6;
+
+// Deterministic samples in [-1, 1].
+static double sample (double k)
+{
+  return std::sin (12.9898 * k);
+}
+
+// Angle between two rotations given by unit quaternions.
+static double angle (const Quaternion<double>& a, const Quaternion<double>& b)
+{
+  double plus = 0., minus = 0.;
+  for (unsigned int k = 0; k < 4; ++k)
+    {
+      plus += (a.data ()[k] + b.data ()[k]) * (a.data ()[k] + b.data ()[k]);
+      minus += (a.data ()[k] - b.data ()[k]) * (a.data ()[k] - b.data ()[k]);
+    }
+  return 4. * std::atan (std::sqrt (std::min (plus, minus)
+				    / std::max (plus, minus)));
+}
+
+BOOST_AUTO_TEST_CASE (vectors)
+{
+  const Vector3Quantizer quantizer (Vector3D<double> (-5., -2., 0.),
+				    Vector3D<double> (5., 2., 1.));
+  const Vector3D<double> error = quantizer.maxError ();
+  BOOST_CHECK_CLOSE (error.m_x, 5. / 65535., 1e-10);
+
+  const std::size_t n = 1003;
+  std::vector<Vector3D<double> > in (n), out (n);
+  std::vector<QuantizedVector3D> quantized (n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const double k = static_cast<double> (i);
+      in[i] = Vector3D<double> (5. * sample (k), 2. * sample (k + .25),
+				.5 + .5 * sample (k + .5));
+    }
+  encodeVectors (quantizer, &in[0], &quantized[0], quantized.size ());
+  decodeVectors (quantizer, &quantized[0], &out[0], out.size ());
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const QuantizedVector3D one = quantizer.encode (in[i]);
+      BOOST_CHECK_EQUAL (one.m_x, quantized[i].m_x);
+      BOOST_CHECK_EQUAL (one.m_y, quantized[i].m_y);
+      BOOST_CHECK_EQUAL (one.m_z, quantized[i].m_z);
+      BOOST_CHECK_SMALL (quantizer.decode (one).m_y - out[i].m_y, 1e-14);
+      BOOST_CHECK (std::abs (out[i].m_x - in[i].m_x) <= error.m_x * 1.0001);
+      BOOST_CHECK (std::abs (out[i].m_y - in[i].m_y) <= error.m_y * 1.0001);
+      BOOST_CHECK (std::abs (out[i].m_z - in[i].m_z) <= error.m_z * 1.0001);
+    }
+
+  // Points out of the box are clamped, corners are exact.
+  const QuantizedVector3D outside =
+    quantizer.encode (Vector3D<double> (-6., 3., 1.));
+  BOOST_CHECK_EQUAL (outside.m_x, 0);
+  BOOST_CHECK_EQUAL (outside.m_y, 65535);
+  BOOST_CHECK_EQUAL (outside.m_z, 65535);
+  BOOST_CHECK_EQUAL (quantizer.decode (outside).m_x, -5.);
+
+  BOOST_CHECK_THROW (Vector3Quantizer (Vector3D<double> (0., 0., 0.),
+				       Vector3D<double> (1., 0., 1.)),
+		     std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE (rotations)
+{
+  // Special rotations: identity, half turns, largest coefficient ties.
+  const double h = M_SQRT1_2;
+  const Quaternion<double> special[] =
+    {Quaternion<double> (0., 0., 0., 1.), Quaternion<double> (1., 0., 0., 0.),
+     Quaternion<double> (0., -1., 0., 0.), Quaternion<double> (0., 0., 1., 0.),
+     Quaternion<double> (h, -h, 0., 0.), Quaternion<double> (.5, .5, .5, -.5),
+     Quaternion<double> (0., h, 0., -h)};
+  for (std::size_t i = 0; i < sizeof (special) / sizeof (special[0]); ++i)
+    {
+      const Quaternion<double> q = decodeRotation (encodeRotation (special[i]));
+      BOOST_CHECK_SMALL (angle (q, special[i]), angleTolerance);
+      BOOST_CHECK_CLOSE (q.norm (), 1., 1e-12);
+    }
+
+  const std::size_t n = 4000;
+  std::vector<Quaternion<double> > quaternions (n);
+  RandomStream random (1);
+  randomQuaternions (random, &quaternions[0], n);
+  double largest = 0.;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const Quaternion<double> q =
+	decodeRotation (encodeRotation (quaternions[i]));
+      largest = std::max (largest, angle (q, quaternions[i]));
+    }
+  BOOST_CHECK_SMALL (largest, angleTolerance);
+  BOOST_CHECK (largest > 1e-7);
+}
+
+BOOST_AUTO_TEST_CASE (poses)
+{
+  const Vector3Quantizer quantizer (Vector3D<double> (-10., -10., -1.),
+				    Vector3D<double> (10., 10., 3.));
+  const std::size_t n = 1003;
+  std::vector<Quaternion<double> > rotations (n);
+  RandomStream random (2);
+  randomQuaternions (random, &rotations[0], n);
+  // Half turns and the identity, whose encodings have a zero
+  // coefficient.
+  rotations[0] = Quaternion<double> (0., 0., 0., 1.);
+  rotations[1] = Quaternion<double> (0., 0., 1., 0.);
+  rotations[6] = Quaternion<double> (M_SQRT1_2, 0., -M_SQRT1_2, 0.);
+
+  std::vector<Matrix4x4<double> > in (n), out (n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const Matrix3x3<double> r = rotations[i].toRotationMatrix ();
+      const double k = static_cast<double> (i);
+      const double t[3] =
+	{10. * sample (k), 10. * sample (k + .25), 1. + 2. * sample (k + .5)};
+      for (unsigned int row = 0; row < 3; ++row)
+	{
+	  for (unsigned int col = 0; col < 3; ++col)
+	    in[i].m[4 * row + col] = r.m[3 * row + col];
+	  in[i].m[4 * row + 3] = t[row];
+	}
+      in[i].m[12] = in[i].m[13] = in[i].m[14] = 0.;
+      in[i].m[15] = 1.;
+    }
+
+  std::vector<QuantizedPose> quantized (n);
+  encodePoses (quantizer, &in[0], &quantized[0], quantized.size ());
+  decodePoses (quantizer, &quantized[0], &out[0], out.size ());
+  const Vector3D<double> error = quantizer.maxError ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      // Same rotation as the quaternion encoding.
+      const Quaternion<double> q = decodeRotation (quantized[i].m_rotation);
+      BOOST_CHECK_SMALL (angle (q, rotations[i]), angleTolerance);
+
+      Matrix3x3<double> r;
+      for (unsigned int row = 0; row < 3; ++row)
+	for (unsigned int col = 0; col < 3; ++col)
+	  r.m[3 * row + col] = out[i].m[4 * row + col];
+      const Matrix3x3<double> expected = q.toRotationMatrix ();
+      for (unsigned int k = 0; k < 9; ++k)
+	BOOST_CHECK_SMALL (r.m[k] - expected.m[k], 1e-14);
+      BOOST_CHECK_CLOSE (r.determinant (), 1., 1e-10);
+
+      BOOST_CHECK (std::abs (out[i].m[3] - in[i].m[3]) <= error.m_x * 1.0001);
+      BOOST_CHECK (std::abs (out[i].m[7] - in[i].m[7]) <= error.m_y * 1.0001);
+      BOOST_CHECK (std::abs (out[i].m[11] - in[i].m[11])
+		   <= error.m_z * 1.0001);
+      for (unsigned int k = 12; k < 16; ++k)
+	BOOST_CHECK_EQUAL (out[i].m[k], in[i].m[k]);
+    }
+}
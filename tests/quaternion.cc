@@ -0,0 +1,213 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include <jrl/mathtools/quaternion.hh>
+
+#define BOOST_TEST_MODULE quaternion
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using boost::test_tools::output_test_stream;
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+template <typename T>
+static T tolerance ()
+{
+  return std::is_same<T, float>::value ? T (1e-5) : T (1e-12);
+}
+
+template <typename T>
+static void checkClose (const jrlMathTools::Quaternion<T>& a,
+			const jrlMathTools::Quaternion<T>& b)
+{
+  for (unsigned i = 0; i < 4; ++i)
+    BOOST_CHECK_SMALL (a[i] - b[i], tolerance<T> ());
+}
+
+// q and -q represent the same rotation.
+template <typename T>
+static void checkSameRotation (const jrlMathTools::Quaternion<T>& a,
+			       const jrlMathTools::Quaternion<T>& b)
+{
+  checkClose (a, a.dot (b) < 0 ? -b : b);
+}
+
+template <typename T>
+static void checkClose (const jrlMathTools::Vector3D<T>& a,
+			const jrlMathTools::Vector3D<T>& b)
+{
+  for (unsigned i = 0; i < 3; ++i)
+    BOOST_CHECK_SMALL (a[i] - b[i], tolerance<T> ());
+}
+
+template <typename T>
+static jrlMathTools::Vector3D<T> product (const jrlMathTools::Matrix3x3<T>& R,
+					  const jrlMathTools::Vector3D<T>& v)
+{
+  return jrlMathTools::Vector3D<T>
+    (R.m[0] * v.m_x + R.m[1] * v.m_y + R.m[2] * v.m_z,
+     R.m[3] * v.m_x + R.m[4] * v.m_y + R.m[5] * v.m_z,
+     R.m[6] * v.m_x + R.m[7] * v.m_y + R.m[8] * v.m_z);
+}
+
+// Deterministic unit quaternion, with a positive real part.
+template <typename T>
+static jrlMathTools::Quaternion<T> sample (unsigned i)
+{
+  jrlMathTools::Vector3D<T> axis (std::cos (T (0.7) * i),
+				  std::sin (T (1.3) * i),
+				  T (0.5) - T (i % 3));
+  axis.normalize ();
+  return jrlMathTools::Quaternion<T>::fromAxisAngle
+    (axis, T (0.01) + T (0.37) * T (i % 8));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (basics, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Quaternion<T> quaternion_t;
+
+  BOOST_CHECK (std::is_trivially_copyable<quaternion_t>::value);
+  constexpr quaternion_t identity;
+  static_assert (identity.m_w == 1 && identity.m_x == 0,
+		 "constexpr identity");
+
+  const quaternion_t q (T (1), T (2), T (3), T (4));
+  BOOST_CHECK_EQUAL (q[0], T (1));
+  BOOST_CHECK_EQUAL (q[3], T (4));
+  CHECK_BAD_INDEX (q[4]);
+  BOOST_CHECK (quaternion_t (q.toVector4D ()) == q);
+  BOOST_CHECK_EQUAL (q.normsquared (), T (30));
+  BOOST_CHECK_CLOSE (q.normalized ().norm (), T (1), T (1e-4));
+  checkClose (q * q.inverse (), identity);
+  BOOST_CHECK (q.conjugate () == quaternion_t (T (-1), T (-2), T (-3), T (4)));
+
+  output_test_stream stream;
+  stream << q;
+  BOOST_CHECK (stream.is_equal ("1 2 3 4"));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (rotations, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Quaternion<T> quaternion_t;
+  typedef jrlMathTools::Vector3D<T> vector_t;
+
+  // Quarter turn about z.
+  const quaternion_t z =
+    quaternion_t::fromAxisAngle (vector_t (T (0), T (0), T (1)),
+				 T (M_PI / 2));
+  checkClose (z * vector_t (T (1), T (0), T (0)),
+	      vector_t (T (0), T (1), T (0)));
+
+  for (unsigned i = 0; i < 16; ++i)
+    {
+      const quaternion_t p = sample<T> (i);
+      const quaternion_t q = sample<T> (i + 5);
+      const vector_t v (T (0.3), T (-1.2), T (2));
+
+      // Rotation of vectors, against the rotation matrix.
+      const jrlMathTools::Matrix3x3<T> R = q.toRotationMatrix ();
+      checkClose (q * v, product (R, v));
+
+      // Round trip through the rotation matrix.
+      checkSameRotation (quaternion_t (R), q);
+
+      // Composition applies the right-hand side first.
+      checkClose ((p * q) * v, p * (q * v));
+      checkSameRotation (quaternion_t (p.toRotationMatrix () * R), p * q);
+    }
+
+  // Rotations by pi take every branch of the matrix conversion.
+  for (unsigned k = 0; k < 3; ++k)
+    {
+      vector_t axis;
+      axis[k] = T (1);
+      const quaternion_t q = quaternion_t::fromAxisAngle (axis, T (M_PI));
+      const quaternion_t r (q.toRotationMatrix ());
+      checkSameRotation (r, q);
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (interpolation, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Quaternion<T> quaternion_t;
+  typedef jrlMathTools::Vector3D<T> vector_t;
+
+  const vector_t axis (T (0), T (0.6), T (0.8));
+  const quaternion_t a = quaternion_t::fromAxisAngle (axis, T (0.2));
+  const quaternion_t b = quaternion_t::fromAxisAngle (axis, T (1.4));
+
+  // Constant angular velocity about a common axis.
+  for (unsigned i = 0; i <= 10; ++i)
+    {
+      const T t = T (i) / 10;
+      checkClose (jrlMathTools::slerp (a, b, t),
+		  quaternion_t::fromAxisAngle (axis, T (0.2) + T (1.2) * t));
+    }
+  checkClose (jrlMathTools::slerp (a, a, T (0.3)), a);
+
+  // Shortest path: -b is the same rotation as b.
+  checkClose (jrlMathTools::slerp (a, -b, T (0.5)),
+	      jrlMathTools::slerp (a, b, T (0.5)));
+  checkClose (jrlMathTools::nlerp (a, -b, T (0.5)),
+	      jrlMathTools::nlerp (a, b, T (0.5)));
+
+  // nlerp has the same end points and mid point.
+  checkClose (jrlMathTools::nlerp (a, b, T (0)), a);
+  checkClose (jrlMathTools::nlerp (a, b, T (1)), b);
+  checkClose (jrlMathTools::nlerp (a, b, T (0.5)),
+	      jrlMathTools::slerp (a, b, T (0.5)));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (batchedInterpolation, T, floatingTypes_t)
+{
+  typedef jrlMathTools::Quaternion<T> quaternion_t;
+
+  const std::size_t n = 103;
+  std::vector<quaternion_t> a (n), b (n), out (n);
+  std::vector<T> t (n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      a[i] = sample<T> (static_cast<unsigned> (i));
+      b[i] = sample<T> (static_cast<unsigned> (3 * i + 1));
+      if (i % 5 == 0)
+	b[i] = -b[i];
+      if (i % 7 == 0)
+	b[i] = a[i];
+      t[i] = T (i % 11) / 10;
+    }
+
+  jrlMathTools::slerp (a.data (), b.data (), t.data (), out.data (), n);
+  for (std::size_t i = 0; i < n; ++i)
+    checkClose (out[i], jrlMathTools::slerp (a[i], b[i], t[i]));
+
+  jrlMathTools::nlerp (a.data (), b.data (), t.data (), out.data (), n);
+  for (std::size_t i = 0; i < n; ++i)
+    checkClose (out[i], jrlMathTools::nlerp (a[i], b[i], t[i]));
+
+  // In place.
+  jrlMathTools::slerp (a.data (), b.data (), t.data (), a.data (), n);
+  for (std::size_t i = 0; i < n; ++i)
+    checkClose (a[i], jrlMathTools::slerp (sample<T> (unsigned (i)), b[i],
+					   t[i]));
+}
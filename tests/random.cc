@@ -0,0 +1,166 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <jrl/mathtools/random.hh>
+
+#define BOOST_TEST_MODULE random
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+// Known-answer tests of the reference Random123 implementation.
+BOOST_AUTO_TEST_CASE (philox)
+{
+  const std::uint32_t counters[3][4] =
+    {{0, 0, 0, 0},
+     {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+     {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+  const std::uint32_t keys[3][2] =
+    {{0, 0}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+  const std::uint32_t expected[3][4] =
+    {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+  for (unsigned int t = 0; t < 3; ++t)
+    {
+      std::uint32_t out[4];
+      detail::philox4x32 (counters[t], keys[t], out);
+      for (unsigned int i = 0; i < 4; ++i)
+	BOOST_CHECK_EQUAL (out[i], expected[t][i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (stream)
+{
+  const std::size_t n = 1001;
+  std::vector<double> a (n), b (n), c (n);
+  RandomStream first (42, 0);
+  first.uniform (&a[0], n);
+  BOOST_CHECK_EQUAL (first.position (), (n + 1) / 2);
+
+  // Same seed and stream: same numbers, also after a seek.
+  RandomStream again (42, 0);
+  again.uniform (&b[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    BOOST_CHECK_EQUAL (a[i], b[i]);
+  again.seek (10);
+  BOOST_CHECK_EQUAL (again.uniform (), a[20]);
+
+  // Another stream: other numbers.
+  RandomStream other (42, 1);
+  other.uniform (&c[0], n);
+  std::size_t equal = 0;
+  double mean = 0.;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      BOOST_CHECK (a[i] >= 0. && a[i] < 1.);
+      equal += a[i] == c[i];
+      mean += a[i];
+    }
+  BOOST_CHECK_EQUAL (equal, 0u);
+  BOOST_CHECK_CLOSE (mean / double (n), .5, 5.);
+}
+
+BOOST_AUTO_TEST_CASE (angles)
+{
+  const std::size_t n = 4003;
+  std::vector<double> angles (n);
+  RandomStream random (7);
+  randomAngles (random, &angles[0], n);
+  double c = 0., s = 0.;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      BOOST_CHECK (angles[i] >= -M_PI && angles[i] < M_PI);
+      c += std::cos (angles[i]);
+      s += std::sin (angles[i]);
+    }
+  // The mean resultant length of n uniform angles is about 1/sqrt(n).
+  BOOST_CHECK_SMALL (std::sqrt (c * c + s * s) / double (n), .05);
+}
+
+BOOST_AUTO_TEST_CASE (quaternions)
+{
+  const std::size_t n = 4003;
+  std::vector<double> q (4 * n);
+  RandomStream random (7);
+  randomQuaternions (random, &q[0], n);
+  double mean[4] = {0., 0., 0., 0.};
+  double square[4] = {0., 0., 0., 0.};
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      double norm = 0.;
+      for (unsigned int k = 0; k < 4; ++k)
+	{
+	  const double x = q[k * n + i];
+	  norm += x * x;
+	  mean[k] += x;
+	  square[k] += x * x;
+	}
+      BOOST_CHECK_CLOSE (norm, 1., 1e-12);
+    }
+  // Uniform on the 3-sphere: zero mean, variance 1/4 per coordinate.
+  for (unsigned int k = 0; k < 4; ++k)
+    {
+      BOOST_CHECK_SMALL (mean[k] / double (n), .05);
+      BOOST_CHECK_CLOSE (square[k] / double (n), .25, 10.);
+    }
+
+  // The Quaternion overload samples the same distribution.
+  std::vector<Quaternion<double> > quaternions (n);
+  randomQuaternions (random, &quaternions[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    BOOST_CHECK_CLOSE (quaternions[i].norm (), 1., 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (rotations)
+{
+  const std::size_t n = 1003;
+  std::vector<double> r (9 * n), q (4 * n);
+  RandomStream random (3, 5);
+  randomRotations (random, &r[0], n);
+  random.seek (0);
+  randomQuaternions (random, &q[0], n);
+
+  double trace = 0.;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      Matrix3x3<double> m;
+      for (unsigned int k = 0; k < 9; ++k)
+	m.m[k] = r[k * n + i];
+      const Quaternion<double> quaternion
+	(q[i], q[n + i], q[2 * n + i], q[3 * n + i]);
+      const Matrix3x3<double> expected = quaternion.toRotationMatrix ();
+      for (unsigned int k = 0; k < 9; ++k)
+	BOOST_CHECK_SMALL (m.m[k] - expected.m[k], 1e-14);
+      BOOST_CHECK_CLOSE (m.determinant (), 1., 1e-12);
+      const Matrix3x3<double> identity = m * m.Transpose ();
+      for (unsigned int k = 0; k < 9; ++k)
+	BOOST_CHECK_SMALL (identity.m[k] - (k % 4 == 0 ? 1. : 0.), 1e-14);
+      trace += m.m[0] + m.m[4] + m.m[8];
+    }
+  // The trace of a uniform rotation has mean 0.
+  BOOST_CHECK_SMALL (trace / double (n), .1);
+
+  std::vector<Matrix3x3<double> > rotations (n);
+  randomRotations (random, &rotations[0], n);
+  for (std::size_t i = 0; i < n; ++i)
+    BOOST_CHECK_CLOSE (rotations[i].determinant (), 1., 1e-12);
+}
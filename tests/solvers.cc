@@ -0,0 +1,201 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <jrl/mathtools/decompositions.hh>
+#include <jrl/mathtools/matrix3x3.hh>
+#include <jrl/mathtools/matrix4x4.hh>
+
+#define BOOST_TEST_MODULE solvers
+
+#include <boost/test/unit_test.hpp>
+
+typedef jrlMathTools::MatrixRxC<double, 12, 12> matrix12x12_t;
+typedef jrlMathTools::MatrixRxC<double, 12, 3> matrix12x3_t;
+
+// Symmetric positive definite matrix.
+template <unsigned N>
+jrlMathTools::MatrixRxC<double, N, N> spd ()
+{
+  jrlMathTools::MatrixRxC<double, N, N> A;
+  for (unsigned i = 0; i < N; ++i)
+    for (unsigned j = 0; j < N; ++j)
+      A (i, j) = 1. / (1. + i + j);
+  for (unsigned i = 0; i < N; ++i)
+    A (i, i) += N;
+  return A;
+}
+
+static matrix12x3_t rhs ()
+{
+  matrix12x3_t X;
+  for (unsigned i = 0; i < 36; ++i)
+    X[i] = 0.25 * i - 3.;
+  return X;
+}
+
+BOOST_AUTO_TEST_CASE (lu)
+{
+  matrix12x12_t A = spd<12> ();
+  A (0, 0) = 0.;
+  A (11, 0) = 5.;
+  const matrix12x3_t X = rhs ();
+
+  jrlMathTools::LUDecomposition<double, 12> lu (A);
+  BOOST_CHECK (lu.ok ());
+
+  matrix12x3_t B = A * X;
+  lu.solveInPlace (B);
+  for (unsigned i = 0; i < 36; ++i)
+    BOOST_CHECK_SMALL (B[i] - X[i], 1e-10);
+
+  matrix12x3_t Y = lu.solve (A * X);
+  BOOST_CHECK (Y == B);
+
+  BOOST_CHECK (! lu.compute (matrix12x12_t ()));
+  BOOST_CHECK (! lu.ok ());
+}
+
+BOOST_AUTO_TEST_CASE (luDeterminant)
+{
+  jrlMathTools::Matrix4x4<double> m4;
+  for (unsigned i = 0; i < 16; ++i)
+    m4[i] = (i * 7) % 5 + (i % 4 == i / 4 ? 3. : 0.);
+
+  jrlMathTools::LUDecomposition<double, 4> lu
+    ((jrlMathTools::MatrixRxC<double, 4, 4> (m4)));
+  BOOST_CHECK_CLOSE (lu.determinant (), m4.determinant (), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE (luSingularDeterminant)
+{
+  jrlMathTools::MatrixRxC<double, 4, 4> A;
+  for (unsigned i = 0; i < 4; ++i)
+    for (unsigned j = 0; j < 4; ++j)
+      A (i, j) = double (i + j);
+
+  jrlMathTools::LUDecomposition<double, 4> lu (A);
+  BOOST_CHECK (! lu.ok ());
+  BOOST_CHECK_EQUAL (lu.determinant (), 0.);
+
+  BOOST_CHECK (! lu.compute (jrlMathTools::MatrixRxC<double, 4, 4> ()));
+  BOOST_CHECK_EQUAL (lu.determinant (), 0.);
+}
+
+BOOST_AUTO_TEST_CASE (cholesky)
+{
+  const matrix12x12_t A = spd<12> ();
+  const matrix12x3_t X = rhs ();
+
+  jrlMathTools::CholeskyDecomposition<double, 12> llt (A);
+  BOOST_CHECK (llt.ok ());
+
+  matrix12x3_t B = A * X;
+  llt.solveInPlace (B);
+  for (unsigned i = 0; i < 36; ++i)
+    BOOST_CHECK_SMALL (B[i] - X[i], 1e-10);
+
+  BOOST_CHECK (! llt.compute (A * -1.));
+}
+
+BOOST_AUTO_TEST_CASE (ldlt)
+{
+  // Symmetric indefinite matrix: LDL^T succeeds where Cholesky fails.
+  matrix12x12_t A = spd<12> ();
+  A (4, 4) = -A (4, 4);
+  const matrix12x3_t X = rhs ();
+
+  jrlMathTools::LDLTDecomposition<double, 12> ldlt (A);
+  jrlMathTools::CholeskyDecomposition<double, 12> llt (A);
+  BOOST_CHECK (ldlt.ok ());
+  BOOST_CHECK (! llt.ok ());
+
+  matrix12x3_t B = ldlt.solve (A * X);
+  for (unsigned i = 0; i < 36; ++i)
+    BOOST_CHECK_SMALL (B[i] - X[i], 1e-10);
+
+  jrlMathTools::LUDecomposition<double, 12> lu (A);
+  BOOST_CHECK_CLOSE (ldlt.determinant (), lu.determinant (), 1e-8);
+
+  matrix12x3_t C;
+  BOOST_CHECK (A.ldltSolve (A * X, C));
+  BOOST_CHECK (C == B);
+}
+
+BOOST_AUTO_TEST_CASE (matrix3x3)
+{
+  jrlMathTools::Matrix3x3<double> A (4., 1., 2.,
+				     1., 5., 3.,
+				     2., 3., 6.);
+  jrlMathTools::Vector3D<double> b (1., 2., 3.);
+  jrlMathTools::Matrix3x3<double> Ainv;
+  A.Inversion (Ainv);
+
+  jrlMathTools::Vector3D<double> x[3];
+  BOOST_CHECK (A.luSolve (b, x[0]));
+  BOOST_CHECK (A.choleskySolve (b, x[1]));
+  BOOST_CHECK (A.ldltSolve (b, x[2]));
+  for (unsigned k = 0; k < 3; ++k)
+    for (unsigned i = 0; i < 3; ++i)
+      BOOST_CHECK_SMALL (x[k][i] - (Ainv.m[3 * i] * b[0]
+				    + Ainv.m[3 * i + 1] * b[1]
+				    + Ainv.m[3 * i + 2] * b[2]), 1e-12);
+
+  jrlMathTools::Matrix3x3<double> I;
+  I.setIdentity ();
+  jrlMathTools::Matrix3x3<double> X[3];
+  BOOST_CHECK (A.luSolve (I, X[0]));
+  BOOST_CHECK (A.choleskySolve (I, X[1]));
+  BOOST_CHECK (A.ldltSolve (I, X[2]));
+  for (unsigned k = 0; k < 3; ++k)
+    for (unsigned i = 0; i < 9; ++i)
+      BOOST_CHECK_SMALL (X[k][i] - Ainv[i], 1e-12);
+
+  // Solutions may overwrite the right-hand side.
+  jrlMathTools::Vector3D<double> y (b);
+  BOOST_CHECK (A.luSolve (y, y));
+  BOOST_CHECK (y == x[0]);
+
+  jrlMathTools::Matrix3x3<double> S;
+  BOOST_CHECK (! S.luSolve (b, y));
+  BOOST_CHECK (y == x[0]);
+}
+
+BOOST_AUTO_TEST_CASE (matrix4x4)
+{
+  jrlMathTools::MatrixRxC<double, 4, 4> spd4 = spd<4> ();
+  jrlMathTools::Matrix4x4<double> A = spd4.toMatrix4x4 ();
+  jrlMathTools::Vector4D<double> b (1., 2., 3., 4.);
+  jrlMathTools::Matrix4x4<double> Ainv;
+  A.Inversion (Ainv);
+
+  jrlMathTools::Vector4D<double> bref = Ainv * b;
+  jrlMathTools::Vector4D<double> x[3];
+  BOOST_CHECK (A.luSolve (b, x[0]));
+  BOOST_CHECK (A.choleskySolve (b, x[1]));
+  BOOST_CHECK (A.ldltSolve (b, x[2]));
+  for (unsigned k = 0; k < 3; ++k)
+    for (unsigned i = 0; i < 4; ++i)
+      BOOST_CHECK_SMALL (x[k][i] - bref[i], 1e-12);
+
+  jrlMathTools::Matrix4x4<double> I;
+  I.setIdentity ();
+  jrlMathTools::Matrix4x4<double> X[3];
+  BOOST_CHECK (A.luSolve (I, X[0]));
+  BOOST_CHECK (A.choleskySolve (I, X[1]));
+  BOOST_CHECK (A.ldltSolve (I, X[2]));
+  for (unsigned k = 0; k < 3; ++k)
+    for (unsigned i = 0; i < 16; ++i)
+      BOOST_CHECK_SMALL (X[k][i] - Ainv[i], 1e-12);
+}
@@ -0,0 +1,150 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <jrl/mathtools/trajectorylog.hh>
+
+#define BOOST_TEST_MODULE trajectory_log
+
+#include <boost/test/unit_test.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools;
+
+static Matrix4x4<double> pose (std::size_t i)
+{
+  const double k = static_cast<double> (i);
+  Matrix4x4<double> m;
+  for (unsigned int e = 0; e < 16; ++e)
+    m.m[e] = std::sin (k + 0.1 * e);
+  return m;
+}
+
+BOOST_AUTO_TEST_CASE (layout)
+{
+  TrajectoryLayout layout;
+  BOOST_CHECK_EQUAL (layout.addPose ("base"), 0u);
+  BOOST_CHECK_EQUAL (layout.addPosition ("com"), 1u);
+  BOOST_CHECK_EQUAL (layout.addAngle ("knee"), 2u);
+  BOOST_CHECK_EQUAL (layout.columns (), 21u);
+  BOOST_CHECK_EQUAL (layout.column (1), 17u);
+  BOOST_CHECK_EQUAL (layout.find ("knee"), 2u);
+  BOOST_CHECK_EQUAL (layout.find ("hip"), 3u);
+  BOOST_CHECK_THROW (layout.addAngle ("knee"), std::invalid_argument);
+  BOOST_CHECK_THROW (layout.addAngle ("left knee"), std::invalid_argument);
+
+  const TrajectoryLayout parsed =
+    TrajectoryLayout::fromString (layout.toString ());
+  BOOST_CHECK_EQUAL (parsed.toString (), "pose base\nposition com\n"
+		     "angle knee\n");
+  BOOST_CHECK_EQUAL (parsed.kind (1), TRAJECTORY_POSITION);
+  BOOST_CHECK_EQUAL (parsed.columns (), 21u);
+  BOOST_CHECK_THROW (TrajectoryLayout::fromString ("matrix base\n"),
+		     std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (ring)
+{
+  detail::SampleRing ring (2, 3);
+  BOOST_CHECK_EQUAL (ring.capacity (), 4u);
+  BOOST_CHECK (!ring.front ());
+  for (int i = 0; i < 4; ++i)
+    {
+      double* slot = ring.back ();
+      BOOST_REQUIRE (slot);
+      slot[0] = i;
+      slot[1] = -i;
+      ring.push ();
+    }
+  BOOST_CHECK (!ring.back ());
+  BOOST_CHECK_EQUAL (ring.front ()[1], 0.);
+  ring.pop ();
+  BOOST_CHECK (ring.back ());
+  BOOST_CHECK_EQUAL (ring.front ()[0], 1.);
+}
+
+BOOST_AUTO_TEST_CASE (write_and_read)
+{
+  const char* path = "trajectory-log.bin";
+  TrajectoryLayout layout;
+  const std::size_t base = layout.addPose ("base");
+  const std::size_t com = layout.addPosition ("com");
+  const std::size_t knee = layout.addAngle ("knee");
+
+  const std::size_t n = 2500;
+  {
+    TrajectoryLogWriter writer (path, layout, 256, 4096);
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	const double k = static_cast<double> (i);
+	writer.set (base, pose (i));
+	if (i % 2 == 0)
+	  writer.set (com, Vector3D<double> (k, 2. * k, 3. * k));
+	writer.set (knee, Angle (std::sin (k)));
+	BOOST_CHECK (writer.commit (0.001 * k));
+      }
+    CHECK_BAD_INDEX (writer.set (base, Angle (0.)));
+    writer.close ();
+    BOOST_CHECK_EQUAL (writer.size (), n);
+    BOOST_CHECK_EQUAL (writer.dropped (), 0u);
+  }
+
+  TrajectoryLog log (path);
+  BOOST_CHECK_EQUAL (log.size (), n);
+  BOOST_CHECK_EQUAL (log.chunkSize (), 256u);
+  BOOST_CHECK_EQUAL (log.chunks (), 10u);
+  BOOST_CHECK_EQUAL (log.layout ().toString (), layout.toString ());
+
+  for (std::size_t i = 0; i < n; i += 7)
+    {
+      const Matrix4x4<double> m = log.pose (base, i);
+      const Matrix4x4<double> expected = pose (i);
+      for (unsigned int e = 0; e < 16; ++e)
+	BOOST_CHECK_EQUAL (m.m[e], expected.m[e]);
+      // Positions keep their value when not set.
+      const double k = static_cast<double> (i - i % 2);
+      BOOST_CHECK_EQUAL (log.position (com, i).m_y, 2. * k);
+      BOOST_CHECK_CLOSE (log.angle (knee, i).value (),
+			 std::sin (static_cast<double> (i)), 1e-12);
+    }
+  CHECK_BAD_INDEX (log.value (n, 0));
+  CHECK_BAD_INDEX (log.pose (com, 0));
+
+  // The z translation of the base is a contiguous column in each chunk.
+  const std::size_t z = layout.column (base) + 11;
+  for (std::size_t k = 0; k < log.chunks (); ++k)
+    {
+      const double* column = log.column (k, z);
+      for (std::size_t i = 0; i < log.chunkSize (); ++i)
+	if (k * log.chunkSize () + i < n)
+	  BOOST_CHECK_EQUAL (column[i], pose (k * log.chunkSize () + i).m[11]);
+      if (k + 1 == log.chunks ())
+	BOOST_CHECK (std::isnan (log.column (k, 0)[log.chunkSize () - 1]));
+    }
+
+  // Access by time.
+  BOOST_CHECK_EQUAL (log.find (-1.), log.size ());
+  BOOST_CHECK_EQUAL (log.find (0.), 0u);
+  BOOST_CHECK_EQUAL (log.find (0.2565), 256u);
+  BOOST_CHECK_EQUAL (log.find (0.256), 256u);
+  BOOST_CHECK_EQUAL (log.find (1.0005), 1000u);
+  BOOST_CHECK_EQUAL (log.find (100.), n - 1);
+  std::remove (path);
+
+  BOOST_CHECK_THROW (TrajectoryLog missing (path), std::runtime_error);
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include <jrl/mathtools/trigonometry.hh>
+
+#define BOOST_TEST_MODULE trigonometry
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "common.hh"
+
+using namespace jrlMathTools::detail;
+
+typedef boost::mpl::list<float, double> floatingTypes_t;
+
+template <typename T>
+static T tolerance ()
+{
+  return std::is_same<T, float>::value ? T (1e-6) : T (1e-15);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (polynomials, T, floatingTypes_t)
+{
+  typedef Trigonometry<T, ScalarOps<T> > trigonometry_t;
+  for (int i = 0; i <= 1000; ++i)
+    {
+      const T r = T (i) / 1000;
+      BOOST_CHECK_SMALL (trigonometry_t::atan (r) - std::atan (r),
+			 2 * tolerance<T> ());
+      const T x = T (M_PI / 2) * r;
+      BOOST_CHECK_SMALL (trigonometry_t::sin (x) - std::sin (x),
+			 2 * tolerance<T> ());
+      BOOST_CHECK_SMALL (trigonometry_t::sin (-x) + std::sin (x),
+			 2 * tolerance<T> ());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (reducedSincos, T, floatingTypes_t)
+{
+  typedef Trigonometry<T, ScalarOps<T> > trigonometry_t;
+
+  // The error grows with the argument, relatively to the epsilon.
+  for (int i = -20000; i <= 20000; ++i)
+    {
+      const T x = T (i) / 100;
+      const T bound = tolerance<T> () * (4 + std::abs (x));
+      T s, c;
+      trigonometry_t::sincos (x, s, c);
+      BOOST_CHECK_SMALL (s - std::sin (x), bound);
+      BOOST_CHECK_SMALL (c - std::cos (x), bound);
+    }
+
+  // Quadrant boundaries.
+  for (int k = -8; k <= 8; ++k)
+    {
+      const T x = T (k * M_PI / 2);
+      T s, c;
+      trigonometry_t::sincos (x, s, c);
+      BOOST_CHECK_SMALL (s - std::sin (x), 16 * tolerance<T> ());
+      BOOST_CHECK_SMALL (c - std::cos (x), 16 * tolerance<T> ());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (wrappedSincos, T, floatingTypes_t)
+{
+  typedef WrappedSinCos<T, ScalarOps<T>, jrlMathTools::FULL_PRECISION>
+    sincos_t;
+  for (int i = -1000; i <= 1000; ++i)
+    {
+      const T x = T (M_PI) * T (i) / 1000;
+      T s, c;
+      sincos_t::run (x, s, c);
+      BOOST_CHECK_SMALL (s - std::sin (x), 2 * tolerance<T> ());
+      BOOST_CHECK_SMALL (c - std::cos (x), 2 * tolerance<T> ());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (wrap, T, floatingTypes_t)
+{
+  typedef Trigonometry<T, ScalarOps<T> > trigonometry_t;
+  const T twoPi = T (2 * M_PI);
+  const T pi = T (M_PI);
+  const T limit = std::is_same<T, float>::value ? T (4e5) : T (2e11);
+  const T epsilon = std::numeric_limits<T>::epsilon ();
+
+  // Exact up to limit, but next to the bounds where it is clamped.
+  for (T x = T (1); x < limit; x *= T (1.0123))
+    for (int sign = -1; sign <= 1; sign += 2)
+      {
+	const T y = T (sign) * x;
+	const T r = std::remainder (y, twoPi);
+	const T w = trigonometry_t::wrap (y);
+	if (pi - std::abs (r) > x * epsilon)
+	  BOOST_CHECK_EQUAL (w, r);
+	else
+	  BOOST_CHECK_SMALL (std::abs (w) - pi, 2 * x * epsilon);
+      }
+}
+
+#if JRL_MATHTOOLS_HAS_AVX2
+BOOST_AUTO_TEST_CASE_TEMPLATE (simd4, T, floatingTypes_t)
+{
+  typedef Simd4<T> V;
+  for (int i = -400; i <= 400; ++i)
+    {
+      const T in[4] = {T (i) / 10, T (i) / 10 + T (0.025),
+		       T (i) / 10 + T (0.05), T (i) / 10 + T (0.075)};
+      typename V::type s, c;
+      Trigonometry<T, V>::sincos (V::load (in), s, c);
+      T out[2][4];
+      V::store (out[0], s);
+      V::store (out[1], c);
+      for (unsigned l = 0; l < 4; ++l)
+	{
+	  T sl, cl;
+	  Trigonometry<T, ScalarOps<T> >::sincos (in[l], sl, cl);
+	  BOOST_CHECK_SMALL (out[0][l] - sl, 4 * tolerance<T> ());
+	  BOOST_CHECK_SMALL (out[1][l] - cl, 4 * tolerance<T> ());
+	}
+    }
+}
+#endif //! JRL_MATHTOOLS_HAS_AVX2
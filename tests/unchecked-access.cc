@@ -0,0 +1,97 @@
+// Copyright (C) 2008-2013 LAAS-CNRS, JRL AIST-CNRS.
+//
+// This file is part of jrl-mathtools.
+// jrl-mathtools is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// jrl-mathtools is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// You should have received a copy of the GNU Lesser General Public License
+// along with jrl-mathtools.  If not, see <http://www.gnu.org/licenses/>.
+
+// Check the real-time accessor policy regardless of the build type.
+#define JRL_MATHTOOLS_DISABLE_BOUNDS_CHECK
+
+#include <jrl/mathtools/vector3.hh>
+#include <jrl/mathtools/vector4.hh>
+#include <jrl/mathtools/matrix3x3.hh>
+#include <jrl/mathtools/matrix4x4.hh>
+
+#define BOOST_TEST_MODULE unchecked-access
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE (policy)
+{
+  BOOST_CHECK_EQUAL (JRL_MATHTOOLS_BOUNDS_CHECK, 0);
+}
+
+BOOST_AUTO_TEST_CASE (vector3)
+{
+  jrlMathTools::Vector3D<double> v (0., 1., 2.);
+  const jrlMathTools::Vector3D<double>& cv = v;
+
+  BOOST_CHECK (noexcept (v[0]));
+  BOOST_CHECK (noexcept (cv[0]));
+  BOOST_CHECK (noexcept (v (0)));
+  BOOST_CHECK (noexcept (cv (0)));
+
+  BOOST_CHECK_EQUAL (&v[0], &v.m_x);
+  BOOST_CHECK_EQUAL (&v[1], &v.m_y);
+  BOOST_CHECK_EQUAL (&v[2], &v.m_z);
+  for (unsigned i = 0; i < 3; ++i)
+    BOOST_CHECK_EQUAL (cv[i], static_cast<double> (i));
+}
+
+BOOST_AUTO_TEST_CASE (vector4)
+{
+  jrlMathTools::Vector4D<double> v (0., 1., 2., 3.);
+  const jrlMathTools::Vector4D<double>& cv = v;
+
+  BOOST_CHECK (noexcept (v[0]));
+  BOOST_CHECK (noexcept (cv[0]));
+  BOOST_CHECK (noexcept (v (0)));
+  BOOST_CHECK (noexcept (cv (0)));
+
+  BOOST_CHECK_EQUAL (&v[3], &v.m_w);
+  for (unsigned i = 0; i < 4; ++i)
+    BOOST_CHECK_EQUAL (cv[i], static_cast<double> (i));
+}
+
+BOOST_AUTO_TEST_CASE (matrix3x3)
+{
+  jrlMathTools::Matrix3x3<double> m;
+  const jrlMathTools::Matrix3x3<double>& cm = m;
+
+  BOOST_CHECK (noexcept (m[0]));
+  BOOST_CHECK (noexcept (cm[0]));
+  BOOST_CHECK (noexcept (m (0, 0)));
+  BOOST_CHECK (noexcept (cm (0, 0)));
+
+  for (unsigned i = 0; i < 3; ++i)
+    for (unsigned j = 0; j < 3; ++j)
+      m (i, j) = 3. * i + j;
+  for (unsigned i = 0; i < 9; ++i)
+    BOOST_CHECK_EQUAL (cm[i], static_cast<double> (i));
+}
+
+BOOST_AUTO_TEST_CASE (matrix4x4)
+{
+  jrlMathTools::Matrix4x4<double> m;
+  const jrlMathTools::Matrix4x4<double>& cm = m;
+
+  BOOST_CHECK (noexcept (m[0]));
+  BOOST_CHECK (noexcept (cm[0]));
+  BOOST_CHECK (noexcept (m (0, 0)));
+  BOOST_CHECK (noexcept (cm (0, 0)));
+
+  for (unsigned i = 0; i < 4; ++i)
+    for (unsigned j = 0; j < 4; ++j)
+      m (i, j) = 4. * i + j;
+  for (unsigned i = 0; i < 16; ++i)
+    BOOST_CHECK_EQUAL (cm[i], static_cast<double> (i));
+}
@@ -22,6 +22,8 @@
 #include <boost/test/output_test_stream.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <type_traits>
+
 #include "common.hh"
 
 using boost::test_tools::output_test_stream;
@@ -49,12 +51,12 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
   BOOST_CHECK_EQUAL (v[0], T ());
   BOOST_CHECK_EQUAL (v[1], T ());
   BOOST_CHECK_EQUAL (v[2], T ());
-  BOOST_CHECK_THROW (v[3], std::logic_error);
+  CHECK_BAD_INDEX (v[3]);
 
   BOOST_CHECK_EQUAL (v (0), T ());
   BOOST_CHECK_EQUAL (v (1), T ());
   BOOST_CHECK_EQUAL (v (2), T ());
-  BOOST_CHECK_THROW (v (3), std::logic_error);
+  CHECK_BAD_INDEX (v (3));
 
   BOOST_CHECK_EQUAL (v.m_x, T ());
   BOOST_CHECK_EQUAL (v.m_y, T ());
@@ -70,12 +72,12 @@ BOOST_AUTO_TEST_CASE (constructor)
   BOOST_CHECK_EQUAL (v[0], 0.);
   BOOST_CHECK_EQUAL (v[1], 1.);
   BOOST_CHECK_EQUAL (v[2], 2.);
-  BOOST_CHECK_THROW (v[3], std::logic_error);
+  CHECK_BAD_INDEX (v[3]);
 
   BOOST_CHECK_EQUAL (v (0), 0.);
   BOOST_CHECK_EQUAL (v (1), 1.);
   BOOST_CHECK_EQUAL (v (2), 2.);
-  BOOST_CHECK_THROW (v (3), std::logic_error);
+  CHECK_BAD_INDEX (v (3));
 
   BOOST_CHECK_EQUAL (v.m_x, 0.);
   BOOST_CHECK_EQUAL (v.m_y, 1.);
@@ -196,3 +198,25 @@ BOOST_AUTO_TEST_CASE (cross_product)
 
   BOOST_CHECK_EQUAL (v1 ^ v2, vres);
 }
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (triviallyCopyable, T, numericTypes_t)
+{
+  BOOST_CHECK (std::is_trivially_copyable<jrlMathTools::Vector3D<T> >::value);
+}
+
+BOOST_AUTO_TEST_CASE (constantExpression)
+{
+  constexpr jrlMathTools::Vector3D<double> v1 (4., 3., 10.);
+  constexpr jrlMathTools::Vector3D<double> v2 (12., 5., 2.);
+
+  constexpr jrlMathTools::Vector3D<double> vres (-44., 112., -16.);
+
+  static_assert ((v1 ^ v2) == vres, "constexpr cross product");
+  static_assert (v1 * v2 == 83., "constexpr dot product");
+  static_assert ((v1 + v2 - v2) == v1, "constexpr addition");
+  static_assert ((v1 * 2.) / 2. == v1, "constexpr scaling");
+  static_assert (v1.normsquared () == 125., "constexpr squared norm");
+
+  BOOST_CHECK (-v1 != v1);
+  BOOST_CHECK (! jrlMathTools::Vector3D<double> (v1).IsZero ());
+}
@@ -22,6 +22,8 @@
 #include <boost/test/output_test_stream.hpp>
 #include <boost/mpl/list.hpp>
 
+#include <type_traits>
+
 #include "common.hh"
 
 using boost::test_tools::output_test_stream;
@@ -51,13 +53,13 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (defaultConstructor, T, testTypes_t)
   BOOST_CHECK_EQUAL (v[1], T ());
   BOOST_CHECK_EQUAL (v[2], T ());
   BOOST_CHECK_EQUAL (v[3], T ());
-  BOOST_CHECK_THROW (v[4], std::logic_error);
+  CHECK_BAD_INDEX (v[4]);
 
   BOOST_CHECK_EQUAL (v (0), T ());
   BOOST_CHECK_EQUAL (v (1), T ());
   BOOST_CHECK_EQUAL (v (2), T ());
   BOOST_CHECK_EQUAL (v (3), T ());
-  BOOST_CHECK_THROW (v (4), std::logic_error);
+  CHECK_BAD_INDEX (v (4));
 
   BOOST_CHECK_EQUAL (v.m_x, T ());
   BOOST_CHECK_EQUAL (v.m_y, T ());
@@ -73,13 +75,13 @@ BOOST_AUTO_TEST_CASE (constructor)
   BOOST_CHECK_EQUAL (v[1], 1.);
   BOOST_CHECK_EQUAL (v[2], 2.);
   BOOST_CHECK_EQUAL (v[3], 3.);
-  BOOST_CHECK_THROW (v[4], std::logic_error);
+  CHECK_BAD_INDEX (v[4]);
 
   BOOST_CHECK_EQUAL (v (0), 0.);
   BOOST_CHECK_EQUAL (v (1), 1.);
   BOOST_CHECK_EQUAL (v (2), 2.);
   BOOST_CHECK_EQUAL (v (3), 3.);
-  BOOST_CHECK_THROW (v (4), std::logic_error);
+  CHECK_BAD_INDEX (v (4));
 
   BOOST_CHECK_EQUAL (v.m_x, 0.);
   BOOST_CHECK_EQUAL (v.m_y, 1.);
@@ -168,3 +170,21 @@ BOOST_AUTO_TEST_CASE (normsquared)
   BOOST_CHECK_EQUAL (v1.normsquared (),
 		     4. * 4. + 3. * 3. + 10. * 10. + 12. * 12.);
 }
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (triviallyCopyable, T, numericTypes_t)
+{
+  BOOST_CHECK (std::is_trivially_copyable<jrlMathTools::Vector4D<T> >::value);
+}
+
+BOOST_AUTO_TEST_CASE (constantExpression)
+{
+  constexpr jrlMathTools::Vector4D<double> v1 (4., 3., 10., 12.);
+  constexpr jrlMathTools::Vector4D<double> v2 (1., 2., 3.);
+
+  static_assert (v2.m_w == 1., "constexpr default homogeneous coordinate");
+  static_assert ((v1 + v2 - v2) == v1, "constexpr addition");
+  static_assert ((v1 * 2.) / 2. == v1, "constexpr scaling");
+  static_assert (v1.normsquared () == 269., "constexpr squared norm");
+
+  BOOST_CHECK_EQUAL (-v1 + v1, jrlMathTools::Vector4D<double> (0., 0., 0., 0.));
+}